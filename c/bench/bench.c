@@ -0,0 +1,878 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil -*-
+ * 
+ * SmolTLV - Simple serialization format for JSON/CBOR-like data model 
+ * for embedded devices - C API benchmark.
+ * 
+ * Copyright (c) 2025 Aleš Hakl
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <smoltlv.h>
+#include <smoltlv_archive.h>
+#include <smoltlv_cbor.h>
+#include <smoltlv_diff.h>
+#include <smoltlv_dom.h>
+#include <smoltlv_ingest.h>
+#include <smoltlv_json.h>
+#include <smoltlv_parallel.h>
+#include <smoltlv_shared.h>
+#include <corpus.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+ * Every benchmark prints one JSON line:
+ *
+ *   {"bench": ..., "corpus": ..., "ops": ..., "bytes": ...,
+ *    "ns_per_op": ..., "mb_per_s": ..., "check": ...}
+ *
+ * Timings are the best of BENCH_ROUNDS runs, "check" is a value derived
+ * from the results so that runs over the same corpora are comparable and
+ * the work cannot be optimized away. Optional argument filters benchmarks
+ * by substring of "bench/corpus".
+ */
+
+#define BENCH_ROUNDS 5
+
+typedef struct BenchResult_s {
+    size_t ops;
+    size_t bytes;
+    int64_t check;
+} BenchResult;
+
+typedef BenchResult (*BenchFunction)(const BenchCorpus *corpus);
+
+static const char *bench_filter = NULL;
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static void run(const char *name, const BenchCorpus *corpus, BenchFunction function) {
+    const char *corpus_name = corpus ? corpus->name : "none";
+    char label[128];
+    snprintf(label, sizeof(label), "%s/%s", name, corpus_name);
+    if (bench_filter && !strstr(label, bench_filter)) {
+        return;
+    }
+
+    BenchResult result = { 0, 0, 0 };
+    double best = 0;
+    for (int r = 0; r < BENCH_ROUNDS; r++) {
+        double start = now_ns();
+        result = function(corpus);
+        double elapsed = now_ns() - start;
+        if (r == 0 || elapsed < best) {
+            best = elapsed;
+        }
+    }
+
+    if (best <= 0) {
+        best = 1;
+    }
+    printf("{\"bench\": \"%s\", \"corpus\": \"%s\", \"ops\": %zu, \"bytes\": %zu, "
+           "\"ns_per_op\": %.3f, \"mb_per_s\": %.1f, \"check\": %lld}\n",
+           name, corpus_name, result.ops, result.bytes,
+           best / (double)result.ops, (double)result.bytes * 1e3 / best,
+           (long long)result.check);
+    fflush(stdout);
+}
+
+static SmolTLV_Item corpus_root(const BenchCorpus *corpus) {
+    SmolTLV_Item item = { corpus->buffer };
+    return item;
+}
+
+/*
+ * Decoder
+ */
+
+static void traverse(SmolTLV_Item container, BenchResult *result) {
+    SmolTLV_Cursor cursor;
+    SmolTLV_Item item;
+    SmolTLV_Cursor_for_item(&cursor, container);
+    while (SmolTLV_Cursor_next(&cursor, &item) == SMOLTLV_STATUS_OK) {
+        result->ops++;
+        result->check += SmolTLV_Item_get_type_raw(item);
+        if (SmolTLV_Item_is_container(item)) {
+            traverse(item, result);
+        }
+    }
+}
+
+static BenchResult bench_traverse(const BenchCorpus *corpus) {
+    BenchResult result = { 1, corpus->size, 0 };
+    traverse(corpus_root(corpus), &result);
+    return result;
+}
+
+static BenchResult bench_dict_get_flat(const BenchCorpus *corpus) {
+    SmolTLV_Item dict = corpus_root(corpus), value;
+    size_t count = bench_corpus_flat_count();
+    BenchResult result = { 0, 0, 0 };
+    char key[32];
+
+    // Visit every key once in a scattered order
+    for (size_t i = 0; i < count; i++) {
+        bench_corpus_flat_key((i * 7919u) % count, key, sizeof(key));
+        if (SmolTLV_Item_dict_get(dict, key, &value)) {
+            result.check += SmolTLV_Item_get_type_raw(value);
+            result.bytes += (size_t)(value.pointer - dict.pointer);
+        }
+        result.ops++;
+    }
+    return result;
+}
+
+static BenchResult bench_dict_get_records(const BenchCorpus *corpus) {
+    SmolTLV_Cursor cursor;
+    SmolTLV_Item record, value;
+    BenchResult result = { 0, corpus->size, 0 };
+
+    SmolTLV_Cursor_for_item(&cursor, corpus_root(corpus));
+    while (SmolTLV_Cursor_next(&cursor, &record) == SMOLTLV_STATUS_OK) {
+        bool ok;
+        if (SmolTLV_Item_dict_get(record, "ok", &value) &&
+            SmolTLV_Item_as_bool(value, &ok) && ok) {
+            result.check++;
+        }
+        result.ops++;
+    }
+    return result;
+}
+
+static BenchResult bench_list_at(const BenchCorpus *corpus) {
+    SmolTLV_Item list = corpus_root(corpus), value;
+    BenchResult result = { 0, 0, 0 };
+    size_t count = 0;
+
+    SmolTLV_Cursor cursor;
+    SmolTLV_Cursor_for_item(&cursor, list);
+    while (SmolTLV_Cursor_next(&cursor, &value) == SMOLTLV_STATUS_OK) {
+        count++;
+    }
+
+    // Lookups are linear, bytes count the prefix skipped by each of them
+    for (size_t i = 0; i < 256; i++) {
+        size_t index = (i * 104729u) % count;
+        if (SmolTLV_Item_list_at(list, index, &value)) {
+            result.check += (int64_t)index;
+            result.bytes += (size_t)(value.pointer - list.pointer);
+        }
+        result.ops++;
+    }
+    return result;
+}
+
+static BenchResult bench_count(const BenchCorpus *corpus) {
+    BenchResult result = { 1, corpus->size, 0 };
+    size_t count = 0;
+    if (SmolTLV_Item_count(corpus_root(corpus), &count)) {
+        result.check = (int64_t)count;
+    }
+    return result;
+}
+
+/** Index build of the first lookup is included in the timing */
+static BenchResult bench_shared_dict_get(const BenchCorpus *corpus) {
+    SmolTLV_SharedDocument *document = SmolTLV_SharedDocument_create(corpus->buffer, corpus->size, NULL);
+    SmolTLV_Item dict = corpus_root(corpus), value;
+    size_t count = bench_corpus_flat_count();
+    BenchResult result = { 0, 0, 0 };
+    char key[32];
+
+    for (size_t i = 0; i < count; i++) {
+        bench_corpus_flat_key((i * 7919u) % count, key, sizeof(key));
+        if (SmolTLV_SharedDocument_dict_get(document, dict, key, &value)) {
+            result.check += SmolTLV_Item_get_type_raw(value);
+            result.bytes += (size_t)(value.pointer - dict.pointer);
+        }
+        result.ops++;
+    }
+    SmolTLV_SharedDocument_destroy(document);
+    return result;
+}
+
+static BenchResult bench_shared_list_at(const BenchCorpus *corpus) {
+    SmolTLV_SharedDocument *document = SmolTLV_SharedDocument_create(corpus->buffer, corpus->size, NULL);
+    SmolTLV_Item list = corpus_root(corpus), value;
+    BenchResult result = { 0, 0, 0 };
+    size_t count = 0;
+
+    SmolTLV_Cursor cursor;
+    SmolTLV_Cursor_for_item(&cursor, list);
+    while (SmolTLV_Cursor_next(&cursor, &value) == SMOLTLV_STATUS_OK) {
+        count++;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        size_t index = (i * 104729u) % count;
+        if (SmolTLV_SharedDocument_list_at(document, list, index, &value)) {
+            result.check += (int64_t)index;
+            result.bytes += (size_t)(value.pointer - list.pointer);
+        }
+        result.ops++;
+    }
+    SmolTLV_SharedDocument_destroy(document);
+    return result;
+}
+
+static BenchResult bench_dom_create(const BenchCorpus *corpus) {
+    SmolTLV_Dom *dom;
+    BenchResult result = { 1, corpus->size, 0 };
+    if (SmolTLV_Dom_create(corpus->buffer, corpus->size, &dom) == SMOLTLV_STATUS_OK) {
+        result.check = (int64_t)SmolTLV_Dom_node_count(dom);
+        SmolTLV_Dom_destroy(dom);
+    }
+    return result;
+}
+
+/** DOM is built once outside of the timing loop */
+static SmolTLV_Dom *bench_dom;
+
+static BenchResult bench_dom_dict_get(const BenchCorpus *corpus) {
+    size_t count = bench_corpus_flat_count();
+    BenchResult result = { 0, 0, 0 };
+    SmolTLV_DomNode value;
+    char key[32];
+    (void)corpus;
+
+    for (size_t i = 0; i < count; i++) {
+        bench_corpus_flat_key((i * 7919u) % count, key, sizeof(key));
+        if (SmolTLV_Dom_dict_get(bench_dom, 0, key, &value)) {
+            result.check += SmolTLV_Dom_get_type(bench_dom, value);
+        }
+        result.ops++;
+    }
+    return result;
+}
+
+static BenchResult bench_dom_list_at(const BenchCorpus *corpus) {
+    size_t count = SmolTLV_Dom_get_count(bench_dom, 0);
+    BenchResult result = { 0, 0, 0 };
+    SmolTLV_DomNode value;
+    (void)corpus;
+
+    for (size_t i = 0; i < count; i++) {
+        size_t index = (i * 104729u) % count;
+        if (SmolTLV_Dom_list_at(bench_dom, 0, index, &value)) {
+            result.check += (int64_t)index;
+        }
+        result.ops++;
+    }
+    return result;
+}
+
+static void run_dom(const char *name, const BenchCorpus *corpus, BenchFunction function) {
+    if (SmolTLV_Dom_create(corpus->buffer, corpus->size, &bench_dom) != SMOLTLV_STATUS_OK) {
+        return;
+    }
+    run(name, corpus, function);
+    SmolTLV_Dom_destroy(bench_dom);
+    bench_dom = NULL;
+}
+
+/*
+ * Ingestion
+ */
+
+#define INGEST_SOURCES 16
+
+/** Items of corpus root list written as top-level stream, one file per
+ * source */
+static FILE *bench_ingest_files[INGEST_SOURCES];
+
+static bool bench_ingest_open(const BenchCorpus *corpus) {
+    SmolTLV_Item root = corpus_root(corpus);
+    for (size_t i = 0; i < INGEST_SOURCES; i++) {
+        bench_ingest_files[i] = tmpfile();
+        if (!bench_ingest_files[i]) {
+            return false;
+        }
+        fwrite(SmolTLV_Item_get_value(root), 1, SmolTLV_Item_get_length(root), bench_ingest_files[i]);
+        fflush(bench_ingest_files[i]);
+    }
+    return true;
+}
+
+static void bench_ingest_close(void) {
+    for (size_t i = 0; i < INGEST_SOURCES; i++) {
+        if (bench_ingest_files[i]) {
+            fclose(bench_ingest_files[i]);
+        }
+        bench_ingest_files[i] = NULL;
+    }
+}
+
+static SmolTLV_Status bench_ingest_item(SmolTLV_Item item, void *context) {
+    BenchResult *result = (BenchResult *)context;
+    result->ops++;
+    result->bytes += 4u + SmolTLV_Item_get_length(item);
+    return SMOLTLV_STATUS_OK;
+}
+
+/** Check is number of system calls */
+static BenchResult bench_ingest(bool no_io_uring) {
+    SmolTLV_IngestConfig config = { 0 };
+    SmolTLV_IngestStats stats;
+    SmolTLV_Ingest *ingest;
+    BenchResult result = { 0, 0, 0 };
+    config.no_io_uring = no_io_uring;
+    if (SmolTLV_Ingest_create(&config, &ingest) != SMOLTLV_STATUS_OK) {
+        return result;
+    }
+
+    for (size_t i = 0; i < INGEST_SOURCES; i++) {
+        SmolTLV_IngestSource source = { fileno(bench_ingest_files[i]), bench_ingest_item, NULL, &result };
+        lseek(source.fd, 0, SEEK_SET);
+        SmolTLV_Ingest_add(ingest, &source);
+    }
+    SmolTLV_Ingest_run(ingest);
+    SmolTLV_Ingest_get_stats(ingest, &stats);
+    result.check = (int64_t)stats.syscalls;
+    SmolTLV_Ingest_destroy(ingest);
+    return result;
+}
+
+static BenchResult bench_ingest_io_uring(const BenchCorpus *corpus) {
+    (void)corpus;
+    return bench_ingest(false);
+}
+
+static BenchResult bench_ingest_read(const BenchCorpus *corpus) {
+    (void)corpus;
+    return bench_ingest(true);
+}
+
+/*
+ * Archive
+ */
+
+typedef struct BenchArchiveSink_s {
+    uint8_t *buffer;
+    size_t size;
+    size_t capacity;
+} BenchArchiveSink;
+
+/** Archive of items of corpus root list, opened by run_archive */
+static BenchArchiveSink bench_archive_sink;
+static SmolTLV_Archive *bench_archive;
+static uint8_t *bench_archive_output;
+
+static SmolTLV_Status bench_archive_write(const uint8_t *data, size_t length, void *context) {
+    BenchArchiveSink *sink = (BenchArchiveSink *)context;
+    if (sink->size + length > sink->capacity) {
+        size_t capacity = sink->capacity ? sink->capacity : 65536u;
+        while (capacity < sink->size + length) {
+            capacity *= 2u;
+        }
+        uint8_t *buffer = (uint8_t *)realloc(sink->buffer, capacity);
+        if (!buffer) {
+            return SMOLTLV_STATUS_OUT_OF_MEMORY;
+        }
+        sink->buffer = buffer;
+        sink->capacity = capacity;
+    }
+    memcpy(sink->buffer + sink->size, data, length);
+    sink->size += length;
+    return SMOLTLV_STATUS_OK;
+}
+
+/** Check is archive size */
+static BenchResult bench_archive_create(const BenchCorpus *corpus) {
+    SmolTLV_Item root = corpus_root(corpus);
+    BenchResult result = { 1, SmolTLV_Item_get_length(root), 0 };
+    SmolTLV_ArchiveWriter *writer;
+    bench_archive_sink.size = 0;
+    if (SmolTLV_ArchiveWriter_create(0, bench_archive_write, &bench_archive_sink, &writer) != SMOLTLV_STATUS_OK) {
+        return result;
+    }
+    if (SmolTLV_ArchiveWriter_write(writer, SmolTLV_Item_get_value(root), result.bytes) == SMOLTLV_STATUS_OK &&
+        SmolTLV_ArchiveWriter_finish(writer) == SMOLTLV_STATUS_OK) {
+        result.check = (int64_t)bench_archive_sink.size;
+    }
+    SmolTLV_ArchiveWriter_destroy(writer);
+    return result;
+}
+
+static BenchResult bench_archive_read_all(unsigned threads) {
+    size_t size = SmolTLV_Archive_stream_size(bench_archive);
+    BenchResult result = { 1, size, 0 };
+    if (SmolTLV_Archive_read_all(bench_archive, bench_archive_output, size, threads) == SMOLTLV_STATUS_OK) {
+        result.check = (int64_t)bench_archive_output[size / 2u];
+    }
+    return result;
+}
+
+static BenchResult bench_archive_read_all_1(const BenchCorpus *corpus) {
+    (void)corpus;
+    return bench_archive_read_all(1);
+}
+
+static BenchResult bench_archive_read_all_4(const BenchCorpus *corpus) {
+    (void)corpus;
+    return bench_archive_read_all(4);
+}
+
+/** Random access, one frame decompressed per item */
+static BenchResult bench_archive_read_item(const BenchCorpus *corpus) {
+    (void)corpus;
+    uint64_t count = SmolTLV_Archive_item_count(bench_archive);
+    size_t size = SmolTLV_Archive_stream_size(bench_archive);
+    BenchResult result = { 0, 0, 0 };
+    SmolTLV_Item item;
+    for (uint64_t i = 0; i < 1000u && count > 0; i++) {
+        uint64_t index = (i * 2654435761u) % count;
+        if (SmolTLV_Archive_read_item(bench_archive, index, bench_archive_output, size,
+                                      &item, NULL) == SMOLTLV_STATUS_OK) {
+            result.ops++;
+            result.bytes += 4u + SmolTLV_Item_get_length(item);
+            result.check += SmolTLV_Item_get_type(item);
+        }
+    }
+    return result;
+}
+
+static void run_archive(const BenchCorpus *corpus) {
+    run("archive_create", corpus, bench_archive_create);
+    if (bench_archive_create(corpus).check == 0 ||
+        SmolTLV_Archive_open(bench_archive_sink.buffer, bench_archive_sink.size,
+                             &bench_archive) != SMOLTLV_STATUS_OK) {
+        return;
+    }
+    // Frames of a single item can be larger than the stream
+    bench_archive_output = (uint8_t *)malloc(SmolTLV_Archive_stream_size(bench_archive) + corpus->size);
+    if (bench_archive_output) {
+        run("archive_read_all_1", corpus, bench_archive_read_all_1);
+        run("archive_read_all_4", corpus, bench_archive_read_all_4);
+        run("archive_read_item", corpus, bench_archive_read_item);
+    }
+    free(bench_archive_output);
+    bench_archive_output = NULL;
+    SmolTLV_Archive_destroy(bench_archive);
+    bench_archive = NULL;
+}
+
+/*
+ * Diff
+ */
+
+/** Corpus copy with one INT value changed and patch to it, set up by
+ * run_diff */
+static uint8_t *bench_diff_target;
+static const uint8_t *bench_diff_patch;
+
+/** Check is patch size */
+static BenchResult bench_diff(const BenchCorpus *corpus) {
+    SmolTLV_Item target = { bench_diff_target };
+    BenchResult result = { 1, corpus->size, 0 };
+    SmolTLV_Encoder *encoder = SmolTLV_Encoder_create();
+    if (SmolTLV_diff(corpus_root(corpus), target, encoder) == SMOLTLV_STATUS_OK) {
+        result.check = (int64_t)SmolTLV_Encoder_get_position(encoder);
+    }
+    SmolTLV_Encoder_destroy(encoder);
+    return result;
+}
+
+static BenchResult bench_diff_apply(const BenchCorpus *corpus) {
+    SmolTLV_Item patch = { bench_diff_patch };
+    BenchResult result = { 1, corpus->size, 0 };
+    size_t size;
+    uint8_t *output = (uint8_t *)malloc(corpus->size);
+    if (output && SmolTLV_diff_apply(corpus_root(corpus), patch, output, corpus->size, &size) == SMOLTLV_STATUS_OK) {
+        result.check = memcmp(output, bench_diff_target, size) == 0 ? (int64_t)size : -1;
+    }
+    free(output);
+    return result;
+}
+
+static void run_diff(const BenchCorpus *corpus) {
+    SmolTLV_Item root = corpus_root(corpus), record, key, value;
+    SmolTLV_Cursor cursor;
+    size_t count, size;
+
+    // Last byte of first INT value of the middle record
+    bench_diff_target = (uint8_t *)malloc(corpus->size);
+    if (!bench_diff_target || !SmolTLV_Item_count(root, &count) ||
+        !SmolTLV_Item_list_at(root, count / 2u, &record)) {
+        free(bench_diff_target);
+        return;
+    }
+    memcpy(bench_diff_target, corpus->buffer, corpus->size);
+    SmolTLV_Cursor_for_item(&cursor, record);
+    while (SmolTLV_Cursor_next(&cursor, &key) == SMOLTLV_STATUS_OK &&
+           SmolTLV_Cursor_next(&cursor, &value) == SMOLTLV_STATUS_OK) {
+        if (SmolTLV_Item_get_type(value) == SMOLTLV_TYPE_INT) {
+            bench_diff_target[(size_t)(value.pointer - corpus->buffer) + 11u] ^= 1u;
+            break;
+        }
+    }
+
+    SmolTLV_Item target = { bench_diff_target };
+    SmolTLV_Encoder *encoder = SmolTLV_Encoder_create();
+    if (SmolTLV_diff(root, target, encoder) == SMOLTLV_STATUS_OK &&
+        SmolTLV_Encoder_finalize(encoder, &bench_diff_patch, &size) == SMOLTLV_STATUS_OK) {
+        run("diff", corpus, bench_diff);
+        run("diff_apply", corpus, bench_diff_apply);
+        free((void*)bench_diff_patch);
+    }
+    SmolTLV_Encoder_destroy(encoder);
+    free(bench_diff_target);
+    bench_diff_patch = NULL;
+    bench_diff_target = NULL;
+}
+
+/*
+ * Encoder
+ */
+
+#define ENCODER_OPS 200000u
+
+static const uint8_t bench_blob[4096] = { 0xAB };
+static const int64_t bench_ints[256] = { 1, -1, 1000000 };
+static const double bench_doubles[256] = { 1.5, -2.25 };
+
+static BenchResult encoder_result(SmolTLV_Encoder *encoder, size_t ops) {
+    BenchResult result = { ops, SmolTLV_Encoder_get_position(encoder), 0 };
+    result.check = (int64_t)result.bytes;
+    SmolTLV_Encoder_destroy(encoder);
+    return result;
+}
+
+static BenchResult bench_write_null(const BenchCorpus *corpus) {
+    (void)corpus;
+    SmolTLV_Encoder *encoder = SmolTLV_Encoder_create();
+    for (size_t i = 0; i < ENCODER_OPS; i++) {
+        SmolTLV_Encoder_write_null(encoder);
+    }
+    return encoder_result(encoder, ENCODER_OPS);
+}
+
+static BenchResult bench_write_bool(const BenchCorpus *corpus) {
+    (void)corpus;
+    SmolTLV_Encoder *encoder = SmolTLV_Encoder_create();
+    for (size_t i = 0; i < ENCODER_OPS; i++) {
+        SmolTLV_Encoder_write_bool(encoder, i & 1u);
+    }
+    return encoder_result(encoder, ENCODER_OPS);
+}
+
+static BenchResult bench_write_int(const BenchCorpus *corpus) {
+    (void)corpus;
+    SmolTLV_Encoder *encoder = SmolTLV_Encoder_create();
+    for (size_t i = 0; i < ENCODER_OPS; i++) {
+        SmolTLV_Encoder_write_int(encoder, (int64_t)i * 2654435761);
+    }
+    return encoder_result(encoder, ENCODER_OPS);
+}
+
+static BenchResult bench_write_string(const BenchCorpus *corpus) {
+    (void)corpus;
+    SmolTLV_Encoder *encoder = SmolTLV_Encoder_create();
+    for (size_t i = 0; i < ENCODER_OPS; i++) {
+        SmolTLV_Encoder_write_string(encoder, "temperature_celsius");
+    }
+    return encoder_result(encoder, ENCODER_OPS);
+}
+
+static BenchResult bench_write_bytes_small(const BenchCorpus *corpus) {
+    (void)corpus;
+    SmolTLV_Encoder *encoder = SmolTLV_Encoder_create();
+    for (size_t i = 0; i < ENCODER_OPS; i++) {
+        SmolTLV_Encoder_write_bytes(encoder, bench_blob, 64);
+    }
+    return encoder_result(encoder, ENCODER_OPS);
+}
+
+static BenchResult bench_write_bytes_large(const BenchCorpus *corpus) {
+    (void)corpus;
+    SmolTLV_Encoder *encoder = SmolTLV_Encoder_create();
+    for (size_t i = 0; i < ENCODER_OPS / 100u; i++) {
+        SmolTLV_Encoder_write_bytes(encoder, bench_blob, sizeof(bench_blob));
+    }
+    return encoder_result(encoder, ENCODER_OPS / 100u);
+}
+
+static BenchResult bench_write_int64_array(const BenchCorpus *corpus) {
+    (void)corpus;
+    SmolTLV_Encoder *encoder = SmolTLV_Encoder_create();
+    for (size_t i = 0; i < ENCODER_OPS / 100u; i++) {
+        SmolTLV_Encoder_write_int64_array(encoder, bench_ints, 256);
+    }
+    return encoder_result(encoder, ENCODER_OPS / 100u);
+}
+
+static BenchResult bench_write_double_array(const BenchCorpus *corpus) {
+    (void)corpus;
+    SmolTLV_Encoder *encoder = SmolTLV_Encoder_create();
+    for (size_t i = 0; i < ENCODER_OPS / 100u; i++) {
+        SmolTLV_Encoder_write_double_array(encoder, bench_doubles, 256);
+    }
+    return encoder_result(encoder, ENCODER_OPS / 100u);
+}
+
+static BenchResult bench_write_empty_list(const BenchCorpus *corpus) {
+    (void)corpus;
+    SmolTLV_Encoder *encoder = SmolTLV_Encoder_create();
+    for (size_t i = 0; i < ENCODER_OPS; i++) {
+        SmolTLV_Encoder_start_list(encoder);
+        SmolTLV_Encoder_end(encoder);
+    }
+    return encoder_result(encoder, ENCODER_OPS);
+}
+
+static BenchResult bench_write_record(const BenchCorpus *corpus) {
+    (void)corpus;
+    SmolTLV_Encoder *encoder = SmolTLV_Encoder_create();
+    for (size_t i = 0; i < ENCODER_OPS / 10u; i++) {
+        SmolTLV_Encoder_start_dict(encoder);
+        SmolTLV_Encoder_write_string(encoder, "id");
+        SmolTLV_Encoder_write_int(encoder, (int64_t)i);
+        SmolTLV_Encoder_write_string(encoder, "name");
+        SmolTLV_Encoder_write_string(encoder, "sensor");
+        SmolTLV_Encoder_write_string(encoder, "tags");
+        SmolTLV_Encoder_start_list(encoder);
+        SmolTLV_Encoder_write_string(encoder, "a");
+        SmolTLV_Encoder_write_string(encoder, "b");
+        SmolTLV_Encoder_end(encoder);
+        SmolTLV_Encoder_end(encoder);
+    }
+    return encoder_result(encoder, ENCODER_OPS / 10u);
+}
+
+static BenchResult bench_write_item(const BenchCorpus *corpus) {
+    SmolTLV_Encoder *encoder = SmolTLV_Encoder_create();
+    SmolTLV_Cursor cursor;
+    SmolTLV_Item item;
+    size_t ops = 0;
+
+    SmolTLV_Cursor_for_item(&cursor, corpus_root(corpus));
+    while (SmolTLV_Cursor_next(&cursor, &item) == SMOLTLV_STATUS_OK) {
+        SmolTLV_Encoder_write_item(encoder, item);
+        ops++;
+    }
+    return encoder_result(encoder, ops);
+}
+
+static SmolTLV_Status encode_records(SmolTLV_Encoder *encoder,
+                                     size_t begin,
+                                     size_t end,
+                                     void *context) {
+    (void)context;
+    for (size_t i = begin; i < end; i++) {
+        SmolTLV_Encoder_start_dict(encoder);
+        SmolTLV_Encoder_write_string(encoder, "id");
+        SmolTLV_Encoder_write_int(encoder, (int64_t)i);
+        SmolTLV_Encoder_write_string(encoder, "name");
+        SmolTLV_Encoder_write_string(encoder, "sensor");
+        SmolTLV_Encoder_write_string(encoder, "value");
+        SmolTLV_Encoder_write_int(encoder, (int64_t)(i * 31u));
+        SmolTLV_Encoder_end(encoder);
+    }
+    return SMOLTLV_STATUS_OK;
+}
+
+static BenchResult parallel_list(unsigned thread_count) {
+    SmolTLV_ParallelList list = { encode_records, NULL, 200000u, thread_count };
+    SmolTLV_Encoder *encoder = SmolTLV_Encoder_create();
+    SmolTLV_ParallelList_encode(&list, encoder);
+    return encoder_result(encoder, list.count);
+}
+
+static BenchResult bench_parallel_list_1(const BenchCorpus *corpus) {
+    (void)corpus;
+    return parallel_list(1);
+}
+
+static BenchResult bench_parallel_list_4(const BenchCorpus *corpus) {
+    (void)corpus;
+    return parallel_list(4);
+}
+
+/** Counts transcoder output without keeping it */
+static SmolTLV_Status output_count(const uint8_t *data, size_t length, void *context) {
+    BenchResult *result = (BenchResult *)context;
+    result->bytes += length;
+    result->check += data[length - 1u];
+    return SMOLTLV_STATUS_OK;
+}
+
+static BenchResult bench_json_write(const BenchCorpus *corpus) {
+    BenchResult result = { corpus->item_count, 0, 0 };
+    SmolTLV_json_write(corpus->buffer, corpus->size, output_count, &result);
+    return result;
+}
+
+static BenchResult bench_cbor_write(const BenchCorpus *corpus) {
+    BenchResult result = { corpus->item_count, 0, 0 };
+    SmolTLV_cbor_write(corpus->buffer, corpus->size, output_count, &result);
+    return result;
+}
+
+typedef SmolTLV_Status (*BenchRenderFunction)(const uint8_t *buffer,
+                                              size_t size,
+                                              SmolTLV_WriteFunction write,
+                                              void *context);
+
+/** Corpus transcoded to another format */
+typedef struct BenchRendering_s {
+    const BenchCorpus *corpus;
+    uint8_t *data;
+    size_t size;
+} BenchRendering;
+
+static BenchRendering bench_json_renderings[BENCH_CORPUS_COUNT];
+static BenchRendering bench_cbor_renderings[BENCH_CORPUS_COUNT];
+
+static SmolTLV_Status rendering_append(const uint8_t *data, size_t length, void *context) {
+    BenchRendering *rendering = (BenchRendering *)context;
+    uint8_t *grown = (uint8_t *)realloc(rendering->data, rendering->size + length);
+    if (!grown) {
+        return SMOLTLV_STATUS_OUT_OF_MEMORY;
+    }
+    memcpy(grown + rendering->size, data, length);
+    rendering->data = grown;
+    rendering->size += length;
+    return SMOLTLV_STATUS_OK;
+}
+
+/** Rendering of corpus, made once outside of timed runs */
+static const BenchRendering *corpus_render(BenchRendering *renderings,
+                                           const BenchCorpus *corpus,
+                                           BenchRenderFunction render) {
+    for (size_t i = 0; i < BENCH_CORPUS_COUNT; i++) {
+        BenchRendering *rendering = &renderings[i];
+        if (rendering->corpus == corpus) {
+            return rendering;
+        }
+        if (!rendering->corpus) {
+            rendering->corpus = corpus;
+            render(corpus->buffer, corpus->size, rendering_append, rendering);
+            return rendering;
+        }
+    }
+    return NULL;
+}
+
+static BenchResult bench_json_encode(const BenchCorpus *corpus) {
+    const BenchRendering *json = corpus_render(bench_json_renderings, corpus, SmolTLV_json_write);
+    SmolTLV_Encoder *encoder = SmolTLV_Encoder_create_with_size(json->size);
+    SmolTLV_json_encode((const char *)json->data, json->size, encoder, NULL);
+    BenchResult result = encoder_result(encoder, corpus->item_count);
+    result.bytes = json->size;
+    return result;
+}
+
+static BenchResult bench_cbor_encode(const BenchCorpus *corpus) {
+    const BenchRendering *cbor = corpus_render(bench_cbor_renderings, corpus, SmolTLV_cbor_write);
+    SmolTLV_Encoder *encoder = SmolTLV_Encoder_create_with_size(corpus->size);
+    SmolTLV_cbor_encode(cbor->data, cbor->size, encoder, NULL);
+    BenchResult result = encoder_result(encoder, corpus->item_count);
+    result.bytes = cbor->size;
+    return result;
+}
+
+int main(int argc, char **argv) {
+    BenchCorpus corpora[BENCH_CORPUS_COUNT];
+
+    if (argc > 1) {
+        bench_filter = argv[1];
+    }
+
+    for (int kind = 0; kind < BENCH_CORPUS_COUNT; kind++) {
+        if (bench_corpus_generate((BenchCorpusKind)kind, &corpora[kind]) != SMOLTLV_STATUS_OK) {
+            fprintf(stderr, "Failed to generate corpus %d\n", kind);
+            return 1;
+        }
+    }
+
+    for (int kind = 0; kind < BENCH_CORPUS_COUNT; kind++) {
+        run("cursor_traverse", &corpora[kind], bench_traverse);
+    }
+
+    run("dict_get", &corpora[BENCH_CORPUS_FLAT_DICT], bench_dict_get_flat);
+    run("dict_get", &corpora[BENCH_CORPUS_RECORDS], bench_dict_get_records);
+    run("list_at", &corpora[BENCH_CORPUS_INT_LIST], bench_list_at);
+    run("list_at", &corpora[BENCH_CORPUS_BLOBS], bench_list_at);
+    run("list_at", &corpora[BENCH_CORPUS_RECORDS], bench_list_at);
+    run("count", &corpora[BENCH_CORPUS_INT_LIST], bench_count);
+    run("count", &corpora[BENCH_CORPUS_BLOBS], bench_count);
+    run("count", &corpora[BENCH_CORPUS_RECORDS], bench_count);
+    run("shared_dict_get", &corpora[BENCH_CORPUS_FLAT_DICT], bench_shared_dict_get);
+    run("shared_list_at", &corpora[BENCH_CORPUS_INT_LIST], bench_shared_list_at);
+    run("shared_list_at", &corpora[BENCH_CORPUS_RECORDS], bench_shared_list_at);
+    run("dom_create", &corpora[BENCH_CORPUS_FLAT_DICT], bench_dom_create);
+    run("dom_create", &corpora[BENCH_CORPUS_DEEP_NESTING], bench_dom_create);
+    run("dom_create", &corpora[BENCH_CORPUS_RECORDS], bench_dom_create);
+    run_dom("dom_dict_get", &corpora[BENCH_CORPUS_FLAT_DICT], bench_dom_dict_get);
+    run_dom("dom_list_at", &corpora[BENCH_CORPUS_INT_LIST], bench_dom_list_at);
+    run_dom("dom_list_at", &corpora[BENCH_CORPUS_RECORDS], bench_dom_list_at);
+    if (bench_ingest_open(&corpora[BENCH_CORPUS_RECORDS])) {
+        run("ingest_io_uring", &corpora[BENCH_CORPUS_RECORDS], bench_ingest_io_uring);
+        run("ingest_read", &corpora[BENCH_CORPUS_RECORDS], bench_ingest_read);
+    }
+    bench_ingest_close();
+    run_archive(&corpora[BENCH_CORPUS_INT_LIST]);
+    run_archive(&corpora[BENCH_CORPUS_RECORDS]);
+    free(bench_archive_sink.buffer);
+    run_diff(&corpora[BENCH_CORPUS_RECORDS]);
+
+    run("write_null", NULL, bench_write_null);
+    run("write_bool", NULL, bench_write_bool);
+    run("write_int", NULL, bench_write_int);
+    run("write_string", NULL, bench_write_string);
+    run("write_bytes_64", NULL, bench_write_bytes_small);
+    run("write_bytes_4k", NULL, bench_write_bytes_large);
+    run("write_int64_array", NULL, bench_write_int64_array);
+    run("write_double_array", NULL, bench_write_double_array);
+    run("write_empty_list", NULL, bench_write_empty_list);
+    run("write_record", NULL, bench_write_record);
+    run("write_item", &corpora[BENCH_CORPUS_RECORDS], bench_write_item);
+    run("write_item", &corpora[BENCH_CORPUS_BLOBS], bench_write_item);
+    run("parallel_list_1", NULL, bench_parallel_list_1);
+    run("parallel_list_4", NULL, bench_parallel_list_4);
+
+    static const BenchCorpusKind transcode_kinds[] = {
+        BENCH_CORPUS_FLAT_DICT, BENCH_CORPUS_INT_LIST, BENCH_CORPUS_RECORDS
+    };
+    for (size_t i = 0; i < sizeof(transcode_kinds) / sizeof(transcode_kinds[0]); i++) {
+        const BenchCorpus *corpus = &corpora[transcode_kinds[i]];
+        corpus_render(bench_json_renderings, corpus, SmolTLV_json_write);
+        corpus_render(bench_cbor_renderings, corpus, SmolTLV_cbor_write);
+        run("json_write", corpus, bench_json_write);
+        run("json_encode", corpus, bench_json_encode);
+        run("cbor_write", corpus, bench_cbor_write);
+        run("cbor_encode", corpus, bench_cbor_encode);
+    }
+
+    for (int kind = 0; kind < BENCH_CORPUS_COUNT; kind++) {
+        bench_corpus_free(&corpora[kind]);
+        free(bench_json_renderings[kind].data);
+        free(bench_cbor_renderings[kind].data);
+    }
+    return 0;
+}
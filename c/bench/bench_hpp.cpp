@@ -0,0 +1,237 @@
+/* -*- mode: c++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+ * 
+ * SmolTLV - Simple serialization format for JSON/CBOR-like data model 
+ * for embedded devices - C++ view layer benchmark.
+ * 
+ * Copyright (c) 2025 Aleš Hakl
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <smoltlv.hpp>
+#include <smoltlv_schema.hpp>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+static double now_ns() {
+    using namespace std::chrono;
+    return (double)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+static void report(const char *name, double elapsed_ns, size_t ops, size_t bytes, int64_t check) {
+    printf("{\"bench\": \"%s\", \"ns_per_op\": %.3f, \"mb_per_s\": %.1f, \"check\": %lld}\n",
+           name, elapsed_ns / (double)ops, (double)bytes * 1e3 / elapsed_ns, (long long)check);
+}
+
+struct Reading {
+    int64_t timestamp;
+    int32_t sensor_id;
+    std::string_view unit;
+    double value;
+    bool calibrated;
+    int32_t sequence;
+};
+
+SMOLTLV_SCHEMA(Reading,
+    SMOLTLV_FIELD(Reading, timestamp),
+    SMOLTLV_FIELD(Reading, sensor_id),
+    SMOLTLV_FIELD(Reading, unit),
+    SMOLTLV_FIELD(Reading, value),
+    SMOLTLV_FIELD(Reading, calibrated),
+    SMOLTLV_FIELD(Reading, sequence))
+
+static size_t encode_reading_by_hand(const Reading &reading, uint8_t *buffer, size_t capacity) {
+    SmolTLV_Encoder *encoder = SmolTLV_Encoder_create_from_buffer(buffer, capacity);
+    SmolTLV_Encoder_start_dict(encoder);
+    SmolTLV_Encoder_write_string(encoder, "timestamp");
+    SmolTLV_Encoder_write_int(encoder, reading.timestamp);
+    SmolTLV_Encoder_write_string(encoder, "sensor_id");
+    SmolTLV_Encoder_write_int(encoder, reading.sensor_id);
+    SmolTLV_Encoder_write_string(encoder, "unit");
+    SmolTLV_Encoder_write_primitive(encoder, SMOLTLV_TYPE_STRING,
+                                    (const uint8_t *)reading.unit.data(), reading.unit.size());
+    SmolTLV_Encoder_write_string(encoder, "value");
+    SmolTLV_Encoder_write_double_array(encoder, &reading.value, 1);
+    SmolTLV_Encoder_write_string(encoder, "calibrated");
+    SmolTLV_Encoder_write_bool(encoder, reading.calibrated);
+    SmolTLV_Encoder_write_string(encoder, "sequence");
+    SmolTLV_Encoder_write_int(encoder, reading.sequence);
+    SmolTLV_Encoder_end(encoder);
+
+    const uint8_t *out;
+    size_t size = 0;
+    if (SmolTLV_Encoder_finalize(encoder, &out, &size) != SMOLTLV_STATUS_OK) {
+        size = 0;
+    }
+    SmolTLV_Encoder_destroy(encoder);
+    return size;
+}
+
+static bool decode_reading_by_hand(SmolTLV_Item dict, Reading &out) {
+    SmolTLV_Item item;
+    int64_t value;
+    const char *unit;
+    size_t unit_size;
+
+    if (!SmolTLV_Item_dict_get(dict, "timestamp", &item) || !SmolTLV_Item_as_int(item, &out.timestamp)) return false;
+    if (!SmolTLV_Item_dict_get(dict, "sensor_id", &item) || !SmolTLV_Item_as_int(item, &value)) return false;
+    out.sensor_id = (int32_t)value;
+    if (!SmolTLV_Item_dict_get(dict, "unit", &item) || !SmolTLV_Item_as_string(item, &unit, &unit_size)) return false;
+    out.unit = std::string_view(unit, unit_size);
+    if (!SmolTLV_Item_dict_get(dict, "value", &item) || !SmolTLV_Item_array_get_float(item, 0, &out.value)) return false;
+    if (!SmolTLV_Item_dict_get(dict, "calibrated", &item) || !SmolTLV_Item_as_bool(item, &out.calibrated)) return false;
+    if (!SmolTLV_Item_dict_get(dict, "sequence", &item) || !SmolTLV_Item_as_int(item, &value)) return false;
+    out.sequence = (int32_t)value;
+    return true;
+}
+
+static void bench_schema() {
+    const size_t iterations = 1000000;
+    Reading reading{ 1700000000000, 42, "celsius", 21.25, true, 0 };
+    uint8_t buffer[256];
+    size_t size = smoltlv::schema::encoded_size(reading);
+
+    int64_t check = 0;
+    double start = now_ns();
+    for (size_t i = 0; i < iterations; i++) {
+        reading.sequence = (int32_t)i;
+        check += (int64_t)encode_reading_by_hand(reading, buffer, sizeof(buffer));
+    }
+    report("c_struct_encode", now_ns() - start, iterations, size * iterations, check);
+
+    check = 0;
+    start = now_ns();
+    for (size_t i = 0; i < iterations; i++) {
+        reading.sequence = (int32_t)i;
+        check += (int64_t)smoltlv::schema::encode(reading, buffer, sizeof(buffer));
+    }
+    report("cpp_schema_encode", now_ns() - start, iterations, size * iterations, check);
+
+    Reading decoded{};
+    SmolTLV_Item dict = { buffer };
+
+    check = 0;
+    start = now_ns();
+    for (size_t i = 0; i < iterations; i++) {
+        if (decode_reading_by_hand(dict, decoded)) {
+            check += decoded.sequence;
+        }
+    }
+    report("c_struct_decode", now_ns() - start, iterations, size * iterations, check);
+
+    check = 0;
+    start = now_ns();
+    for (size_t i = 0; i < iterations; i++) {
+        if (smoltlv::schema::decode(smoltlv::Item(dict), decoded)) {
+            check += decoded.sequence;
+        }
+    }
+    report("cpp_schema_decode", now_ns() - start, iterations, size * iterations, check);
+}
+
+int main() {
+    const size_t count = 1000000;
+    const int rounds = 20;
+
+    SmolTLV_Encoder *encoder = SmolTLV_Encoder_create();
+    SmolTLV_Encoder_start_list(encoder);
+    for (size_t i = 0; i < count; i++) {
+        SmolTLV_Encoder_write_int(encoder, (int64_t)i);
+    }
+    SmolTLV_Encoder_end(encoder);
+
+    SmolTLV_Encoder_start_dict(encoder);
+    char key[16];
+    for (int i = 0; i < 64; i++) {
+        snprintf(key, sizeof(key), "key_%d", i);
+        SmolTLV_Encoder_write_string(encoder, key);
+        SmolTLV_Encoder_write_int(encoder, i);
+    }
+    SmolTLV_Encoder_end(encoder);
+
+    const uint8_t *buffer;
+    size_t size;
+    if (SmolTLV_Encoder_finalize(encoder, &buffer, &size) != SMOLTLV_STATUS_OK) {
+        fprintf(stderr, "Failed to encode benchmark data\n");
+        return 1;
+    }
+
+    SmolTLV_Cursor cursor;
+    SmolTLV_Item list, dict, item;
+    SmolTLV_Cursor_init(&cursor, buffer, size);
+    SmolTLV_Cursor_next(&cursor, &list);
+    SmolTLV_Cursor_next(&cursor, &dict);
+    size_t list_bytes = SmolTLV_Item_get_length(list);
+
+    int64_t sum = 0;
+    double start = now_ns();
+    for (int r = 0; r < rounds; r++) {
+        SmolTLV_Cursor list_cursor;
+        SmolTLV_Cursor_for_item(&list_cursor, list);
+        while (SmolTLV_Cursor_next(&list_cursor, &item) == SMOLTLV_STATUS_OK) {
+            int64_t value;
+            if (SmolTLV_Item_as_int(item, &value)) {
+                sum += value;
+            }
+        }
+    }
+    report("c_list_iterate", now_ns() - start, count * rounds, list_bytes * rounds, sum);
+
+    sum = 0;
+    start = now_ns();
+    smoltlv::ListView list_view = *smoltlv::Item(list).as_list();
+    for (int r = 0; r < rounds; r++) {
+        for (smoltlv::Item element : list_view) {
+            if (auto value = element.as_int()) {
+                sum += *value;
+            }
+        }
+    }
+    report("cpp_list_iterate", now_ns() - start, count * rounds, list_bytes * rounds, sum);
+
+    const size_t lookups = 1000000;
+    size_t dict_bytes = SmolTLV_Item_get_length(dict);
+
+    sum = 0;
+    start = now_ns();
+    for (size_t i = 0; i < lookups; i++) {
+        int64_t value;
+        if (SmolTLV_Item_dict_get(dict, "key_63", &item) && SmolTLV_Item_as_int(item, &value)) {
+            sum += value;
+        }
+    }
+    report("c_dict_get", now_ns() - start, lookups, dict_bytes * lookups, sum);
+
+    sum = 0;
+    start = now_ns();
+    smoltlv::DictView view = *smoltlv::Item(dict).as_dict();
+    for (size_t i = 0; i < lookups; i++) {
+        if (auto value = view.get("key_63")) {
+            sum += value->as_int().value_or(0);
+        }
+    }
+    report("cpp_dict_get", now_ns() - start, lookups, dict_bytes * lookups, sum);
+
+    SmolTLV_Encoder_destroy(encoder);
+    free((void *)buffer);
+
+    bench_schema();
+    return 0;
+}
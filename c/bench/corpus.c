@@ -0,0 +1,216 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil -*-
+ * 
+ * SmolTLV - Simple serialization format for JSON/CBOR-like data model 
+ * for embedded devices - deterministic benchmark corpora.
+ * 
+ * Copyright (c) 2025 Aleš Hakl
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <corpus.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* xorshift64*, fixed seed per corpus */
+typedef struct BenchRandom_s {
+    uint64_t state;
+} BenchRandom;
+
+static uint64_t random_next(BenchRandom *random) {
+    random->state ^= random->state >> 12;
+    random->state ^= random->state << 25;
+    random->state ^= random->state >> 27;
+    return random->state * 0x2545F4914F6CDD1Dull;
+}
+
+static void random_text(BenchRandom *random, char *out, size_t length) {
+    static const char alphabet[] = "abcdefghijklmnopqrstuvwxyz0123456789 ";
+    for (size_t i = 0; i < length; i++) {
+        out[i] = alphabet[random_next(random) % (sizeof(alphabet) - 1u)];
+    }
+    out[length] = '\0';
+}
+
+size_t bench_corpus_flat_count(void) {
+    return 1000u;
+}
+
+void bench_corpus_flat_key(size_t index, char *out, size_t size) {
+    snprintf(out, size, "field_%zu", index);
+}
+
+static size_t write_flat_dict(SmolTLV_Encoder *encoder,
+                              BenchRandom *random) {
+    char key[32], text[64];
+    size_t count = bench_corpus_flat_count();
+
+    SmolTLV_Encoder_start_dict(encoder);
+    for (size_t i = 0; i < count; i++) {
+        bench_corpus_flat_key(i, key, sizeof(key));
+        SmolTLV_Encoder_write_string(encoder, key);
+        switch (random_next(random) % 4u) {
+        case 0:
+            SmolTLV_Encoder_write_int(encoder, (int64_t)random_next(random));
+            break;
+        case 1:
+            random_text(random, text, 8u + random_next(random) % 48u);
+            SmolTLV_Encoder_write_string(encoder, text);
+            break;
+        case 2:
+            SmolTLV_Encoder_write_bool(encoder, random_next(random) & 1u);
+            break;
+        default:
+            SmolTLV_Encoder_write_null(encoder);
+            break;
+        }
+    }
+    SmolTLV_Encoder_end(encoder);
+    return 1u + 2u * count;
+}
+
+static size_t write_deep_nesting(SmolTLV_Encoder *encoder,
+                                 BenchRandom *random) {
+    size_t depth = 10000u;
+    for (size_t i = 0; i < depth; i++) {
+        SmolTLV_Encoder_start_list(encoder);
+        SmolTLV_Encoder_write_int(encoder, (int64_t)(random_next(random) % 1000u));
+    }
+    for (size_t i = 0; i < depth; i++) {
+        SmolTLV_Encoder_end(encoder);
+    }
+    return 2u * depth;
+}
+
+static size_t write_int_list(SmolTLV_Encoder *encoder,
+                             BenchRandom *random) {
+    size_t count = 500000u;
+    SmolTLV_Encoder_start_list(encoder);
+    for (size_t i = 0; i < count; i++) {
+        SmolTLV_Encoder_write_int(encoder, (int64_t)(random_next(random) >> 16));
+    }
+    SmolTLV_Encoder_end(encoder);
+    return 1u + count;
+}
+
+static size_t write_blobs(SmolTLV_Encoder *encoder,
+                          BenchRandom *random) {
+    size_t count = 64u;
+    size_t blob_size = 128u * 1024u;
+    uint8_t *blob = (uint8_t *)malloc(blob_size);
+    if (!blob) {
+        return 0;
+    }
+
+    SmolTLV_Encoder_start_list(encoder);
+    for (size_t i = 0; i < count; i++) {
+        for (size_t j = 0; j < blob_size; j += 8u) {
+            uint64_t value = random_next(random);
+            memcpy(blob + j, &value, 8u);
+        }
+        SmolTLV_Encoder_write_bytes(encoder, blob, blob_size);
+    }
+    SmolTLV_Encoder_end(encoder);
+    free(blob);
+    return 1u + count;
+}
+
+static size_t write_records(SmolTLV_Encoder *encoder,
+                            BenchRandom *random) {
+    size_t count = 50000u;
+    char text[32];
+
+    SmolTLV_Encoder_start_list(encoder);
+    for (size_t i = 0; i < count; i++) {
+        SmolTLV_Encoder_start_dict(encoder);
+        SmolTLV_Encoder_write_string(encoder, "id");
+        SmolTLV_Encoder_write_int(encoder, (int64_t)i);
+        SmolTLV_Encoder_write_string(encoder, "ts");
+        SmolTLV_Encoder_write_int(encoder, 1700000000000 + (int64_t)(i * 1000u));
+        SmolTLV_Encoder_write_string(encoder, "name");
+        random_text(random, text, 4u + random_next(random) % 16u);
+        SmolTLV_Encoder_write_string(encoder, text);
+        SmolTLV_Encoder_write_string(encoder, "ok");
+        SmolTLV_Encoder_write_bool(encoder, random_next(random) & 1u);
+        SmolTLV_Encoder_end(encoder);
+    }
+    SmolTLV_Encoder_end(encoder);
+    return 1u + count * 9u;
+}
+
+static const char *corpus_names[BENCH_CORPUS_COUNT] = {
+    "flat_dict",
+    "deep_nesting",
+    "int_list",
+    "blobs",
+    "records",
+};
+
+SmolTLV_Status bench_corpus_generate(BenchCorpusKind kind,
+                                     BenchCorpus *out) {
+    if (kind >= BENCH_CORPUS_COUNT || !out) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    SmolTLV_Encoder *encoder = SmolTLV_Encoder_create_with_size(1u << 20);
+    if (!encoder) {
+        return SMOLTLV_STATUS_OUT_OF_MEMORY;
+    }
+
+    BenchRandom random = { 0x9E3779B97F4A7C15ull + (uint64_t)kind };
+    size_t item_count = 0;
+    switch (kind) {
+    case BENCH_CORPUS_FLAT_DICT:
+        item_count = write_flat_dict(encoder, &random);
+        break;
+    case BENCH_CORPUS_DEEP_NESTING:
+        item_count = write_deep_nesting(encoder, &random);
+        break;
+    case BENCH_CORPUS_INT_LIST:
+        item_count = write_int_list(encoder, &random);
+        break;
+    case BENCH_CORPUS_BLOBS:
+        item_count = write_blobs(encoder, &random);
+        break;
+    case BENCH_CORPUS_RECORDS:
+        item_count = write_records(encoder, &random);
+        break;
+    default:
+        break;
+    }
+
+    SmolTLV_Status status = SmolTLV_Encoder_finalize(encoder, &out->buffer, &out->size);
+    SmolTLV_Encoder_destroy(encoder);
+    if (status != SMOLTLV_STATUS_OK) {
+        return status;
+    }
+
+    out->name = corpus_names[kind];
+    out->item_count = item_count;
+    return SMOLTLV_STATUS_OK;
+}
+
+void bench_corpus_free(BenchCorpus *corpus) {
+    if (corpus) {
+        free((void *)corpus->buffer);
+        corpus->buffer = NULL;
+        corpus->size = 0;
+    }
+}
@@ -0,0 +1,63 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil -*-
+ * 
+ * SmolTLV - Simple serialization format for JSON/CBOR-like data model 
+ * for embedded devices - deterministic benchmark corpora.
+ * 
+ * Copyright (c) 2025 Aleš Hakl
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef H__SMOLTLV_BENCH_CORPUS
+#define H__SMOLTLV_BENCH_CORPUS
+
+#include <smoltlv.h>
+
+/*
+ * Deterministic benchmark corpora, each kind always produces byte-identical
+ * output (a few MB, below the 24-bit top-level length limit).
+ */
+
+typedef enum BenchCorpusKind_e {
+    BENCH_CORPUS_FLAT_DICT,     /* one dict of mixed scalar values */
+    BENCH_CORPUS_DEEP_NESTING,  /* lists nested 10000 levels deep */
+    BENCH_CORPUS_INT_LIST,      /* one list of INT items */
+    BENCH_CORPUS_BLOBS,         /* list of large BYTES items */
+    BENCH_CORPUS_RECORDS,       /* many small dicts in a list */
+    BENCH_CORPUS_COUNT
+} BenchCorpusKind;
+
+typedef struct BenchCorpus_s {
+    const char *name;
+    /** Malloc'd, single top-level item */
+    const uint8_t *buffer;
+    size_t size;
+    /** Number of items including nested ones */
+    size_t item_count;
+} BenchCorpus;
+
+extern SmolTLV_Status bench_corpus_generate(BenchCorpusKind kind,
+                                            BenchCorpus *out);
+extern void bench_corpus_free(BenchCorpus *corpus);
+
+/** Key of i-th entry of flat dict corpus */
+extern void bench_corpus_flat_key(size_t index, char *out, size_t size);
+extern size_t bench_corpus_flat_count(void);
+
+#endif // H__SMOLTLV_BENCH_CORPUS
@@ -30,16 +30,178 @@
 #include <stdlib.h>
 #endif
 
+/*
+ * Runtime statistics
+ */
+
+#ifdef SMOLTLV_STATS
+#ifndef SMOLTLV_NO_THREADS
+static _Thread_local SmolTLV_DecoderStats decoder_stats;
+#else
+static SmolTLV_DecoderStats decoder_stats;
+#endif
+
+#define STATS_DECODER_ADD(field, n) (decoder_stats.field += (n))
+#define STATS_LOOKUP(scanned) stats_lookup(scanned)
+#define STATS_ENCODER_ADD(encoder, field, n) ((encoder)->stats.field += (n))
+
+static void stats_lookup(uint64_t scanned) {
+    decoder_stats.lookups++;
+    decoder_stats.lookup_scanned += scanned;
+    if (scanned > decoder_stats.lookup_scanned_max) {
+        decoder_stats.lookup_scanned_max = scanned;
+    }
+}
+
+void SmolTLV_DecoderStats_get(SmolTLV_DecoderStats *out) {
+    if (out) {
+        *out = decoder_stats;
+    }
+}
+
+void SmolTLV_DecoderStats_reset(void) {
+    memset(&decoder_stats, 0, sizeof(decoder_stats));
+}
+#else
+#define STATS_DECODER_ADD(field, n) ((void)0)
+#define STATS_LOOKUP(scanned) ((void)(scanned))
+#define STATS_ENCODER_ADD(encoder, field, n) ((void)0)
+#endif /* SMOLTLV_STATS */
+
 /*
  * Decoder functionality
  */
 
+/* External definitions for callers that do not inline (e.g. -O0 builds) */
+extern inline void SmolTLV_Cursor_init(SmolTLV_Cursor *cursor, 
+                                       const uint8_t *buffer, 
+                                       size_t size);
+extern inline bool SmolTLV_Cursor_is_at_end(SmolTLV_Cursor *cursor);
+
 static uint32_t load_len24(const uint8_t *p) {
     return ((uint32_t)p[1] << 16) |
            ((uint32_t)p[2] << 8)  |
            ((uint32_t)p[3]);
 }
 
+/** Whole header in one big-endian load, type in the top byte */
+static inline uint32_t load_header(const uint8_t *p) {
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    uint32_t header;
+    memcpy(&header, p, 4u);
+    return __builtin_bswap32(header);
+#elif defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    uint32_t header;
+    memcpy(&header, p, 4u);
+    return header;
+#else
+    return ((uint32_t)p[0] << 24) | load_len24(p);
+#endif
+}
+
+/*
+ * Per type length constraints checked by the decoder: exact length (plus
+ * one, zero when any length is valid) and length bits that have to be
+ * zero (element size - 1 of typed arrays). STRING_REF length 1..4 is the
+ * only range and is checked separately.
+ */
+typedef struct HeaderRule_s {
+    uint8_t exact;
+    uint8_t align;
+} HeaderRule;
+
+static const HeaderRule header_rules[256] = {
+    [SMOLTLV_TYPE_NULL]          = { 1u, 0u },
+    [SMOLTLV_TYPE_BOOL_TRUE]     = { 1u, 0u },
+    [SMOLTLV_TYPE_BOOL_FALSE]    = { 1u, 0u },
+    [SMOLTLV_TYPE_INT]           = { 9u, 0u },
+    [SMOLTLV_TYPE_ARRAY_INT16]   = { 0u, 1u },
+    [SMOLTLV_TYPE_ARRAY_INT32]   = { 0u, 3u },
+    [SMOLTLV_TYPE_ARRAY_INT64]   = { 0u, 7u },
+    [SMOLTLV_TYPE_ARRAY_FLOAT32] = { 0u, 3u },
+    [SMOLTLV_TYPE_ARRAY_FLOAT64] = { 0u, 7u },
+};
+
+static inline bool header_is_valid(uint32_t header) {
+    uint32_t type = header >> 24;
+    uint32_t length = header & 0xFFFFFFu;
+    HeaderRule rule = header_rules[type];
+    return ((rule.exact == 0u) | (length + 1u == rule.exact)) &
+           ((length & rule.align) == 0u) &
+           ((type != SMOLTLV_TYPE_STRING_REF) | (length - 1u < 4u));
+}
+
+static inline bool header_is_chunk(uint32_t header) {
+    uint32_t type = header >> 24;
+    return (type == SMOLTLV_TYPE_BYTES_CHUNK) | (type == SMOLTLV_TYPE_STRING_CHUNK);
+}
+
+static uint64_t load_be(const uint8_t *p, size_t size) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < size; i++) {
+        value = (value << 8) | (uint64_t)p[i];
+    }
+    return value;
+}
+
+static void store_be(uint8_t *p, uint64_t value, size_t size) {
+    for (size_t i = size; i > 0; i--) {
+        p[i - 1u] = (uint8_t)(value & 0xFFu);
+        value >>= 8;
+    }
+}
+
+/*
+ * Conversion of typed array payloads between big-endian wire format and 
+ * host byte order. Element size is a compile time constant in each 
+ * instantiation, so the loop collapses into a plain byteswap pass (or 
+ * memcpy on big-endian hosts).
+ */
+static inline void array_from_be(uint8_t *dst, 
+                                 const uint8_t *src, 
+                                 size_t count, 
+                                 size_t element_size) {
+    for (size_t i = 0; i < count; i++) {
+        uint64_t value = load_be(src + i * element_size, element_size);
+        switch (element_size) {
+        case 2: { uint16_t v = (uint16_t)value; memcpy(dst + i * 2u, &v, 2u); break; }
+        case 4: { uint32_t v = (uint32_t)value; memcpy(dst + i * 4u, &v, 4u); break; }
+        case 8: { memcpy(dst + i * 8u, &value, 8u); break; }
+        default: dst[i] = (uint8_t)value; break;
+        }
+    }
+}
+
+static inline void array_to_be(uint8_t *dst, 
+                               const uint8_t *src, 
+                               size_t count, 
+                               size_t element_size) {
+    for (size_t i = 0; i < count; i++) {
+        uint64_t value;
+        switch (element_size) {
+        case 2: { uint16_t v; memcpy(&v, src + i * 2u, 2u); value = v; break; }
+        case 4: { uint32_t v; memcpy(&v, src + i * 4u, 4u); value = v; break; }
+        case 8: { memcpy(&value, src + i * 8u, 8u); break; }
+        default: value = src[i]; break;
+        }
+        store_be(dst + i * element_size, value, element_size);
+    }
+}
+
+static void array_convert(uint8_t *dst, 
+                          const uint8_t *src, 
+                          size_t count, 
+                          size_t element_size, 
+                          bool to_be) {
+    switch (element_size) {
+    case 1: memcpy(dst, src, count); break;
+    case 2: if (to_be) array_to_be(dst, src, count, 2u); else array_from_be(dst, src, count, 2u); break;
+    case 4: if (to_be) array_to_be(dst, src, count, 4u); else array_from_be(dst, src, count, 4u); break;
+    case 8: if (to_be) array_to_be(dst, src, count, 8u); else array_from_be(dst, src, count, 8u); break;
+    default: break;
+    }
+}
+
 
 SmolTLV_Status SmolTLV_Cursor_next(SmolTLV_Cursor *c, SmolTLV_Item *out) {
     if (!c || !out) {
@@ -53,40 +215,98 @@ SmolTLV_Status SmolTLV_Cursor_next(SmolTLV_Cursor *c, SmolTLV_Item *out) {
     }
 
     if (rem < 4) {
+        STATS_DECODER_ADD(need_more_data, 1u);
         return SMOLTLV_STATUS_NEED_MORE_DATA;
     }
 
     const uint8_t *p = c->buffer + c->position;
-    uint8_t  type = p[0];
-    uint32_t len = load_len24(p);
+    uint32_t header = load_header(p);
+    uint32_t len = header & 0xFFFFFFu;
 
-    if (len > 0xFFFFFFu) {
+    if (!header_is_valid(header) || (c->nested && header_is_chunk(header))) {
         return SMOLTLV_STATUS_INVALID_FORMAT;
     }
 
-    if (type == SMOLTLV_TYPE_NULL && len != 0u) {
-        return SMOLTLV_STATUS_INVALID_FORMAT;
+    if (rem < 4u + (size_t)len) {
+        STATS_DECODER_ADD(need_more_data, 1u);
+        return SMOLTLV_STATUS_NEED_MORE_DATA;
     }
 
-    if (type == SMOLTLV_TYPE_BOOL_TRUE && len != 0u) {
-        return SMOLTLV_STATUS_INVALID_FORMAT;
+    STATS_DECODER_ADD(items_visited, 1u);
+    out->pointer = p;
+    c->position += 4u + (size_t)len;
+    return SMOLTLV_STATUS_OK;
+}
+
+#define SKIP_PREFETCH_DISTANCE 512u
+
+SmolTLV_Status SmolTLV_Cursor_skip(SmolTLV_Cursor *c, size_t count, size_t *out_skipped) {
+    if (!c) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
     }
 
-    if (type == SMOLTLV_TYPE_BOOL_FALSE && len != 0u) {
-        return SMOLTLV_STATUS_INVALID_FORMAT;
+    const uint8_t *buffer = c->buffer;
+    size_t size = c->size;
+    size_t position = c->position;
+    size_t skipped = 0;
+    SmolTLV_Status status = SMOLTLV_STATUS_OK;
+
+    while (skipped < count) {
+        size_t rem = (size > position) ? (size - position) : 0;
+        if (rem == 0) {
+            status = SMOLTLV_STATUS_END;
+            break;
+        }
+        if (rem < 4u) {
+            status = SMOLTLV_STATUS_NEED_MORE_DATA;
+            break;
+        }
+
+        uint32_t header = load_header(buffer + position);
+        size_t stride = 4u + (size_t)(header & 0xFFFFFFu);
+        if (!header_is_valid(header) || (c->nested && header_is_chunk(header))) {
+            status = SMOLTLV_STATUS_INVALID_FORMAT;
+            break;
+        }
+        if (rem < stride) {
+            status = SMOLTLV_STATUS_NEED_MORE_DATA;
+            break;
+        }
+        position += stride;
+        skipped++;
+
+        // Runs of identical headers (INTs, NULLs, fixed-size values) are
+        // validated once and compared four at a time
+        while (count - skipped >= 4u && size - position >= 4u * stride &&
+               load_header(buffer + position) == header &&
+               load_header(buffer + position + stride) == header &&
+               load_header(buffer + position + 2u * stride) == header &&
+               load_header(buffer + position + 3u * stride) == header) {
+            position += 4u * stride;
+            skipped += 4u;
+#ifdef __GNUC__
+            if (size - position > SKIP_PREFETCH_DISTANCE) {
+                __builtin_prefetch(buffer + position + SKIP_PREFETCH_DISTANCE);
+            }
+#endif
+        }
     }
 
-    if (type == SMOLTLV_TYPE_INT && len != 8u) {
-        return SMOLTLV_STATUS_INVALID_FORMAT;
+    c->position = position;
+    if (out_skipped) {
+        *out_skipped = skipped;
     }
+    return status;
+}
 
-    if (rem < 4u + (size_t)len) {
-        return SMOLTLV_STATUS_NEED_MORE_DATA;
+SmolTLV_Status SmolTLV_Cursor_count(const SmolTLV_Cursor *c, size_t *out_count) {
+    if (!c || !out_count) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
     }
 
-    out->pointer = p;
-    c->position += 4u + (size_t)len;
-    return SMOLTLV_STATUS_OK;
+    SmolTLV_Cursor copy = *c;
+    SmolTLV_Status status = SmolTLV_Cursor_skip(&copy, SIZE_MAX, out_count);
+    return status == SMOLTLV_STATUS_END ? SMOLTLV_STATUS_OK : status;
 }
 
 void SmolTLV_Cursor_for_item(SmolTLV_Cursor *c, SmolTLV_Item item) {
@@ -100,6 +320,7 @@ void SmolTLV_Cursor_for_item(SmolTLV_Cursor *c, SmolTLV_Item item) {
     c->buffer = p + 4;
     c->size = len;
     c->position = 0;
+    c->nested = true;
 }
 
 /*
@@ -260,6 +481,104 @@ bool SmolTLV_Item_is_container(SmolTLV_Item item) {
     return (type == SMOLTLV_TYPE_LIST || type == SMOLTLV_TYPE_DICT);
 }
 
+size_t SmolTLV_Type_array_element_size(SmolTLV_Type type) {
+    switch (type) {
+    case SMOLTLV_TYPE_ARRAY_INT8:    return 1u;
+    case SMOLTLV_TYPE_ARRAY_INT16:   return 2u;
+    case SMOLTLV_TYPE_ARRAY_INT32:   return 4u;
+    case SMOLTLV_TYPE_ARRAY_INT64:   return 8u;
+    case SMOLTLV_TYPE_ARRAY_FLOAT32: return 4u;
+    case SMOLTLV_TYPE_ARRAY_FLOAT64: return 8u;
+    default:                         return 0u;
+    }
+}
+
+bool SmolTLV_Item_is_array(SmolTLV_Item item) {
+    return SmolTLV_Type_array_element_size(SmolTLV_Item_get_type(item)) != 0u;
+}
+
+bool SmolTLV_Item_array_count(SmolTLV_Item item, size_t *out_count) {
+    size_t element_size = SmolTLV_Type_array_element_size(SmolTLV_Item_get_type(item));
+    if (element_size == 0u) {
+        return false;
+    }
+
+    if (out_count) {
+        *out_count = SmolTLV_Item_get_length(item) / element_size;
+    }
+    return true;
+}
+
+bool SmolTLV_Item_array_get_int(SmolTLV_Item item, 
+                                size_t index, 
+                                int64_t *out) {
+    SmolTLV_Type type = SmolTLV_Item_get_type(item);
+    if (type < SMOLTLV_TYPE_ARRAY_INT8 || type > SMOLTLV_TYPE_ARRAY_INT64) {
+        return false;
+    }
+
+    size_t element_size = SmolTLV_Type_array_element_size(type);
+    if (index >= SmolTLV_Item_get_length(item) / element_size) {
+        return false;
+    }
+
+    const uint8_t *p = SmolTLV_Item_get_value(item) + index * element_size;
+    uint64_t raw = load_be(p, element_size);
+
+    if (out) {
+        // Sign extend
+        unsigned shift = 64u - 8u * (unsigned)element_size;
+        *out = (int64_t)(raw << shift) >> shift;
+    }
+    return true;
+}
+
+bool SmolTLV_Item_array_get_float(SmolTLV_Item item, 
+                                  size_t index, 
+                                  double *out) {
+    SmolTLV_Type type = SmolTLV_Item_get_type(item);
+    if (type != SMOLTLV_TYPE_ARRAY_FLOAT32 && type != SMOLTLV_TYPE_ARRAY_FLOAT64) {
+        return false;
+    }
+
+    size_t element_size = SmolTLV_Type_array_element_size(type);
+    if (index >= SmolTLV_Item_get_length(item) / element_size) {
+        return false;
+    }
+
+    const uint8_t *p = SmolTLV_Item_get_value(item) + index * element_size;
+    uint64_t raw = load_be(p, element_size);
+
+    if (out) {
+        if (type == SMOLTLV_TYPE_ARRAY_FLOAT32) {
+            uint32_t bits = (uint32_t)raw;
+            float value;
+            memcpy(&value, &bits, sizeof(value));
+            *out = value;
+        } else {
+            double value;
+            memcpy(&value, &raw, sizeof(value));
+            *out = value;
+        }
+    }
+    return true;
+}
+
+bool SmolTLV_Item_array_copy(SmolTLV_Item item, void *out, size_t count) {
+    size_t element_size = SmolTLV_Type_array_element_size(SmolTLV_Item_get_type(item));
+    if (element_size == 0u || !out) {
+        return false;
+    }
+
+    if (count > SmolTLV_Item_get_length(item) / element_size) {
+        return false;
+    }
+
+    array_convert((uint8_t *)out, SmolTLV_Item_get_value(item), 
+                  count, element_size, false);
+    return true;
+}
+
 bool SmolTLV_Item_list_at(SmolTLV_Item list_item,
                           size_t index,
                           SmolTLV_Item *out_item) {
@@ -270,26 +589,48 @@ bool SmolTLV_Item_list_at(SmolTLV_Item list_item,
     SmolTLV_Cursor cursor;
     SmolTLV_Cursor_for_item(&cursor, list_item);
 
-    size_t current_index = 0;
-    SmolTLV_Status status;
+    size_t skipped = 0;
     SmolTLV_Item item;
 
-    while ((status = SmolTLV_Cursor_next(&cursor, &item)) == SMOLTLV_STATUS_OK) {
-        if (current_index == index) {
-            if (out_item) {
-                *out_item = item;
-            }
-            return true;
-        }
-        current_index++;
+    if (SmolTLV_Cursor_skip(&cursor, index, &skipped) != SMOLTLV_STATUS_OK ||
+        SmolTLV_Cursor_next(&cursor, &item) != SMOLTLV_STATUS_OK) {
+        STATS_LOOKUP(skipped);
+        return false;
     }
 
-    return false;
+    STATS_LOOKUP(index + 1u);
+    if (out_item) {
+        *out_item = item;
+    }
+    return true;
 }
 
-bool SmolTLV_Item_dict_get(SmolTLV_Item dict_item,
-                           const char *key,
-                           SmolTLV_Item *out_item) {
+bool SmolTLV_Item_count(SmolTLV_Item item, size_t *out_count) {
+    if (!item.pointer || !SmolTLV_Item_is_container(item)) {
+        return false;
+    }
+
+    SmolTLV_Cursor cursor;
+    size_t count;
+    SmolTLV_Cursor_for_item(&cursor, item);
+    if (SmolTLV_Cursor_count(&cursor, &count) != SMOLTLV_STATUS_OK) {
+        return false;
+    }
+    if (out_count) {
+        *out_count = count;
+    }
+    return true;
+}
+
+/*
+ * Shared dict scan: matches STRING keys against key (if not NULL) and 
+ * STRING_REF keys against id (if has_id).
+ */
+static bool dict_find(SmolTLV_Item dict_item,
+                      const char *key,
+                      bool has_id,
+                      uint32_t id,
+                      SmolTLV_Item *out_item) {
     if (SmolTLV_Item_get_type(dict_item) != SMOLTLV_TYPE_DICT) {
         return false;
     }
@@ -300,35 +641,1376 @@ bool SmolTLV_Item_dict_get(SmolTLV_Item dict_item,
     SmolTLV_Status status;
     SmolTLV_Item key_item;
     SmolTLV_Item value_item;
+    size_t scanned = 0;
 
     while ((status = SmolTLV_Cursor_next(&cursor, &key_item)) == SMOLTLV_STATUS_OK) {
-        if (SmolTLV_Item_get_type(key_item) != SMOLTLV_TYPE_STRING) {
+        bool match;
+        uint32_t key_id;
+        scanned++;
+
+        switch (SmolTLV_Item_get_type(key_item)) {
+        case SMOLTLV_TYPE_STRING:
+            match = key && SmolTLV_Item_strcmp(key_item, key);
+            break;
+        case SMOLTLV_TYPE_STRING_REF:
+            match = has_id 
+                && SmolTLV_Item_as_string_ref(key_item, &key_id) 
+                && key_id == id;
+            break;
+        default:
+            STATS_LOOKUP(scanned);
             return false;
         }
 
-        if (!SmolTLV_Item_strcmp(key_item, key)) {
-            // Key does not match, skip value
-            status = SmolTLV_Cursor_next(&cursor, &value_item);
-            if (status != SMOLTLV_STATUS_OK) {
+        status = SmolTLV_Cursor_next(&cursor, &value_item);
+        if (status != SMOLTLV_STATUS_OK) {
+            STATS_LOOKUP(scanned);
+            return false;
+        }
+
+        if (!match) {
+            continue;
+        }
+
+        STATS_LOOKUP(scanned);
+        if (out_item) {
+            *out_item = value_item;
+        }
+        return true;
+    }
+
+    STATS_LOOKUP(scanned);
+    return false;
+}
+
+bool SmolTLV_Item_dict_get(SmolTLV_Item dict_item,
+                           const char *key,
+                           SmolTLV_Item *out_item) {
+    if (!key) {
+        return false;
+    }
+    return dict_find(dict_item, key, false, 0u, out_item);
+}
+
+/*
+ * String table
+ */
+
+bool SmolTLV_StringTable_init(SmolTLV_StringTable *table, SmolTLV_Item item) {
+    if (!table) {
+        return false;
+    }
+
+    if (item.pointer && SmolTLV_Item_get_type(item) != SMOLTLV_TYPE_STRING_TABLE) {
+        return false;
+    }
+
+    table->item = item;
+    return true;
+}
+
+bool SmolTLV_StringTable_find(const SmolTLV_StringTable *table, 
+                              const char *str, 
+                              uint32_t *out_id) {
+    if (!table || !table->item.pointer || !str) {
+        return false;
+    }
+
+    SmolTLV_Cursor cursor;
+    SmolTLV_Cursor_for_item(&cursor, table->item);
+
+    uint32_t id = 0;
+    SmolTLV_Item entry;
+
+    while (SmolTLV_Cursor_next(&cursor, &entry) == SMOLTLV_STATUS_OK) {
+        if (SmolTLV_Item_strcmp(entry, str)) {
+            if (out_id) {
+                *out_id = id;
+            }
+            return true;
+        }
+        id++;
+    }
+
+    return false;
+}
+
+bool SmolTLV_StringTable_get(const SmolTLV_StringTable *table, 
+                             uint32_t id, 
+                             SmolTLV_Item *out) {
+    if (!table || !table->item.pointer) {
+        return false;
+    }
+
+    SmolTLV_Cursor cursor;
+    SmolTLV_Cursor_for_item(&cursor, table->item);
+
+    uint32_t current_id = 0;
+    SmolTLV_Item entry;
+
+    while (SmolTLV_Cursor_next(&cursor, &entry) == SMOLTLV_STATUS_OK) {
+        if (current_id == id) {
+            if (SmolTLV_Item_get_type(entry) != SMOLTLV_TYPE_STRING) {
                 return false;
             }
-            continue;
+            if (out) {
+                *out = entry;
+            }
+            return true;
         }
+        current_id++;
+    }
 
-        // Key matches, get value
-        status = SmolTLV_Cursor_next(&cursor, &value_item);
-        if (status != SMOLTLV_STATUS_OK) {
+    return false;
+}
+
+bool SmolTLV_Item_as_string_ref(SmolTLV_Item item, uint32_t *out_id) {
+    if (SmolTLV_Item_get_type(item) != SMOLTLV_TYPE_STRING_REF) {
+        return false;
+    }
+
+    uint32_t length = SmolTLV_Item_get_length(item);
+    if (length < 1u || length > 4u) {
+        return false;
+    }
+
+    if (out_id) {
+        *out_id = (uint32_t)load_be(SmolTLV_Item_get_value(item), length);
+    }
+    return true;
+}
+
+bool SmolTLV_Item_dict_get_id(SmolTLV_Item dict_item, 
+                              uint32_t id, 
+                              SmolTLV_Item *out_item) {
+    return dict_find(dict_item, NULL, true, id, out_item);
+}
+
+bool SmolTLV_Item_dict_get_interned(SmolTLV_Item dict_item, 
+                                    const SmolTLV_StringTable *table, 
+                                    const char *key, 
+                                    SmolTLV_Item *out_item) {
+    if (!key) {
+        return false;
+    }
+
+    uint32_t id = 0;
+    bool has_id = SmolTLV_StringTable_find(table, key, &id);
+    return dict_find(dict_item, key, has_id, id, out_item);
+}
+
+bool SmolTLV_Key_init(SmolTLV_Key *key, 
+                      const SmolTLV_StringTable *table, 
+                      const char *str) {
+    if (!key || !str) {
+        return false;
+    }
+
+    key->str = str;
+    key->id = 0;
+    key->has_id = SmolTLV_StringTable_find(table, str, &key->id);
+    return true;
+}
+
+bool SmolTLV_Item_dict_get_key(SmolTLV_Item dict_item, 
+                               const SmolTLV_Key *key, 
+                               SmolTLV_Item *out_item) {
+    if (!key || !key->str) {
+        return false;
+    }
+    return dict_find(dict_item, key->str, key->has_id, key->id, out_item);
+}
+
+bool SmolTLV_Item_get_path(SmolTLV_Item item, 
+                           const SmolTLV_StringTable *table, 
+                           const char *const *path, 
+                           SmolTLV_Item *out) {
+    if (!item.pointer || !path) {
+        return false;
+    }
+
+    for (; *path; path++) {
+        if (!SmolTLV_Item_dict_get_interned(item, table, *path, &item)) {
             return false;
         }
+    }
+
+    if (out) {
+        *out = item;
+    }
+    return true;
+}
+
+/*
+ * Record batches
+ */
+
+static bool batch_column_is_int(SmolTLV_Type type) {
+    return type >= SMOLTLV_TYPE_ARRAY_INT8 && type <= SMOLTLV_TYPE_ARRAY_INT64;
+}
+
+bool SmolTLV_Item_delta_array(SmolTLV_Item delta, SmolTLV_Item *out_array) {
+    SmolTLV_Cursor cursor;
+    SmolTLV_Item array_item;
+    if (SmolTLV_Item_get_type(delta) != SMOLTLV_TYPE_DELTA) {
+        return false;
+    }
+    SmolTLV_Cursor_for_item(&cursor, delta);
+
+    if (SmolTLV_Cursor_next(&cursor, &array_item) != SMOLTLV_STATUS_OK) {
+        return false;
+    }
+    if (!SmolTLV_Cursor_is_at_end(&cursor)) {
+        return false;
+    }
+    if (!batch_column_is_int(SmolTLV_Item_get_type(array_item))) {
+        return false;
+    }
+
+    *out_array = array_item;
+    return true;
+}
+
+bool SmolTLV_Column_count(SmolTLV_Item column, size_t *out_count) {
+    SmolTLV_Type type = SmolTLV_Item_get_type(column);
+    size_t count = 0;
+
+    if (type == SMOLTLV_TYPE_LIST) {
+        SmolTLV_Cursor cursor;
+        SmolTLV_Cursor_for_item(&cursor, column);
+        if (SmolTLV_Cursor_count(&cursor, &count) != SMOLTLV_STATUS_OK) {
+            return false;
+        }
+    } else if (type == SMOLTLV_TYPE_DELTA) {
+        SmolTLV_Item array_item;
+        if (!SmolTLV_Item_delta_array(column, &array_item)) {
+            return false;
+        }
+        SmolTLV_Item_array_count(array_item, &count);
+    } else if (batch_column_is_int(type)) {
+        SmolTLV_Item_array_count(column, &count);
+    } else {
+        return false;
+    }
+
+    if (out_count) {
+        *out_count = count;
+    }
+    return true;
+}
+
+bool SmolTLV_Column_decode_int(SmolTLV_Item column, 
+                               int64_t *out, 
+                               size_t count) {
+    SmolTLV_Type type = SmolTLV_Item_get_type(column);
+    size_t available;
+
+    if (!out || !SmolTLV_Column_count(column, &available) || count > available) {
+        return false;
+    }
+
+    if (type == SMOLTLV_TYPE_LIST) {
+        SmolTLV_Cursor cursor;
+        SmolTLV_Item item;
+        SmolTLV_Cursor_for_item(&cursor, column);
+        for (size_t i = 0; i < count; i++) {
+            SmolTLV_Cursor_next(&cursor, &item);
+            if (!SmolTLV_Item_as_int(item, &out[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    SmolTLV_Item array_item = column;
+    if (type == SMOLTLV_TYPE_DELTA) {
+        SmolTLV_Item_delta_array(column, &array_item);
+    }
+
+    size_t element_size = SmolTLV_Type_array_element_size(SmolTLV_Item_get_type(array_item));
+    const uint8_t *p = SmolTLV_Item_get_value(array_item);
+    unsigned shift = 64u - 8u * (unsigned)element_size;
+    for (size_t i = 0; i < count; i++) {
+        uint64_t raw = load_be(p + i * element_size, element_size);
+        out[i] = (int64_t)(raw << shift) >> shift;
+    }
+
+    if (type == SMOLTLV_TYPE_DELTA) {
+        // Prefix sum, wrapping arithmetic matches the encoder
+        uint64_t value = 0;
+        for (size_t i = 0; i < count; i++) {
+            value += (uint64_t)out[i];
+            out[i] = (int64_t)value;
+        }
+    }
+    return true;
+}
+
+SmolTLV_Status SmolTLV_Batch_init(SmolTLV_Batch *batch, SmolTLV_Item item) {
+    if (!batch || !item.pointer) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    if (SmolTLV_Item_get_type(item) != SMOLTLV_TYPE_RECORD_BATCH) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    SmolTLV_Cursor cursor;
+    SmolTLV_Cursor_for_item(&cursor, item);
+
+    SmolTLV_Item schema;
+    if (SmolTLV_Cursor_next(&cursor, &schema) != SMOLTLV_STATUS_OK ||
+        SmolTLV_Item_get_type(schema) != SMOLTLV_TYPE_LIST) {
+        return SMOLTLV_STATUS_INVALID_FORMAT;
+    }
+
+    SmolTLV_Cursor schema_cursor;
+    SmolTLV_Item key;
+    SmolTLV_Status status;
+    size_t column_count = 0;
+    SmolTLV_Cursor_for_item(&schema_cursor, schema);
+    while ((status = SmolTLV_Cursor_next(&schema_cursor, &key)) == SMOLTLV_STATUS_OK) {
+        SmolTLV_Type key_type = SmolTLV_Item_get_type(key);
+        if (key_type != SMOLTLV_TYPE_STRING && key_type != SMOLTLV_TYPE_STRING_REF) {
+            return SMOLTLV_STATUS_INVALID_FORMAT;
+        }
+        column_count++;
+    }
+    if (status != SMOLTLV_STATUS_END) {
+        return SMOLTLV_STATUS_INVALID_FORMAT;
+    }
+
+    size_t row_count = 0;
+    SmolTLV_Item column;
+    for (size_t i = 0; i < column_count; i++) {
+        size_t count;
+        if (SmolTLV_Cursor_next(&cursor, &column) != SMOLTLV_STATUS_OK ||
+            !SmolTLV_Column_count(column, &count)) {
+            return SMOLTLV_STATUS_INVALID_FORMAT;
+        }
+        if (i > 0 && count != row_count) {
+            return SMOLTLV_STATUS_INVALID_FORMAT;
+        }
+        row_count = count;
+    }
+
+    if (!SmolTLV_Cursor_is_at_end(&cursor)) {
+        return SMOLTLV_STATUS_INVALID_FORMAT;
+    }
+
+    batch->item = item;
+    batch->schema = schema;
+    batch->column_count = column_count;
+    batch->row_count = row_count;
+    return SMOLTLV_STATUS_OK;
+}
+
+bool SmolTLV_Batch_find_column(const SmolTLV_Batch *batch, 
+                               const SmolTLV_StringTable *table, 
+                               const char *key, 
+                               size_t *out_index) {
+    if (!batch || !key) {
+        return false;
+    }
+
+    // Key is resolved to id once, schema keys compare by id
+    uint32_t id = 0;
+    uint32_t key_id;
+    bool has_id = SmolTLV_StringTable_find(table, key, &id);
+
+    SmolTLV_Cursor cursor;
+    SmolTLV_Item key_item;
+    size_t index = 0;
+    SmolTLV_Cursor_for_item(&cursor, batch->schema);
+    while (SmolTLV_Cursor_next(&cursor, &key_item) == SMOLTLV_STATUS_OK) {
+        bool match = SmolTLV_Item_as_string_ref(key_item, &key_id) 
+            ? has_id && key_id == id 
+            : SmolTLV_Item_strcmp(key_item, key);
+        if (match) {
+            if (out_index) {
+                *out_index = index;
+            }
+            return true;
+        }
+        index++;
+    }
+    return false;
+}
+
+bool SmolTLV_Batch_get_column(const SmolTLV_Batch *batch, 
+                              size_t index, 
+                              SmolTLV_Item *out_key, 
+                              SmolTLV_Item *out_column) {
+    if (!batch || index >= batch->column_count) {
+        return false;
+    }
+
+    if (out_key && !SmolTLV_Item_list_at(batch->schema, index, out_key)) {
+        return false;
+    }
+
+    // Columns follow the schema item
+    SmolTLV_Cursor cursor;
+    SmolTLV_Item column;
+    SmolTLV_Cursor_for_item(&cursor, batch->item);
+    if (SmolTLV_Cursor_next(&cursor, &column) != SMOLTLV_STATUS_OK) {
+        return false;
+    }
+    for (size_t i = 0; i <= index; i++) {
+        if (SmolTLV_Cursor_next(&cursor, &column) != SMOLTLV_STATUS_OK) {
+            return false;
+        }
+    }
+
+    if (out_column) {
+        *out_column = column;
+    }
+    return true;
+}
+
+SmolTLV_Status SmolTLV_BatchReader_init(SmolTLV_BatchReader *reader, 
+                                        const SmolTLV_Batch *batch, 
+                                        SmolTLV_BatchReaderColumn *columns, 
+                                        size_t capacity) {
+    if (!reader || !batch || (!columns && batch->column_count > 0) || 
+        capacity < batch->column_count) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    SmolTLV_Cursor cursor;
+    SmolTLV_Cursor schema_cursor;
+    SmolTLV_Item column;
+    SmolTLV_Cursor_for_item(&cursor, batch->item);
+    SmolTLV_Cursor_next(&cursor, &column);
+    SmolTLV_Cursor_for_item(&schema_cursor, batch->schema);
+
+    for (size_t i = 0; i < batch->column_count; i++) {
+        SmolTLV_BatchReaderColumn *state = &columns[i];
+        memset(state, 0, sizeof(*state));
+        if (SmolTLV_Cursor_next(&schema_cursor, &state->key) != SMOLTLV_STATUS_OK ||
+            SmolTLV_Cursor_next(&cursor, &column) != SMOLTLV_STATUS_OK) {
+            return SMOLTLV_STATUS_INVALID_FORMAT;
+        }
+
+        SmolTLV_Type type = SmolTLV_Item_get_type(column);
+        state->is_list = type == SMOLTLV_TYPE_LIST;
+        state->is_delta = type == SMOLTLV_TYPE_DELTA;
+        if (state->is_list) {
+            SmolTLV_Cursor_for_item(&state->cursor, column);
+        } else if (state->is_delta) {
+            if (!SmolTLV_Item_delta_array(column, &state->array)) {
+                return SMOLTLV_STATUS_INVALID_FORMAT;
+            }
+        } else {
+            state->array = column;
+        }
+    }
+
+    reader->batch = *batch;
+    reader->columns = columns;
+    reader->row = 0;
+    return SMOLTLV_STATUS_OK;
+}
+
+SmolTLV_Status SmolTLV_BatchReader_next(SmolTLV_BatchReader *reader) {
+    if (!reader) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+    if (reader->row >= reader->batch.row_count) {
+        return SMOLTLV_STATUS_END;
+    }
+
+    size_t row = reader->row;
+    for (size_t i = 0; i < reader->batch.column_count; i++) {
+        SmolTLV_BatchReaderColumn *column = &reader->columns[i];
+        if (column->is_list) {
+            if (SmolTLV_Cursor_next(&column->cursor, &column->item) != SMOLTLV_STATUS_OK) {
+                return SMOLTLV_STATUS_INVALID_FORMAT;
+            }
+            continue;
+        }
+
+        size_t element_size = SmolTLV_Type_array_element_size(SmolTLV_Item_get_type(column->array));
+        unsigned shift = 64u - 8u * (unsigned)element_size;
+        uint64_t raw = load_be(SmolTLV_Item_get_value(column->array) + row * element_size, element_size);
+        column->item.pointer = NULL;
+        column->int_value = (int64_t)(raw << shift) >> shift;
+        if (column->is_delta) {
+            column->sum += (uint64_t)column->int_value;
+            column->int_value = (int64_t)column->sum;
+        }
+    }
+
+    reader->row++;
+    return SMOLTLV_STATUS_OK;
+}
+
+/*
+ * Chunked values
+ */
+
+static SmolTLV_Type chunk_type_of(SmolTLV_Type type) {
+    return type == SMOLTLV_TYPE_STRING ? SMOLTLV_TYPE_STRING_CHUNK 
+                                       : SMOLTLV_TYPE_BYTES_CHUNK;
+}
+
+SmolTLV_Status SmolTLV_ChunkWriter_init(SmolTLV_ChunkWriter *writer, 
+                                        SmolTLV_Type type, 
+                                        SmolTLV_WriteFunction write, 
+                                        void *context) {
+    if (!writer || !write || 
+        (type != SMOLTLV_TYPE_BYTES && type != SMOLTLV_TYPE_STRING)) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    writer->write = write;
+    writer->context = context;
+    writer->type = type;
+    return SMOLTLV_STATUS_OK;
+}
+
+static SmolTLV_Status chunk_write_item(SmolTLV_ChunkWriter *writer, 
+                                       SmolTLV_Type type, 
+                                       const uint8_t *data, 
+                                       size_t length) {
+    uint8_t header[4] = {
+        (uint8_t)type,
+        (uint8_t)((length >> 16) & 0xFFu),
+        (uint8_t)((length >> 8) & 0xFFu),
+        (uint8_t)(length & 0xFFu),
+    };
+
+    SmolTLV_Status status = writer->write(header, sizeof(header), writer->context);
+    if (status == SMOLTLV_STATUS_OK && length > 0u) {
+        status = writer->write(data, length, writer->context);
+    }
+    return status;
+}
+
+SmolTLV_Status SmolTLV_ChunkWriter_write(SmolTLV_ChunkWriter *writer, 
+                                         const uint8_t *data, 
+                                         size_t length) {
+    if (!writer || (!data && length > 0u)) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    SmolTLV_Type type = chunk_type_of(writer->type);
+    while (length > 0u) {
+        size_t part = length > SMOLTLV_MAX_LENGTH ? SMOLTLV_MAX_LENGTH : length;
+        SmolTLV_Status status = chunk_write_item(writer, type, data, part);
+        if (status != SMOLTLV_STATUS_OK) {
+            return status;
+        }
+        data += part;
+        length -= part;
+    }
+    return SMOLTLV_STATUS_OK;
+}
+
+SmolTLV_Status SmolTLV_ChunkWriter_finish(SmolTLV_ChunkWriter *writer) {
+    if (!writer) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+    return chunk_write_item(writer, writer->type, NULL, 0u);
+}
+
+void SmolTLV_ChunkReader_init(SmolTLV_ChunkReader *reader, 
+                              SmolTLV_Cursor *cursor) {
+    if (!reader) {
+        return;
+    }
+    reader->cursor = cursor;
+    reader->type = SMOLTLV_TYPE_NULL;
+    reader->done = false;
+}
+
+SmolTLV_Status SmolTLV_ChunkReader_next(SmolTLV_ChunkReader *reader, 
+                                        const uint8_t **out_data, 
+                                        size_t *out_length) {
+    if (!reader || !reader->cursor || !out_data || !out_length) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    if (reader->done) {
+        return SMOLTLV_STATUS_END;
+    }
+
+    size_t position = reader->cursor->position;
+    SmolTLV_Item item;
+    SmolTLV_Status status = SmolTLV_Cursor_next(reader->cursor, &item);
+    if (status == SMOLTLV_STATUS_END) {
+        // Value has to be terminated
+        return SMOLTLV_STATUS_NEED_MORE_DATA;
+    }
+    if (status != SMOLTLV_STATUS_OK) {
+        return status;
+    }
+
+    SmolTLV_Type type = SmolTLV_Item_get_type(item);
+    SmolTLV_Type value_type;
+    switch (type) {
+    case SMOLTLV_TYPE_BYTES:
+    case SMOLTLV_TYPE_BYTES_CHUNK:
+        value_type = SMOLTLV_TYPE_BYTES;
+        break;
+    case SMOLTLV_TYPE_STRING:
+    case SMOLTLV_TYPE_STRING_CHUNK:
+        value_type = SMOLTLV_TYPE_STRING;
+        break;
+    default:
+        value_type = SMOLTLV_TYPE_NULL;
+        break;
+    }
+
+    if (value_type == SMOLTLV_TYPE_NULL || 
+        (reader->type != SMOLTLV_TYPE_NULL && reader->type != value_type)) {
+        reader->cursor->position = position;
+        return SMOLTLV_STATUS_INVALID_FORMAT;
+    }
+
+    reader->type = value_type;
+    reader->done = (type == value_type);
+    *out_data = SmolTLV_Item_get_value(item);
+    *out_length = SmolTLV_Item_get_length(item);
+    return SMOLTLV_STATUS_OK;
+}
+
+/*
+ * Patching
+ */
+
+void SmolTLV_Patch_init(SmolTLV_Patch *patch, 
+                        uint8_t *buffer, 
+                        size_t size, 
+                        size_t capacity) {
+    patch->buffer = buffer;
+    patch->size = size;
+    patch->capacity = capacity;
+}
+
+static bool type_has_items(uint8_t type) {
+    return type == SMOLTLV_TYPE_LIST 
+        || type == SMOLTLV_TYPE_DICT 
+        || type == SMOLTLV_TYPE_STRING_TABLE 
+        || type == SMOLTLV_TYPE_RECORD_BATCH 
+        || type == SMOLTLV_TYPE_DELTA;
+}
+
+/*
+ * Walks from the top level down to target, visiting every container 
+ * enclosing it (and target itself if include_target). With apply false 
+ * only checks that adjusted lengths are representable, otherwise adds 
+ * delta to them. Only headers in front of target are touched, so the walk 
+ * works both before and after the rest of the buffer is moved.
+ */
+static SmolTLV_Status patch_walk(SmolTLV_Patch *patch, 
+                                 const uint8_t *target, 
+                                 bool include_target, 
+                                 int64_t delta, 
+                                 bool apply) {
+    uint8_t *begin = patch->buffer;
+    uint8_t *end = patch->buffer + patch->size;
+
+    for (;;) {
+        uint8_t *p = begin;
+        uint8_t *child = NULL;
+
+        while (p + 4u <= end) {
+            uint8_t *next = p + 4u + load_len24(p);
+            if (next > end) {
+                return SMOLTLV_STATUS_INVALID_FORMAT;
+            }
+            if (p <= target && target < next) {
+                child = p;
+                break;
+            }
+            p = next;
+        }
+
+        if (!child) {
+            return SMOLTLV_STATUS_INVALID_ARGUMENT;
+        }
+
+        if (child == target && !include_target) {
+            return SMOLTLV_STATUS_OK;
+        }
+
+        if (!type_has_items(child[0])) {
+            return SMOLTLV_STATUS_INVALID_ARGUMENT;
+        }
+
+        uint32_t old_length = load_len24(child);
+        int64_t length = (int64_t)old_length + delta;
+        if (length < 0 || length > (int64_t)SMOLTLV_MAX_LENGTH) {
+            return SMOLTLV_STATUS_INVALID_FORMAT;
+        }
+        if (apply) {
+            store_be(child + 1u, (uint64_t)length, 3u);
+        }
+
+        if (child == target) {
+            return SMOLTLV_STATUS_OK;
+        }
+
+        // Descend using old lengths, items in front of target are unchanged
+        begin = child + 4u;
+        end = child + 4u + old_length;
+    }
+}
+
+/*
+ * Resizes span [offset, offset + old_size) to new_size bytes, anchor is 
+ * the item whose enclosing containers (and itself if include_anchor) get 
+ * their lengths fixed. Returns pointer to the resized span.
+ */
+static SmolTLV_Status patch_resize(SmolTLV_Patch *patch, 
+                                   const uint8_t *anchor, 
+                                   bool include_anchor, 
+                                   size_t offset, 
+                                   size_t old_size, 
+                                   size_t new_size, 
+                                   uint8_t **out_span) {
+    if (offset > patch->size || old_size > patch->size - offset) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    if (new_size > old_size && new_size - old_size > patch->capacity - patch->size) {
+        return SMOLTLV_STATUS_OUT_OF_MEMORY;
+    }
+
+    int64_t delta = (int64_t)new_size - (int64_t)old_size;
+    if (delta != 0) {
+        SmolTLV_Status status = patch_walk(patch, anchor, include_anchor, delta, false);
+        if (status != SMOLTLV_STATUS_OK) {
+            return status;
+        }
+
+        memmove(patch->buffer + offset + new_size, 
+                patch->buffer + offset + old_size, 
+                patch->size - offset - old_size);
+        patch_walk(patch, anchor, include_anchor, delta, true);
+        patch->size = (size_t)((int64_t)patch->size + delta);
+    }
+
+    *out_span = patch->buffer + offset;
+    return SMOLTLV_STATUS_OK;
+}
+
+static bool patch_contains(const SmolTLV_Patch *patch, SmolTLV_Item item) {
+    return item.pointer >= patch->buffer 
+        && item.pointer + 4u <= patch->buffer + patch->size;
+}
+
+static bool encoded_is_item(const uint8_t *encoded, size_t encoded_size) {
+    SmolTLV_Cursor cursor;
+    SmolTLV_Item item;
+    SmolTLV_Cursor_init(&cursor, encoded, encoded_size);
+    return encoded 
+        && SmolTLV_Cursor_next(&cursor, &item) == SMOLTLV_STATUS_OK 
+        && SmolTLV_Cursor_is_at_end(&cursor);
+}
+
+SmolTLV_Status SmolTLV_Patch_set_int(SmolTLV_Patch *patch, 
+                                     SmolTLV_Item item, 
+                                     int64_t value) {
+    if (!patch || !patch_contains(patch, item) || 
+        SmolTLV_Item_get_type(item) != SMOLTLV_TYPE_INT || 
+        SmolTLV_Item_get_length(item) != 8u) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    store_be((uint8_t *)item.pointer + 4u, (uint64_t)value, 8u);
+    return SMOLTLV_STATUS_OK;
+}
+
+SmolTLV_Status SmolTLV_Patch_set_bool(SmolTLV_Patch *patch, 
+                                      SmolTLV_Item item, 
+                                      bool value) {
+    if (!patch || !patch_contains(patch, item) || 
+        !SmolTLV_Item_as_bool(item, NULL)) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    ((uint8_t *)item.pointer)[0] = value ? SMOLTLV_TYPE_BOOL_TRUE : SMOLTLV_TYPE_BOOL_FALSE;
+    return SMOLTLV_STATUS_OK;
+}
+
+SmolTLV_Status SmolTLV_Patch_set_string(SmolTLV_Patch *patch, 
+                                        SmolTLV_Item item, 
+                                        const char *str) {
+    if (!str) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+    return SmolTLV_Patch_replace_value(patch, item, SMOLTLV_TYPE_STRING, 
+                                       (const uint8_t *)str, strlen(str));
+}
+
+SmolTLV_Status SmolTLV_Patch_replace_value(SmolTLV_Patch *patch, 
+                                           SmolTLV_Item item, 
+                                           SmolTLV_Type type, 
+                                           const uint8_t *value, 
+                                           size_t length) {
+    if (!patch || !patch_contains(patch, item) || length > SMOLTLV_MAX_LENGTH || 
+        (length > 0u && !value)) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    uint8_t *span;
+    size_t offset = (size_t)(item.pointer - patch->buffer);
+    SmolTLV_Status status = patch_resize(patch, item.pointer, false, offset, 
+                                         4u + SmolTLV_Item_get_length(item), 
+                                         4u + length, &span);
+    if (status != SMOLTLV_STATUS_OK) {
+        return status;
+    }
+
+    span[0] = (uint8_t)type;
+    store_be(span + 1u, length, 3u);
+    if (length > 0u) {
+        memcpy(span + 4u, value, length);
+    }
+    return SMOLTLV_STATUS_OK;
+}
+
+SmolTLV_Status SmolTLV_Patch_replace(SmolTLV_Patch *patch, 
+                                     SmolTLV_Item item, 
+                                     const uint8_t *encoded, 
+                                     size_t encoded_size) {
+    if (!patch || !patch_contains(patch, item) || 
+        !encoded_is_item(encoded, encoded_size)) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    uint8_t *span;
+    size_t offset = (size_t)(item.pointer - patch->buffer);
+    SmolTLV_Status status = patch_resize(patch, item.pointer, false, offset, 
+                                         4u + SmolTLV_Item_get_length(item), 
+                                         encoded_size, &span);
+    if (status == SMOLTLV_STATUS_OK) {
+        memcpy(span, encoded, encoded_size);
+    }
+    return status;
+}
+
+SmolTLV_Status SmolTLV_Patch_remove(SmolTLV_Patch *patch, SmolTLV_Item item) {
+    if (!patch || !patch_contains(patch, item)) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    uint8_t *span;
+    size_t offset = (size_t)(item.pointer - patch->buffer);
+    return patch_resize(patch, item.pointer, false, offset, 
+                        4u + SmolTLV_Item_get_length(item), 0u, &span);
+}
+
+SmolTLV_Status SmolTLV_Patch_insert_before(SmolTLV_Patch *patch, 
+                                           SmolTLV_Item position, 
+                                           const uint8_t *encoded, 
+                                           size_t encoded_size) {
+    if (!patch || !patch_contains(patch, position) || 
+        !encoded_is_item(encoded, encoded_size)) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    uint8_t *span;
+    size_t offset = (size_t)(position.pointer - patch->buffer);
+    SmolTLV_Status status = patch_resize(patch, position.pointer, false, offset, 
+                                         0u, encoded_size, &span);
+    if (status == SMOLTLV_STATUS_OK) {
+        memcpy(span, encoded, encoded_size);
+    }
+    return status;
+}
+
+SmolTLV_Status SmolTLV_Patch_append(SmolTLV_Patch *patch, 
+                                    SmolTLV_Item container, 
+                                    const uint8_t *encoded, 
+                                    size_t encoded_size) {
+    if (!patch || !patch_contains(patch, container) || 
+        !type_has_items(SmolTLV_Item_get_type_raw(container)) || 
+        !encoded_is_item(encoded, encoded_size)) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    uint8_t *span;
+    size_t offset = (size_t)(container.pointer - patch->buffer) 
+        + 4u + SmolTLV_Item_get_length(container);
+    SmolTLV_Status status = patch_resize(patch, container.pointer, true, offset, 
+                                         0u, encoded_size, &span);
+    if (status == SMOLTLV_STATUS_OK) {
+        memcpy(span, encoded, encoded_size);
+    }
+    return status;
+}
+
+static bool patch_dict_find(SmolTLV_Item dict, 
+                            const char *key, 
+                            SmolTLV_Item *out_key, 
+                            SmolTLV_Item *out_value) {
+    SmolTLV_Cursor cursor;
+    SmolTLV_Item key_item, value_item;
+    SmolTLV_Cursor_for_item(&cursor, dict);
+
+    while (SmolTLV_Cursor_next(&cursor, &key_item) == SMOLTLV_STATUS_OK) {
+        if (SmolTLV_Cursor_next(&cursor, &value_item) != SMOLTLV_STATUS_OK) {
+            return false;
+        }
+        if (SmolTLV_Item_strcmp(key_item, key)) {
+            *out_key = key_item;
+            *out_value = value_item;
+            return true;
+        }
+    }
+    return false;
+}
+
+SmolTLV_Status SmolTLV_Patch_dict_set(SmolTLV_Patch *patch, 
+                                      SmolTLV_Item dict, 
+                                      const char *key, 
+                                      const uint8_t *encoded, 
+                                      size_t encoded_size) {
+    if (!patch || !key || !patch_contains(patch, dict) || 
+        SmolTLV_Item_get_type(dict) != SMOLTLV_TYPE_DICT || 
+        !encoded_is_item(encoded, encoded_size)) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    SmolTLV_Item key_item, value_item;
+    if (patch_dict_find(dict, key, &key_item, &value_item)) {
+        return SmolTLV_Patch_replace(patch, value_item, encoded, encoded_size);
+    }
+
+    size_t key_length = strlen(key);
+    if (key_length > SMOLTLV_MAX_LENGTH) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    // Key and value are inserted by a single move
+    uint8_t *span;
+    size_t offset = (size_t)(dict.pointer - patch->buffer) 
+        + 4u + SmolTLV_Item_get_length(dict);
+    SmolTLV_Status status = patch_resize(patch, dict.pointer, true, offset, 0u, 
+                                         4u + key_length + encoded_size, &span);
+    if (status != SMOLTLV_STATUS_OK) {
+        return status;
+    }
+
+    span[0] = SMOLTLV_TYPE_STRING;
+    store_be(span + 1u, key_length, 3u);
+    memcpy(span + 4u, key, key_length);
+    memcpy(span + 4u + key_length, encoded, encoded_size);
+    return SMOLTLV_STATUS_OK;
+}
+
+SmolTLV_Status SmolTLV_Patch_dict_remove(SmolTLV_Patch *patch, 
+                                         SmolTLV_Item dict, 
+                                         const char *key) {
+    if (!patch || !key || !patch_contains(patch, dict) || 
+        SmolTLV_Item_get_type(dict) != SMOLTLV_TYPE_DICT) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    SmolTLV_Item key_item, value_item;
+    if (!patch_dict_find(dict, key, &key_item, &value_item)) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    uint8_t *span;
+    size_t offset = (size_t)(key_item.pointer - patch->buffer);
+    size_t entry_size = (size_t)(value_item.pointer - key_item.pointer) 
+        + 4u + SmolTLV_Item_get_length(value_item);
+    return patch_resize(patch, key_item.pointer, false, offset, 
+                        entry_size, 0u, &span);
+}
+
+SmolTLV_Status SmolTLV_Patch_list_insert(SmolTLV_Patch *patch, 
+                                         SmolTLV_Item list, 
+                                         size_t index, 
+                                         const uint8_t *encoded, 
+                                         size_t encoded_size) {
+    if (!patch || !patch_contains(patch, list) || 
+        SmolTLV_Item_get_type(list) != SMOLTLV_TYPE_LIST) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    SmolTLV_Cursor cursor;
+    SmolTLV_Item item;
+    size_t current_index = 0;
+    SmolTLV_Cursor_for_item(&cursor, list);
+
+    while (SmolTLV_Cursor_next(&cursor, &item) == SMOLTLV_STATUS_OK) {
+        if (current_index == index) {
+            return SmolTLV_Patch_insert_before(patch, item, encoded, encoded_size);
+        }
+        current_index++;
+    }
+
+    if (current_index != index) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+    return SmolTLV_Patch_append(patch, list, encoded, encoded_size);
+}
+
+SmolTLV_Status SmolTLV_Patch_list_remove(SmolTLV_Patch *patch, 
+                                         SmolTLV_Item list, 
+                                         size_t index) {
+    SmolTLV_Item item;
+    if (!patch || !patch_contains(patch, list) || 
+        !SmolTLV_Item_list_at(list, index, &item)) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+    return SmolTLV_Patch_remove(patch, item);
+}
+
+/*
+ * Prepared templates
+ */
+
+#ifndef SMOLTLV_NO_MALLOC
+typedef struct TemplateSlot_s {
+    size_t offset;
+    uint32_t length;
+    uint8_t type;
+} TemplateSlot;
+
+/* Container enclosing slots [first_slot, end_slot) */
+typedef struct TemplateContainer_s {
+    size_t offset;
+    uint32_t length;
+    uint32_t depth;
+    size_t first_slot;
+    size_t end_slot;
+} TemplateContainer;
+
+struct SmolTLV_Template_s {
+    uint8_t *buffer;
+    size_t size;
+    TemplateSlot *slots;
+    size_t slot_count;
+    TemplateContainer *containers;
+    size_t container_count;
+};
+
+/* Same length rules as SmolTLV_Cursor_next */
+static bool template_length_is_valid(uint8_t type, size_t length) {
+    size_t element_size = SmolTLV_Type_array_element_size((SmolTLV_Type)type);
+
+    switch (type) {
+    case SMOLTLV_TYPE_NULL:
+    case SMOLTLV_TYPE_BOOL_TRUE:
+    case SMOLTLV_TYPE_BOOL_FALSE:
+        return length == 0u;
+    case SMOLTLV_TYPE_INT:
+        return length == 8u;
+    case SMOLTLV_TYPE_STRING_REF:
+        return length >= 1u && length <= 4u;
+    default:
+        return length <= SMOLTLV_MAX_LENGTH 
+            && (element_size <= 1u || length % element_size == 0u);
+    }
+}
+
+/*
+ * Index of container at depth with header at offset, containers enclosing 
+ * previous slot are reused, containers are appended in offset order.
+ */
+static SmolTLV_Status template_add_container(SmolTLV_Template *tmpl, 
+                                             size_t *container_capacity, 
+                                             SmolTLV_Item item, 
+                                             uint32_t depth, 
+                                             size_t slot) {
+    size_t offset = (size_t)(item.pointer - tmpl->buffer);
+
+    for (size_t i = tmpl->container_count; i > 0u; i--) {
+        TemplateContainer *container = &tmpl->containers[i - 1u];
+        if (container->depth < depth) {
+            break;
+        }
+        if (container->depth == depth) {
+            if (container->offset == offset) {
+                container->end_slot = slot + 1u;
+                return SMOLTLV_STATUS_OK;
+            }
+            break;
+        }
+    }
+
+    if (tmpl->container_count == *container_capacity) {
+        size_t capacity = *container_capacity ? *container_capacity * 2u : 8u;
+        TemplateContainer *containers = (TemplateContainer *)realloc(
+            tmpl->containers, capacity * sizeof(TemplateContainer)
+        );
+        if (!containers) {
+            return SMOLTLV_STATUS_OUT_OF_MEMORY;
+        }
+        tmpl->containers = containers;
+        *container_capacity = capacity;
+    }
+
+    TemplateContainer *container = &tmpl->containers[tmpl->container_count++];
+    container->offset = offset;
+    container->length = SmolTLV_Item_get_length(item);
+    container->depth = depth;
+    container->first_slot = slot;
+    container->end_slot = slot + 1u;
+    return SMOLTLV_STATUS_OK;
+}
+
+/* Walks down from the top level to the slot item */
+static SmolTLV_Status template_find_slot(SmolTLV_Template *tmpl, 
+                                         size_t *container_capacity, 
+                                         size_t slot) {
+    TemplateSlot *target = &tmpl->slots[slot];
+    SmolTLV_Cursor cursor;
+    SmolTLV_Item item;
+    SmolTLV_Status status;
+    uint32_t depth = 0;
+
+    SmolTLV_Cursor_init(&cursor, tmpl->buffer, tmpl->size);
+    while ((status = SmolTLV_Cursor_next(&cursor, &item)) == SMOLTLV_STATUS_OK) {
+        size_t offset = (size_t)(item.pointer - tmpl->buffer);
+        size_t end = offset + 4u + SmolTLV_Item_get_length(item);
+
+        if (offset == target->offset) {
+            uint8_t type = SmolTLV_Item_get_type_raw(item);
+            if (type_has_items(type)) {
+                return SMOLTLV_STATUS_INVALID_ARGUMENT;
+            }
+            target->type = type;
+            target->length = SmolTLV_Item_get_length(item);
+            return SMOLTLV_STATUS_OK;
+        }
+
+        if (target->offset > offset && target->offset < end) {
+            if (!type_has_items(SmolTLV_Item_get_type_raw(item))) {
+                return SMOLTLV_STATUS_INVALID_ARGUMENT;
+            }
+            status = template_add_container(tmpl, container_capacity, item, 
+                                            depth, slot);
+            if (status != SMOLTLV_STATUS_OK) {
+                return status;
+            }
+            SmolTLV_Cursor_for_item(&cursor, item);
+            depth++;
+        }
+    }
+
+    return status == SMOLTLV_STATUS_END ? SMOLTLV_STATUS_INVALID_ARGUMENT : status;
+}
+
+SmolTLV_Status SmolTLV_Template_create(const uint8_t *buffer, 
+                                       size_t size, 
+                                       const size_t *slot_offsets, 
+                                       size_t slot_count, 
+                                       SmolTLV_Template **out) {
+    if (!buffer || !out || (slot_count > 0u && !slot_offsets)) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    for (size_t i = 1; i < slot_count; i++) {
+        if (slot_offsets[i] <= slot_offsets[i - 1u]) {
+            return SMOLTLV_STATUS_INVALID_ARGUMENT;
+        }
+    }
+
+    // Template, slots and copy of the buffer share one allocation
+    size_t slots_size = slot_count * sizeof(TemplateSlot);
+    SmolTLV_Template *tmpl = (SmolTLV_Template *)malloc(
+        sizeof(SmolTLV_Template) + slots_size + size
+    );
+    if (!tmpl) {
+        return SMOLTLV_STATUS_OUT_OF_MEMORY;
+    }
+
+    tmpl->slots = (TemplateSlot *)(tmpl + 1);
+    tmpl->slot_count = slot_count;
+    tmpl->buffer = (uint8_t *)tmpl->slots + slots_size;
+    tmpl->size = size;
+    tmpl->containers = NULL;
+    tmpl->container_count = 0;
+    memcpy(tmpl->buffer, buffer, size);
+
+    size_t container_capacity = 0;
+    for (size_t i = 0; i < slot_count; i++) {
+        tmpl->slots[i].offset = slot_offsets[i];
+        SmolTLV_Status status = template_find_slot(tmpl, &container_capacity, i);
+        if (status != SMOLTLV_STATUS_OK) {
+            SmolTLV_Template_destroy(tmpl);
+            return status;
+        }
+    }
+
+    *out = tmpl;
+    return SMOLTLV_STATUS_OK;
+}
+
+void SmolTLV_Template_destroy(SmolTLV_Template *tmpl) {
+    if (!tmpl) {
+        return;
+    }
+    free(tmpl->containers);
+    free(tmpl);
+}
+
+size_t SmolTLV_Template_size(const SmolTLV_Template *tmpl) {
+    return tmpl ? tmpl->size : 0u;
+}
+
+size_t SmolTLV_Template_slot_count(const SmolTLV_Template *tmpl) {
+    return tmpl ? tmpl->slot_count : 0u;
+}
+
+size_t SmolTLV_Template_slot_offset(const SmolTLV_Template *tmpl, size_t slot) {
+    return (tmpl && slot < tmpl->slot_count) ? tmpl->slots[slot].offset : 0u;
+}
+
+void SmolTLV_Template_copy(const SmolTLV_Template *tmpl, uint8_t *message) {
+    if (!tmpl || !message) {
+        return;
+    }
+    memcpy(message, tmpl->buffer, tmpl->size);
+}
+
+SmolTLV_Status SmolTLV_Template_store_int(const SmolTLV_Template *tmpl, 
+                                          uint8_t *message, 
+                                          size_t slot, 
+                                          int64_t value) {
+    if (!tmpl || !message || slot >= tmpl->slot_count || 
+        tmpl->slots[slot].type != SMOLTLV_TYPE_INT) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+    store_be(message + tmpl->slots[slot].offset + 4u, (uint64_t)value, 8u);
+    return SMOLTLV_STATUS_OK;
+}
+
+SmolTLV_Status SmolTLV_Template_store_bool(const SmolTLV_Template *tmpl, 
+                                           uint8_t *message, 
+                                           size_t slot, 
+                                           bool value) {
+    if (!tmpl || !message || slot >= tmpl->slot_count || 
+        (tmpl->slots[slot].type != SMOLTLV_TYPE_BOOL_TRUE && 
+         tmpl->slots[slot].type != SMOLTLV_TYPE_BOOL_FALSE)) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+    message[tmpl->slots[slot].offset] = value ? SMOLTLV_TYPE_BOOL_TRUE 
+                                              : SMOLTLV_TYPE_BOOL_FALSE;
+    return SMOLTLV_STATUS_OK;
+}
+
+SmolTLV_Status SmolTLV_Template_store_value(const SmolTLV_Template *tmpl, 
+                                            uint8_t *message, 
+                                            size_t slot, 
+                                            const uint8_t *value, 
+                                            size_t length) {
+    if (!tmpl || !message || slot >= tmpl->slot_count || 
+        length != tmpl->slots[slot].length || (length > 0u && !value)) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+    if (length > 0u) {
+        memcpy(message + tmpl->slots[slot].offset + 4u, value, length);
+    }
+    return SMOLTLV_STATUS_OK;
+}
+
+static int64_t template_slot_delta(const SmolTLV_Template *tmpl, 
+                                   const SmolTLV_SlotValue *values, 
+                                   size_t slot) {
+    if (!values[slot].value) {
+        return 0;
+    }
+    return (int64_t)values[slot].length - (int64_t)tmpl->slots[slot].length;
+}
+
+/*
+ * New lengths of containers enclosing changed slots, containers are 
+ * written only when out is not NULL.
+ */
+static SmolTLV_Status template_fix_containers(const SmolTLV_Template *tmpl, 
+                                              const SmolTLV_SlotValue *values, 
+                                              uint8_t *out) {
+    int64_t shift = 0;
+    size_t slot = 0;
+
+    for (size_t i = 0; i < tmpl->container_count; i++) {
+        const TemplateContainer *container = &tmpl->containers[i];
+
+        // Slots before the container header move it
+        while (slot < container->first_slot) {
+            shift += template_slot_delta(tmpl, values, slot++);
+        }
+
+        int64_t delta = 0;
+        for (size_t j = container->first_slot; j < container->end_slot; j++) {
+            delta += template_slot_delta(tmpl, values, j);
+        }
+        if (delta == 0) {
+            continue;
+        }
+
+        int64_t length = (int64_t)container->length + delta;
+        if (length > (int64_t)SMOLTLV_MAX_LENGTH) {
+            return SMOLTLV_STATUS_INVALID_ARGUMENT;
+        }
+        if (out) {
+            store_be(out + (size_t)((int64_t)container->offset + shift) + 1u, 
+                     (uint64_t)length, 3u);
+        }
+    }
+    return SMOLTLV_STATUS_OK;
+}
+
+SmolTLV_Status SmolTLV_Template_render(const SmolTLV_Template *tmpl, 
+                                       const SmolTLV_SlotValue *values, 
+                                       uint8_t *out, 
+                                       size_t capacity, 
+                                       size_t *out_size) {
+    if (!tmpl || !values || !out_size || (capacity > 0u && !out)) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    int64_t size = (int64_t)tmpl->size;
+    for (size_t i = 0; i < tmpl->slot_count; i++) {
+        if (values[i].value && 
+            !template_length_is_valid(tmpl->slots[i].type, values[i].length)) {
+            return SMOLTLV_STATUS_INVALID_ARGUMENT;
+        }
+        size += template_slot_delta(tmpl, values, i);
+    }
+
+    SmolTLV_Status status = template_fix_containers(tmpl, values, NULL);
+    if (status != SMOLTLV_STATUS_OK) {
+        return status;
+    }
+
+    *out_size = (size_t)size;
+    if ((size_t)size > capacity) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    // Template spans between replaced slot payloads are copied as they are
+    size_t position = 0;
+    uint8_t *p = out;
+    for (size_t i = 0; i < tmpl->slot_count; i++) {
+        const TemplateSlot *slot = &tmpl->slots[i];
+        if (!values[i].value) {
+            continue;
+        }
 
-        if (out_item) {
-            *out_item = value_item;
+        size_t header_end = slot->offset + 4u;
+        memcpy(p, tmpl->buffer + position, header_end - position);
+        p += header_end - position;
+        store_be(p - 3, values[i].length, 3u);
+        if (values[i].length > 0u) {
+            memcpy(p, values[i].value, values[i].length);
+            p += values[i].length;
         }
-        return true;
+        position = header_end + slot->length;
     }
+    memcpy(p, tmpl->buffer + position, tmpl->size - position);
 
-    return false;
+    return template_fix_containers(tmpl, values, out);
 }
+#endif
 
 /*
  * Encoder functionality
@@ -342,6 +2024,14 @@ struct EncoderFrame_s {
     EncoderFrame *next;
 };
 
+/** Entry of string table hash index, position 0 marks free slot */
+typedef struct EncoderKeySlot_s {
+    uint32_t hash;
+    uint32_t id;
+    /** Position of STRING entry in buffer, kept valid by reallocation */
+    size_t position;
+} EncoderKeySlot;
+
 struct SmolTLV_Encoder_s {
     uint8_t *buffer;
     size_t buffer_size;
@@ -349,7 +2039,17 @@ struct SmolTLV_Encoder_s {
     bool error: 1;
     bool finalized: 1;
     bool manage_buffer: 1;
+    bool has_string_table: 1;
+    size_t string_table_position;
+    /** Open addressing index of current string table, NULL falls back to
+     * scanning it */
+    EncoderKeySlot *key_index;
+    size_t key_index_mask;
     EncoderFrame *frame_stack;
+#ifdef SMOLTLV_STATS
+    uint32_t depth;
+    SmolTLV_EncoderStats stats;
+#endif
 };
 
 SmolTLV_Encoder* SmolTLV_Encoder_create() {
@@ -373,7 +2073,15 @@ SmolTLV_Encoder* SmolTLV_Encoder_create_with_size(size_t initial_size) {
     encoder->error = false;
     encoder->finalized = false;
     encoder->manage_buffer = true;
+    encoder->has_string_table = false;
+    encoder->string_table_position = 0;
+    encoder->key_index = NULL;
+    encoder->key_index_mask = 0;
     encoder->frame_stack = NULL;
+#ifdef SMOLTLV_STATS
+    encoder->depth = 0;
+    memset(&encoder->stats, 0, sizeof(encoder->stats));
+#endif
     return encoder;
 }
 
@@ -392,7 +2100,15 @@ SmolTLV_Encoder* SmolTLV_Encoder_create_from_buffer(
     encoder->error = false;
     encoder->finalized = false;
     encoder->manage_buffer = false;
+    encoder->has_string_table = false;
+    encoder->string_table_position = 0;
+    encoder->key_index = NULL;
+    encoder->key_index_mask = 0;
     encoder->frame_stack = NULL;
+#ifdef SMOLTLV_STATS
+    encoder->depth = 0;
+    memset(&encoder->stats, 0, sizeof(encoder->stats));
+#endif
     return encoder;
 }
 
@@ -412,9 +2128,30 @@ void SmolTLV_Encoder_destroy(SmolTLV_Encoder *encoder) {
         frame = next;
     }
 
+    free(encoder->key_index);
     free(encoder);
 }
 
+size_t SmolTLV_Encoder_get_position(const SmolTLV_Encoder *encoder) {
+    return encoder ? encoder->position : 0u;
+}
+
+#ifdef SMOLTLV_STATS
+void SmolTLV_Encoder_get_stats(const SmolTLV_Encoder *encoder, 
+                               SmolTLV_EncoderStats *out) {
+    if (encoder && out) {
+        *out = encoder->stats;
+    }
+}
+
+void SmolTLV_Encoder_reset_stats(SmolTLV_Encoder *encoder) {
+    if (encoder) {
+        memset(&encoder->stats, 0, sizeof(encoder->stats));
+        encoder->stats.peak_depth = encoder->depth;
+    }
+}
+#endif /* SMOLTLV_STATS */
+
 SmolTLV_Status SmolTLV_Encoder_finalize(
     SmolTLV_Encoder *encoder,
     const uint8_t **out_buffer,
@@ -467,6 +2204,9 @@ static bool encoder_reserve(SmolTLV_Encoder *encoder, size_t size) {
         return false;
     }
 
+    STATS_ENCODER_ADD(encoder, reallocs, 1u);
+    STATS_ENCODER_ADD(encoder, realloc_bytes, encoder->position);
+
     encoder->buffer = new_buffer;
     encoder->buffer_size = new_size;
     return true;
@@ -488,6 +2228,7 @@ bool encoder_write_header(SmolTLV_Encoder *encoder,
     encoder->buffer[encoder->position + 2u] = (uint8_t)((length >> 8) & 0xFFu);
     encoder->buffer[encoder->position + 3u] = (uint8_t)(length & 0xFFu);
     encoder->position += 4u;
+    STATS_ENCODER_ADD(encoder, items_written, 1u);
     return true;
 }
 void encoder_patch_header(SmolTLV_Encoder *encoder, 
@@ -514,6 +2255,12 @@ SmolTLV_Status SmolTLV_Encoder_write_primitive(SmolTLV_Encoder *encoder,
         return SMOLTLV_STATUS_INVALID_ARGUMENT;
     }
 
+    // Chunked values are top-level only
+    if (encoder->frame_stack && 
+        (type == SMOLTLV_TYPE_BYTES_CHUNK || type == SMOLTLV_TYPE_STRING_CHUNK)) {
+        return SMOLTLV_STATUS_INVALID_STATE;
+    }
+
     // Reserve space
     if (!encoder_reserve(encoder, 4u + (size_t)length)) {
         return SMOLTLV_STATUS_OUT_OF_MEMORY;
@@ -528,6 +2275,7 @@ SmolTLV_Status SmolTLV_Encoder_write_primitive(SmolTLV_Encoder *encoder,
     if (length > 0u && value != NULL) {
         memcpy(&encoder->buffer[encoder->position], value, (size_t)length);
         encoder->position += (size_t)length;
+        STATS_ENCODER_ADD(encoder, bytes_copied, length);
     }
 
     return SMOLTLV_STATUS_OK;
@@ -567,13 +2315,597 @@ SmolTLV_Status SmolTLV_Encoder_write_string(SmolTLV_Encoder *encoder,
     return SmolTLV_Encoder_write_primitive(encoder, SMOLTLV_TYPE_STRING, (const uint8_t *)str, length);
 }
 
+SmolTLV_Status SmolTLV_Encoder_write_array(SmolTLV_Encoder *encoder, 
+                                           SmolTLV_Type type, 
+                                           const void *values, 
+                                           size_t count) {
+    if (encoder->error || encoder->finalized) {
+        return SMOLTLV_STATUS_INVALID_STATE;
+    }
+
+    size_t element_size = SmolTLV_Type_array_element_size(type);
+    if (element_size == 0u || (count > 0u && !values)) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    if (count > SMOLTLV_MAX_LENGTH / element_size) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    size_t length = count * element_size;
+    if (!encoder_reserve(encoder, 4u + length)) {
+        return SMOLTLV_STATUS_OUT_OF_MEMORY;
+    }
+
+    if (!encoder_write_header(encoder, type, (uint32_t)length)) {
+        return SMOLTLV_STATUS_OUT_OF_MEMORY;
+    }
+
+    array_convert(&encoder->buffer[encoder->position], (const uint8_t *)values, 
+                  count, element_size, true);
+    encoder->position += length;
+    STATS_ENCODER_ADD(encoder, bytes_copied, length);
+    return SMOLTLV_STATUS_OK;
+}
+SmolTLV_Status SmolTLV_Encoder_write_int8_array(SmolTLV_Encoder *encoder, 
+                                                const int8_t *values, 
+                                                size_t count) {
+    return SmolTLV_Encoder_write_array(encoder, SMOLTLV_TYPE_ARRAY_INT8, values, count);
+}
+SmolTLV_Status SmolTLV_Encoder_write_int16_array(SmolTLV_Encoder *encoder, 
+                                                 const int16_t *values, 
+                                                 size_t count) {
+    return SmolTLV_Encoder_write_array(encoder, SMOLTLV_TYPE_ARRAY_INT16, values, count);
+}
+SmolTLV_Status SmolTLV_Encoder_write_int32_array(SmolTLV_Encoder *encoder, 
+                                                 const int32_t *values, 
+                                                 size_t count) {
+    return SmolTLV_Encoder_write_array(encoder, SMOLTLV_TYPE_ARRAY_INT32, values, count);
+}
+SmolTLV_Status SmolTLV_Encoder_write_int64_array(SmolTLV_Encoder *encoder, 
+                                                 const int64_t *values, 
+                                                 size_t count) {
+    return SmolTLV_Encoder_write_array(encoder, SMOLTLV_TYPE_ARRAY_INT64, values, count);
+}
+SmolTLV_Status SmolTLV_Encoder_write_float_array(SmolTLV_Encoder *encoder, 
+                                                 const float *values, 
+                                                 size_t count) {
+    return SmolTLV_Encoder_write_array(encoder, SMOLTLV_TYPE_ARRAY_FLOAT32, values, count);
+}
+SmolTLV_Status SmolTLV_Encoder_write_double_array(SmolTLV_Encoder *encoder, 
+                                                  const double *values, 
+                                                  size_t count) {
+    return SmolTLV_Encoder_write_array(encoder, SMOLTLV_TYPE_ARRAY_FLOAT64, values, count);
+}
+
+/** FNV-1a */
+static uint32_t encoder_key_hash(const uint8_t *key, size_t length) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ key[i]) * 16777619u;
+    }
+    return hash;
+}
+
+/** Indexes count entries of table at table_position, first occurrence of
+ * a string wins as in SmolTLV_StringTable_find. Without memory the table
+ * is scanned instead. */
+static void encoder_index_table(SmolTLV_Encoder *encoder, size_t table_position, size_t count) {
+    free(encoder->key_index);
+    encoder->key_index = NULL;
+    encoder->key_index_mask = 0;
+
+    // Load factor at most 1/2
+    size_t slot_count = 4u;
+    while (slot_count < 2u * count) {
+        slot_count *= 2u;
+    }
+    EncoderKeySlot *slots = (EncoderKeySlot *)calloc(slot_count, sizeof(EncoderKeySlot));
+    if (!slots) {
+        return;
+    }
+
+    size_t position = table_position + 4u;
+    for (uint32_t id = 0; id < count; id++) {
+        SmolTLV_Item entry = { encoder->buffer + position };
+        const uint8_t *key = SmolTLV_Item_get_value(entry);
+        uint32_t length = SmolTLV_Item_get_length(entry);
+        uint32_t hash = encoder_key_hash(key, length);
+
+        size_t slot = hash & (slot_count - 1u);
+        while (slots[slot].position != 0u) {
+            SmolTLV_Item other = { encoder->buffer + slots[slot].position };
+            if (slots[slot].hash == hash && SmolTLV_Item_get_length(other) == length &&
+                memcmp(SmolTLV_Item_get_value(other), key, length) == 0) {
+                break;
+            }
+            slot = (slot + 1u) & (slot_count - 1u);
+        }
+        if (slots[slot].position == 0u) {
+            slots[slot].hash = hash;
+            slots[slot].id = id;
+            slots[slot].position = position;
+        }
+        position += 4u + length;
+    }
+
+    encoder->key_index = slots;
+    encoder->key_index_mask = slot_count - 1u;
+}
+
+SmolTLV_Status SmolTLV_Encoder_write_string_table(
+    SmolTLV_Encoder *encoder,
+    const char *const *strings,
+    size_t count
+) {
+    if (encoder->error || encoder->finalized) {
+        return SMOLTLV_STATUS_INVALID_STATE;
+    }
+
+    if (encoder->frame_stack != NULL) {
+        return SMOLTLV_STATUS_INVALID_STATE;
+    }
+
+    if (count > 0u && !strings) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    size_t table_position = encoder->position;
+    if (!encoder_write_header(encoder, SMOLTLV_TYPE_STRING_TABLE, 0u)) {
+        return SMOLTLV_STATUS_OUT_OF_MEMORY;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        SmolTLV_Status status = SmolTLV_Encoder_write_string(encoder, strings[i]);
+        if (status != SMOLTLV_STATUS_OK) {
+            encoder->error = true;
+            return status;
+        }
+    }
+
+    size_t table_length = encoder->position - table_position - 4u;
+    if (table_length > SMOLTLV_MAX_LENGTH) {
+        encoder->error = true;
+        return SMOLTLV_STATUS_INVALID_FORMAT;
+    }
+
+    encoder_patch_header(encoder, (uint32_t)table_length, table_position);
+    encoder->has_string_table = true;
+    encoder->string_table_position = table_position;
+    encoder_index_table(encoder, table_position, count);
+    return SMOLTLV_STATUS_OK;
+}
+
+SmolTLV_Status SmolTLV_Encoder_write_string_ref(SmolTLV_Encoder *encoder, 
+                                                uint32_t id) {
+    uint8_t buf[4];
+    size_t length = 1u;
+    while (length < 4u && (id >> (8u * length)) != 0u) {
+        length++;
+    }
+    store_be(buf, id, length);
+    return SmolTLV_Encoder_write_primitive(encoder, SMOLTLV_TYPE_STRING_REF, buf, length);
+}
+
+SmolTLV_Status SmolTLV_Encoder_write_key(SmolTLV_Encoder *encoder, 
+                                         const char *key) {
+    if (!key) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    if (encoder->has_string_table && encoder->key_index) {
+        size_t length = strlen(key);
+        uint32_t hash = encoder_key_hash((const uint8_t *)key, length);
+        const EncoderKeySlot *slots = encoder->key_index;
+        for (size_t slot = hash & encoder->key_index_mask; slots[slot].position != 0u;
+             slot = (slot + 1u) & encoder->key_index_mask) {
+            SmolTLV_Item entry = { encoder->buffer + slots[slot].position };
+            if (slots[slot].hash == hash && SmolTLV_Item_get_length(entry) == length &&
+                memcmp(SmolTLV_Item_get_value(entry), key, length) == 0) {
+                return SmolTLV_Encoder_write_string_ref(encoder, slots[slot].id);
+            }
+        }
+    } else if (encoder->has_string_table) {
+        SmolTLV_StringTable table;
+        uint32_t id;
+        table.item.pointer = encoder->buffer + encoder->string_table_position;
+        if (SmolTLV_StringTable_find(&table, key, &id)) {
+            return SmolTLV_Encoder_write_string_ref(encoder, id);
+        }
+    }
+
+    return SmolTLV_Encoder_write_string(encoder, key);
+}
+
+SmolTLV_Status SmolTLV_Encoder_write_item(SmolTLV_Encoder *encoder, 
+                                          SmolTLV_Item item) {
+    if (!item.pointer) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    return SmolTLV_Encoder_write_primitive(encoder, 
+                                           SmolTLV_Item_get_type(item), 
+                                           SmolTLV_Item_get_value(item), 
+                                           SmolTLV_Item_get_length(item));
+}
+
+SmolTLV_Status SmolTLV_Encoder_write_items(SmolTLV_Encoder *encoder, 
+                                           const uint8_t *buffer, 
+                                           size_t size) {
+    if (!buffer && size > 0u) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    if (encoder->error || encoder->finalized) {
+        return SMOLTLV_STATUS_INVALID_STATE;
+    }
+
+    if (!encoder_reserve(encoder, size)) {
+        return SMOLTLV_STATUS_OUT_OF_MEMORY;
+    }
+
+    if (size > 0u) {
+        memcpy(&encoder->buffer[encoder->position], buffer, size);
+        encoder->position += size;
+        STATS_ENCODER_ADD(encoder, bytes_copied, size);
+    }
+    return SMOLTLV_STATUS_OK;
+}
+
+SmolTLV_Status SmolTLV_Encoder_write_delta_column(
+    SmolTLV_Encoder *encoder,
+    const int64_t *values,
+    size_t count
+) {
+    if (encoder->error || encoder->finalized) {
+        return SMOLTLV_STATUS_INVALID_STATE;
+    }
+
+    if (count > 0u && !values) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    // Find the narrowest element able to hold all differences
+    int64_t min_delta = 0, max_delta = 0;
+    uint64_t previous = 0;
+    for (size_t i = 0; i < count; i++) {
+        int64_t delta = (int64_t)((uint64_t)values[i] - previous);
+        previous = (uint64_t)values[i];
+        if (delta < min_delta) min_delta = delta;
+        if (delta > max_delta) max_delta = delta;
+    }
+
+    SmolTLV_Type array_type = SMOLTLV_TYPE_ARRAY_INT64;
+    if (min_delta >= INT8_MIN && max_delta <= INT8_MAX) {
+        array_type = SMOLTLV_TYPE_ARRAY_INT8;
+    } else if (min_delta >= INT16_MIN && max_delta <= INT16_MAX) {
+        array_type = SMOLTLV_TYPE_ARRAY_INT16;
+    } else if (min_delta >= INT32_MIN && max_delta <= INT32_MAX) {
+        array_type = SMOLTLV_TYPE_ARRAY_INT32;
+    }
+
+    size_t element_size = SmolTLV_Type_array_element_size(array_type);
+    if (count > (SMOLTLV_MAX_LENGTH - 4u) / element_size) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    size_t length = count * element_size;
+    if (!encoder_reserve(encoder, 8u + length)) {
+        return SMOLTLV_STATUS_OUT_OF_MEMORY;
+    }
+
+    if (!encoder_write_header(encoder, SMOLTLV_TYPE_DELTA, (uint32_t)(4u + length)) ||
+        !encoder_write_header(encoder, array_type, (uint32_t)length)) {
+        return SMOLTLV_STATUS_OUT_OF_MEMORY;
+    }
+
+    uint8_t *p = &encoder->buffer[encoder->position];
+    previous = 0;
+    for (size_t i = 0; i < count; i++) {
+        store_be(p + i * element_size, (uint64_t)values[i] - previous, element_size);
+        previous = (uint64_t)values[i];
+    }
+    encoder->position += length;
+    STATS_ENCODER_ADD(encoder, bytes_copied, length);
+    return SMOLTLV_STATUS_OK;
+}
+
+static bool key_matches(SmolTLV_Item key_item, 
+                        const SmolTLV_StringTable *table, 
+                        const char *key) {
+    uint32_t id;
+    SmolTLV_Item entry;
+
+    if (SmolTLV_Item_as_string_ref(key_item, &id)) {
+        return SmolTLV_StringTable_get(table, id, &entry) 
+            && SmolTLV_Item_strcmp(entry, key);
+    }
+    return SmolTLV_Item_strcmp(key_item, key);
+}
+
+/** True when dict has a value at path from given depth on */
+static bool projection_path_exists(SmolTLV_Item dict, 
+                                   const SmolTLV_StringTable *table, 
+                                   const char *const *path, 
+                                   size_t depth) {
+    SmolTLV_Cursor cursor;
+    SmolTLV_Item key_item, value_item;
+    SmolTLV_Cursor_for_item(&cursor, dict);
+
+    while (SmolTLV_Cursor_next(&cursor, &key_item) == SMOLTLV_STATUS_OK &&
+           SmolTLV_Cursor_next(&cursor, &value_item) == SMOLTLV_STATUS_OK) {
+        if (!key_matches(key_item, table, path[depth])) {
+            continue;
+        }
+        if (path[depth + 1u] == NULL) {
+            return true;
+        }
+        if (SmolTLV_Item_get_type(value_item) == SMOLTLV_TYPE_DICT &&
+            projection_path_exists(value_item, table, path, depth + 1u)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * Projects dict at given depth of paths listed in active. Computes output 
+ * size when encoder is NULL, otherwise writes. Nested dicts without any 
+ * value on the paths are left out together with their key.
+ */
+static SmolTLV_Status projection(SmolTLV_Encoder *encoder, 
+                                 size_t *size, 
+                                 SmolTLV_Item dict, 
+                                 const SmolTLV_StringTable *table, 
+                                 const char *const *const *paths, 
+                                 const size_t *active, 
+                                 size_t active_count, 
+                                 size_t depth) {
+    SmolTLV_Status status = SMOLTLV_STATUS_OK;
+    size_t *nested = (size_t *)malloc((active_count ? active_count : 1u) * sizeof(size_t));
+    if (!nested) {
+        return SMOLTLV_STATUS_OUT_OF_MEMORY;
+    }
+
+    if (encoder) {
+        status = SmolTLV_Encoder_start_dict(encoder);
+    }
+    *size += 4u;
+
+    SmolTLV_Cursor cursor;
+    SmolTLV_Item key_item, value_item;
+    SmolTLV_Cursor_for_item(&cursor, dict);
+
+    while (status == SMOLTLV_STATUS_OK && 
+           SmolTLV_Cursor_next(&cursor, &key_item) == SMOLTLV_STATUS_OK) {
+        if (SmolTLV_Cursor_next(&cursor, &value_item) != SMOLTLV_STATUS_OK) {
+            status = SMOLTLV_STATUS_INVALID_FORMAT;
+            break;
+        }
+
+        bool whole = false;
+        size_t nested_count = 0;
+        for (size_t i = 0; i < active_count; i++) {
+            const char *const *path = paths[active[i]];
+            if (!key_matches(key_item, table, path[depth])) {
+                continue;
+            }
+            if (path[depth + 1u] == NULL) {
+                whole = true;
+                break;
+            }
+            nested[nested_count++] = active[i];
+        }
+
+        if (!whole && (nested_count == 0u || 
+                       SmolTLV_Item_get_type(value_item) != SMOLTLV_TYPE_DICT)) {
+            continue;
+        }
+        if (!whole) {
+            bool exists = false;
+            for (size_t i = 0; i < nested_count && !exists; i++) {
+                exists = projection_path_exists(value_item, table, paths[nested[i]], depth + 1u);
+            }
+            if (!exists) {
+                continue;
+            }
+        }
+
+        size_t key_size = 4u + SmolTLV_Item_get_length(key_item);
+        *size += key_size;
+        if (encoder) {
+            status = SmolTLV_Encoder_write_item(encoder, key_item);
+            if (status != SMOLTLV_STATUS_OK) {
+                break;
+            }
+        }
+
+        if (whole) {
+            // Untouched subtree, copied in one piece
+            *size += 4u + SmolTLV_Item_get_length(value_item);
+            if (encoder) {
+                status = SmolTLV_Encoder_write_item(encoder, value_item);
+            }
+        } else {
+            status = projection(encoder, size, value_item, table, paths, 
+                                nested, nested_count, depth + 1u);
+        }
+    }
+
+    free(nested);
+
+    if (status == SMOLTLV_STATUS_OK && encoder) {
+        status = SmolTLV_Encoder_end(encoder);
+    }
+    return status;
+}
+
+static SmolTLV_Status projection_root(SmolTLV_Encoder *encoder, 
+                                      size_t *size, 
+                                      SmolTLV_Item item, 
+                                      const SmolTLV_StringTable *table, 
+                                      const char *const *const *paths, 
+                                      size_t path_count) {
+    if (!item.pointer || (path_count > 0u && !paths)) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    size_t *active = (size_t *)malloc((path_count ? path_count : 1u) * sizeof(size_t));
+    if (!active) {
+        return SMOLTLV_STATUS_OUT_OF_MEMORY;
+    }
+
+    bool whole = false;
+    for (size_t i = 0; i < path_count; i++) {
+        if (!paths[i]) {
+            free(active);
+            return SMOLTLV_STATUS_INVALID_ARGUMENT;
+        }
+        whole = whole || paths[i][0] == NULL;
+        active[i] = i;
+    }
+
+    SmolTLV_Status status;
+    if (whole) {
+        *size += 4u + SmolTLV_Item_get_length(item);
+        status = encoder ? SmolTLV_Encoder_write_item(encoder, item) : SMOLTLV_STATUS_OK;
+    } else if (SmolTLV_Item_get_type(item) != SMOLTLV_TYPE_DICT) {
+        status = SMOLTLV_STATUS_INVALID_ARGUMENT;
+    } else {
+        status = projection(encoder, size, item, table, paths, active, path_count, 0u);
+    }
+
+    free(active);
+    return status;
+}
+
+SmolTLV_Status SmolTLV_Encoder_write_projection(
+    SmolTLV_Encoder *encoder,
+    SmolTLV_Item item,
+    const SmolTLV_StringTable *table,
+    const char *const *const *paths,
+    size_t path_count
+) {
+    size_t size = 0;
+    if (!encoder) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+    return projection_root(encoder, &size, item, table, paths, path_count);
+}
+
+SmolTLV_Status SmolTLV_Item_projection_size(
+    SmolTLV_Item item,
+    const SmolTLV_StringTable *table,
+    const char *const *const *paths,
+    size_t path_count,
+    size_t *out_size
+) {
+    if (!out_size) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+    *out_size = 0;
+    return projection_root(NULL, out_size, item, table, paths, path_count);
+}
+
+SmolTLV_Status SmolTLV_Batch_write_row(const SmolTLV_Batch *batch, 
+                                       size_t row, 
+                                       SmolTLV_Encoder *encoder) {
+    if (!batch || row >= batch->row_count) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    SmolTLV_Status status = SmolTLV_Encoder_start_dict(encoder);
+    if (status != SMOLTLV_STATUS_OK) {
+        return status;
+    }
+
+    SmolTLV_Cursor cursor;
+    SmolTLV_Cursor schema_cursor;
+    SmolTLV_Item key, column, value;
+    SmolTLV_Cursor_for_item(&cursor, batch->item);
+    SmolTLV_Cursor_next(&cursor, &column);
+    SmolTLV_Cursor_for_item(&schema_cursor, batch->schema);
+
+    for (size_t i = 0; i < batch->column_count; i++) {
+        if (SmolTLV_Cursor_next(&schema_cursor, &key) != SMOLTLV_STATUS_OK ||
+            SmolTLV_Cursor_next(&cursor, &column) != SMOLTLV_STATUS_OK) {
+            return SMOLTLV_STATUS_INVALID_FORMAT;
+        }
+
+        status = SmolTLV_Encoder_write_item(encoder, key);
+        if (status != SMOLTLV_STATUS_OK) {
+            return status;
+        }
+
+        SmolTLV_Type type = SmolTLV_Item_get_type(column);
+        if (type == SMOLTLV_TYPE_LIST) {
+            if (!SmolTLV_Item_list_at(column, row, &value)) {
+                return SMOLTLV_STATUS_INVALID_FORMAT;
+            }
+            status = SmolTLV_Encoder_write_item(encoder, value);
+        } else {
+            int64_t int_value = 0;
+            if (type == SMOLTLV_TYPE_DELTA) {
+                // Prefix sum in one pass over raw elements
+                SmolTLV_Item array_item;
+                if (!SmolTLV_Item_delta_array(column, &array_item)) {
+                    return SMOLTLV_STATUS_INVALID_FORMAT;
+                }
+                size_t element_size = SmolTLV_Type_array_element_size(SmolTLV_Item_get_type(array_item));
+                unsigned shift = 64u - 8u * (unsigned)element_size;
+                const uint8_t *p = SmolTLV_Item_get_value(array_item);
+                uint64_t sum = 0;
+                for (size_t j = 0; j <= row; j++, p += element_size) {
+                    sum += (uint64_t)((int64_t)(load_be(p, element_size) << shift) >> shift);
+                }
+                int_value = (int64_t)sum;
+            } else if (!SmolTLV_Item_array_get_int(column, row, &int_value)) {
+                return SMOLTLV_STATUS_INVALID_FORMAT;
+            }
+            status = SmolTLV_Encoder_write_int(encoder, int_value);
+        }
+
+        if (status != SMOLTLV_STATUS_OK) {
+            return status;
+        }
+    }
+
+    return SmolTLV_Encoder_end(encoder);
+}
+
+SmolTLV_Status SmolTLV_BatchReader_write_row(const SmolTLV_BatchReader *reader, 
+                                             SmolTLV_Encoder *encoder) {
+    if (!reader || reader->row == 0) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    SmolTLV_Status status = SmolTLV_Encoder_start_dict(encoder);
+    for (size_t i = 0; i < reader->batch.column_count && status == SMOLTLV_STATUS_OK; i++) {
+        const SmolTLV_BatchReaderColumn *column = &reader->columns[i];
+        status = SmolTLV_Encoder_write_item(encoder, column->key);
+        if (status == SMOLTLV_STATUS_OK) {
+            status = column->item.pointer 
+                ? SmolTLV_Encoder_write_item(encoder, column->item) 
+                : SmolTLV_Encoder_write_int(encoder, column->int_value);
+        }
+    }
+    if (status != SMOLTLV_STATUS_OK) {
+        return status;
+    }
+    return SmolTLV_Encoder_end(encoder);
+}
+
 SmolTLV_Status SmolTLV_Encoder_start_nested(SmolTLV_Encoder *encoder, 
                                             SmolTLV_Type container_type) {
     if (encoder->error) {
         return SMOLTLV_STATUS_INVALID_STATE;
     }
 
-    if (container_type != SMOLTLV_TYPE_LIST && container_type != SMOLTLV_TYPE_DICT) {
+    if (container_type != SMOLTLV_TYPE_LIST && 
+        container_type != SMOLTLV_TYPE_DICT && 
+        container_type != SMOLTLV_TYPE_RECORD_BATCH &&
+        container_type != SMOLTLV_TYPE_BYTES &&
+        container_type != SMOLTLV_TYPE_STRING) {
         return SMOLTLV_STATUS_INVALID_ARGUMENT;
     }
 
@@ -596,6 +2928,12 @@ SmolTLV_Status SmolTLV_Encoder_start_nested(SmolTLV_Encoder *encoder,
         return SMOLTLV_STATUS_OUT_OF_MEMORY;
     }
 
+#ifdef SMOLTLV_STATS
+    encoder->depth++;
+    if (encoder->depth > encoder->stats.peak_depth) {
+        encoder->stats.peak_depth = encoder->depth;
+    }
+#endif
     return SMOLTLV_STATUS_OK;
 }
 SmolTLV_Status SmolTLV_Encoder_start_list(SmolTLV_Encoder *encoder) {
@@ -604,6 +2942,9 @@ SmolTLV_Status SmolTLV_Encoder_start_list(SmolTLV_Encoder *encoder) {
 SmolTLV_Status SmolTLV_Encoder_start_dict(SmolTLV_Encoder *encoder) {
     return SmolTLV_Encoder_start_nested(encoder, SMOLTLV_TYPE_DICT);
 }
+SmolTLV_Status SmolTLV_Encoder_start_batch(SmolTLV_Encoder *encoder) {
+    return SmolTLV_Encoder_start_nested(encoder, SMOLTLV_TYPE_RECORD_BATCH);
+}
 SmolTLV_Status SmolTLV_Encoder_end(SmolTLV_Encoder *encoder) {
     if (encoder->error || encoder->finalized) {
         return SMOLTLV_STATUS_INVALID_STATE;
@@ -614,6 +2955,9 @@ SmolTLV_Status SmolTLV_Encoder_end(SmolTLV_Encoder *encoder) {
     // Pop frame from stack
     EncoderFrame *frame = encoder->frame_stack;
     encoder->frame_stack = frame->next;
+#ifdef SMOLTLV_STATS
+    encoder->depth--;
+#endif
 
     // Calculate length of nested container
     size_t container_start = frame->start_position + 4u;
@@ -46,7 +46,28 @@ typedef enum SmolTLV_Type_e {
     SMOLTLV_TYPE_STRING     = 0x05,
     SMOLTLV_TYPE_LIST       = 0x06,
     SMOLTLV_TYPE_DICT       = 0x07,
-    SMOLTLV_TYPE_MAX     /* = 0x08 */
+
+    /* Extension: packed big-endian typed arrays */
+    SMOLTLV_TYPE_ARRAY_INT8    = 0x08,
+    SMOLTLV_TYPE_ARRAY_INT16   = 0x09,
+    SMOLTLV_TYPE_ARRAY_INT32   = 0x0A,
+    SMOLTLV_TYPE_ARRAY_INT64   = 0x0B,
+    SMOLTLV_TYPE_ARRAY_FLOAT32 = 0x0C,
+    SMOLTLV_TYPE_ARRAY_FLOAT64 = 0x0D,
+
+    /* Extension: key interning */
+    SMOLTLV_TYPE_STRING_TABLE  = 0x0E,
+    SMOLTLV_TYPE_STRING_REF    = 0x0F,
+
+    /* Extension: columnar record batches */
+    SMOLTLV_TYPE_RECORD_BATCH  = 0x10,
+    SMOLTLV_TYPE_DELTA         = 0x11,
+
+    /* Extension: chunked values beyond SMOLTLV_MAX_LENGTH */
+    SMOLTLV_TYPE_BYTES_CHUNK   = 0x12,
+    SMOLTLV_TYPE_STRING_CHUNK  = 0x13,
+
+    SMOLTLV_TYPE_MAX     /* = 0x14 */
 } SmolTLV_Type;
 
 typedef enum SmolTLV_Status_e {
@@ -67,6 +88,8 @@ typedef struct SmolTLV_Cursor_s {
     const uint8_t *buffer;
     size_t size;
     size_t position;
+    /** Cursor over container payload, chunk items are invalid there */
+    bool nested;
 } SmolTLV_Cursor;
 
 typedef struct SmolTLV_Item_s {
@@ -79,6 +102,7 @@ inline void SmolTLV_Cursor_init(SmolTLV_Cursor *cursor,
     cursor->buffer = buffer;
     cursor->size = size;
     cursor->position = 0;
+    cursor->nested = false;
 }
 
 inline bool SmolTLV_Cursor_is_at_end(SmolTLV_Cursor *cursor) {
@@ -91,6 +115,17 @@ extern SmolTLV_Status SmolTLV_Cursor_next(SmolTLV_Cursor *cursor,
 extern void SmolTLV_Cursor_for_item(SmolTLV_Cursor *cursor, 
                                     SmolTLV_Item item);
 
+/** Advances over count items, validating their headers like 
+ * SmolTLV_Cursor_next but without returning them. Returns END when fewer 
+ * items remain, on errors cursor stays at the offending item. 
+ * out_skipped (can be NULL) is set to number of items skipped. */
+extern SmolTLV_Status SmolTLV_Cursor_skip(SmolTLV_Cursor *cursor, 
+                                          size_t count, 
+                                          size_t *out_skipped);
+/** Number of items left, cursor is not advanced */
+extern SmolTLV_Status SmolTLV_Cursor_count(const SmolTLV_Cursor *cursor, 
+                                           size_t *out_count);
+
 /*
  * Accessors for items
  */
@@ -125,13 +160,389 @@ extern bool SmolTLV_Item_strcmp(SmolTLV_Item item, const char *str);
 
 extern bool SmolTLV_Item_is_container(SmolTLV_Item item);
 
+/*
+ * Typed arrays
+ *
+ * Payload of an array item is a packed sequence of big-endian elements, 
+ * element count is length / element size.
+ */
+
+/** Size of one element of given array type in bytes, 0 for non-array types */
+extern size_t SmolTLV_Type_array_element_size(SmolTLV_Type type);
+
+extern bool SmolTLV_Item_is_array(SmolTLV_Item item);
+extern bool SmolTLV_Item_array_count(SmolTLV_Item item, size_t *out_count);
+
+/** Element accessors, integer arrays convert to int64_t, float arrays to 
+ * double */
+extern bool SmolTLV_Item_array_get_int(SmolTLV_Item item, 
+                                       size_t index, 
+                                       int64_t *out);
+extern bool SmolTLV_Item_array_get_float(SmolTLV_Item item, 
+                                         size_t index, 
+                                         double *out);
+
+/** Copies first count elements to out in host byte order, out has to be 
+ * an array of the matching C type (int8_t ... int64_t, float, double) */
+extern bool SmolTLV_Item_array_copy(SmolTLV_Item item, 
+                                    void *out, 
+                                    size_t count);
+
+/** Number of items in container (keys and values for dict) */
+extern bool SmolTLV_Item_count(SmolTLV_Item item, size_t *out_count);
 extern bool SmolTLV_Item_list_at(SmolTLV_Item list_item, 
                                  size_t index, 
                                  SmolTLV_Item *out);
+/** Dict lookup by string key, entries with STRING_REF keys never match 
+ * (use SmolTLV_Item_dict_get_interned for documents with string table) */
 extern bool SmolTLV_Item_dict_get(SmolTLV_Item dict_item, 
                                  const char *key, 
                                  SmolTLV_Item *out);
 
+/*
+ * String table (key interning)
+ *
+ * STRING_TABLE item is a sequence of STRING items which applies to the 
+ * items following it in the same stream. STRING_REF items refer to table 
+ * entries by their index.
+ */
+
+typedef struct SmolTLV_StringTable_s {
+    SmolTLV_Item item;
+} SmolTLV_StringTable;
+
+/** Initializes table from STRING_TABLE item, NULL item pointer gives an 
+ * empty table */
+extern bool SmolTLV_StringTable_init(SmolTLV_StringTable *table, 
+                                     SmolTLV_Item item);
+extern bool SmolTLV_StringTable_find(const SmolTLV_StringTable *table, 
+                                     const char *str, 
+                                     uint32_t *out_id);
+extern bool SmolTLV_StringTable_get(const SmolTLV_StringTable *table, 
+                                    uint32_t id, 
+                                    SmolTLV_Item *out);
+
+extern bool SmolTLV_Item_as_string_ref(SmolTLV_Item item, uint32_t *out_id);
+
+/** Dict lookup by interned key id, compares only STRING_REF keys */
+extern bool SmolTLV_Item_dict_get_id(SmolTLV_Item dict_item, 
+                                     uint32_t id, 
+                                     SmolTLV_Item *out);
+/** Dict lookup matching both STRING keys and STRING_REF keys resolved 
+ * through the table, searches the table on each call (see SmolTLV_Key) */
+extern bool SmolTLV_Item_dict_get_interned(SmolTLV_Item dict_item, 
+                                           const SmolTLV_StringTable *table, 
+                                           const char *key, 
+                                           SmolTLV_Item *out);
+
+/** Dict key resolved against a string table once, for repeated lookups 
+ * without searching the table each time */
+typedef struct SmolTLV_Key_s {
+    const char *str;
+    /** Id of str in the table, valid when has_id */
+    uint32_t id;
+    bool has_id;
+} SmolTLV_Key;
+
+/** Table can be NULL, str has to outlive the key */
+extern bool SmolTLV_Key_init(SmolTLV_Key *key, 
+                             const SmolTLV_StringTable *table, 
+                             const char *str);
+/** Same results as SmolTLV_Item_dict_get_interned with the table the key 
+ * was resolved against */
+extern bool SmolTLV_Item_dict_get_key(SmolTLV_Item dict_item, 
+                                      const SmolTLV_Key *key, 
+                                      SmolTLV_Item *out);
+
+/** Follows path (NULL terminated list of dict keys) from item, table 
+ * can be NULL */
+extern bool SmolTLV_Item_get_path(SmolTLV_Item item, 
+                                  const SmolTLV_StringTable *table, 
+                                  const char *const *path, 
+                                  SmolTLV_Item *out);
+
+/*
+ * Record batches
+ *
+ * RECORD_BATCH item contains schema (LIST of STRING or STRING_REF keys) 
+ * followed by one column item per key. Column is either a LIST with one 
+ * item per row, an integer typed array or a DELTA item wrapping integer 
+ * typed array of successive differences.
+ */
+
+typedef struct SmolTLV_Batch_s {
+    SmolTLV_Item item;
+    SmolTLV_Item schema;
+    size_t column_count;
+    size_t row_count;
+} SmolTLV_Batch;
+
+/** Validates batch structure, all columns have to have the same number of 
+ * rows */
+extern SmolTLV_Status SmolTLV_Batch_init(SmolTLV_Batch *batch, 
+                                         SmolTLV_Item item);
+/** Finds column by name, STRING_REF keys are resolved through table 
+ * (can be NULL) */
+extern bool SmolTLV_Batch_find_column(const SmolTLV_Batch *batch, 
+                                      const SmolTLV_StringTable *table, 
+                                      const char *key, 
+                                      size_t *out_index);
+extern bool SmolTLV_Batch_get_column(const SmolTLV_Batch *batch, 
+                                     size_t index, 
+                                     SmolTLV_Item *out_key, 
+                                     SmolTLV_Item *out_column);
+
+/** Integer typed array wrapped in DELTA item, values are its prefix sums */
+extern bool SmolTLV_Item_delta_array(SmolTLV_Item delta, 
+                                     SmolTLV_Item *out_array);
+/** Number of rows in column item */
+extern bool SmolTLV_Column_count(SmolTLV_Item column, size_t *out_count);
+/** Decodes first count values of integer column (typed array, DELTA or 
+ * LIST of INT items) to out */
+extern bool SmolTLV_Column_decode_int(SmolTLV_Item column, 
+                                      int64_t *out, 
+                                      size_t count);
+
+/** Column state of SmolTLV_BatchReader */
+typedef struct SmolTLV_BatchReaderColumn_s {
+    SmolTLV_Item key;
+    /** Typed array of integer and DELTA columns */
+    SmolTLV_Item array;
+    /** Next item of LIST column */
+    SmolTLV_Cursor cursor;
+    bool is_list;
+    bool is_delta;
+    uint64_t sum;
+    /** Value in current row: item of LIST column, otherwise NULL pointer 
+     * and int_value */
+    SmolTLV_Item item;
+    int64_t int_value;
+} SmolTLV_BatchReaderColumn;
+
+/** Reads batch row by row in one pass over columns, DELTA columns keep 
+ * running sums */
+typedef struct SmolTLV_BatchReader_s {
+    SmolTLV_Batch batch;
+    SmolTLV_BatchReaderColumn *columns;
+    /** Rows read so far */
+    size_t row;
+} SmolTLV_BatchReader;
+
+/** Columns is an array of at least batch->column_count elements, 
+ * SMOLTLV_STATUS_INVALID_ARGUMENT when capacity is smaller */
+extern SmolTLV_Status SmolTLV_BatchReader_init(SmolTLV_BatchReader *reader, 
+                                               const SmolTLV_Batch *batch, 
+                                               SmolTLV_BatchReaderColumn *columns, 
+                                               size_t capacity);
+/** Moves to next row and fills item/int_value of columns, 
+ * SMOLTLV_STATUS_END after last row */
+extern SmolTLV_Status SmolTLV_BatchReader_next(SmolTLV_BatchReader *reader);
+
+/*
+ * Chunked values
+ *
+ * BYTES (STRING) value of any length is a sequence of BYTES_CHUNK 
+ * (STRING_CHUNK) items terminated by a BYTES (STRING) item holding the last 
+ * part, possibly empty. Value is the concatenation of all payloads, plain 
+ * BYTES or STRING item is a value with single chunk. Chunked values are 
+ * only valid in the top-level sequence, containers cannot exceed 
+ * SMOLTLV_MAX_LENGTH anyway. Cursor over container payload (see 
+ * SmolTLV_Cursor_for_item) fails with SMOLTLV_STATUS_INVALID_FORMAT on 
+ * chunk items and encoder refuses to write them inside a container.
+ *
+ * Encoder writes chunks with SmolTLV_Encoder_write_primitive and the 
+ * terminating item with SmolTLV_Encoder_write_bytes/_string, 
+ * SmolTLV_ChunkWriter streams them without buffering.
+ */
+
+/** Consumes data, e.g. writes it to file or socket */
+typedef SmolTLV_Status (*SmolTLV_WriteFunction)(const uint8_t *data, 
+                                                size_t length, 
+                                                void *context);
+
+typedef struct SmolTLV_ChunkWriter_s {
+    SmolTLV_WriteFunction write;
+    void *context;
+    SmolTLV_Type type;
+} SmolTLV_ChunkWriter;
+
+/** Type is SMOLTLV_TYPE_BYTES or SMOLTLV_TYPE_STRING */
+extern SmolTLV_Status SmolTLV_ChunkWriter_init(SmolTLV_ChunkWriter *writer, 
+                                               SmolTLV_Type type, 
+                                               SmolTLV_WriteFunction write, 
+                                               void *context);
+/** Passes header and data of chunk items (split at SMOLTLV_MAX_LENGTH) to 
+ * write function, data is not copied */
+extern SmolTLV_Status SmolTLV_ChunkWriter_write(SmolTLV_ChunkWriter *writer, 
+                                                const uint8_t *data, 
+                                                size_t length);
+/** Writes terminating item */
+extern SmolTLV_Status SmolTLV_ChunkWriter_finish(SmolTLV_ChunkWriter *writer);
+
+typedef struct SmolTLV_ChunkReader_s {
+    SmolTLV_Cursor *cursor;
+    /** SMOLTLV_TYPE_BYTES or SMOLTLV_TYPE_STRING after first chunk 
+     * (SMOLTLV_TYPE_NULL before) */
+    SmolTLV_Type type;
+    bool done;
+} SmolTLV_ChunkReader;
+
+/** Reads value starting at cursor position */
+extern void SmolTLV_ChunkReader_init(SmolTLV_ChunkReader *reader, 
+                                     SmolTLV_Cursor *cursor);
+/** Returns next chunk pointing into cursor buffer, SMOLTLV_STATUS_END 
+ * after the terminating item. Cursor is not advanced on errors, reading 
+ * can be resumed after SMOLTLV_STATUS_NEED_MORE_DATA once cursor covers 
+ * more data. */
+extern SmolTLV_Status SmolTLV_ChunkReader_next(SmolTLV_ChunkReader *reader, 
+                                               const uint8_t **out_data, 
+                                               size_t *out_length);
+
+/*
+ * In-place patching of encoded buffers
+ *
+ * Items passed to patch functions have to point into the patched buffer. 
+ * Same-size updates are done in place, size-changing ones move the rest 
+ * of the buffer and fix lengths of all containers enclosing the change, 
+ * which invalidates items pointing past the change. Encoded items given 
+ * as new values must not point into the patched buffer.
+ */
+
+typedef struct SmolTLV_Patch_s {
+    uint8_t *buffer;
+    size_t size;
+    size_t capacity;
+} SmolTLV_Patch;
+
+/** Buffer contains size bytes of encoded items and can grow up to 
+ * capacity */
+extern void SmolTLV_Patch_init(SmolTLV_Patch *patch, 
+                               uint8_t *buffer, 
+                               size_t size, 
+                               size_t capacity);
+
+extern SmolTLV_Status SmolTLV_Patch_set_int(SmolTLV_Patch *patch, 
+                                            SmolTLV_Item item, 
+                                            int64_t value);
+extern SmolTLV_Status SmolTLV_Patch_set_bool(SmolTLV_Patch *patch, 
+                                             SmolTLV_Item item, 
+                                             bool value);
+extern SmolTLV_Status SmolTLV_Patch_set_string(SmolTLV_Patch *patch, 
+                                               SmolTLV_Item item, 
+                                               const char *str);
+/** Replaces item with primitive value of given type */
+extern SmolTLV_Status SmolTLV_Patch_replace_value(SmolTLV_Patch *patch, 
+                                                  SmolTLV_Item item, 
+                                                  SmolTLV_Type type, 
+                                                  const uint8_t *value, 
+                                                  size_t length);
+/** Replaces item with encoded item */
+extern SmolTLV_Status SmolTLV_Patch_replace(SmolTLV_Patch *patch, 
+                                            SmolTLV_Item item, 
+                                            const uint8_t *encoded, 
+                                            size_t encoded_size);
+extern SmolTLV_Status SmolTLV_Patch_remove(SmolTLV_Patch *patch, 
+                                           SmolTLV_Item item);
+/** Inserts encoded item before position item (in the same container) */
+extern SmolTLV_Status SmolTLV_Patch_insert_before(SmolTLV_Patch *patch, 
+                                                  SmolTLV_Item position, 
+                                                  const uint8_t *encoded, 
+                                                  size_t encoded_size);
+/** Appends encoded item at the end of container */
+extern SmolTLV_Status SmolTLV_Patch_append(SmolTLV_Patch *patch, 
+                                           SmolTLV_Item container, 
+                                           const uint8_t *encoded, 
+                                           size_t encoded_size);
+
+/** Replaces value of existing key or appends new entry */
+extern SmolTLV_Status SmolTLV_Patch_dict_set(SmolTLV_Patch *patch, 
+                                             SmolTLV_Item dict, 
+                                             const char *key, 
+                                             const uint8_t *encoded, 
+                                             size_t encoded_size);
+extern SmolTLV_Status SmolTLV_Patch_dict_remove(SmolTLV_Patch *patch, 
+                                                SmolTLV_Item dict, 
+                                                const char *key);
+/** Inserts before element at index, index equal to list size appends */
+extern SmolTLV_Status SmolTLV_Patch_list_insert(SmolTLV_Patch *patch, 
+                                                SmolTLV_Item list, 
+                                                size_t index, 
+                                                const uint8_t *encoded, 
+                                                size_t encoded_size);
+extern SmolTLV_Status SmolTLV_Patch_list_remove(SmolTLV_Patch *patch, 
+                                                SmolTLV_Item list, 
+                                                size_t index);
+
+/*
+ * Prepared templates
+ *
+ * Template is an encoded message with slots - primitive items at known 
+ * offsets, usually recorded with SmolTLV_Encoder_get_position while 
+ * encoding the message. Messages are produced by copying the template and 
+ * storing slot values directly, or by rendering, which allows slot values 
+ * of different length and fixes lengths of enclosing containers.
+ */
+
+#ifndef SMOLTLV_NO_MALLOC
+typedef struct SmolTLV_Template_s SmolTLV_Template;
+
+typedef struct SmolTLV_SlotValue_s {
+    /** Payload of slot item, NULL keeps template value */
+    const uint8_t *value;
+    size_t length;
+} SmolTLV_SlotValue;
+
+/** Copies buffer, slot_offsets are offsets of slot item headers in 
+ * ascending order, slots have to be primitive items */
+extern SmolTLV_Status SmolTLV_Template_create(const uint8_t *buffer, 
+                                              size_t size, 
+                                              const size_t *slot_offsets, 
+                                              size_t slot_count, 
+                                              SmolTLV_Template **out);
+extern void SmolTLV_Template_destroy(SmolTLV_Template *tmpl);
+
+extern size_t SmolTLV_Template_size(const SmolTLV_Template *tmpl);
+extern size_t SmolTLV_Template_slot_count(const SmolTLV_Template *tmpl);
+/** Offset of slot item header in copied message */
+extern size_t SmolTLV_Template_slot_offset(const SmolTLV_Template *tmpl, 
+                                           size_t slot);
+
+/** Copies template into message of SmolTLV_Template_size bytes */
+extern void SmolTLV_Template_copy(const SmolTLV_Template *tmpl, 
+                                  uint8_t *message);
+/** Slot stores into copied message, value has to keep slot length */
+extern SmolTLV_Status SmolTLV_Template_store_int(
+    const SmolTLV_Template *tmpl, 
+    uint8_t *message, 
+    size_t slot, 
+    int64_t value
+);
+extern SmolTLV_Status SmolTLV_Template_store_bool(
+    const SmolTLV_Template *tmpl, 
+    uint8_t *message, 
+    size_t slot, 
+    bool value
+);
+extern SmolTLV_Status SmolTLV_Template_store_value(
+    const SmolTLV_Template *tmpl, 
+    uint8_t *message, 
+    size_t slot, 
+    const uint8_t *value, 
+    size_t length
+);
+
+/** Writes message with values (slot_count entries) into out. When out is 
+ * too small, returns SMOLTLV_STATUS_INVALID_ARGUMENT and sets out_size to 
+ * required size */
+extern SmolTLV_Status SmolTLV_Template_render(
+    const SmolTLV_Template *tmpl, 
+    const SmolTLV_SlotValue *values, 
+    uint8_t *out, 
+    size_t capacity, 
+    size_t *out_size
+);
+#endif
+
 /*
  * Encoder functionality
  *
@@ -150,6 +561,8 @@ extern SmolTLV_Encoder* SmolTLV_Encoder_create_from_buffer(
     size_t size
 );
 extern void SmolTLV_Encoder_destroy(SmolTLV_Encoder *encoder);
+/** Number of bytes written so far, i.e. offset of the next item */
+extern size_t SmolTLV_Encoder_get_position(const SmolTLV_Encoder *encoder);
 extern SmolTLV_Status SmolTLV_Encoder_finalize(
     SmolTLV_Encoder *encoder,
     const uint8_t **out_buffer,
@@ -170,14 +583,149 @@ extern SmolTLV_Status SmolTLV_Encoder_write_bytes(SmolTLV_Encoder *encoder,
 extern SmolTLV_Status SmolTLV_Encoder_write_string(SmolTLV_Encoder *encoder, 
                                                    const char *str);
 
+/** Writes typed array, values are in host byte order */
+extern SmolTLV_Status SmolTLV_Encoder_write_array(SmolTLV_Encoder *encoder, 
+                                                  SmolTLV_Type type, 
+                                                  const void *values, 
+                                                  size_t count);
+extern SmolTLV_Status SmolTLV_Encoder_write_int8_array(SmolTLV_Encoder *encoder, 
+                                                       const int8_t *values, 
+                                                       size_t count);
+extern SmolTLV_Status SmolTLV_Encoder_write_int16_array(SmolTLV_Encoder *encoder, 
+                                                        const int16_t *values, 
+                                                        size_t count);
+extern SmolTLV_Status SmolTLV_Encoder_write_int32_array(SmolTLV_Encoder *encoder, 
+                                                        const int32_t *values, 
+                                                        size_t count);
+extern SmolTLV_Status SmolTLV_Encoder_write_int64_array(SmolTLV_Encoder *encoder, 
+                                                        const int64_t *values, 
+                                                        size_t count);
+extern SmolTLV_Status SmolTLV_Encoder_write_float_array(SmolTLV_Encoder *encoder, 
+                                                        const float *values, 
+                                                        size_t count);
+extern SmolTLV_Status SmolTLV_Encoder_write_double_array(SmolTLV_Encoder *encoder, 
+                                                         const double *values, 
+                                                         size_t count);
+
+/** Writes STRING_TABLE item (only at top level), subsequent 
+ * SmolTLV_Encoder_write_key calls emit references to its entries */
+extern SmolTLV_Status SmolTLV_Encoder_write_string_table(
+    SmolTLV_Encoder *encoder,
+    const char *const *strings,
+    size_t count
+);
+extern SmolTLV_Status SmolTLV_Encoder_write_string_ref(SmolTLV_Encoder *encoder, 
+                                                       uint32_t id);
+/** Writes dict key, as STRING_REF when present in current string table */
+extern SmolTLV_Status SmolTLV_Encoder_write_key(SmolTLV_Encoder *encoder, 
+                                                const char *key);
+
+/** Copies already encoded item verbatim */
+extern SmolTLV_Status SmolTLV_Encoder_write_item(SmolTLV_Encoder *encoder, 
+                                                 SmolTLV_Item item);
+/** Copies sequence of already encoded items verbatim (not validated) */
+extern SmolTLV_Status SmolTLV_Encoder_write_items(SmolTLV_Encoder *encoder, 
+                                                  const uint8_t *buffer, 
+                                                  size_t size);
+
+/** Writes DELTA column using the narrowest integer array able to hold the 
+ * differences */
+extern SmolTLV_Status SmolTLV_Encoder_write_delta_column(
+    SmolTLV_Encoder *encoder,
+    const int64_t *values,
+    size_t count
+);
+
+/** Writes copy of item containing only dict entries on given paths (each 
+ * a NULL terminated list of dict keys), values at path ends are copied 
+ * verbatim. Nested dicts with no value on the paths are omitted, the root 
+ * dict is always written. Table resolves STRING_REF keys and can be NULL. */
+extern SmolTLV_Status SmolTLV_Encoder_write_projection(
+    SmolTLV_Encoder *encoder,
+    SmolTLV_Item item,
+    const SmolTLV_StringTable *table,
+    const char *const *const *paths,
+    size_t path_count
+);
+/** Size of output of SmolTLV_Encoder_write_projection */
+extern SmolTLV_Status SmolTLV_Item_projection_size(
+    SmolTLV_Item item,
+    const SmolTLV_StringTable *table,
+    const char *const *const *paths,
+    size_t path_count,
+    size_t *out_size
+);
+
+/** Writes batch row as DICT. Random access walks DELTA columns from the 
+ * first row, use SmolTLV_BatchReader_write_row for consecutive rows. */
+extern SmolTLV_Status SmolTLV_Batch_write_row(const SmolTLV_Batch *batch, 
+                                              size_t row, 
+                                              SmolTLV_Encoder *encoder);
+/** Writes current row of reader (after SmolTLV_BatchReader_next) as DICT */
+extern SmolTLV_Status SmolTLV_BatchReader_write_row(const SmolTLV_BatchReader *reader, 
+                                                    SmolTLV_Encoder *encoder);
+
+/** Starts container closed by SmolTLV_Encoder_end, which patches its 
+ * length. BYTES and STRING values of unknown length can be started too, 
+ * their payload is then appended with SmolTLV_Encoder_write_items. */
 extern SmolTLV_Status SmolTLV_Encoder_start_nested(SmolTLV_Encoder *encoder, 
                                                    SmolTLV_Type container_type);
 extern SmolTLV_Status SmolTLV_Encoder_start_list(SmolTLV_Encoder *encoder);
 extern SmolTLV_Status SmolTLV_Encoder_start_dict(SmolTLV_Encoder *encoder);
+/** Batch content is schema list followed by columns */
+extern SmolTLV_Status SmolTLV_Encoder_start_batch(SmolTLV_Encoder *encoder);
 extern SmolTLV_Status SmolTLV_Encoder_end(SmolTLV_Encoder *encoder);
 
 #endif /* SMOLTLV_NO_ENCODER */
 
+/*
+ * Runtime statistics
+ *
+ * Compiled in only when SMOLTLV_STATS is defined, otherwise the counters 
+ * and this API do not exist and hot paths carry no overhead. Decoder 
+ * counters are per thread (global without threads, see SMOLTLV_NO_THREADS), 
+ * encoder counters are per encoder.
+ */
+
+#ifdef SMOLTLV_STATS
+typedef struct SmolTLV_DecoderStats_s {
+    /** Items returned by SmolTLV_Cursor_next */
+    uint64_t items_visited;
+    /** SmolTLV_Cursor_next calls ending with NEED_MORE_DATA */
+    uint64_t need_more_data;
+    /** Dict lookups and SmolTLV_Item_list_at calls */
+    uint64_t lookups;
+    /** Entries (dict) or items (list) examined by all lookups */
+    uint64_t lookup_scanned;
+    /** Longest scan of a single lookup */
+    uint64_t lookup_scanned_max;
+} SmolTLV_DecoderStats;
+
+/** Counters of the calling thread */
+extern void SmolTLV_DecoderStats_get(SmolTLV_DecoderStats *out);
+extern void SmolTLV_DecoderStats_reset(void);
+
+#ifndef SMOLTLV_NO_ENCODER
+typedef struct SmolTLV_EncoderStats_s {
+    /** Items (headers) written, including nested ones */
+    uint64_t items_written;
+    /** Buffer growths */
+    uint64_t reallocs;
+    /** Bytes in use when the buffer grew, i.e. moved by realloc at worst */
+    uint64_t realloc_bytes;
+    /** Value bytes copied or converted into the buffer */
+    uint64_t bytes_copied;
+    /** Deepest container nesting */
+    uint32_t peak_depth;
+} SmolTLV_EncoderStats;
+
+extern void SmolTLV_Encoder_get_stats(const SmolTLV_Encoder *encoder, 
+                                      SmolTLV_EncoderStats *out);
+/** Clears counters, peak depth restarts from current depth */
+extern void SmolTLV_Encoder_reset_stats(SmolTLV_Encoder *encoder);
+#endif /* SMOLTLV_NO_ENCODER */
+#endif /* SMOLTLV_STATS */
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,444 @@
+/* -*- mode: c++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+ * 
+ * SmolTLV - Simple serialization format for JSON/CBOR-like data model 
+ * for embedded devices - C++ view layer.
+ * 
+ * Copyright (c) 2025 Aleš Hakl
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef H__SMOLTLV_HPP
+#define H__SMOLTLV_HPP
+
+#include <smoltlv.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <optional>
+#include <string_view>
+#if __cplusplus >= 202002L && __has_include(<span>)
+#include <span>
+#define SMOLTLV_HPP_HAS_SPAN 1
+#endif
+
+/*
+ * Header-only C++ view layer over encoded buffers. Everything is inline
+ * and allocation-free, views borrow the underlying buffer. Decoding rules
+ * follow SmolTLV_Cursor_next, iteration over malformed content stops at
+ * the first invalid item.
+ */
+
+namespace smoltlv {
+
+using Type = SmolTLV_Type;
+using Status = SmolTLV_Status;
+
+namespace detail {
+
+inline uint32_t load_len24(const uint8_t *p) noexcept {
+    return (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) |
+           static_cast<uint32_t>(p[3]);
+}
+
+inline uint64_t load_be(const uint8_t *p, size_t size) noexcept {
+    uint64_t value = 0;
+    for (size_t i = 0; i < size; i++) {
+        value = (value << 8) | p[i];
+    }
+    return value;
+}
+
+inline size_t array_element_size(uint8_t type) noexcept {
+    switch (type) {
+    case SMOLTLV_TYPE_ARRAY_INT8:    return 1;
+    case SMOLTLV_TYPE_ARRAY_INT16:   return 2;
+    case SMOLTLV_TYPE_ARRAY_INT32:   return 4;
+    case SMOLTLV_TYPE_ARRAY_INT64:   return 8;
+    case SMOLTLV_TYPE_ARRAY_FLOAT32: return 4;
+    case SMOLTLV_TYPE_ARRAY_FLOAT64: return 8;
+    default:                         return 0;
+    }
+}
+
+/** Same checks as SmolTLV_Cursor_next, returns item size or 0 */
+inline size_t check_item(const uint8_t *p, size_t remaining, bool nested) noexcept {
+    if (remaining < 4) {
+        return 0;
+    }
+
+    uint8_t type = p[0];
+    uint32_t len = load_len24(p);
+
+    switch (type) {
+    case SMOLTLV_TYPE_BYTES_CHUNK:
+    case SMOLTLV_TYPE_STRING_CHUNK:
+        // Chunked values are top-level only
+        if (nested) return 0;
+        break;
+    case SMOLTLV_TYPE_NULL:
+    case SMOLTLV_TYPE_BOOL_TRUE:
+    case SMOLTLV_TYPE_BOOL_FALSE:
+        if (len != 0) return 0;
+        break;
+    case SMOLTLV_TYPE_INT:
+        if (len != 8) return 0;
+        break;
+    case SMOLTLV_TYPE_STRING_REF:
+        if (len < 1 || len > 4) return 0;
+        break;
+    default: {
+        size_t element_size = array_element_size(type);
+        if (element_size > 1 && len % element_size != 0) return 0;
+        break;
+    }
+    }
+
+    if (remaining - 4 < len) {
+        return 0;
+    }
+    return 4 + static_cast<size_t>(len);
+}
+
+} // namespace detail
+
+class ListView;
+class DictView;
+
+class Item {
+public:
+    constexpr Item() noexcept : pointer_(nullptr) {}
+    constexpr explicit Item(const uint8_t *pointer) noexcept : pointer_(pointer) {}
+    constexpr Item(SmolTLV_Item item) noexcept : pointer_(item.pointer) {}
+
+    operator SmolTLV_Item() const noexcept { return SmolTLV_Item{ pointer_ }; }
+
+    const uint8_t *pointer() const noexcept { return pointer_; }
+    explicit operator bool() const noexcept { return pointer_ != nullptr; }
+
+    Type type() const noexcept { return static_cast<Type>(pointer_[0]); }
+    uint8_t type_raw() const noexcept { return pointer_[0]; }
+    uint32_t length() const noexcept { return detail::load_len24(pointer_); }
+    const uint8_t *value() const noexcept { return pointer_ + 4; }
+    /** Size including header */
+    size_t size() const noexcept { return 4 + static_cast<size_t>(length()); }
+
+    bool is_null() const noexcept { return type() == SMOLTLV_TYPE_NULL; }
+    bool is_container() const noexcept {
+        return type() == SMOLTLV_TYPE_LIST || type() == SMOLTLV_TYPE_DICT;
+    }
+
+    std::optional<bool> as_bool() const noexcept {
+        if (type() == SMOLTLV_TYPE_BOOL_TRUE) return true;
+        if (type() == SMOLTLV_TYPE_BOOL_FALSE) return false;
+        return std::nullopt;
+    }
+
+    std::optional<int64_t> as_int() const noexcept {
+        if (type() != SMOLTLV_TYPE_INT || length() != 8) {
+            return std::nullopt;
+        }
+        return static_cast<int64_t>(detail::load_be(value(), 8));
+    }
+
+    std::optional<std::string_view> as_string() const noexcept {
+        if (type() != SMOLTLV_TYPE_STRING) {
+            return std::nullopt;
+        }
+        return std::string_view(reinterpret_cast<const char *>(value()), length());
+    }
+
+    /** Raw payload of BYTES item */
+    std::optional<std::string_view> as_bytes() const noexcept {
+        if (type() != SMOLTLV_TYPE_BYTES) {
+            return std::nullopt;
+        }
+        return std::string_view(reinterpret_cast<const char *>(value()), length());
+    }
+
+#ifdef SMOLTLV_HPP_HAS_SPAN
+    std::optional<std::span<const uint8_t>> as_byte_span() const noexcept {
+        if (type() != SMOLTLV_TYPE_BYTES) {
+            return std::nullopt;
+        }
+        return std::span<const uint8_t>(value(), length());
+    }
+#endif
+
+    /** String comparison, true only for STRING items */
+    bool equals(std::string_view str) const noexcept {
+        return type() == SMOLTLV_TYPE_STRING
+            && length() == str.size()
+            && std::memcmp(value(), str.data(), str.size()) == 0;
+    }
+
+    inline std::optional<ListView> as_list() const noexcept;
+    inline std::optional<DictView> as_dict() const noexcept;
+
+    /** Dict lookup, empty for missing keys and non-dict items */
+    inline std::optional<Item> operator[](std::string_view key) const noexcept;
+    /** List element, empty for out of range index and non-list items */
+    inline std::optional<Item> at(size_t index) const noexcept;
+
+    friend bool operator==(Item a, Item b) noexcept { return a.pointer_ == b.pointer_; }
+    friend bool operator!=(Item a, Item b) noexcept { return a.pointer_ != b.pointer_; }
+
+private:
+    const uint8_t *pointer_;
+};
+
+/** Forward iterator over consecutive items of a buffer */
+class ItemIterator {
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Item;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const Item *;
+    using reference = const Item &;
+
+    constexpr ItemIterator() noexcept : end_(nullptr), item_(), next_(nullptr), nested_(false) {}
+    ItemIterator(const uint8_t *begin, const uint8_t *end, bool nested) noexcept
+        : end_(end), item_(), next_(nullptr), nested_(nested) {
+        advance(begin);
+    }
+
+    reference operator*() const noexcept { return item_; }
+    pointer operator->() const noexcept { return &item_; }
+
+    ItemIterator &operator++() noexcept {
+        advance(next_);
+        return *this;
+    }
+    ItemIterator operator++(int) noexcept {
+        ItemIterator previous = *this;
+        ++*this;
+        return previous;
+    }
+
+    friend bool operator==(const ItemIterator &a, const ItemIterator &b) noexcept {
+        return a.item_ == b.item_;
+    }
+    friend bool operator!=(const ItemIterator &a, const ItemIterator &b) noexcept {
+        return !(a == b);
+    }
+
+private:
+    void advance(const uint8_t *p) noexcept {
+        size_t size = (p && p < end_) ? detail::check_item(p, static_cast<size_t>(end_ - p), nested_) : 0;
+        if (size == 0) {
+            item_ = Item();
+            next_ = nullptr;
+            return;
+        }
+        item_ = Item(p);
+        next_ = p + size;
+    }
+
+    const uint8_t *end_;
+    Item item_;
+    const uint8_t *next_;
+    bool nested_;
+};
+
+/** Sequence of items, e.g. a buffer of top-level items or container payload */
+class ItemRange {
+public:
+    constexpr ItemRange() noexcept : begin_(nullptr), end_(nullptr), nested_(false) {}
+    /** Container payload is nested, chunk items end iteration there */
+    ItemRange(const uint8_t *buffer, size_t size, bool nested = false) noexcept
+        : begin_(buffer), end_(buffer + size), nested_(nested) {}
+
+    ItemIterator begin() const noexcept { return ItemIterator(begin_, end_, nested_); }
+    ItemIterator end() const noexcept { return ItemIterator(); }
+
+    bool empty() const noexcept { return begin_ == end_; }
+
+    /** Number of items (linear) */
+    size_t count() const noexcept {
+        size_t n = 0;
+        for (auto it = begin(); it != end(); ++it) {
+            n++;
+        }
+        return n;
+    }
+
+    std::optional<Item> at(size_t index) const noexcept {
+        for (Item item : *this) {
+            if (index-- == 0) {
+                return item;
+            }
+        }
+        return std::nullopt;
+    }
+
+    std::optional<Item> front() const noexcept { return at(0); }
+
+protected:
+    const uint8_t *begin_;
+    const uint8_t *end_;
+    bool nested_;
+};
+
+class ListView : public ItemRange {
+public:
+    constexpr ListView() noexcept = default;
+    explicit ListView(Item list) noexcept
+        : ItemRange(list.value(), list.length(), true), item_(list) {}
+
+    Item item() const noexcept { return item_; }
+    size_t size() const noexcept { return count(); }
+
+private:
+    Item item_;
+};
+
+struct DictEntry {
+    Item key;
+    Item value;
+};
+
+class DictIterator {
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = DictEntry;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const DictEntry *;
+    using reference = const DictEntry &;
+
+    constexpr DictIterator() noexcept : it_(), entry_() {}
+    explicit DictIterator(ItemIterator it) noexcept : it_(it), entry_() {
+        load();
+    }
+
+    reference operator*() const noexcept { return entry_; }
+    pointer operator->() const noexcept { return &entry_; }
+
+    DictIterator &operator++() noexcept {
+        ++it_;
+        load();
+        return *this;
+    }
+    DictIterator operator++(int) noexcept {
+        DictIterator previous = *this;
+        ++*this;
+        return previous;
+    }
+
+    friend bool operator==(const DictIterator &a, const DictIterator &b) noexcept {
+        return a.it_ == b.it_;
+    }
+    friend bool operator!=(const DictIterator &a, const DictIterator &b) noexcept {
+        return !(a == b);
+    }
+
+private:
+    void load() noexcept {
+        if (it_ == ItemIterator()) {
+            return;
+        }
+        entry_.key = *it_;
+        ++it_;
+        if (it_ == ItemIterator()) {
+            // Key without value ends iteration
+            return;
+        }
+        entry_.value = *it_;
+    }
+
+    ItemIterator it_;
+    DictEntry entry_;
+};
+
+class DictView {
+public:
+    constexpr DictView() noexcept : range_(), item_() {}
+    explicit DictView(Item dict) noexcept
+        : range_(dict.value(), dict.length(), true), item_(dict) {}
+
+    Item item() const noexcept { return item_; }
+
+    DictIterator begin() const noexcept { return DictIterator(range_.begin()); }
+    DictIterator end() const noexcept { return DictIterator(); }
+
+    bool empty() const noexcept { return range_.empty(); }
+
+    /** Number of entries (linear) */
+    size_t size() const noexcept { return range_.count() / 2; }
+
+    std::optional<Item> get(std::string_view key) const noexcept {
+        for (const DictEntry &entry : *this) {
+            if (entry.key.equals(key)) {
+                return entry.value;
+            }
+        }
+        return std::nullopt;
+    }
+
+    std::optional<Item> operator[](std::string_view key) const noexcept {
+        return get(key);
+    }
+
+    bool contains(std::string_view key) const noexcept {
+        return get(key).has_value();
+    }
+
+private:
+    ItemRange range_;
+    Item item_;
+};
+
+inline std::optional<ListView> Item::as_list() const noexcept {
+    if (type() != SMOLTLV_TYPE_LIST) {
+        return std::nullopt;
+    }
+    return ListView(*this);
+}
+
+inline std::optional<DictView> Item::as_dict() const noexcept {
+    if (type() != SMOLTLV_TYPE_DICT) {
+        return std::nullopt;
+    }
+    return DictView(*this);
+}
+
+inline std::optional<Item> Item::operator[](std::string_view key) const noexcept {
+    if (type() != SMOLTLV_TYPE_DICT) {
+        return std::nullopt;
+    }
+    return DictView(*this).get(key);
+}
+
+inline std::optional<Item> Item::at(size_t index) const noexcept {
+    if (type() != SMOLTLV_TYPE_LIST) {
+        return std::nullopt;
+    }
+    return ListView(*this).at(index);
+}
+
+/** First item of buffer */
+inline std::optional<Item> parse(const uint8_t *buffer, size_t size) noexcept {
+    return ItemRange(buffer, size).front();
+}
+
+} // namespace smoltlv
+
+#endif // H__SMOLTLV_HPP
@@ -0,0 +1,1186 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil -*-
+ * 
+ * SmolTLV - Simple serialization format for JSON/CBOR-like data model 
+ * for embedded devices - block compressed archive.
+ * 
+ * Copyright (c) 2025 Aleš Hakl
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <smoltlv_archive.h>
+#include <stdlib.h>
+#include <string.h>
+#ifndef SMOLTLV_NO_THREADS
+#include <pthread.h>
+#endif
+
+#define ARCHIVE_MAGIC "STLZ"
+#define ARCHIVE_VERSION 1u
+#define ARCHIVE_HEADER_SIZE 8u
+#define ARCHIVE_FRAME_HEADER_SIZE 16u
+#define ARCHIVE_INDEX_ENTRY_SIZE 16u
+#define ARCHIVE_TRAILER_SIZE 24u
+/** Frames have 32-bit sizes, largest item is added on top of frame_size */
+#define ARCHIVE_MAX_FRAME_SIZE (1024u * 1024u * 1024u)
+#define ARCHIVE_MAX_THREADS 64u
+
+/*
+ * LZ4 block format: sequences of token (literal length, match length - 4
+ * in 4 bits each, 15 continues in following bytes of 255), literals,
+ * 2-byte little-endian match offset. Last sequence has literals only,
+ * last 5 bytes are always literals and last match starts at least 12
+ * bytes before end.
+ */
+
+#define LZ_HASH_BITS 12u
+#define LZ_MIN_MATCH 4u
+#define LZ_LAST_LITERALS 5u
+#define LZ_MATCH_START_LIMIT 12u
+#define LZ_MAX_OFFSET 65535u
+/** Skip step grows by one every 2^n bytes without match */
+#define LZ_SKIP_TRIGGER 6u
+
+static uint32_t load_be32(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+           ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+static uint64_t load_be64(const uint8_t *p) {
+    return ((uint64_t)load_be32(p) << 32) | load_be32(p + 4);
+}
+
+static void store_be32(uint8_t *p, uint32_t value) {
+    p[0] = (uint8_t)(value >> 24);
+    p[1] = (uint8_t)(value >> 16);
+    p[2] = (uint8_t)(value >> 8);
+    p[3] = (uint8_t)value;
+}
+
+static void store_be64(uint8_t *p, uint64_t value) {
+    store_be32(p, (uint32_t)(value >> 32));
+    store_be32(p + 4, (uint32_t)value);
+}
+
+static uint32_t lz_read32(const uint8_t *p) {
+    uint32_t value;
+    memcpy(&value, p, 4u);
+    return value;
+}
+
+static uint32_t lz_hash(uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32u - LZ_HASH_BITS);
+}
+
+/** Number of equal bytes at p and match, p stops at limit */
+static size_t lz_match_length(const uint8_t *p, const uint8_t *match, const uint8_t *limit) {
+    const uint8_t *start = p;
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    while (limit - p >= 8) {
+        uint64_t a, b;
+        memcpy(&a, p, 8u);
+        memcpy(&b, match, 8u);
+        if (a != b) {
+            return (size_t)(p - start) + ((unsigned)__builtin_ctzll(a ^ b) >> 3);
+        }
+        p += 8;
+        match += 8;
+    }
+#endif
+    while (p < limit && *p == *match) {
+        p++;
+        match++;
+    }
+    return (size_t)(p - start);
+}
+
+static uint8_t *lz_write_length(uint8_t *op, size_t length) {
+    while (length >= 255u) {
+        *op++ = 255u;
+        length -= 255u;
+    }
+    *op++ = (uint8_t)length;
+    return op;
+}
+
+/** Writes literals and (unless match_length is 0) match */
+static uint8_t *lz_write_sequence(uint8_t *op,
+                                  const uint8_t *literals,
+                                  size_t literal_length,
+                                  size_t offset,
+                                  size_t match_length) {
+    uint8_t *token = op++;
+    size_t match_code = match_length ? match_length - LZ_MIN_MATCH : 0u;
+    *token = (uint8_t)(((literal_length < 15u ? literal_length : 15u) << 4) |
+                       (match_code < 15u ? match_code : 15u));
+    if (literal_length >= 15u) {
+        op = lz_write_length(op, literal_length - 15u);
+    }
+    memcpy(op, literals, literal_length);
+    op += literal_length;
+
+    if (match_length) {
+        *op++ = (uint8_t)offset;
+        *op++ = (uint8_t)(offset >> 8);
+        if (match_code >= 15u) {
+            op = lz_write_length(op, match_code - 15u);
+        }
+    }
+    return op;
+}
+
+size_t SmolTLV_lz_compress_bound(size_t size) {
+    return size + size / 255u + 16u;
+}
+
+SmolTLV_Status SmolTLV_lz_compress(const uint8_t *data,
+                                   size_t size,
+                                   uint8_t *out,
+                                   size_t capacity,
+                                   size_t *out_size) {
+    if ((!data && size) || !out || !out_size || capacity < SmolTLV_lz_compress_bound(size)) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    // Positions are 32-bit, inputs are frames
+    if (size > UINT32_MAX) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    uint32_t table[1u << LZ_HASH_BITS];
+    const uint8_t *ip = data;
+    const uint8_t *anchor = data;
+    const uint8_t *end = data + size;
+    uint8_t *op = out;
+
+    if (size > LZ_MATCH_START_LIMIT) {
+        const uint8_t *match_limit = end - LZ_LAST_LITERALS;
+        const uint8_t *start_limit = end - LZ_MATCH_START_LIMIT;
+        memset(table, 0, sizeof(table));
+        ip++;
+
+        while (ip < start_limit) {
+            uint32_t sequence = lz_read32(ip);
+            uint32_t hash = lz_hash(sequence);
+            const uint8_t *match = data + table[hash];
+            table[hash] = (uint32_t)(ip - data);
+
+            if (match >= ip || (size_t)(ip - match) > LZ_MAX_OFFSET ||
+                lz_read32(match) != sequence) {
+                ip += 1u + ((size_t)(ip - anchor) >> LZ_SKIP_TRIGGER);
+                continue;
+            }
+
+            while (ip > anchor && match > data && ip[-1] == match[-1]) {
+                ip--;
+                match--;
+            }
+            size_t match_length = LZ_MIN_MATCH + lz_match_length(ip + LZ_MIN_MATCH,
+                                                                 match + LZ_MIN_MATCH,
+                                                                 match_limit);
+            op = lz_write_sequence(op, anchor, (size_t)(ip - anchor),
+                                   (size_t)(ip - match), match_length);
+            ip += match_length;
+            anchor = ip;
+
+            // Position just before next search often starts next match
+            if (ip < start_limit) {
+                table[lz_hash(lz_read32(ip - 2))] = (uint32_t)(ip - 2 - data);
+            }
+        }
+    }
+
+    op = lz_write_sequence(op, anchor, (size_t)(end - anchor), 0u, 0u);
+    *out_size = (size_t)(op - out);
+    return SMOLTLV_STATUS_OK;
+}
+
+static bool lz_read_length(const uint8_t **ip, const uint8_t *end, size_t *length) {
+    uint8_t byte;
+    do {
+        if (*ip >= end) {
+            return false;
+        }
+        byte = *(*ip)++;
+        *length += byte;
+    } while (byte == 255u);
+    return true;
+}
+
+SmolTLV_Status SmolTLV_lz_decompress(const uint8_t *data,
+                                     size_t size,
+                                     uint8_t *out,
+                                     size_t capacity,
+                                     size_t *out_size) {
+    if ((!data && size) || (!out && capacity) || !out_size) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    const uint8_t *ip = data;
+    const uint8_t *end = data + size;
+    uint8_t *op = out;
+    uint8_t *out_end = out + capacity;
+
+    while (ip < end) {
+        uint8_t token = *ip++;
+        size_t literal_length = token >> 4;
+        if (literal_length == 15u && !lz_read_length(&ip, end, &literal_length)) {
+            return SMOLTLV_STATUS_INVALID_FORMAT;
+        }
+        if (literal_length > (size_t)(end - ip) || literal_length > (size_t)(out_end - op)) {
+            return SMOLTLV_STATUS_INVALID_FORMAT;
+        }
+        if ((size_t)(end - ip) >= literal_length + 16u && (size_t)(out_end - op) >= literal_length + 16u) {
+            // Room past the literals, copied in fixed 16-byte steps
+            for (size_t copied = 0; copied < literal_length; copied += 16u) {
+                memcpy(op + copied, ip + copied, 16u);
+            }
+        } else {
+            memcpy(op, ip, literal_length);
+        }
+        op += literal_length;
+        ip += literal_length;
+        if (ip == end) {
+            break;
+        }
+
+        if (end - ip < 2) {
+            return SMOLTLV_STATUS_INVALID_FORMAT;
+        }
+        size_t offset = (size_t)ip[0] | ((size_t)ip[1] << 8);
+        ip += 2;
+        size_t match_length = token & 15u;
+        if (match_length == 15u && !lz_read_length(&ip, end, &match_length)) {
+            return SMOLTLV_STATUS_INVALID_FORMAT;
+        }
+        match_length += LZ_MIN_MATCH;
+        if (offset == 0 || offset > (size_t)(op - out) || match_length > (size_t)(out_end - op)) {
+            return SMOLTLV_STATUS_INVALID_FORMAT;
+        }
+
+        const uint8_t *match = op - offset;
+        if (offset >= 8u && (size_t)(out_end - op) >= match_length + 8u) {
+            // Source of every 8-byte step is already written
+            for (size_t copied = 0; copied < match_length; copied += 8u) {
+                memcpy(op + copied, match + copied, 8u);
+            }
+        } else if (offset >= 8u) {
+            size_t copied = 0;
+            for (; copied + 8u <= match_length; copied += 8u) {
+                memcpy(op + copied, match + copied, 8u);
+            }
+            memcpy(op + copied, match + copied, match_length - copied);
+        } else if (offset == 1u) {
+            memset(op, *match, match_length);
+        } else {
+            for (size_t i = 0; i < match_length; i++) {
+                op[i] = match[i];
+            }
+        }
+        op += match_length;
+    }
+
+    *out_size = (size_t)(op - out);
+    return SMOLTLV_STATUS_OK;
+}
+
+/*
+ * Writer
+ */
+
+typedef struct ArchiveIndexEntry_s {
+    uint64_t offset;
+    uint64_t first_item;
+} ArchiveIndexEntry;
+
+struct SmolTLV_ArchiveWriter_s {
+    SmolTLV_WriteFunction write;
+    void *context;
+    size_t frame_size;
+    /** Bytes written so far, 0 before file header */
+    uint64_t offset;
+    uint64_t item_count;
+
+    /** String table in effect and items of current frame */
+    uint8_t *frame;
+    size_t frame_used;
+    size_t frame_capacity;
+    size_t frame_table_size;
+    size_t frame_items;
+
+    /** Last STRING_TABLE item */
+    uint8_t *table;
+    size_t table_size;
+    size_t table_capacity;
+
+    uint8_t *compressed;
+    size_t compressed_capacity;
+
+    ArchiveIndexEntry *index;
+    size_t frame_count;
+    size_t index_capacity;
+};
+
+static bool ensure_capacity(uint8_t **buffer, size_t *capacity, size_t needed) {
+    if (needed <= *capacity) {
+        return true;
+    }
+    size_t new_capacity = *capacity ? *capacity : 4096u;
+    while (new_capacity < needed) {
+        new_capacity *= 2u;
+    }
+    uint8_t *new_buffer = (uint8_t *)realloc(*buffer, new_capacity);
+    if (!new_buffer) {
+        return false;
+    }
+    *buffer = new_buffer;
+    *capacity = new_capacity;
+    return true;
+}
+
+static SmolTLV_Status writer_emit(SmolTLV_ArchiveWriter *writer, const uint8_t *data, size_t length) {
+    if (length == 0) {
+        return SMOLTLV_STATUS_OK;
+    }
+    SmolTLV_Status status = writer->write(data, length, writer->context);
+    if (status == SMOLTLV_STATUS_OK) {
+        writer->offset += length;
+    }
+    return status;
+}
+
+static SmolTLV_Status writer_start(SmolTLV_ArchiveWriter *writer) {
+    if (writer->offset > 0) {
+        return SMOLTLV_STATUS_OK;
+    }
+    uint8_t header[ARCHIVE_HEADER_SIZE] = { 0 };
+    memcpy(header, ARCHIVE_MAGIC, 4u);
+    header[4] = ARCHIVE_VERSION;
+    return writer_emit(writer, header, sizeof(header));
+}
+
+static SmolTLV_Status writer_flush(SmolTLV_ArchiveWriter *writer) {
+    if (writer->frame_items == 0) {
+        return SMOLTLV_STATUS_OK;
+    }
+
+    SmolTLV_Status status = writer_start(writer);
+    if (status != SMOLTLV_STATUS_OK) {
+        return status;
+    }
+
+    if (writer->frame_count == writer->index_capacity) {
+        size_t capacity = writer->index_capacity ? 2u * writer->index_capacity : 64u;
+        ArchiveIndexEntry *index = (ArchiveIndexEntry *)realloc(writer->index,
+                                                                capacity * sizeof(ArchiveIndexEntry));
+        if (!index) {
+            return SMOLTLV_STATUS_OUT_OF_MEMORY;
+        }
+        writer->index = index;
+        writer->index_capacity = capacity;
+    }
+
+    const uint8_t *items = writer->frame + writer->frame_table_size;
+    size_t size = writer->frame_used - writer->frame_table_size;
+    size_t stored_size;
+    if (!ensure_capacity(&writer->compressed, &writer->compressed_capacity,
+                         SmolTLV_lz_compress_bound(size))) {
+        return SMOLTLV_STATUS_OUT_OF_MEMORY;
+    }
+    status = SmolTLV_lz_compress(items, size, writer->compressed,
+                                 writer->compressed_capacity, &stored_size);
+    if (status != SMOLTLV_STATUS_OK) {
+        return status;
+    }
+
+    // Incompressible items are stored as they are
+    const uint8_t *stored = writer->compressed;
+    if (stored_size >= size) {
+        stored = items;
+        stored_size = size;
+    }
+
+    writer->index[writer->frame_count].offset = writer->offset;
+    writer->index[writer->frame_count].first_item = writer->item_count;
+
+    uint8_t header[ARCHIVE_FRAME_HEADER_SIZE];
+    store_be32(header, (uint32_t)stored_size);
+    store_be32(header + 4, (uint32_t)size);
+    store_be32(header + 8, (uint32_t)writer->frame_items);
+    store_be32(header + 12, (uint32_t)writer->frame_table_size);
+    status = writer_emit(writer, header, sizeof(header));
+    if (status == SMOLTLV_STATUS_OK) {
+        status = writer_emit(writer, writer->frame, writer->frame_table_size);
+    }
+    if (status == SMOLTLV_STATUS_OK) {
+        status = writer_emit(writer, stored, stored_size);
+    }
+    if (status != SMOLTLV_STATUS_OK) {
+        return status;
+    }
+
+    writer->frame_count++;
+    writer->item_count += writer->frame_items;
+    writer->frame_used = 0;
+    writer->frame_table_size = 0;
+    writer->frame_items = 0;
+    return SMOLTLV_STATUS_OK;
+}
+
+SmolTLV_Status SmolTLV_ArchiveWriter_create(size_t frame_size,
+                                            SmolTLV_WriteFunction write,
+                                            void *context,
+                                            SmolTLV_ArchiveWriter **out) {
+    if (!write || !out) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    SmolTLV_ArchiveWriter *writer = (SmolTLV_ArchiveWriter *)calloc(1, sizeof(SmolTLV_ArchiveWriter));
+    if (!writer) {
+        return SMOLTLV_STATUS_OUT_OF_MEMORY;
+    }
+    writer->write = write;
+    writer->context = context;
+    writer->frame_size = frame_size ? frame_size : SMOLTLV_ARCHIVE_DEFAULT_FRAME_SIZE;
+    if (writer->frame_size > ARCHIVE_MAX_FRAME_SIZE) {
+        writer->frame_size = ARCHIVE_MAX_FRAME_SIZE;
+    }
+    *out = writer;
+    return SMOLTLV_STATUS_OK;
+}
+
+void SmolTLV_ArchiveWriter_destroy(SmolTLV_ArchiveWriter *writer) {
+    if (!writer) {
+        return;
+    }
+    free(writer->frame);
+    free(writer->table);
+    free(writer->compressed);
+    free(writer->index);
+    free(writer);
+}
+
+SmolTLV_Status SmolTLV_ArchiveWriter_write(SmolTLV_ArchiveWriter *writer,
+                                           const uint8_t *buffer,
+                                           size_t size) {
+    if (!writer || (!buffer && size)) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    SmolTLV_Cursor cursor;
+    SmolTLV_Item item;
+    size_t count;
+    SmolTLV_Cursor_init(&cursor, buffer, size);
+    SmolTLV_Status status = SmolTLV_Cursor_count(&cursor, &count);
+    if (status != SMOLTLV_STATUS_OK) {
+        return status;
+    }
+
+    while (SmolTLV_Cursor_next(&cursor, &item) == SMOLTLV_STATUS_OK) {
+        size_t item_size = 4u + (size_t)SmolTLV_Item_get_length(item);
+        bool is_table = SmolTLV_Item_get_type(item) == SMOLTLV_TYPE_STRING_TABLE;
+
+        if (writer->frame_items > 0 && writer->frame_used + item_size > writer->frame_size) {
+            status = writer_flush(writer);
+            if (status != SMOLTLV_STATUS_OK) {
+                return status;
+            }
+        }
+
+        // New frame repeats string table for its items
+        if (writer->frame_items == 0 && !is_table && writer->table_size > 0) {
+            if (!ensure_capacity(&writer->frame, &writer->frame_capacity, writer->table_size)) {
+                return SMOLTLV_STATUS_OUT_OF_MEMORY;
+            }
+            memcpy(writer->frame, writer->table, writer->table_size);
+            writer->frame_used = writer->table_size;
+            writer->frame_table_size = writer->table_size;
+        }
+
+        if (!ensure_capacity(&writer->frame, &writer->frame_capacity, writer->frame_used + item_size)) {
+            return SMOLTLV_STATUS_OUT_OF_MEMORY;
+        }
+        memcpy(writer->frame + writer->frame_used, item.pointer, item_size);
+        writer->frame_used += item_size;
+        writer->frame_items++;
+
+        if (is_table) {
+            if (!ensure_capacity(&writer->table, &writer->table_capacity, item_size)) {
+                return SMOLTLV_STATUS_OUT_OF_MEMORY;
+            }
+            memcpy(writer->table, item.pointer, item_size);
+            writer->table_size = item_size;
+        }
+    }
+    return SMOLTLV_STATUS_OK;
+}
+
+SmolTLV_Status SmolTLV_ArchiveWriter_finish(SmolTLV_ArchiveWriter *writer) {
+    if (!writer) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    SmolTLV_Status status = writer_flush(writer);
+    if (status == SMOLTLV_STATUS_OK) {
+        status = writer_start(writer);
+    }
+
+    uint64_t index_offset = writer->offset;
+    for (size_t i = 0; i < writer->frame_count && status == SMOLTLV_STATUS_OK; i++) {
+        uint8_t entry[ARCHIVE_INDEX_ENTRY_SIZE];
+        store_be64(entry, writer->index[i].offset);
+        store_be64(entry + 8, writer->index[i].first_item);
+        status = writer_emit(writer, entry, sizeof(entry));
+    }
+    if (status != SMOLTLV_STATUS_OK) {
+        return status;
+    }
+
+    uint8_t trailer[ARCHIVE_TRAILER_SIZE];
+    store_be64(trailer, index_offset);
+    store_be64(trailer + 8, writer->item_count);
+    store_be32(trailer + 16, (uint32_t)writer->frame_count);
+    memcpy(trailer + 20, ARCHIVE_MAGIC, 4u);
+    return writer_emit(writer, trailer, sizeof(trailer));
+}
+
+/*
+ * Reader
+ */
+
+struct SmolTLV_Archive_s {
+    const uint8_t *data;
+    size_t size;
+    uint64_t item_count;
+    size_t stream_size;
+    size_t frame_count;
+    SmolTLV_ArchiveFrame *frames;
+    /** Offset of frame items in original stream */
+    size_t *stream_offsets;
+};
+
+SmolTLV_Status SmolTLV_Archive_open(const uint8_t *data,
+                                    size_t size,
+                                    SmolTLV_Archive **out) {
+    if (!data || !out) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+    *out = NULL;
+
+    if (size < ARCHIVE_HEADER_SIZE + ARCHIVE_TRAILER_SIZE ||
+        memcmp(data, ARCHIVE_MAGIC, 4u) != 0 || data[4] != ARCHIVE_VERSION ||
+        memcmp(data + size - 4u, ARCHIVE_MAGIC, 4u) != 0) {
+        return SMOLTLV_STATUS_INVALID_FORMAT;
+    }
+
+    const uint8_t *trailer = data + size - ARCHIVE_TRAILER_SIZE;
+    uint64_t index_offset = load_be64(trailer);
+    uint64_t item_count = load_be64(trailer + 8);
+    size_t frame_count = load_be32(trailer + 16);
+    size_t index_size = size - ARCHIVE_TRAILER_SIZE - ARCHIVE_HEADER_SIZE;
+    if (index_offset < ARCHIVE_HEADER_SIZE ||
+        index_offset > size - ARCHIVE_TRAILER_SIZE ||
+        frame_count > index_size / ARCHIVE_INDEX_ENTRY_SIZE ||
+        size - ARCHIVE_TRAILER_SIZE - index_offset != frame_count * ARCHIVE_INDEX_ENTRY_SIZE) {
+        return SMOLTLV_STATUS_INVALID_FORMAT;
+    }
+
+    SmolTLV_Archive *archive = (SmolTLV_Archive *)calloc(1, sizeof(SmolTLV_Archive));
+    if (!archive) {
+        return SMOLTLV_STATUS_OUT_OF_MEMORY;
+    }
+    archive->frames = (SmolTLV_ArchiveFrame *)malloc((frame_count ? frame_count : 1u) *
+                                                     sizeof(SmolTLV_ArchiveFrame));
+    archive->stream_offsets = (size_t *)malloc((frame_count ? frame_count : 1u) * sizeof(size_t));
+    if (!archive->frames || !archive->stream_offsets) {
+        SmolTLV_Archive_destroy(archive);
+        return SMOLTLV_STATUS_OUT_OF_MEMORY;
+    }
+    archive->data = data;
+    archive->size = size;
+    archive->frame_count = frame_count;
+    archive->item_count = item_count;
+
+    // Frames follow each other, sizes in headers have to match index
+    const uint8_t *index = data + index_offset;
+    uint64_t expected_offset = ARCHIVE_HEADER_SIZE;
+    uint64_t expected_item = 0;
+    for (size_t i = 0; i < frame_count; i++) {
+        SmolTLV_ArchiveFrame *frame = &archive->frames[i];
+        frame->offset = load_be64(index + i * ARCHIVE_INDEX_ENTRY_SIZE);
+        frame->first_item = load_be64(index + i * ARCHIVE_INDEX_ENTRY_SIZE + 8u);
+        if (frame->offset != expected_offset || frame->first_item != expected_item ||
+            index_offset - frame->offset < ARCHIVE_FRAME_HEADER_SIZE) {
+            SmolTLV_Archive_destroy(archive);
+            return SMOLTLV_STATUS_INVALID_FORMAT;
+        }
+
+        const uint8_t *header = data + frame->offset;
+        frame->stored_size = load_be32(header);
+        frame->size = load_be32(header + 4);
+        frame->item_count = load_be32(header + 8);
+        frame->table_size = load_be32(header + 12);
+        uint64_t frame_size = (uint64_t)ARCHIVE_FRAME_HEADER_SIZE + frame->table_size + frame->stored_size;
+        if (frame->stored_size > frame->size || frame->item_count == 0 ||
+            frame_size > index_offset - frame->offset) {
+            SmolTLV_Archive_destroy(archive);
+            return SMOLTLV_STATUS_INVALID_FORMAT;
+        }
+
+        archive->stream_offsets[i] = archive->stream_size;
+        archive->stream_size += frame->size;
+        expected_offset = frame->offset + frame_size;
+        expected_item += frame->item_count;
+    }
+    if (expected_offset != index_offset || expected_item != item_count) {
+        SmolTLV_Archive_destroy(archive);
+        return SMOLTLV_STATUS_INVALID_FORMAT;
+    }
+
+    *out = archive;
+    return SMOLTLV_STATUS_OK;
+}
+
+void SmolTLV_Archive_destroy(SmolTLV_Archive *archive) {
+    if (!archive) {
+        return;
+    }
+    free(archive->frames);
+    free(archive->stream_offsets);
+    free(archive);
+}
+
+size_t SmolTLV_Archive_frame_count(const SmolTLV_Archive *archive) {
+    return archive ? archive->frame_count : 0;
+}
+
+uint64_t SmolTLV_Archive_item_count(const SmolTLV_Archive *archive) {
+    return archive ? archive->item_count : 0;
+}
+
+size_t SmolTLV_Archive_stream_size(const SmolTLV_Archive *archive) {
+    return archive ? archive->stream_size : 0;
+}
+
+bool SmolTLV_Archive_get_frame(const SmolTLV_Archive *archive,
+                               size_t index,
+                               SmolTLV_ArchiveFrame *out) {
+    if (!archive || index >= archive->frame_count) {
+        return false;
+    }
+    if (out) {
+        *out = archive->frames[index];
+    }
+    return true;
+}
+
+bool SmolTLV_Archive_find_item(const SmolTLV_Archive *archive,
+                               uint64_t item,
+                               size_t *out_frame) {
+    if (!archive || item >= archive->item_count) {
+        return false;
+    }
+
+    // Last frame starting at or before item
+    size_t low = 0;
+    size_t high = archive->frame_count;
+    while (high - low > 1u) {
+        size_t middle = low + (high - low) / 2u;
+        if (archive->frames[middle].first_item <= item) {
+            low = middle;
+        } else {
+            high = middle;
+        }
+    }
+    if (out_frame) {
+        *out_frame = low;
+    }
+    return true;
+}
+
+/** Decompresses items of frame into out of exactly frame size bytes */
+static SmolTLV_Status archive_read_items(const SmolTLV_Archive *archive,
+                                         const SmolTLV_ArchiveFrame *frame,
+                                         uint8_t *out) {
+    const uint8_t *stored = archive->data + frame->offset + ARCHIVE_FRAME_HEADER_SIZE + frame->table_size;
+    if (frame->stored_size == frame->size) {
+        memcpy(out, stored, frame->size);
+        return SMOLTLV_STATUS_OK;
+    }
+
+    size_t size;
+    SmolTLV_Status status = SmolTLV_lz_decompress(stored, frame->stored_size, out, frame->size, &size);
+    if (status == SMOLTLV_STATUS_OK && size != frame->size) {
+        status = SMOLTLV_STATUS_INVALID_FORMAT;
+    }
+    return status;
+}
+
+SmolTLV_Status SmolTLV_Archive_read_frame(const SmolTLV_Archive *archive,
+                                          size_t index,
+                                          uint8_t *out,
+                                          size_t capacity,
+                                          size_t *out_size) {
+    if (!archive || index >= archive->frame_count || !out) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    const SmolTLV_ArchiveFrame *frame = &archive->frames[index];
+    if (capacity < frame->table_size + frame->size) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    memcpy(out, archive->data + frame->offset + ARCHIVE_FRAME_HEADER_SIZE, frame->table_size);
+    SmolTLV_Status status = archive_read_items(archive, frame, out + frame->table_size);
+    if (status == SMOLTLV_STATUS_OK && out_size) {
+        *out_size = frame->table_size + frame->size;
+    }
+    return status;
+}
+
+SmolTLV_Status SmolTLV_Archive_read_item(const SmolTLV_Archive *archive,
+                                         uint64_t item,
+                                         uint8_t *out,
+                                         size_t capacity,
+                                         SmolTLV_Item *out_item,
+                                         SmolTLV_Item *out_table) {
+    size_t index;
+    if (!SmolTLV_Archive_find_item(archive, item, &index)) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    size_t size;
+    SmolTLV_Status status = SmolTLV_Archive_read_frame(archive, index, out, capacity, &size);
+    if (status != SMOLTLV_STATUS_OK) {
+        return status;
+    }
+
+    // Items before the wanted one, tracking string table in effect
+    SmolTLV_Cursor cursor;
+    SmolTLV_Item current = { NULL };
+    SmolTLV_Item table = { NULL };
+    size_t skip = (size_t)(item - archive->frames[index].first_item) +
+                  (archive->frames[index].table_size > 0 ? 1u : 0u);
+    SmolTLV_Cursor_init(&cursor, out, size);
+    for (size_t i = 0; i <= skip; i++) {
+        if (SmolTLV_Cursor_next(&cursor, &current) != SMOLTLV_STATUS_OK) {
+            return SMOLTLV_STATUS_INVALID_FORMAT;
+        }
+        if (i < skip && SmolTLV_Item_get_type(current) == SMOLTLV_TYPE_STRING_TABLE) {
+            table = current;
+        }
+    }
+
+    if (out_item) {
+        *out_item = current;
+    }
+    if (out_table) {
+        *out_table = table;
+    }
+    return SMOLTLV_STATUS_OK;
+}
+
+typedef struct ArchiveJob_s {
+    const SmolTLV_Archive *archive;
+    uint8_t *out;
+    size_t first;
+    size_t step;
+    SmolTLV_Status status;
+} ArchiveJob;
+
+static void *archive_worker(void *arg) {
+    ArchiveJob *job = (ArchiveJob *)arg;
+    const SmolTLV_Archive *archive = job->archive;
+    job->status = SMOLTLV_STATUS_OK;
+    for (size_t i = job->first; i < archive->frame_count && job->status == SMOLTLV_STATUS_OK; i += job->step) {
+        job->status = archive_read_items(archive, &archive->frames[i],
+                                         job->out + archive->stream_offsets[i]);
+    }
+    return NULL;
+}
+
+SmolTLV_Status SmolTLV_Archive_read_all(const SmolTLV_Archive *archive,
+                                        uint8_t *out,
+                                        size_t capacity,
+                                        unsigned thread_count) {
+    if (!archive || (!out && archive->stream_size) || capacity < archive->stream_size) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    size_t job_count = thread_count < 1u ? 1u : thread_count;
+    if (job_count > ARCHIVE_MAX_THREADS) {
+        job_count = ARCHIVE_MAX_THREADS;
+    }
+    if (job_count > archive->frame_count) {
+        job_count = archive->frame_count ? archive->frame_count : 1u;
+    }
+
+    // Frames are striped so neighbouring frames decompress concurrently
+    ArchiveJob jobs[ARCHIVE_MAX_THREADS];
+    for (size_t i = 0; i < job_count; i++) {
+        jobs[i].archive = archive;
+        jobs[i].out = out;
+        jobs[i].first = i;
+        jobs[i].step = job_count;
+        jobs[i].status = SMOLTLV_STATUS_OK;
+    }
+
+#ifndef SMOLTLV_NO_THREADS
+    pthread_t threads[ARCHIVE_MAX_THREADS];
+    bool started[ARCHIVE_MAX_THREADS];
+
+    for (size_t i = 1; i < job_count; i++) {
+        started[i] = pthread_create(&threads[i], NULL, archive_worker, &jobs[i]) == 0;
+        if (!started[i]) {
+            archive_worker(&jobs[i]);
+        }
+    }
+    archive_worker(&jobs[0]);
+    for (size_t i = 1; i < job_count; i++) {
+        if (started[i]) {
+            pthread_join(threads[i], NULL);
+        }
+    }
+#else
+    for (size_t i = 0; i < job_count; i++) {
+        archive_worker(&jobs[i]);
+    }
+#endif
+
+    for (size_t i = 0; i < job_count; i++) {
+        if (jobs[i].status != SMOLTLV_STATUS_OK) {
+            return jobs[i].status;
+        }
+    }
+    return SMOLTLV_STATUS_OK;
+}
+
+/*
+ * Sequential reader
+ */
+
+/** Read chunk when the next unit is smaller */
+#define ARCHIVE_READ_SIZE (64u * 1024u)
+
+typedef enum ArchiveReaderState_e {
+    ARCHIVE_READER_HEADER,
+    ARCHIVE_READER_FRAMES,
+    ARCHIVE_READER_INDEX,
+    ARCHIVE_READER_DONE,
+} ArchiveReaderState;
+
+struct SmolTLV_ArchiveReader_s {
+    SmolTLV_ArchiveItemFunction on_item;
+    void *context;
+    ArchiveReaderState state;
+    /** First error, later calls return it */
+    SmolTLV_Status status;
+    /** Archive offset of next unconsumed byte */
+    uint64_t offset;
+    uint64_t item_count;
+
+    /** Partial unit (file header, frame or index with trailer) */
+    uint8_t *input;
+    size_t input_used;
+    size_t input_capacity;
+
+    /** Decompressed items of current frame */
+    uint8_t *items;
+    size_t items_capacity;
+
+    /** Frames read so far, checked against index */
+    ArchiveIndexEntry *index;
+    size_t frame_count;
+    size_t index_capacity;
+};
+
+/** Size of unit starting at data, known once enough of it is available
+ * (0 for invalid frame header) */
+static size_t reader_unit_size(const SmolTLV_ArchiveReader *reader,
+                               const uint8_t *data,
+                               size_t available) {
+    switch (reader->state) {
+    case ARCHIVE_READER_HEADER:
+        return ARCHIVE_HEADER_SIZE;
+    case ARCHIVE_READER_INDEX:
+        return reader->frame_count * ARCHIVE_INDEX_ENTRY_SIZE + ARCHIVE_TRAILER_SIZE;
+    case ARCHIVE_READER_FRAMES:
+        if (available < ARCHIVE_FRAME_HEADER_SIZE) {
+            return ARCHIVE_FRAME_HEADER_SIZE;
+        } else {
+            uint32_t stored_size = load_be32(data);
+            uint32_t size = load_be32(data + 4);
+            uint64_t frame_size = (uint64_t)ARCHIVE_FRAME_HEADER_SIZE + load_be32(data + 12) + stored_size;
+            if (stored_size > size || load_be32(data + 8) == 0 || (size_t)frame_size != frame_size) {
+                return 0;
+            }
+            return (size_t)frame_size;
+        }
+    default:
+        return 0;
+    }
+}
+
+static SmolTLV_Status reader_frame(SmolTLV_ArchiveReader *reader, const uint8_t *frame) {
+    size_t stored_size = load_be32(frame);
+    size_t size = load_be32(frame + 4);
+    size_t item_count = load_be32(frame + 8);
+    const uint8_t *items = frame + ARCHIVE_FRAME_HEADER_SIZE + load_be32(frame + 12);
+
+    if (reader->frame_count == reader->index_capacity) {
+        size_t capacity = reader->index_capacity ? 2u * reader->index_capacity : 64u;
+        ArchiveIndexEntry *index = (ArchiveIndexEntry *)realloc(reader->index,
+                                                                capacity * sizeof(ArchiveIndexEntry));
+        if (!index) {
+            return SMOLTLV_STATUS_OUT_OF_MEMORY;
+        }
+        reader->index = index;
+        reader->index_capacity = capacity;
+    }
+    reader->index[reader->frame_count].offset = reader->offset;
+    reader->index[reader->frame_count].first_item = reader->item_count;
+    reader->frame_count++;
+    reader->item_count += item_count;
+
+    if (stored_size != size) {
+        size_t decompressed;
+        if (!ensure_capacity(&reader->items, &reader->items_capacity, size)) {
+            return SMOLTLV_STATUS_OUT_OF_MEMORY;
+        }
+        SmolTLV_Status status = SmolTLV_lz_decompress(items, stored_size, reader->items,
+                                                      size, &decompressed);
+        if (status != SMOLTLV_STATUS_OK || decompressed != size) {
+            return SMOLTLV_STATUS_INVALID_FORMAT;
+        }
+        items = reader->items;
+    }
+
+    // String table at frame start repeats one of the earlier items, only
+    // items of the original stream are passed on
+    SmolTLV_Cursor cursor;
+    SmolTLV_Item item;
+    SmolTLV_Status status;
+    size_t count = 0;
+    SmolTLV_Cursor_init(&cursor, items, size);
+    while ((status = SmolTLV_Cursor_next(&cursor, &item)) == SMOLTLV_STATUS_OK) {
+        count++;
+        status = reader->on_item(item, reader->context);
+        if (status != SMOLTLV_STATUS_OK) {
+            return status;
+        }
+    }
+    if (status != SMOLTLV_STATUS_END || count != item_count) {
+        return SMOLTLV_STATUS_INVALID_FORMAT;
+    }
+    return SMOLTLV_STATUS_OK;
+}
+
+static SmolTLV_Status reader_index(SmolTLV_ArchiveReader *reader, const uint8_t *index) {
+    for (size_t i = 0; i < reader->frame_count; i++) {
+        if (load_be64(index) != reader->index[i].offset ||
+            load_be64(index + 8) != reader->index[i].first_item) {
+            return SMOLTLV_STATUS_INVALID_FORMAT;
+        }
+        index += ARCHIVE_INDEX_ENTRY_SIZE;
+    }
+
+    uint64_t index_offset = reader->offset;
+    if (load_be64(index) != index_offset || load_be64(index + 8) != reader->item_count ||
+        load_be32(index + 16) != reader->frame_count || memcmp(index + 20, ARCHIVE_MAGIC, 4u) != 0) {
+        return SMOLTLV_STATUS_INVALID_FORMAT;
+    }
+    return SMOLTLV_STATUS_OK;
+}
+
+/** Processes complete units of data, consumed is set to their size */
+static SmolTLV_Status reader_consume(SmolTLV_ArchiveReader *reader,
+                                     const uint8_t *data,
+                                     size_t size,
+                                     size_t *consumed) {
+    size_t position = 0;
+    SmolTLV_Status status = SMOLTLV_STATUS_OK;
+
+    while (status == SMOLTLV_STATUS_OK && position < size) {
+        const uint8_t *unit = data + position;
+        size_t available = size - position;
+        if (reader->state == ARCHIVE_READER_DONE) {
+            status = SMOLTLV_STATUS_INVALID_FORMAT;
+            break;
+        }
+
+        // Frames end with the first index entry or, without frames, the
+        // trailer; both start with offset of the first frame where frame
+        // header has stored size, which is never 0
+        if (reader->state == ARCHIVE_READER_FRAMES && available >= ARCHIVE_FRAME_HEADER_SIZE &&
+            load_be32(unit) == 0) {
+            reader->state = ARCHIVE_READER_INDEX;
+        }
+
+        size_t unit_size = reader_unit_size(reader, unit, available);
+        if (unit_size == 0) {
+            status = SMOLTLV_STATUS_INVALID_FORMAT;
+            break;
+        }
+        if (available < unit_size) {
+            break;
+        }
+
+        switch (reader->state) {
+        case ARCHIVE_READER_HEADER:
+            if (memcmp(unit, ARCHIVE_MAGIC, 4u) != 0 || unit[4] != ARCHIVE_VERSION) {
+                status = SMOLTLV_STATUS_INVALID_FORMAT;
+            }
+            reader->state = ARCHIVE_READER_FRAMES;
+            break;
+        case ARCHIVE_READER_FRAMES:
+            status = reader_frame(reader, unit);
+            break;
+        default:
+            status = reader_index(reader, unit);
+            reader->state = ARCHIVE_READER_DONE;
+            break;
+        }
+        position += unit_size;
+        reader->offset += unit_size;
+    }
+
+    *consumed = position;
+    return status;
+}
+
+/** Consumes buffered input, keeping partial unit at its start */
+static SmolTLV_Status reader_consume_input(SmolTLV_ArchiveReader *reader) {
+    size_t consumed;
+    SmolTLV_Status status = reader_consume(reader, reader->input, reader->input_used, &consumed);
+    memmove(reader->input, reader->input + consumed, reader->input_used - consumed);
+    reader->input_used -= consumed;
+    return status;
+}
+
+SmolTLV_Status SmolTLV_ArchiveReader_create(SmolTLV_ArchiveItemFunction on_item,
+                                            void *context,
+                                            SmolTLV_ArchiveReader **out) {
+    if (!on_item || !out) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    SmolTLV_ArchiveReader *reader = (SmolTLV_ArchiveReader *)calloc(1, sizeof(SmolTLV_ArchiveReader));
+    if (!reader) {
+        return SMOLTLV_STATUS_OUT_OF_MEMORY;
+    }
+    reader->on_item = on_item;
+    reader->context = context;
+    reader->state = ARCHIVE_READER_HEADER;
+    reader->status = SMOLTLV_STATUS_OK;
+    *out = reader;
+    return SMOLTLV_STATUS_OK;
+}
+
+void SmolTLV_ArchiveReader_destroy(SmolTLV_ArchiveReader *reader) {
+    if (!reader) {
+        return;
+    }
+    free(reader->input);
+    free(reader->items);
+    free(reader->index);
+    free(reader);
+}
+
+SmolTLV_Status SmolTLV_ArchiveReader_write(SmolTLV_ArchiveReader *reader,
+                                           const uint8_t *data,
+                                           size_t size) {
+    if (!reader || (!data && size > 0)) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+    if (reader->status != SMOLTLV_STATUS_OK) {
+        return reader->status;
+    }
+
+    SmolTLV_Status status;
+    if (reader->input_used == 0) {
+        // Complete units are processed in place, only the rest is kept
+        size_t consumed;
+        status = reader_consume(reader, data, size, &consumed);
+        data += consumed;
+        size -= consumed;
+        if (status == SMOLTLV_STATUS_OK && size > 0) {
+            if (ensure_capacity(&reader->input, &reader->input_capacity, size)) {
+                memcpy(reader->input, data, size);
+                reader->input_used = size;
+            } else {
+                status = SMOLTLV_STATUS_OUT_OF_MEMORY;
+            }
+        }
+    } else if (ensure_capacity(&reader->input, &reader->input_capacity, reader->input_used + size)) {
+        memcpy(reader->input + reader->input_used, data, size);
+        reader->input_used += size;
+        status = reader_consume_input(reader);
+    } else {
+        status = SMOLTLV_STATUS_OUT_OF_MEMORY;
+    }
+
+    reader->status = status;
+    return status;
+}
+
+SmolTLV_Status SmolTLV_ArchiveReader_read(SmolTLV_ArchiveReader *reader,
+                                          SmolTLV_ArchiveReadFunction read,
+                                          void *context) {
+    if (!reader || !read) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    while (reader->status == SMOLTLV_STATUS_OK) {
+        // Rest of the current unit in one read when it is large
+        size_t unit_size = reader_unit_size(reader, reader->input, reader->input_used);
+        size_t wanted = unit_size > reader->input_used ? unit_size - reader->input_used : 0;
+        if (wanted < ARCHIVE_READ_SIZE) {
+            wanted = ARCHIVE_READ_SIZE;
+        }
+        if (!ensure_capacity(&reader->input, &reader->input_capacity, reader->input_used + wanted)) {
+            reader->status = SMOLTLV_STATUS_OUT_OF_MEMORY;
+            break;
+        }
+
+        size_t length = 0;
+        SmolTLV_Status status = read(reader->input + reader->input_used,
+                                     reader->input_capacity - reader->input_used,
+                                     &length, context);
+        if (status != SMOLTLV_STATUS_OK) {
+            reader->status = status;
+            break;
+        }
+        if (length == 0) {
+            return SmolTLV_ArchiveReader_finish(reader);
+        }
+        reader->input_used += length;
+        reader->status = reader_consume_input(reader);
+    }
+    return reader->status;
+}
+
+SmolTLV_Status SmolTLV_ArchiveReader_finish(SmolTLV_ArchiveReader *reader) {
+    if (!reader) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+    if (reader->status != SMOLTLV_STATUS_OK) {
+        return reader->status;
+    }
+    return reader->state == ARCHIVE_READER_DONE ? SMOLTLV_STATUS_OK : SMOLTLV_STATUS_NEED_MORE_DATA;
+}
@@ -0,0 +1,210 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil -*-
+ * 
+ * SmolTLV - Simple serialization format for JSON/CBOR-like data model 
+ * for embedded devices - block compressed archive.
+ * 
+ * Copyright (c) 2025 Aleš Hakl
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef H__SMOLTLV_ARCHIVE
+#define H__SMOLTLV_ARCHIVE
+
+#include <smoltlv.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Block compressed archive of top-level items.
+ *
+ * Items are grouped into frames of roughly frame_size bytes (an item is
+ * never split), each frame is compressed independently with an LZ77
+ * codec using the LZ4 block format. Frame starts with the STRING_TABLE
+ * item in effect (stored uncompressed), so a decompressed frame is a
+ * standalone stream for SmolTLV_Cursor, SmolTLV_extract and friends.
+ * Frame index at the end maps item numbers to frames for seeking and
+ * lets readers decompress frames in parallel. SmolTLV_ArchiveReader reads
+ * archive front to back without the index (pipes, sockets, files not
+ * held in memory), one frame in memory at a time.
+ *
+ * Layout (integers big-endian):
+ *   "STLZ", version (1 byte), 3 reserved bytes
+ *   frames: stored size, items size, item count, string table size
+ *           (4 bytes each), string table, items (stored uncompressed
+ *           when stored size equals items size)
+ *   index: frame offset, number of first item (8 bytes each) per frame
+ *   trailer: index offset, item count (8 bytes each), frame count
+ *            (4 bytes), "STLZ"
+ */
+
+#define SMOLTLV_ARCHIVE_DEFAULT_FRAME_SIZE (256u * 1024u)
+
+/*
+ * Codec
+ */
+
+/** Capacity of compress output needed for size bytes of input */
+extern size_t SmolTLV_lz_compress_bound(size_t size);
+/** Returns SMOLTLV_STATUS_INVALID_ARGUMENT when capacity is below
+ * SmolTLV_lz_compress_bound(size) */
+extern SmolTLV_Status SmolTLV_lz_compress(const uint8_t *data,
+                                          size_t size,
+                                          uint8_t *out,
+                                          size_t capacity,
+                                          size_t *out_size);
+/** Returns SMOLTLV_STATUS_INVALID_FORMAT for corrupted input or output
+ * not fitting capacity */
+extern SmolTLV_Status SmolTLV_lz_decompress(const uint8_t *data,
+                                            size_t size,
+                                            uint8_t *out,
+                                            size_t capacity,
+                                            size_t *out_size);
+
+/*
+ * Writer
+ */
+
+typedef struct SmolTLV_ArchiveWriter_s SmolTLV_ArchiveWriter;
+
+/** Archive is passed to write as it is produced, frame_size 0 means
+ * default */
+extern SmolTLV_Status SmolTLV_ArchiveWriter_create(size_t frame_size,
+                                                   SmolTLV_WriteFunction write,
+                                                   void *context,
+                                                   SmolTLV_ArchiveWriter **out);
+extern void SmolTLV_ArchiveWriter_destroy(SmolTLV_ArchiveWriter *writer);
+
+/** Adds complete top-level items, nothing is added when buffer ends with
+ * partial or malformed item */
+extern SmolTLV_Status SmolTLV_ArchiveWriter_write(SmolTLV_ArchiveWriter *writer,
+                                                  const uint8_t *buffer,
+                                                  size_t size);
+/** Writes last frame, index and trailer */
+extern SmolTLV_Status SmolTLV_ArchiveWriter_finish(SmolTLV_ArchiveWriter *writer);
+
+/*
+ * Reader
+ */
+
+typedef struct SmolTLV_Archive_s SmolTLV_Archive;
+
+typedef struct SmolTLV_ArchiveFrame_s {
+    /** Offset of frame in archive */
+    uint64_t offset;
+    /** Number of first item of frame */
+    uint64_t first_item;
+    size_t item_count;
+    /** Size of STRING_TABLE item at frame start, 0 without it */
+    size_t table_size;
+    /** Decompressed size of items */
+    size_t size;
+    /** Compressed size of items */
+    size_t stored_size;
+} SmolTLV_ArchiveFrame;
+
+/** Parses and checks index, data (e.g. mapped file) has to outlive
+ * archive */
+extern SmolTLV_Status SmolTLV_Archive_open(const uint8_t *data,
+                                           size_t size,
+                                           SmolTLV_Archive **out);
+extern void SmolTLV_Archive_destroy(SmolTLV_Archive *archive);
+
+extern size_t SmolTLV_Archive_frame_count(const SmolTLV_Archive *archive);
+extern uint64_t SmolTLV_Archive_item_count(const SmolTLV_Archive *archive);
+/** Size of the original stream (items of all frames) */
+extern size_t SmolTLV_Archive_stream_size(const SmolTLV_Archive *archive);
+
+extern bool SmolTLV_Archive_get_frame(const SmolTLV_Archive *archive,
+                                      size_t index,
+                                      SmolTLV_ArchiveFrame *out);
+/** Frame containing item, binary search over index */
+extern bool SmolTLV_Archive_find_item(const SmolTLV_Archive *archive,
+                                      uint64_t item,
+                                      size_t *out_frame);
+
+/** Decompresses string table and items of frame into out of at least
+ * table_size + size bytes, sets out_size. Can be called from multiple
+ * threads. */
+extern SmolTLV_Status SmolTLV_Archive_read_frame(const SmolTLV_Archive *archive,
+                                                 size_t index,
+                                                 uint8_t *out,
+                                                 size_t capacity,
+                                                 size_t *out_size);
+/** Decompresses frame of item into out (see SmolTLV_Archive_read_frame),
+ * out_item points into out and out_table to STRING_TABLE in effect
+ * (NULL pointer without it) */
+extern SmolTLV_Status SmolTLV_Archive_read_item(const SmolTLV_Archive *archive,
+                                                uint64_t item,
+                                                uint8_t *out,
+                                                size_t capacity,
+                                                SmolTLV_Item *out_item,
+                                                SmolTLV_Item *out_table);
+/** Decompresses the original stream into out of at least
+ * SmolTLV_Archive_stream_size bytes, frames are split between
+ * thread_count threads */
+extern SmolTLV_Status SmolTLV_Archive_read_all(const SmolTLV_Archive *archive,
+                                               uint8_t *out,
+                                               size_t capacity,
+                                               unsigned thread_count);
+
+/*
+ * Sequential reader
+ */
+
+typedef struct SmolTLV_ArchiveReader_s SmolTLV_ArchiveReader;
+
+/** Called for every item of the original stream in order, item is valid
+ * only during the call. Status other than SMOLTLV_STATUS_OK stops reading
+ * and is returned. Same signature as SmolTLV_IngestItemFunction. */
+typedef SmolTLV_Status (*SmolTLV_ArchiveItemFunction)(SmolTLV_Item item,
+                                                      void *context);
+/** Reads up to capacity bytes of archive into buffer and sets length, 0
+ * at end of input (e.g. wraps read(2) on file or socket) */
+typedef SmolTLV_Status (*SmolTLV_ArchiveReadFunction)(uint8_t *buffer,
+                                                      size_t capacity,
+                                                      size_t *out_length,
+                                                      void *context);
+
+extern SmolTLV_Status SmolTLV_ArchiveReader_create(SmolTLV_ArchiveItemFunction on_item,
+                                                   void *context,
+                                                   SmolTLV_ArchiveReader **out);
+extern void SmolTLV_ArchiveReader_destroy(SmolTLV_ArchiveReader *reader);
+
+/** Consumes next part of archive of any size, every completed frame is
+ * checked, decompressed and its items passed to on_item. Index and
+ * trailer are checked against frames read. Errors are sticky. */
+extern SmolTLV_Status SmolTLV_ArchiveReader_write(SmolTLV_ArchiveReader *reader,
+                                                  const uint8_t *data,
+                                                  size_t size);
+/** Pulls archive through read until end of input, reading each frame
+ * with a single call when possible, then finishes */
+extern SmolTLV_Status SmolTLV_ArchiveReader_read(SmolTLV_ArchiveReader *reader,
+                                                 SmolTLV_ArchiveReadFunction read,
+                                                 void *context);
+/** Returns SMOLTLV_STATUS_NEED_MORE_DATA when archive is not complete */
+extern SmolTLV_Status SmolTLV_ArchiveReader_finish(SmolTLV_ArchiveReader *reader);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // H__SMOLTLV_ARCHIVE
@@ -0,0 +1,707 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil -*-
+ * 
+ * SmolTLV - Simple serialization format for JSON/CBOR-like data model 
+ * for embedded devices - CBOR transcoding.
+ * 
+ * Copyright (c) 2025 Aleš Hakl
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <smoltlv_cbor.h>
+#include <smoltlv_writer.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CBOR_MAJOR_UNSIGNED 0u
+#define CBOR_MAJOR_NEGATIVE 1u
+#define CBOR_MAJOR_BYTES 2u
+#define CBOR_MAJOR_TEXT 3u
+#define CBOR_MAJOR_ARRAY 4u
+#define CBOR_MAJOR_MAP 5u
+#define CBOR_MAJOR_TAG 6u
+#define CBOR_MAJOR_SIMPLE 7u
+
+#define CBOR_INDEFINITE 31u
+#define CBOR_BREAK 0xFFu
+
+/** RFC 8746 typed array tag and its SmolTLV counterpart */
+typedef struct CborArrayTag_s {
+    uint64_t tag;
+    SmolTLV_Type type;
+    bool little_endian;
+} CborArrayTag;
+
+static const CborArrayTag cbor_array_tags[] = {
+    { 72, SMOLTLV_TYPE_ARRAY_INT8, false },
+    { 73, SMOLTLV_TYPE_ARRAY_INT16, false },
+    { 74, SMOLTLV_TYPE_ARRAY_INT32, false },
+    { 75, SMOLTLV_TYPE_ARRAY_INT64, false },
+    { 77, SMOLTLV_TYPE_ARRAY_INT16, true },
+    { 78, SMOLTLV_TYPE_ARRAY_INT32, true },
+    { 79, SMOLTLV_TYPE_ARRAY_INT64, true },
+    { 81, SMOLTLV_TYPE_ARRAY_FLOAT32, false },
+    { 82, SMOLTLV_TYPE_ARRAY_FLOAT64, false },
+    { 85, SMOLTLV_TYPE_ARRAY_FLOAT32, true },
+    { 86, SMOLTLV_TYPE_ARRAY_FLOAT64, true },
+};
+
+#define CBOR_ARRAY_TAG_COUNT (sizeof(cbor_array_tags) / sizeof(cbor_array_tags[0]))
+
+/*
+ * CBOR -> SmolTLV
+ */
+
+#ifndef SMOLTLV_NO_ENCODER
+
+typedef struct CborParser_s {
+    const uint8_t *p;
+    const uint8_t *end;
+    SmolTLV_Encoder *encoder;
+    /** Data item being transcoded */
+    const uint8_t *item;
+    const char *message;
+} CborParser;
+
+/** Open array or map */
+typedef struct CborFrame_s {
+    /** Items left in definite, items seen in indefinite length container */
+    uint64_t count;
+    bool indefinite;
+    bool is_map;
+} CborFrame;
+
+static SmolTLV_Status parser_error(CborParser *parser, const char *message) {
+    parser->message = message;
+    return SMOLTLV_STATUS_INVALID_FORMAT;
+}
+
+/** Reads initial byte and argument, indefinite length has argument 0 */
+static SmolTLV_Status read_header(CborParser *parser,
+                                  uint8_t *out_initial,
+                                  uint64_t *out_argument) {
+    if (parser->p >= parser->end) {
+        return parser_error(parser, "truncated data item");
+    }
+
+    uint8_t initial = *parser->p++;
+    uint8_t info = initial & 0x1Fu;
+    uint8_t major = initial >> 5;
+    *out_initial = initial;
+    *out_argument = info;
+
+    if (info >= 24u && info <= 27u) {
+        size_t size = (size_t)1u << (info - 24u);
+        if ((size_t)(parser->end - parser->p) < size) {
+            return parser_error(parser, "truncated data item");
+        }
+        *out_argument = load_element(parser->p, size);
+        parser->p += size;
+    } else if (info == CBOR_INDEFINITE) {
+        *out_argument = 0;
+        if (major == CBOR_MAJOR_SIMPLE) {
+            return parser_error(parser, "break outside of indefinite length item");
+        }
+        if (major < CBOR_MAJOR_BYTES || major > CBOR_MAJOR_MAP) {
+            return parser_error(parser, "indefinite length not allowed for major type");
+        }
+    } else if (info > 27u) {
+        return parser_error(parser, "reserved additional information");
+    }
+    return SMOLTLV_STATUS_OK;
+}
+
+static SmolTLV_Status parse_string(CborParser *parser, uint8_t initial, uint64_t length) {
+    SmolTLV_Type type = (initial >> 5) == CBOR_MAJOR_BYTES ? SMOLTLV_TYPE_BYTES
+                                                           : SMOLTLV_TYPE_STRING;
+    if ((initial & 0x1Fu) != CBOR_INDEFINITE) {
+        if (length > (uint64_t)(parser->end - parser->p)) {
+            return parser_error(parser, "truncated data item");
+        }
+        if (length > SMOLTLV_MAX_LENGTH) {
+            return parser_error(parser, "string longer than SMOLTLV_MAX_LENGTH");
+        }
+        const uint8_t *value = parser->p;
+        parser->p += length;
+        return SmolTLV_Encoder_write_primitive(parser->encoder, type, value, (size_t)length);
+    }
+
+    // Chunks are appended to one value, its length is patched at the end
+    SmolTLV_Status status = SmolTLV_Encoder_start_nested(parser->encoder, type);
+    while (status == SMOLTLV_STATUS_OK) {
+        if (parser->p >= parser->end) {
+            return parser_error(parser, "truncated data item");
+        }
+        if (*parser->p == CBOR_BREAK) {
+            parser->p++;
+            status = SmolTLV_Encoder_end(parser->encoder);
+            return status == SMOLTLV_STATUS_INVALID_FORMAT
+                ? parser_error(parser, "string longer than SMOLTLV_MAX_LENGTH")
+                : status;
+        }
+
+        uint8_t chunk_initial;
+        status = read_header(parser, &chunk_initial, &length);
+        if (status != SMOLTLV_STATUS_OK) {
+            return status;
+        }
+        if ((chunk_initial >> 5) != (initial >> 5) || (chunk_initial & 0x1Fu) == CBOR_INDEFINITE) {
+            return parser_error(parser, "invalid chunk of indefinite length string");
+        }
+        if (length > (uint64_t)(parser->end - parser->p)) {
+            return parser_error(parser, "truncated data item");
+        }
+        if (length > SMOLTLV_MAX_LENGTH) {
+            return parser_error(parser, "string longer than SMOLTLV_MAX_LENGTH");
+        }
+        status = SmolTLV_Encoder_write_items(parser->encoder, parser->p, (size_t)length);
+        parser->p += length;
+    }
+    return status;
+}
+
+static SmolTLV_Status parse_typed_array(CborParser *parser, uint64_t tag) {
+    const CborArrayTag *array_tag = NULL;
+    for (size_t i = 0; i < CBOR_ARRAY_TAG_COUNT; i++) {
+        if (cbor_array_tags[i].tag == tag) {
+            array_tag = &cbor_array_tags[i];
+            break;
+        }
+    }
+    if (!array_tag) {
+        return parser_error(parser, "unsupported tag");
+    }
+
+    uint8_t initial;
+    uint64_t length;
+    SmolTLV_Status status = read_header(parser, &initial, &length);
+    if (status != SMOLTLV_STATUS_OK) {
+        return status;
+    }
+    size_t element_size = SmolTLV_Type_array_element_size(array_tag->type);
+    if ((initial >> 5) != CBOR_MAJOR_BYTES || (initial & 0x1Fu) == CBOR_INDEFINITE) {
+        return parser_error(parser, "typed array tag without definite byte string");
+    }
+    if (length > (uint64_t)(parser->end - parser->p)) {
+        return parser_error(parser, "truncated data item");
+    }
+    if (length > SMOLTLV_MAX_LENGTH) {
+        return parser_error(parser, "string longer than SMOLTLV_MAX_LENGTH");
+    }
+    if (length % element_size != 0u) {
+        return parser_error(parser, "typed array length not multiple of element size");
+    }
+
+    const uint8_t *value = parser->p;
+    parser->p += length;
+    if (!array_tag->little_endian) {
+        return SmolTLV_Encoder_write_primitive(parser->encoder, array_tag->type,
+                                               value, (size_t)length);
+    }
+
+    uint8_t *swapped = (uint8_t *)malloc(length ? (size_t)length : 1u);
+    if (!swapped) {
+        return SMOLTLV_STATUS_OUT_OF_MEMORY;
+    }
+    for (size_t i = 0; i < length; i += element_size) {
+        for (size_t j = 0; j < element_size; j++) {
+            swapped[i + j] = value[i + element_size - 1u - j];
+        }
+    }
+    status = SmolTLV_Encoder_write_primitive(parser->encoder, array_tag->type,
+                                             swapped, (size_t)length);
+    free(swapped);
+    return status;
+}
+
+static float half_to_float(uint16_t half) {
+    uint32_t sign = (uint32_t)(half >> 15) << 31;
+    uint32_t exponent = (half >> 10) & 0x1Fu;
+    uint32_t mantissa = half & 0x3FFu;
+    uint32_t bits;
+    float value;
+
+    if (exponent == 0u) {
+        // Subnormal (and zero), exact in float
+        value = (float)mantissa * (1.0f / 16777216.0f);
+        return sign ? -value : value;
+    }
+    if (exponent == 31u) {
+        bits = sign | 0x7F800000u | (mantissa << 13);
+    } else {
+        bits = sign | ((exponent + 112u) << 23) | (mantissa << 13);
+    }
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static SmolTLV_Status parse_simple(CborParser *parser, uint8_t initial, uint64_t argument) {
+    switch (initial & 0x1Fu) {
+    case 20:
+        return SmolTLV_Encoder_write_bool(parser->encoder, false);
+    case 21:
+        return SmolTLV_Encoder_write_bool(parser->encoder, true);
+    case 22:
+        return SmolTLV_Encoder_write_null(parser->encoder);
+    case 25: {
+        float value = half_to_float((uint16_t)argument);
+        return SmolTLV_Encoder_write_float_array(parser->encoder, &value, 1);
+    }
+    case 26: {
+        uint32_t bits = (uint32_t)argument;
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        return SmolTLV_Encoder_write_float_array(parser->encoder, &value, 1);
+    }
+    case 27: {
+        double value;
+        memcpy(&value, &argument, sizeof(value));
+        return SmolTLV_Encoder_write_double_array(parser->encoder, &value, 1);
+    }
+    case 23:
+        return parser_error(parser, "undefined has no SmolTLV counterpart");
+    default:
+        return parser_error(parser, "unsupported simple value");
+    }
+}
+
+static void frame_count_item(CborFrame *frame) {
+    if (frame->indefinite) {
+        frame->count++;
+    } else {
+        frame->count--;
+    }
+}
+
+/*
+ * Transcodes one top-level data item. Open arrays and maps are kept in an
+ * explicit stack, so deep input does not recurse.
+ */
+static SmolTLV_Status parse_item(CborParser *parser) {
+    CborFrame stack[SMOLTLV_CBOR_MAX_DEPTH];
+    size_t depth = 0;
+    SmolTLV_Status status;
+
+    do {
+        uint8_t initial;
+        uint64_t argument;
+        parser->item = parser->p;
+        status = read_header(parser, &initial, &argument);
+        if (status != SMOLTLV_STATUS_OK) {
+            return status;
+        }
+
+        uint8_t major = initial >> 5;
+        bool is_container = major == CBOR_MAJOR_ARRAY || major == CBOR_MAJOR_MAP;
+        switch (major) {
+        case CBOR_MAJOR_UNSIGNED:
+            if (argument > (uint64_t)INT64_MAX) {
+                return parser_error(parser, "unsigned integer above INT64_MAX");
+            }
+            status = SmolTLV_Encoder_write_int(parser->encoder, (int64_t)argument);
+            break;
+        case CBOR_MAJOR_NEGATIVE:
+            if (argument > (uint64_t)INT64_MAX) {
+                return parser_error(parser, "negative integer below INT64_MIN");
+            }
+            status = SmolTLV_Encoder_write_int(parser->encoder, -1 - (int64_t)argument);
+            break;
+        case CBOR_MAJOR_BYTES:
+        case CBOR_MAJOR_TEXT:
+            status = parse_string(parser, initial, argument);
+            break;
+        case CBOR_MAJOR_ARRAY:
+        case CBOR_MAJOR_MAP: {
+            CborFrame frame = { argument, (initial & 0x1Fu) == CBOR_INDEFINITE,
+                                major == CBOR_MAJOR_MAP };
+            if (depth >= SMOLTLV_CBOR_MAX_DEPTH) {
+                return parser_error(parser, "nesting deeper than SMOLTLV_CBOR_MAX_DEPTH");
+            }
+            // Every item takes at least one byte
+            if (argument > (uint64_t)(parser->end - parser->p) / (frame.is_map ? 2u : 1u)) {
+                return parser_error(parser, "truncated data item");
+            }
+            if (frame.is_map) {
+                frame.count *= 2u;
+            }
+            status = frame.is_map ? SmolTLV_Encoder_start_dict(parser->encoder)
+                                  : SmolTLV_Encoder_start_list(parser->encoder);
+            stack[depth++] = frame;
+            break;
+        }
+        case CBOR_MAJOR_TAG:
+            status = parse_typed_array(parser, argument);
+            break;
+        default:
+            status = parse_simple(parser, initial, argument);
+            break;
+        }
+
+        if (status != SMOLTLV_STATUS_OK) {
+            return status;
+        }
+        if (!is_container && depth > 0u) {
+            frame_count_item(&stack[depth - 1u]);
+        }
+
+        // Close complete containers
+        while (depth > 0u) {
+            CborFrame *top = &stack[depth - 1u];
+            if (top->indefinite) {
+                if (parser->p >= parser->end) {
+                    return parser_error(parser, "truncated data item");
+                }
+                if (*parser->p != CBOR_BREAK) {
+                    break;
+                }
+                if (top->is_map && top->count % 2u != 0u) {
+                    parser->item = parser->p;
+                    return parser_error(parser, "map key without value");
+                }
+                parser->p++;
+            } else if (top->count > 0u) {
+                break;
+            }
+
+            status = SmolTLV_Encoder_end(parser->encoder);
+            if (status != SMOLTLV_STATUS_OK) {
+                return status;
+            }
+            depth--;
+            if (depth > 0u) {
+                frame_count_item(&stack[depth - 1u]);
+            }
+        }
+    } while (depth > 0u);
+
+    return SMOLTLV_STATUS_OK;
+}
+
+SmolTLV_Status SmolTLV_cbor_encode(const uint8_t *cbor,
+                                   size_t size,
+                                   SmolTLV_Encoder *encoder,
+                                   SmolTLV_CborError *out_error) {
+    if ((!cbor && size > 0u) || !encoder) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    CborParser parser = { cbor, cbor + size, encoder, cbor, NULL };
+    SmolTLV_Status status = SMOLTLV_STATUS_OK;
+    while (parser.p < parser.end && status == SMOLTLV_STATUS_OK) {
+        status = parse_item(&parser);
+    }
+
+    if (status == SMOLTLV_STATUS_INVALID_FORMAT && out_error) {
+        out_error->offset = (size_t)(parser.item - cbor);
+        out_error->message = parser.message ? parser.message : "item too large for SmolTLV";
+    }
+    return status;
+}
+
+#endif /* SMOLTLV_NO_ENCODER */
+
+/*
+ * SmolTLV -> CBOR
+ */
+
+/** Initial byte with the shortest argument encoding */
+static void writer_header(TranscodeWriter *writer, uint8_t major, uint64_t argument) {
+    uint8_t header[9];
+    size_t size;
+    if (argument < 24u) {
+        header[0] = (uint8_t)(major << 5 | argument);
+        size = 1;
+    } else {
+        size_t argument_size = argument <= 0xFFu ? 1u
+                             : argument <= 0xFFFFu ? 2u
+                             : argument <= 0xFFFFFFFFu ? 4u : 8u;
+        header[0] = (uint8_t)(major << 5 | (argument_size == 1u ? 24u
+                                          : argument_size == 2u ? 25u
+                                          : argument_size == 4u ? 26u : 27u));
+        for (size_t i = 0; i < argument_size; i++) {
+            header[argument_size - i] = (uint8_t)(argument >> (8u * i));
+        }
+        size = argument_size + 1u;
+    }
+    writer_bytes(writer, header, size);
+}
+
+static void writer_int(TranscodeWriter *writer, int64_t value) {
+    if (value < 0) {
+        writer_header(writer, CBOR_MAJOR_NEGATIVE, ~(uint64_t)value);
+    } else {
+        writer_header(writer, CBOR_MAJOR_UNSIGNED, (uint64_t)value);
+    }
+}
+
+static void writer_string_ref(TranscodeWriter *writer, SmolTLV_Item item) {
+    SmolTLV_Item entry;
+    if (writer_resolve_string(writer, item, &entry)) {
+        writer_header(writer, CBOR_MAJOR_TEXT, SmolTLV_Item_get_length(entry));
+        writer_bytes(writer, SmolTLV_Item_get_value(entry), SmolTLV_Item_get_length(entry));
+    }
+}
+
+static uint64_t array_tag(SmolTLV_Type type) {
+    for (size_t i = 0; i < CBOR_ARRAY_TAG_COUNT; i++) {
+        if (cbor_array_tags[i].type == type && !cbor_array_tags[i].little_endian) {
+            return cbor_array_tags[i].tag;
+        }
+    }
+    return 0;
+}
+
+static void writer_array(TranscodeWriter *writer, SmolTLV_Item item) {
+    SmolTLV_Type type = SmolTLV_Item_get_type(item);
+    const uint8_t *value = SmolTLV_Item_get_value(item);
+    size_t length = SmolTLV_Item_get_length(item);
+
+    // Single floats are how CBOR floats arrive, written back as such
+    if ((type == SMOLTLV_TYPE_ARRAY_FLOAT32 && length == 4u) ||
+        (type == SMOLTLV_TYPE_ARRAY_FLOAT64 && length == 8u)) {
+        uint8_t initial = length == 4u ? 0xFAu : 0xFBu;
+        writer_bytes(writer, &initial, 1);
+        writer_bytes(writer, value, length);
+        return;
+    }
+
+    writer_header(writer, CBOR_MAJOR_TAG, array_tag(type));
+    writer_header(writer, CBOR_MAJOR_BYTES, length);
+    writer_bytes(writer, value, length);
+}
+
+/** Prefix sums as int64 typed array */
+static void writer_delta(TranscodeWriter *writer, SmolTLV_Item item) {
+    SmolTLV_Item array;
+    if (!SmolTLV_Item_delta_array(item, &array)) {
+        writer->status = SMOLTLV_STATUS_INVALID_FORMAT;
+        return;
+    }
+
+    size_t element_size = SmolTLV_Type_array_element_size(SmolTLV_Item_get_type(array));
+    size_t count = SmolTLV_Item_get_length(array) / element_size;
+    const uint8_t *p = SmolTLV_Item_get_value(array);
+    uint64_t sum = 0;
+
+    writer_header(writer, CBOR_MAJOR_TAG, array_tag(SMOLTLV_TYPE_ARRAY_INT64));
+    writer_header(writer, CBOR_MAJOR_BYTES, (uint64_t)count * 8u);
+    for (size_t i = 0; i < count; i++, p += element_size) {
+        uint8_t element[8];
+        sum += (uint64_t)load_int_element(p, element_size);
+        for (size_t j = 0; j < 8u; j++) {
+            element[j] = (uint8_t)(sum >> (56u - 8u * j));
+        }
+        writer_bytes(writer, element, sizeof(element));
+    }
+}
+
+static void writer_item(TranscodeWriter *writer, SmolTLV_Item item, size_t depth);
+
+/** Rows of record batch as array of maps */
+static void writer_batch(TranscodeWriter *writer, SmolTLV_Item item, size_t depth) {
+    SmolTLV_BatchReader reader;
+    if (!writer_start_batch(writer, item, &reader)) {
+        return;
+    }
+
+    writer_header(writer, CBOR_MAJOR_ARRAY, reader.batch.row_count);
+    while (writer_next_row(writer, &reader)) {
+        writer_header(writer, CBOR_MAJOR_MAP, reader.batch.column_count);
+        for (size_t i = 0; i < reader.batch.column_count; i++) {
+            const SmolTLV_BatchReaderColumn *column = &reader.columns[i];
+            writer_item(writer, column->key, depth + 2u);
+            if (column->item.pointer) {
+                writer_item(writer, column->item, depth + 2u);
+            } else {
+                writer_int(writer, column->int_value);
+            }
+        }
+    }
+    free(reader.columns);
+}
+
+static void writer_container(TranscodeWriter *writer, SmolTLV_Item item, size_t depth, bool is_dict) {
+    SmolTLV_Cursor cursor;
+    SmolTLV_Item entry;
+    SmolTLV_Status status;
+    size_t count = 0;
+
+    // Headers only, counting pass is cheap compared to the content
+    SmolTLV_Cursor_for_item(&cursor, item);
+    while ((status = SmolTLV_Cursor_next(&cursor, &entry)) == SMOLTLV_STATUS_OK) {
+        count++;
+    }
+    if (status != SMOLTLV_STATUS_END || (is_dict && count % 2u != 0u)) {
+        writer->status = SMOLTLV_STATUS_INVALID_FORMAT;
+        return;
+    }
+
+    writer_header(writer, is_dict ? CBOR_MAJOR_MAP : CBOR_MAJOR_ARRAY, is_dict ? count / 2u : count);
+    SmolTLV_Cursor_for_item(&cursor, item);
+    while (writer->status == SMOLTLV_STATUS_OK &&
+           SmolTLV_Cursor_next(&cursor, &entry) == SMOLTLV_STATUS_OK) {
+        writer_item(writer, entry, depth + 1u);
+    }
+}
+
+static void writer_item(TranscodeWriter *writer, SmolTLV_Item item, size_t depth) {
+    if (writer->status != SMOLTLV_STATUS_OK) {
+        return;
+    }
+    if (depth > SMOLTLV_CBOR_MAX_DEPTH) {
+        writer->status = SMOLTLV_STATUS_INVALID_FORMAT;
+        return;
+    }
+
+    const uint8_t *value = SmolTLV_Item_get_value(item);
+    size_t length = SmolTLV_Item_get_length(item);
+    uint8_t simple;
+
+    switch (SmolTLV_Item_get_type(item)) {
+    case SMOLTLV_TYPE_NULL:
+        simple = 0xF6u;
+        writer_bytes(writer, &simple, 1);
+        break;
+    case SMOLTLV_TYPE_BOOL_TRUE:
+        simple = 0xF5u;
+        writer_bytes(writer, &simple, 1);
+        break;
+    case SMOLTLV_TYPE_BOOL_FALSE:
+        simple = 0xF4u;
+        writer_bytes(writer, &simple, 1);
+        break;
+    case SMOLTLV_TYPE_INT:
+        if (length != 8u) {
+            writer->status = SMOLTLV_STATUS_INVALID_FORMAT;
+            break;
+        }
+        writer_int(writer, (int64_t)load_element(value, 8));
+        break;
+    case SMOLTLV_TYPE_BYTES:
+        writer_header(writer, CBOR_MAJOR_BYTES, length);
+        writer_bytes(writer, value, length);
+        break;
+    case SMOLTLV_TYPE_STRING:
+        writer_header(writer, CBOR_MAJOR_TEXT, length);
+        writer_bytes(writer, value, length);
+        break;
+    case SMOLTLV_TYPE_STRING_REF:
+        writer_string_ref(writer, item);
+        break;
+    case SMOLTLV_TYPE_LIST:
+        writer_container(writer, item, depth, false);
+        break;
+    case SMOLTLV_TYPE_DICT:
+        writer_container(writer, item, depth, true);
+        break;
+    case SMOLTLV_TYPE_ARRAY_INT8:
+    case SMOLTLV_TYPE_ARRAY_INT16:
+    case SMOLTLV_TYPE_ARRAY_INT32:
+    case SMOLTLV_TYPE_ARRAY_INT64:
+    case SMOLTLV_TYPE_ARRAY_FLOAT32:
+    case SMOLTLV_TYPE_ARRAY_FLOAT64:
+        writer_array(writer, item);
+        break;
+    case SMOLTLV_TYPE_DELTA:
+        writer_delta(writer, item);
+        break;
+    case SMOLTLV_TYPE_RECORD_BATCH:
+        writer_batch(writer, item, depth);
+        break;
+    default:
+        writer->status = SMOLTLV_STATUS_INVALID_FORMAT;
+        break;
+    }
+}
+
+/** Chunked value starting at cursor as indefinite length string */
+static void writer_chunks(TranscodeWriter *writer, SmolTLV_Cursor *cursor) {
+    SmolTLV_ChunkReader reader;
+    SmolTLV_Status status;
+    const uint8_t *chunk;
+    size_t length;
+    uint8_t marker;
+
+    SmolTLV_ChunkReader_init(&reader, cursor);
+    status = SmolTLV_ChunkReader_next(&reader, &chunk, &length);
+    uint8_t major = reader.type == SMOLTLV_TYPE_STRING ? CBOR_MAJOR_TEXT : CBOR_MAJOR_BYTES;
+    marker = (uint8_t)(major << 5 | CBOR_INDEFINITE);
+    writer_bytes(writer, &marker, 1);
+    for (; status == SMOLTLV_STATUS_OK; status = SmolTLV_ChunkReader_next(&reader, &chunk, &length)) {
+        writer_header(writer, major, length);
+        writer_bytes(writer, chunk, length);
+    }
+    marker = CBOR_BREAK;
+    writer_bytes(writer, &marker, 1);
+
+    if (status != SMOLTLV_STATUS_END && writer->status == SMOLTLV_STATUS_OK) {
+        writer->status = status;
+    }
+}
+
+SmolTLV_Status SmolTLV_cbor_write(const uint8_t *buffer,
+                                  size_t size,
+                                  SmolTLV_WriteFunction write,
+                                  void *context) {
+    if ((!buffer && size > 0u) || !write) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    TranscodeWriter writer;
+    writer_init(&writer, write, context);
+
+    SmolTLV_Cursor cursor;
+    SmolTLV_Item item;
+    SmolTLV_Status status = SMOLTLV_STATUS_END;
+    SmolTLV_Cursor_init(&cursor, buffer, size);
+    while (writer.status == SMOLTLV_STATUS_OK &&
+           (status = SmolTLV_Cursor_next(&cursor, &item)) == SMOLTLV_STATUS_OK) {
+        SmolTLV_Type type = SmolTLV_Item_get_type(item);
+        if (type == SMOLTLV_TYPE_STRING_TABLE) {
+            writer_set_table(&writer, item);
+        } else if (type == SMOLTLV_TYPE_BYTES_CHUNK || type == SMOLTLV_TYPE_STRING_CHUNK) {
+            cursor.position = (size_t)(item.pointer - buffer);
+            writer_chunks(&writer, &cursor);
+        } else {
+            writer_item(&writer, item, 1u);
+        }
+    }
+
+    if (writer.status == SMOLTLV_STATUS_OK && status != SMOLTLV_STATUS_END) {
+        writer.status = status;
+    }
+    return writer_finish(&writer);
+}
+
+SmolTLV_Status SmolTLV_cbor_write_item(SmolTLV_Item item,
+                                       const SmolTLV_StringTable *table,
+                                       SmolTLV_WriteFunction write,
+                                       void *context) {
+    if (!item.pointer || !write) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    TranscodeWriter writer;
+    writer_init(&writer, write, context);
+    if (table && table->item.pointer) {
+        writer_set_table(&writer, table->item);
+    }
+    writer_item(&writer, item, 1u);
+    return writer_finish(&writer);
+}
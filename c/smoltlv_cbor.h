@@ -0,0 +1,99 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil -*-
+ * 
+ * SmolTLV - Simple serialization format for JSON/CBOR-like data model 
+ * for embedded devices - CBOR transcoding.
+ * 
+ * Copyright (c) 2025 Aleš Hakl
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef H__SMOLTLV_CBOR
+#define H__SMOLTLV_CBOR
+
+#include <smoltlv.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * CBOR (RFC 8949) transcoding without intermediate trees. Sequence of 
+ * CBOR data items (RFC 8742) maps to sequence of top-level items and back.
+ *
+ * CBOR -> SmolTLV: integers, byte and text strings, arrays, maps, false, 
+ * true and null map directly, map keys of any type are kept. Floats 
+ * (including half precision) are single element float arrays. Typed 
+ * array tags of RFC 8746 for signed integers and floats are typed arrays, 
+ * little-endian ones are byte swapped. Indefinite length strings, arrays 
+ * and maps are encoded with backpatched lengths.
+ *
+ * Not mappable, reported as SMOLTLV_STATUS_INVALID_FORMAT with a message: 
+ * unsigned integers above INT64_MAX, negative ones below INT64_MIN, 
+ * undefined and other simple values, other tags and strings over 
+ * SMOLTLV_MAX_LENGTH.
+ *
+ * SmolTLV -> CBOR: mapping above in reverse with shortest headers and 
+ * definite lengths, typed arrays use big-endian tags, DELTA is int64 
+ * typed array, record batches are arrays of row maps, STRING_REF items 
+ * are resolved through string table and chunked values are indefinite 
+ * length strings.
+ */
+
+#ifndef SMOLTLV_CBOR_MAX_DEPTH
+#define SMOLTLV_CBOR_MAX_DEPTH 1024u
+#endif
+
+/** Location and reason of CBOR that could not be transcoded */
+typedef struct SmolTLV_CborError_s {
+    /** Offset of the offending data item */
+    size_t offset;
+    /** Static description */
+    const char *message;
+} SmolTLV_CborError;
+
+#ifndef SMOLTLV_NO_ENCODER
+/** Encodes all CBOR data items in cbor into encoder. On format error 
+ * returns SMOLTLV_STATUS_INVALID_FORMAT and fills out_error (can be NULL), 
+ * items before the error stay written. */
+extern SmolTLV_Status SmolTLV_cbor_encode(const uint8_t *cbor,
+                                          size_t size,
+                                          SmolTLV_Encoder *encoder,
+                                          SmolTLV_CborError *out_error);
+#endif
+
+/** Writes top-level items of buffer as CBOR through write, output is 
+ * passed in blocks of a few KB */
+extern SmolTLV_Status SmolTLV_cbor_write(const uint8_t *buffer,
+                                         size_t size,
+                                         SmolTLV_WriteFunction write,
+                                         void *context);
+
+/** Writes single item (and its content) as CBOR, table resolves 
+ * STRING_REF items and can be NULL */
+extern SmolTLV_Status SmolTLV_cbor_write_item(SmolTLV_Item item,
+                                              const SmolTLV_StringTable *table,
+                                              SmolTLV_WriteFunction write,
+                                              void *context);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // H__SMOLTLV_CBOR
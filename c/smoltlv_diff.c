@@ -0,0 +1,729 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil -*-
+ * 
+ * SmolTLV - Simple serialization format for JSON/CBOR-like data model 
+ * for embedded devices - structural diff and patch.
+ * 
+ * Copyright (c) 2025 Aleš Hakl
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <smoltlv_diff.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DIFF_OP_SET 0
+#define DIFF_OP_REMOVE 1
+#define DIFF_OP_INSERT 2
+
+static size_t item_size(SmolTLV_Item item) {
+    return 4u + (size_t)SmolTLV_Item_get_length(item);
+}
+
+/** FNV-1a over 64-bit words, tail bytes one by one */
+static uint64_t diff_hash(const uint8_t *data, size_t size) {
+    uint64_t hash = 0xCBF29CE484222325ull;
+    size_t i = 0;
+    for (; i + 8u <= size; i += 8u) {
+        uint64_t word;
+        memcpy(&word, data + i, sizeof(word));
+        hash = (hash ^ word) * 0x100000001B3ull;
+    }
+    for (; i < size; i++) {
+        hash = (hash ^ data[i]) * 0x100000001B3ull;
+    }
+    return hash ^ (hash >> 32);
+}
+
+static bool is_list_or_dict(SmolTLV_Type type) {
+    return type == SMOLTLV_TYPE_LIST || type == SMOLTLV_TYPE_DICT;
+}
+
+/** Reads patch header, ops is LIST of operations */
+static SmolTLV_Status diff_parse(SmolTLV_Item patch,
+                                 int64_t *out_base_size,
+                                 int64_t *out_base_hash,
+                                 int64_t *out_target_size,
+                                 SmolTLV_Item *out_ops) {
+    SmolTLV_Cursor cursor;
+    SmolTLV_Item base_size, base_hash, target_size;
+    if (!patch.pointer || SmolTLV_Item_get_type(patch) != SMOLTLV_TYPE_LIST) {
+        return SMOLTLV_STATUS_INVALID_FORMAT;
+    }
+    SmolTLV_Cursor_init(&cursor, SmolTLV_Item_get_value(patch), SmolTLV_Item_get_length(patch));
+    if (SmolTLV_Cursor_next(&cursor, &base_size) != SMOLTLV_STATUS_OK ||
+        SmolTLV_Cursor_next(&cursor, &base_hash) != SMOLTLV_STATUS_OK ||
+        SmolTLV_Cursor_next(&cursor, &target_size) != SMOLTLV_STATUS_OK ||
+        SmolTLV_Cursor_next(&cursor, out_ops) != SMOLTLV_STATUS_OK ||
+        !SmolTLV_Item_as_int(base_size, out_base_size) ||
+        !SmolTLV_Item_as_int(base_hash, out_base_hash) ||
+        !SmolTLV_Item_as_int(target_size, out_target_size) ||
+        *out_base_size < 4 || *out_target_size < 4 ||
+        SmolTLV_Item_get_type(*out_ops) != SMOLTLV_TYPE_LIST) {
+        return SMOLTLV_STATUS_INVALID_FORMAT;
+    }
+    return SMOLTLV_STATUS_OK;
+}
+
+/*
+ * Diff
+ */
+
+#ifndef SMOLTLV_NO_ENCODER
+
+/** Child of list, or key and value of dict entry */
+typedef struct DiffSpan_s {
+    const uint8_t *start;
+    size_t size;
+} DiffSpan;
+
+typedef struct DiffState_s {
+    SmolTLV_Encoder *encoder;
+    size_t path[SMOLTLV_DIFF_MAX_DEPTH];
+    size_t depth;
+    /** Children of containers being compared, stack shared by levels */
+    DiffSpan *spans;
+    size_t span_count;
+    size_t span_capacity;
+} DiffState;
+
+static bool spans_equal(DiffSpan a, DiffSpan b) {
+    return a.size == b.size && memcmp(a.start, b.start, a.size) == 0;
+}
+
+/** Pushes children spans of container, sets out_count */
+static SmolTLV_Status diff_collect(DiffState *state, SmolTLV_Item container, size_t *out_count) {
+    SmolTLV_Cursor cursor;
+    SmolTLV_Item key, value;
+    SmolTLV_Status status;
+    bool is_dict = SmolTLV_Item_get_type(container) == SMOLTLV_TYPE_DICT;
+    size_t first = state->span_count;
+
+    SmolTLV_Cursor_for_item(&cursor, container);
+    while ((status = SmolTLV_Cursor_next(&cursor, &key)) == SMOLTLV_STATUS_OK) {
+        size_t size = item_size(key);
+        if (is_dict) {
+            if (SmolTLV_Cursor_next(&cursor, &value) != SMOLTLV_STATUS_OK) {
+                return SMOLTLV_STATUS_INVALID_FORMAT;
+            }
+            size += item_size(value);
+        }
+
+        if (state->span_count == state->span_capacity) {
+            size_t capacity = state->span_capacity ? 2u * state->span_capacity : 256u;
+            DiffSpan *spans = (DiffSpan *)realloc(state->spans, capacity * sizeof(DiffSpan));
+            if (!spans) {
+                return SMOLTLV_STATUS_OUT_OF_MEMORY;
+            }
+            state->spans = spans;
+            state->span_capacity = capacity;
+        }
+        state->spans[state->span_count].start = key.pointer;
+        state->spans[state->span_count].size = size;
+        state->span_count++;
+    }
+    if (status != SMOLTLV_STATUS_END) {
+        return SMOLTLV_STATUS_INVALID_FORMAT;
+    }
+
+    *out_count = state->span_count - first;
+    return SMOLTLV_STATUS_OK;
+}
+
+/** Starts operation list with path of current container and index (when
+ * has_index), payload and SmolTLV_Encoder_end follow */
+static SmolTLV_Status diff_start_op(DiffState *state, int64_t kind, size_t index, bool has_index) {
+    SmolTLV_Encoder *encoder = state->encoder;
+    SmolTLV_Status status = SmolTLV_Encoder_start_list(encoder);
+    if (status == SMOLTLV_STATUS_OK) {
+        status = SmolTLV_Encoder_write_int(encoder, kind);
+    }
+    if (status == SMOLTLV_STATUS_OK) {
+        status = SmolTLV_Encoder_start_list(encoder);
+    }
+    for (size_t i = 0; i < state->depth && status == SMOLTLV_STATUS_OK; i++) {
+        status = SmolTLV_Encoder_write_int(encoder, (int64_t)state->path[i]);
+    }
+    if (status == SMOLTLV_STATUS_OK && has_index) {
+        status = SmolTLV_Encoder_write_int(encoder, (int64_t)index);
+    }
+    if (status == SMOLTLV_STATUS_OK) {
+        status = SmolTLV_Encoder_end(encoder);
+    }
+    return status;
+}
+
+static SmolTLV_Status diff_write_op(DiffState *state,
+                                    int64_t kind,
+                                    size_t index,
+                                    bool has_index,
+                                    const uint8_t *items,
+                                    size_t size) {
+    SmolTLV_Status status = diff_start_op(state, kind, index, has_index);
+    if (status == SMOLTLV_STATUS_OK) {
+        status = SmolTLV_Encoder_write_items(state->encoder, items, size);
+    }
+    if (status == SMOLTLV_STATUS_OK) {
+        status = SmolTLV_Encoder_end(state->encoder);
+    }
+    return status;
+}
+
+static SmolTLV_Status diff_write_remove(DiffState *state, size_t index, size_t count) {
+    SmolTLV_Status status = diff_start_op(state, DIFF_OP_REMOVE, index, true);
+    if (status == SMOLTLV_STATUS_OK) {
+        status = SmolTLV_Encoder_write_int(state->encoder, (int64_t)count);
+    }
+    if (status == SMOLTLV_STATUS_OK) {
+        status = SmolTLV_Encoder_end(state->encoder);
+    }
+    return status;
+}
+
+static SmolTLV_Status diff_container(DiffState *state, SmolTLV_Item base, SmolTLV_Item target);
+
+/** Value at index of current container changed */
+static SmolTLV_Status diff_value(DiffState *state, SmolTLV_Item base, SmolTLV_Item target, size_t index) {
+    if (item_size(base) == item_size(target) &&
+        memcmp(base.pointer, target.pointer, item_size(base)) == 0) {
+        return SMOLTLV_STATUS_OK;
+    }
+
+    SmolTLV_Type type = SmolTLV_Item_get_type(target);
+    if (type != SmolTLV_Item_get_type(base) || !is_list_or_dict(type) ||
+        state->depth + 1u >= SMOLTLV_DIFF_MAX_DEPTH) {
+        return diff_write_op(state, DIFF_OP_SET, index, true, target.pointer, item_size(target));
+    }
+
+    state->path[state->depth++] = index;
+    SmolTLV_Status status = diff_container(state, base, target);
+    state->depth--;
+    return status;
+}
+
+/** Inserts target spans [first, first + count) before base child index */
+static SmolTLV_Status diff_write_insert(DiffState *state, size_t index, size_t first, size_t count) {
+    // Spans are consecutive in target
+    const DiffSpan *start = &state->spans[first];
+    const DiffSpan *last = &state->spans[first + count - 1u];
+    return diff_write_op(state, DIFF_OP_INSERT, index, true, start->start,
+                         (size_t)(last->start + last->size - start->start));
+}
+
+/** Changed middle of lists, elements are paired by position. Spans are
+ * re-read as nested levels may grow the stack. */
+static SmolTLV_Status diff_list_elements(DiffState *state,
+                                         size_t base_first,
+                                         size_t base_count,
+                                         size_t target_first,
+                                         size_t target_count,
+                                         size_t index) {
+    SmolTLV_Status status = SMOLTLV_STATUS_OK;
+    size_t paired = base_count < target_count ? base_count : target_count;
+    for (size_t i = 0; i < paired && status == SMOLTLV_STATUS_OK; i++) {
+        SmolTLV_Item base_item = { state->spans[base_first + i].start };
+        SmolTLV_Item target_item = { state->spans[target_first + i].start };
+        status = diff_value(state, base_item, target_item, index + i);
+    }
+
+    if (status == SMOLTLV_STATUS_OK && base_count > paired) {
+        status = diff_write_remove(state, index + paired, base_count - paired);
+    } else if (status == SMOLTLV_STATUS_OK && target_count > paired) {
+        status = diff_write_insert(state, index + paired, target_first + paired, target_count - paired);
+    }
+    return status;
+}
+
+static uint64_t diff_key_hash(SmolTLV_Item key) {
+    return diff_hash(key.pointer, item_size(key));
+}
+
+/** Changed middle of dicts, entries are matched by key. Matches keeping
+ * base order are diffed, base entries between them are removed and
+ * target entries inserted, which keeps target order exactly. */
+static SmolTLV_Status diff_dict_entries(DiffState *state,
+                                       size_t base_first,
+                                       size_t base_count,
+                                       size_t target_first,
+                                       size_t target_count,
+                                       size_t index) {
+    if (base_count == 0 || target_count == 0) {
+        return diff_list_elements(state, base_first, base_count, target_first, target_count, index);
+    }
+
+    // Open addressing over base keys, slot holds base entry + 1
+    size_t slot_count = 4u;
+    while (slot_count < 2u * base_count) {
+        slot_count *= 2u;
+    }
+    size_t *slots = (size_t *)calloc(slot_count, sizeof(size_t));
+    if (!slots) {
+        return SMOLTLV_STATUS_OUT_OF_MEMORY;
+    }
+    for (size_t i = 0; i < base_count; i++) {
+        SmolTLV_Item key = { state->spans[base_first + i].start };
+        size_t slot = (size_t)diff_key_hash(key) & (slot_count - 1u);
+        while (slots[slot]) {
+            slot = (slot + 1u) & (slot_count - 1u);
+        }
+        slots[slot] = i + 1u;
+    }
+
+    SmolTLV_Status status = SMOLTLV_STATUS_OK;
+    size_t next_base = 0;
+    size_t pending = 0;
+    for (size_t t = 0; t < target_count && status == SMOLTLV_STATUS_OK; t++) {
+        SmolTLV_Item target_key = { state->spans[target_first + t].start };
+        size_t key_size = item_size(target_key);
+        size_t slot = (size_t)diff_key_hash(target_key) & (slot_count - 1u);
+        size_t match = SIZE_MAX;
+        for (; slots[slot]; slot = (slot + 1u) & (slot_count - 1u)) {
+            size_t candidate = slots[slot] - 1u;
+            const uint8_t *base_key = state->spans[base_first + candidate].start;
+            if (candidate >= next_base && item_size((SmolTLV_Item){ base_key }) == key_size &&
+                memcmp(base_key, target_key.pointer, key_size) == 0 &&
+                (match == SIZE_MAX || candidate < match)) {
+                match = candidate;
+            }
+        }
+        if (match == SIZE_MAX) {
+            pending++;
+            continue;
+        }
+
+        if (pending > 0) {
+            status = diff_write_insert(state, index + next_base, target_first + t - pending, pending);
+            pending = 0;
+        }
+        if (status == SMOLTLV_STATUS_OK && match > next_base) {
+            status = diff_write_remove(state, index + next_base, match - next_base);
+        }
+        if (status == SMOLTLV_STATUS_OK) {
+            SmolTLV_Item base_value = { state->spans[base_first + match].start + key_size };
+            SmolTLV_Item target_value = { target_key.pointer + key_size };
+            status = diff_value(state, base_value, target_value, index + match);
+        }
+        next_base = match + 1u;
+    }
+
+    if (status == SMOLTLV_STATUS_OK && pending > 0) {
+        status = diff_write_insert(state, index + next_base, target_first + target_count - pending, pending);
+    }
+    if (status == SMOLTLV_STATUS_OK && next_base < base_count) {
+        status = diff_write_remove(state, index + next_base, base_count - next_base);
+    }
+    free(slots);
+    return status;
+}
+
+static SmolTLV_Status diff_container(DiffState *state, SmolTLV_Item base, SmolTLV_Item target) {
+    bool is_dict = SmolTLV_Item_get_type(base) == SMOLTLV_TYPE_DICT;
+    size_t first = state->span_count;
+    size_t base_count, target_count;
+    SmolTLV_Status status = diff_collect(state, base, &base_count);
+    if (status == SMOLTLV_STATUS_OK) {
+        status = diff_collect(state, target, &target_count);
+    }
+    if (status != SMOLTLV_STATUS_OK) {
+        state->span_count = first;
+        return status;
+    }
+
+    // Unchanged children at both ends are skipped by comparing bytes
+    size_t base_first = first;
+    size_t target_first = first + base_count;
+    size_t prefix = 0;
+    size_t suffix = 0;
+    while (prefix < base_count && prefix < target_count &&
+           spans_equal(state->spans[base_first + prefix], state->spans[target_first + prefix])) {
+        prefix++;
+    }
+    while (suffix < base_count - prefix && suffix < target_count - prefix &&
+           spans_equal(state->spans[base_first + base_count - 1u - suffix],
+                       state->spans[target_first + target_count - 1u - suffix])) {
+        suffix++;
+    }
+
+    size_t base_rest = base_count - prefix - suffix;
+    size_t target_rest = target_count - prefix - suffix;
+    if (is_dict) {
+        status = diff_dict_entries(state, base_first + prefix, base_rest,
+                                   target_first + prefix, target_rest, prefix);
+    } else {
+        status = diff_list_elements(state, base_first + prefix, base_rest,
+                                    target_first + prefix, target_rest, prefix);
+    }
+
+    state->span_count = first;
+    return status;
+}
+
+SmolTLV_Status SmolTLV_diff(SmolTLV_Item base,
+                            SmolTLV_Item target,
+                            SmolTLV_Encoder *encoder) {
+    if (!base.pointer || !target.pointer || !encoder) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    DiffState state;
+    memset(&state, 0, sizeof(state));
+    state.encoder = encoder;
+
+    SmolTLV_Status status = SmolTLV_Encoder_start_list(encoder);
+    if (status == SMOLTLV_STATUS_OK) {
+        status = SmolTLV_Encoder_write_int(encoder, (int64_t)item_size(base));
+    }
+    if (status == SMOLTLV_STATUS_OK) {
+        status = SmolTLV_Encoder_write_int(encoder, (int64_t)diff_hash(base.pointer, item_size(base)));
+    }
+    if (status == SMOLTLV_STATUS_OK) {
+        status = SmolTLV_Encoder_write_int(encoder, (int64_t)item_size(target));
+    }
+    if (status == SMOLTLV_STATUS_OK) {
+        status = SmolTLV_Encoder_start_list(encoder);
+    }
+
+    if (status == SMOLTLV_STATUS_OK &&
+        (item_size(base) != item_size(target) || memcmp(base.pointer, target.pointer, item_size(base)) != 0)) {
+        SmolTLV_Type type = SmolTLV_Item_get_type(target);
+        if (type == SmolTLV_Item_get_type(base) && is_list_or_dict(type)) {
+            status = diff_container(&state, base, target);
+        } else {
+            status = diff_write_op(&state, DIFF_OP_SET, 0, false, target.pointer, item_size(target));
+        }
+    }
+
+    if (status == SMOLTLV_STATUS_OK) {
+        status = SmolTLV_Encoder_end(encoder);
+    }
+    if (status == SMOLTLV_STATUS_OK) {
+        status = SmolTLV_Encoder_end(encoder);
+    }
+    free(state.spans);
+    return status;
+}
+
+#endif /* SMOLTLV_NO_ENCODER */
+
+/*
+ * Apply
+ */
+
+typedef struct ApplyOp_s {
+    int64_t kind;
+    size_t path[SMOLTLV_DIFF_MAX_DEPTH];
+    size_t depth;
+    /** Item of set, items of insert */
+    const uint8_t *items;
+    size_t items_size;
+    /** Items of insert, children of remove */
+    size_t count;
+} ApplyOp;
+
+typedef struct ApplyState_s {
+    SmolTLV_Cursor ops;
+    ApplyOp op;
+    bool has_op;
+    /** Path of container being rebuilt */
+    size_t path[SMOLTLV_DIFF_MAX_DEPTH];
+    uint8_t *out;
+    size_t capacity;
+    size_t position;
+} ApplyState;
+
+/** Parses next operation, has_op is false after the last one */
+static SmolTLV_Status apply_next(ApplyState *state) {
+    SmolTLV_Item op_item, kind, path, index, payload;
+    SmolTLV_Cursor cursor, path_cursor;
+    ApplyOp *op = &state->op;
+    SmolTLV_Status status = SmolTLV_Cursor_next(&state->ops, &op_item);
+    if (status == SMOLTLV_STATUS_END) {
+        state->has_op = false;
+        return SMOLTLV_STATUS_OK;
+    }
+    if (status != SMOLTLV_STATUS_OK || SmolTLV_Item_get_type(op_item) != SMOLTLV_TYPE_LIST) {
+        return SMOLTLV_STATUS_INVALID_FORMAT;
+    }
+
+    SmolTLV_Cursor_init(&cursor, SmolTLV_Item_get_value(op_item), SmolTLV_Item_get_length(op_item));
+    if (SmolTLV_Cursor_next(&cursor, &kind) != SMOLTLV_STATUS_OK ||
+        SmolTLV_Cursor_next(&cursor, &path) != SMOLTLV_STATUS_OK ||
+        !SmolTLV_Item_as_int(kind, &op->kind) ||
+        SmolTLV_Item_get_type(path) != SMOLTLV_TYPE_LIST) {
+        return SMOLTLV_STATUS_INVALID_FORMAT;
+    }
+
+    op->depth = 0;
+    SmolTLV_Cursor_init(&path_cursor, SmolTLV_Item_get_value(path), SmolTLV_Item_get_length(path));
+    while ((status = SmolTLV_Cursor_next(&path_cursor, &index)) == SMOLTLV_STATUS_OK) {
+        int64_t value;
+        if (op->depth == SMOLTLV_DIFF_MAX_DEPTH || !SmolTLV_Item_as_int(index, &value) || value < 0) {
+            return SMOLTLV_STATUS_INVALID_FORMAT;
+        }
+        op->path[op->depth++] = (size_t)value;
+    }
+    if (status != SMOLTLV_STATUS_END) {
+        return SMOLTLV_STATUS_INVALID_FORMAT;
+    }
+
+    // Payload is the rest of operation
+    op->items = cursor.buffer + cursor.position;
+    op->items_size = cursor.size - cursor.position;
+    if (SmolTLV_Cursor_count(&cursor, &op->count) != SMOLTLV_STATUS_OK) {
+        return SMOLTLV_STATUS_INVALID_FORMAT;
+    }
+
+    int64_t count;
+    switch (op->kind) {
+    case DIFF_OP_SET:
+        if (op->count != 1u) {
+            return SMOLTLV_STATUS_INVALID_FORMAT;
+        }
+        break;
+    case DIFF_OP_REMOVE:
+        if (op->count != 1u || SmolTLV_Cursor_next(&cursor, &payload) != SMOLTLV_STATUS_OK ||
+            !SmolTLV_Item_as_int(payload, &count) || count < 1) {
+            return SMOLTLV_STATUS_INVALID_FORMAT;
+        }
+        op->count = (size_t)count;
+        break;
+    case DIFF_OP_INSERT:
+        if (op->count == 0) {
+            return SMOLTLV_STATUS_INVALID_FORMAT;
+        }
+        break;
+    default:
+        return SMOLTLV_STATUS_INVALID_FORMAT;
+    }
+    if (op->depth == 0 && op->kind != DIFF_OP_SET) {
+        return SMOLTLV_STATUS_INVALID_FORMAT;
+    }
+
+    state->has_op = true;
+    return SMOLTLV_STATUS_OK;
+}
+
+/** True when operation is inside container at depth */
+static bool apply_op_inside(const ApplyState *state, size_t depth) {
+    return state->has_op && state->op.depth > depth &&
+           memcmp(state->op.path, state->path, depth * sizeof(size_t)) == 0;
+}
+
+static SmolTLV_Status apply_write(ApplyState *state, const uint8_t *data, size_t size) {
+    if (state->capacity - state->position < size) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+    memcpy(state->out + state->position, data, size);
+    state->position += size;
+    return SMOLTLV_STATUS_OK;
+}
+
+/** Next child, for dicts out_value is value of entry */
+static SmolTLV_Status apply_next_child(SmolTLV_Cursor *cursor,
+                                       bool is_dict,
+                                       SmolTLV_Item *out_child,
+                                       SmolTLV_Item *out_value) {
+    SmolTLV_Status status = SmolTLV_Cursor_next(cursor, out_child);
+    if (status != SMOLTLV_STATUS_OK) {
+        return status == SMOLTLV_STATUS_END ? status : SMOLTLV_STATUS_INVALID_FORMAT;
+    }
+    *out_value = *out_child;
+    if (is_dict && SmolTLV_Cursor_next(cursor, out_value) != SMOLTLV_STATUS_OK) {
+        return SMOLTLV_STATUS_INVALID_FORMAT;
+    }
+    return SMOLTLV_STATUS_OK;
+}
+
+static SmolTLV_Status apply_container(ApplyState *state, SmolTLV_Item container, size_t depth) {
+    SmolTLV_Type type = SmolTLV_Item_get_type(container);
+    if (!is_list_or_dict(type)) {
+        return SMOLTLV_STATUS_INVALID_FORMAT;
+    }
+    bool is_dict = type == SMOLTLV_TYPE_DICT;
+
+    // Header is written once the length is known
+    size_t header = state->position;
+    if (state->capacity - state->position < 4u) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+    state->position += 4u;
+
+    SmolTLV_Cursor cursor;
+    SmolTLV_Item child, value;
+    SmolTLV_Status status = SMOLTLV_STATUS_OK;
+    const uint8_t *start = SmolTLV_Item_get_value(container);
+    const uint8_t *run = start;
+    SmolTLV_Cursor_for_item(&cursor, container);
+
+    for (size_t i = 0; status == SMOLTLV_STATUS_OK; i++) {
+        while (status == SMOLTLV_STATUS_OK && apply_op_inside(state, depth) &&
+               state->op.path[depth] == i && state->op.depth == depth + 1u &&
+               state->op.kind == DIFF_OP_INSERT) {
+            if (is_dict && state->op.count % 2u != 0) {
+                return SMOLTLV_STATUS_INVALID_FORMAT;
+            }
+            status = apply_write(state, run, (size_t)(start + cursor.position - run));
+            run = start + cursor.position;
+            if (status == SMOLTLV_STATUS_OK) {
+                status = apply_write(state, state->op.items, state->op.items_size);
+            }
+            if (status == SMOLTLV_STATUS_OK) {
+                status = apply_next(state);
+            }
+        }
+        if (status != SMOLTLV_STATUS_OK) {
+            return status;
+        }
+
+        const uint8_t *child_start = start + cursor.position;
+        status = apply_next_child(&cursor, is_dict, &child, &value);
+        if (status == SMOLTLV_STATUS_END) {
+            status = SMOLTLV_STATUS_OK;
+            break;
+        }
+        if (status != SMOLTLV_STATUS_OK || !apply_op_inside(state, depth)) {
+            continue;
+        }
+        if (state->op.path[depth] < i) {
+            return SMOLTLV_STATUS_INVALID_FORMAT;
+        }
+        if (state->op.path[depth] > i) {
+            continue;
+        }
+
+        // Unchanged children before this one are copied at once
+        status = apply_write(state, run, (size_t)(child_start - run));
+        bool descend = state->op.depth > depth + 1u;
+        if (status == SMOLTLV_STATUS_OK && is_dict && (descend || state->op.kind != DIFF_OP_REMOVE)) {
+            status = apply_write(state, child.pointer, item_size(child));
+        }
+        if (status != SMOLTLV_STATUS_OK) {
+            return status;
+        }
+
+        if (descend) {
+            state->path[depth] = i;
+            status = apply_container(state, value, depth + 1u);
+        } else if (state->op.kind == DIFF_OP_SET) {
+            status = apply_write(state, state->op.items, state->op.items_size);
+            if (status == SMOLTLV_STATUS_OK) {
+                status = apply_next(state);
+            }
+        } else {
+            for (size_t removed = 1; removed < state->op.count && status == SMOLTLV_STATUS_OK; removed++) {
+                status = apply_next_child(&cursor, is_dict, &child, &value);
+                i++;
+            }
+            if (status == SMOLTLV_STATUS_END) {
+                return SMOLTLV_STATUS_INVALID_FORMAT;
+            }
+            if (status == SMOLTLV_STATUS_OK) {
+                status = apply_next(state);
+            }
+        }
+        run = start + cursor.position;
+    }
+    if (status == SMOLTLV_STATUS_OK) {
+        status = apply_write(state, run, (size_t)(start + cursor.position - run));
+    }
+    if (status != SMOLTLV_STATUS_OK) {
+        return status;
+    }
+
+    // Operation left for this container points past its children
+    size_t length = state->position - header - 4u;
+    if (apply_op_inside(state, depth) || length > SMOLTLV_MAX_LENGTH) {
+        return SMOLTLV_STATUS_INVALID_FORMAT;
+    }
+    state->out[header] = container.pointer[0];
+    state->out[header + 1u] = (uint8_t)(length >> 16);
+    state->out[header + 2u] = (uint8_t)(length >> 8);
+    state->out[header + 3u] = (uint8_t)length;
+    return SMOLTLV_STATUS_OK;
+}
+
+SmolTLV_Status SmolTLV_diff_target_size(SmolTLV_Item patch,
+                                        size_t *out_size) {
+    int64_t base_size, base_hash, target_size;
+    SmolTLV_Item ops;
+    if (!out_size) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+    SmolTLV_Status status = diff_parse(patch, &base_size, &base_hash, &target_size, &ops);
+    if (status == SMOLTLV_STATUS_OK) {
+        *out_size = (size_t)target_size;
+    }
+    return status;
+}
+
+bool SmolTLV_diff_is_empty(SmolTLV_Item patch) {
+    int64_t base_size, base_hash, target_size;
+    SmolTLV_Item ops;
+    return diff_parse(patch, &base_size, &base_hash, &target_size, &ops) == SMOLTLV_STATUS_OK &&
+           SmolTLV_Item_get_length(ops) == 0;
+}
+
+SmolTLV_Status SmolTLV_diff_apply(SmolTLV_Item base,
+                                  SmolTLV_Item patch,
+                                  uint8_t *out,
+                                  size_t capacity,
+                                  size_t *out_size) {
+    int64_t base_size, base_hash, target_size;
+    SmolTLV_Item ops;
+    if (!base.pointer || !out) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+    SmolTLV_Status status = diff_parse(patch, &base_size, &base_hash, &target_size, &ops);
+    if (status != SMOLTLV_STATUS_OK) {
+        return status;
+    }
+    if ((uint64_t)base_size != item_size(base) || (uint64_t)target_size > capacity ||
+        (uint64_t)base_hash != diff_hash(base.pointer, item_size(base))) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    ApplyState state;
+    state.has_op = false;
+    state.out = out;
+    state.capacity = (size_t)target_size;
+    state.position = 0;
+    SmolTLV_Cursor_init(&state.ops, SmolTLV_Item_get_value(ops), SmolTLV_Item_get_length(ops));
+    status = apply_next(&state);
+
+    if (status == SMOLTLV_STATUS_OK && !state.has_op) {
+        status = apply_write(&state, base.pointer, item_size(base));
+    } else if (status == SMOLTLV_STATUS_OK && state.op.depth == 0) {
+        status = apply_write(&state, state.op.items, state.op.items_size);
+        if (status == SMOLTLV_STATUS_OK) {
+            status = apply_next(&state);
+        }
+    } else if (status == SMOLTLV_STATUS_OK) {
+        status = apply_container(&state, base, 0);
+    }
+
+    // Capacity is target size, anything not fitting is a bad patch
+    if (status == SMOLTLV_STATUS_INVALID_ARGUMENT ||
+        (status == SMOLTLV_STATUS_OK && (state.has_op || state.position != (size_t)target_size))) {
+        status = SMOLTLV_STATUS_INVALID_FORMAT;
+    }
+    if (status == SMOLTLV_STATUS_OK && out_size) {
+        *out_size = state.position;
+    }
+    return status;
+}
@@ -0,0 +1,98 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil -*-
+ * 
+ * SmolTLV - Simple serialization format for JSON/CBOR-like data model 
+ * for embedded devices - structural diff and patch.
+ * 
+ * Copyright (c) 2025 Aleš Hakl
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef H__SMOLTLV_DIFF
+#define H__SMOLTLV_DIFF
+
+#include <smoltlv.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Structural diff of two items into an encoded patch and rebuilding of
+ * the target from the base and the patch, for sending changes of large
+ * documents instead of whole documents.
+ *
+ * Identical subtrees are skipped by comparing their bytes. Children of
+ * changed lists and dicts are matched by common prefix and suffix, the
+ * rest of lists pairwise by position and of dicts by key (in base order,
+ * keys moved backwards are removed and inserted again): changed lists and
+ * dicts are descended into, other values are replaced, surplus children
+ * are removed or inserted.
+ * Apply copies unchanged runs of children with memcpy and rewrites only
+ * headers of containers on changed paths, so work on both sides scales
+ * with the change and the number of children on changed paths.
+ *
+ * Patch is a LIST: base size, base hash (FNV-1a of base item bytes),
+ * target size (INTs, sizes of whole items including headers) and LIST of operations ordered by path:
+ *   [0, path, item]        set, replaces child (value of dict entry)
+ *   [1, path, count]       remove, count children starting at path
+ *   [2, path, items...]    insert, items before child at path (for dicts
+ *                          key and value pairs), index equal to child
+ *                          count appends
+ * Path is a LIST of INT child indexes from the root (dict entries are
+ * counted as key and value pairs), empty path sets the root. Indexes
+ * refer to children of the base, inserts come before other operations on
+ * the same child. Patch is valid only for the base it was made from,
+ * apply checks its size and hash.
+ */
+
+#ifndef SMOLTLV_DIFF_MAX_DEPTH
+/** Changes below this depth replace the whole container */
+#define SMOLTLV_DIFF_MAX_DEPTH 64u
+#endif
+
+#ifndef SMOLTLV_NO_ENCODER
+/** Writes patch turning base into target into encoder */
+extern SmolTLV_Status SmolTLV_diff(SmolTLV_Item base,
+                                   SmolTLV_Item target,
+                                   SmolTLV_Encoder *encoder);
+#endif
+
+/** Size of item produced by SmolTLV_diff_apply */
+extern SmolTLV_Status SmolTLV_diff_target_size(SmolTLV_Item patch,
+                                               size_t *out_size);
+
+/** True when patch has no operations */
+extern bool SmolTLV_diff_is_empty(SmolTLV_Item patch);
+
+/** Writes target into out of at least SmolTLV_diff_target_size bytes.
+ * Returns SMOLTLV_STATUS_INVALID_ARGUMENT when base size or hash does not match
+ * or capacity is too small, SMOLTLV_STATUS_INVALID_FORMAT for malformed
+ * patch or operations not matching base. Out must not overlap base. */
+extern SmolTLV_Status SmolTLV_diff_apply(SmolTLV_Item base,
+                                         SmolTLV_Item patch,
+                                         uint8_t *out,
+                                         size_t capacity,
+                                         size_t *out_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // H__SMOLTLV_DIFF
@@ -0,0 +1,444 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil -*-
+ * 
+ * SmolTLV - Simple serialization format for JSON/CBOR-like data model 
+ * for embedded devices - materialized DOM.
+ * 
+ * Copyright (c) 2025 Aleš Hakl
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <smoltlv_dom.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct DomNode_s {
+    /** Item in document buffer */
+    const uint8_t *pointer;
+    /** First child node of list or dict */
+    uint32_t first;
+    /** List items or dict entries */
+    uint32_t count;
+    /** Offset of dict hash table in slots */
+    uint32_t table;
+    /** Slot mask for dicts, key hash for keys */
+    uint32_t aux;
+} DomNode;
+
+/*
+ * Single allocation: struct, nodes, string table entries, dict hash
+ * tables (entry index + 1, 0 for free slot).
+ */
+struct SmolTLV_Dom_s {
+    size_t memory;
+    size_t node_count;
+    size_t string_count;
+    DomNode *nodes;
+    SmolTLV_Item *strings;
+    uint32_t *slots;
+};
+
+/** FNV-1a */
+static uint32_t hash_key(const uint8_t *key, size_t length) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ key[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static size_t round_up_power_of_two(size_t value) {
+    size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+static void dom_layout(SmolTLV_Dom *dom) {
+    uint8_t *base = (uint8_t *)dom;
+    dom->nodes = (DomNode *)(base + sizeof(SmolTLV_Dom));
+    dom->strings = (SmolTLV_Item *)(dom->nodes + dom->node_count);
+    dom->slots = (uint32_t *)(dom->strings + dom->string_count);
+}
+
+/** Bytes of STRING node or STRING_REF resolved through string table */
+static bool dom_string(const SmolTLV_Dom *dom,
+                       SmolTLV_Item item,
+                       const uint8_t **out,
+                       size_t *out_len) {
+    uint32_t id;
+    if (SmolTLV_Item_as_string_ref(item, &id)) {
+        if (id >= dom->string_count) {
+            return false;
+        }
+        item = dom->strings[id];
+    }
+    if (SmolTLV_Item_get_type(item) != SMOLTLV_TYPE_STRING) {
+        return false;
+    }
+    *out = SmolTLV_Item_get_value(item);
+    *out_len = SmolTLV_Item_get_length(item);
+    return true;
+}
+
+/** Nodes in subtree of root, walking items in document order and
+ * descending into containers */
+static SmolTLV_Status dom_count_nodes(SmolTLV_Item root, size_t *out_count) {
+    size_t count = 1;
+    if (SmolTLV_Item_is_container(root)) {
+        SmolTLV_Cursor cursor;
+        SmolTLV_Item item;
+        SmolTLV_Status status;
+        SmolTLV_Cursor_init(&cursor, root.pointer, 4u + SmolTLV_Item_get_length(root));
+        cursor.position = 4u;
+        cursor.nested = true;
+
+        while ((status = SmolTLV_Cursor_next(&cursor, &item)) == SMOLTLV_STATUS_OK) {
+            // Node indexes and hash table offsets have to fit uint32_t
+            if (++count > (UINT32_MAX >> 1)) {
+                return SMOLTLV_STATUS_OUT_OF_MEMORY;
+            }
+            if (SmolTLV_Item_is_container(item)) {
+                cursor.position = (size_t)(item.pointer - root.pointer) + 4u;
+            }
+        }
+        if (status != SMOLTLV_STATUS_END) {
+            return SMOLTLV_STATUS_INVALID_FORMAT;
+        }
+    }
+    *out_count = count;
+    return SMOLTLV_STATUS_OK;
+}
+
+static bool dom_key_equal(const SmolTLV_Dom *dom,
+                          const DomNode *node,
+                          uint32_t hash,
+                          const uint8_t *key,
+                          size_t length) {
+    const uint8_t *bytes;
+    size_t bytes_length;
+    SmolTLV_Item item = { node->pointer };
+    return node->aux == hash &&
+           dom_string(dom, item, &bytes, &bytes_length) &&
+           bytes_length == length && memcmp(bytes, key, length) == 0;
+}
+
+/** Hashes keys of dict node, stops at first key that is not a string
+ * like dict_get does, duplicate keys keep first entry */
+static void dom_index_dict(SmolTLV_Dom *dom, DomNode *dict, size_t *slots_used) {
+    if (dict->count == 0) {
+        return;
+    }
+
+    size_t slot_count = round_up_power_of_two(2u * (size_t)dict->count);
+    uint32_t *table = dom->slots + *slots_used;
+    uint32_t mask = (uint32_t)(slot_count - 1u);
+    memset(table, 0, slot_count * sizeof(uint32_t));
+    dict->table = (uint32_t)*slots_used;
+    dict->aux = mask;
+    *slots_used += slot_count;
+
+    for (uint32_t entry = 0; entry < dict->count; entry++) {
+        DomNode *key = &dom->nodes[dict->first + 2u * entry];
+        SmolTLV_Item item = { key->pointer };
+        const uint8_t *bytes;
+        size_t length;
+        if (!dom_string(dom, item, &bytes, &length)) {
+            break;
+        }
+
+        uint32_t hash = hash_key(bytes, length);
+        uint32_t slot = hash & mask;
+        bool duplicate = false;
+        key->aux = hash;
+        while (table[slot] && !duplicate) {
+            const DomNode *other = &dom->nodes[dict->first + 2u * (table[slot] - 1u)];
+            duplicate = dom_key_equal(dom, other, hash, bytes, length);
+            slot = (slot + 1u) & mask;
+        }
+        if (!duplicate) {
+            table[slot] = entry + 1u;
+        }
+    }
+}
+
+/** Appends children of containers in breadth-first order, node array is
+ * the queue */
+static SmolTLV_Status dom_build(SmolTLV_Dom *dom, size_t *out_slots_used) {
+    size_t count = 1;
+    size_t slots_used = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        DomNode *node = &dom->nodes[i];
+        SmolTLV_Item item = { node->pointer };
+        if (!SmolTLV_Item_is_container(item)) {
+            continue;
+        }
+
+        SmolTLV_Cursor cursor;
+        SmolTLV_Item child;
+        SmolTLV_Status status;
+        node->first = (uint32_t)count;
+        SmolTLV_Cursor_for_item(&cursor, item);
+        while ((status = SmolTLV_Cursor_next(&cursor, &child)) == SMOLTLV_STATUS_OK) {
+            if (count == dom->node_count) {
+                return SMOLTLV_STATUS_INVALID_FORMAT;
+            }
+            DomNode *child_node = &dom->nodes[count++];
+            child_node->pointer = child.pointer;
+            child_node->first = 0;
+            child_node->count = 0;
+            child_node->table = 0;
+            child_node->aux = 0;
+        }
+        if (status != SMOLTLV_STATUS_END) {
+            return SMOLTLV_STATUS_INVALID_FORMAT;
+        }
+
+        node->count = (uint32_t)(count - node->first);
+        if (SmolTLV_Item_get_type(item) == SMOLTLV_TYPE_DICT) {
+            if (node->count % 2u != 0u) {
+                return SMOLTLV_STATUS_INVALID_FORMAT;
+            }
+            node->count /= 2u;
+            dom_index_dict(dom, node, &slots_used);
+        }
+    }
+
+    if (count != dom->node_count) {
+        return SMOLTLV_STATUS_INVALID_FORMAT;
+    }
+    *out_slots_used = slots_used;
+    return SMOLTLV_STATUS_OK;
+}
+
+SmolTLV_Status SmolTLV_Dom_create(const uint8_t *buffer,
+                                  size_t size,
+                                  SmolTLV_Dom **out) {
+    if (!buffer || !out) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+    *out = NULL;
+
+    // Leading string table resolves STRING_REF keys
+    SmolTLV_Cursor cursor;
+    SmolTLV_Item item;
+    SmolTLV_Item table = { NULL };
+    SmolTLV_Status status;
+    SmolTLV_Cursor_init(&cursor, buffer, size);
+    while ((status = SmolTLV_Cursor_next(&cursor, &item)) == SMOLTLV_STATUS_OK) {
+        if (SmolTLV_Item_get_type(item) != SMOLTLV_TYPE_STRING_TABLE) {
+            break;
+        }
+        if (!table.pointer) {
+            table = item;
+        }
+    }
+    if (status == SMOLTLV_STATUS_END) {
+        return SMOLTLV_STATUS_END;
+    }
+    if (status != SMOLTLV_STATUS_OK) {
+        return SMOLTLV_STATUS_INVALID_FORMAT;
+    }
+
+    size_t string_count = 0;
+    if (table.pointer) {
+        SmolTLV_Cursor entries;
+        SmolTLV_Cursor_for_item(&entries, table);
+        if (SmolTLV_Cursor_count(&entries, &string_count) != SMOLTLV_STATUS_OK) {
+            return SMOLTLV_STATUS_INVALID_FORMAT;
+        }
+    }
+
+    size_t node_count;
+    status = dom_count_nodes(item, &node_count);
+    if (status != SMOLTLV_STATUS_OK) {
+        return status;
+    }
+
+    // Dict with n entries has 2n child nodes and at most 4n slots
+    size_t per_node = sizeof(DomNode) + 2u * sizeof(uint32_t);
+    if (node_count > (SIZE_MAX - sizeof(SmolTLV_Dom) - string_count * sizeof(SmolTLV_Item)) / per_node) {
+        return SMOLTLV_STATUS_OUT_OF_MEMORY;
+    }
+    size_t memory = sizeof(SmolTLV_Dom) +
+                    node_count * sizeof(DomNode) +
+                    string_count * sizeof(SmolTLV_Item) +
+                    2u * node_count * sizeof(uint32_t);
+    SmolTLV_Dom *dom = (SmolTLV_Dom *)malloc(memory);
+    if (!dom) {
+        return SMOLTLV_STATUS_OUT_OF_MEMORY;
+    }
+    dom->node_count = node_count;
+    dom->string_count = string_count;
+    dom_layout(dom);
+
+    if (table.pointer) {
+        SmolTLV_Cursor entries;
+        SmolTLV_Item entry;
+        size_t i = 0;
+        SmolTLV_Cursor_for_item(&entries, table);
+        while (SmolTLV_Cursor_next(&entries, &entry) == SMOLTLV_STATUS_OK) {
+            dom->strings[i++] = entry;
+        }
+    }
+
+    dom->nodes[0].pointer = item.pointer;
+    dom->nodes[0].first = 0;
+    dom->nodes[0].count = 0;
+    dom->nodes[0].table = 0;
+    dom->nodes[0].aux = 0;
+
+    size_t slots_used;
+    status = dom_build(dom, &slots_used);
+    if (status != SMOLTLV_STATUS_OK) {
+        free(dom);
+        return status;
+    }
+
+    // Give back unused part of worst case hash table space
+    size_t used = memory - (2u * node_count - slots_used) * sizeof(uint32_t);
+    SmolTLV_Dom *shrunk = (SmolTLV_Dom *)realloc(dom, used);
+    if (shrunk) {
+        dom = shrunk;
+        dom_layout(dom);
+        memory = used;
+    }
+    dom->memory = memory;
+
+    *out = dom;
+    return SMOLTLV_STATUS_OK;
+}
+
+void SmolTLV_Dom_destroy(SmolTLV_Dom *dom) {
+    free(dom);
+}
+
+size_t SmolTLV_Dom_node_count(const SmolTLV_Dom *dom) {
+    return dom ? dom->node_count : 0;
+}
+
+size_t SmolTLV_Dom_memory(const SmolTLV_Dom *dom) {
+    return dom ? dom->memory : 0;
+}
+
+SmolTLV_Item SmolTLV_Dom_get_item(const SmolTLV_Dom *dom, SmolTLV_DomNode node) {
+    SmolTLV_Item item = { dom->nodes[node].pointer };
+    return item;
+}
+
+SmolTLV_Type SmolTLV_Dom_get_type(const SmolTLV_Dom *dom, SmolTLV_DomNode node) {
+    return (SmolTLV_Type)dom->nodes[node].pointer[0];
+}
+
+size_t SmolTLV_Dom_get_count(const SmolTLV_Dom *dom, SmolTLV_DomNode node) {
+    return dom->nodes[node].count;
+}
+
+bool SmolTLV_Dom_list_at(const SmolTLV_Dom *dom,
+                         SmolTLV_DomNode list,
+                         size_t index,
+                         SmolTLV_DomNode *out) {
+    if (!dom || list >= dom->node_count) {
+        return false;
+    }
+
+    const DomNode *node = &dom->nodes[list];
+    if (node->pointer[0] != SMOLTLV_TYPE_LIST || index >= node->count) {
+        return false;
+    }
+    if (out) {
+        *out = node->first + (uint32_t)index;
+    }
+    return true;
+}
+
+bool SmolTLV_Dom_dict_get(const SmolTLV_Dom *dom,
+                          SmolTLV_DomNode dict,
+                          const char *key,
+                          SmolTLV_DomNode *out) {
+    if (!dom || !key || dict >= dom->node_count) {
+        return false;
+    }
+
+    const DomNode *node = &dom->nodes[dict];
+    if (node->pointer[0] != SMOLTLV_TYPE_DICT || node->count == 0) {
+        return false;
+    }
+
+    size_t length = strlen(key);
+    uint32_t hash = hash_key((const uint8_t *)key, length);
+    const uint32_t *table = dom->slots + node->table;
+    for (uint32_t slot = hash & node->aux; table[slot]; slot = (slot + 1u) & node->aux) {
+        uint32_t key_node = node->first + 2u * (table[slot] - 1u);
+        if (dom_key_equal(dom, &dom->nodes[key_node], hash, (const uint8_t *)key, length)) {
+            if (out) {
+                *out = key_node + 1u;
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+bool SmolTLV_Dom_dict_entry(const SmolTLV_Dom *dom,
+                            SmolTLV_DomNode dict,
+                            size_t index,
+                            SmolTLV_DomNode *out_key,
+                            SmolTLV_DomNode *out_value) {
+    if (!dom || dict >= dom->node_count) {
+        return false;
+    }
+
+    const DomNode *node = &dom->nodes[dict];
+    if (node->pointer[0] != SMOLTLV_TYPE_DICT || index >= node->count) {
+        return false;
+    }
+    if (out_key) {
+        *out_key = node->first + 2u * (uint32_t)index;
+    }
+    if (out_value) {
+        *out_value = node->first + 2u * (uint32_t)index + 1u;
+    }
+    return true;
+}
+
+bool SmolTLV_Dom_get_string(const SmolTLV_Dom *dom,
+                            SmolTLV_DomNode node,
+                            const char **out,
+                            size_t *out_len) {
+    if (!dom || node >= dom->node_count) {
+        return false;
+    }
+
+    const uint8_t *bytes;
+    size_t length;
+    SmolTLV_Item item = { dom->nodes[node].pointer };
+    if (!dom_string(dom, item, &bytes, &length)) {
+        return false;
+    }
+    if (out) {
+        *out = (const char *)bytes;
+    }
+    if (out_len) {
+        *out_len = length;
+    }
+    return true;
+}
@@ -0,0 +1,104 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil -*-
+ * 
+ * SmolTLV - Simple serialization format for JSON/CBOR-like data model 
+ * for embedded devices - materialized DOM.
+ * 
+ * Copyright (c) 2025 Aleš Hakl
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef H__SMOLTLV_DOM
+#define H__SMOLTLV_DOM
+
+#include <smoltlv.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Materialized document for repeated random access. SmolTLV_Dom_create
+ * walks the document once and builds flat array of nodes in a single
+ * allocation: children of each container are consecutive nodes (dict
+ * children alternate key and value), dicts get hash table of their keys.
+ * List access is constant time, dict lookups are hashed, strings are
+ * returned as views into the original buffer, which has to outlive the
+ * DOM.
+ *
+ * Only LIST and DICT have child nodes, other items (arrays, record
+ * batches, chunked values, ...) are leaves accessed through their
+ * SmolTLV_Item. STRING_REF values and keys are resolved through the
+ * string table when buffer starts with one. Dict lookups give the same
+ * results as SmolTLV_Item_dict_get_interned, including keys after the
+ * first key that is not a string not being found.
+ */
+
+typedef struct SmolTLV_Dom_s SmolTLV_Dom;
+
+/** Node index, root is node 0 */
+typedef uint32_t SmolTLV_DomNode;
+
+/** Builds DOM of first top-level item other than string table. Returns
+ * SMOLTLV_STATUS_INVALID_FORMAT for malformed or truncated document and
+ * SMOLTLV_STATUS_END when there is no such item. */
+extern SmolTLV_Status SmolTLV_Dom_create(const uint8_t *buffer,
+                                         size_t size,
+                                         SmolTLV_Dom **out);
+/** Frees all nodes and tables */
+extern void SmolTLV_Dom_destroy(SmolTLV_Dom *dom);
+
+extern size_t SmolTLV_Dom_node_count(const SmolTLV_Dom *dom);
+/** Bytes allocated for the DOM */
+extern size_t SmolTLV_Dom_memory(const SmolTLV_Dom *dom);
+
+/** Node has to be less than node count */
+extern SmolTLV_Item SmolTLV_Dom_get_item(const SmolTLV_Dom *dom, SmolTLV_DomNode node);
+extern SmolTLV_Type SmolTLV_Dom_get_type(const SmolTLV_Dom *dom, SmolTLV_DomNode node);
+/** Number of list items or dict entries, 0 for other nodes. Node has to 
+ * be less than node count. */
+extern size_t SmolTLV_Dom_get_count(const SmolTLV_Dom *dom, SmolTLV_DomNode node);
+
+extern bool SmolTLV_Dom_list_at(const SmolTLV_Dom *dom,
+                                SmolTLV_DomNode list,
+                                size_t index,
+                                SmolTLV_DomNode *out);
+extern bool SmolTLV_Dom_dict_get(const SmolTLV_Dom *dom,
+                                 SmolTLV_DomNode dict,
+                                 const char *key,
+                                 SmolTLV_DomNode *out);
+/** Entry of dict in encoded order */
+extern bool SmolTLV_Dom_dict_entry(const SmolTLV_Dom *dom,
+                                   SmolTLV_DomNode dict,
+                                   size_t index,
+                                   SmolTLV_DomNode *out_key,
+                                   SmolTLV_DomNode *out_value);
+
+/** View of STRING (or resolved STRING_REF) node into buffer, not
+ * terminated by \0 */
+extern bool SmolTLV_Dom_get_string(const SmolTLV_Dom *dom,
+                                   SmolTLV_DomNode node,
+                                   const char **out,
+                                   size_t *out_len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // H__SMOLTLV_DOM
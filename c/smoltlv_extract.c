@@ -0,0 +1,402 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil -*-
+ * 
+ * SmolTLV - Simple serialization format for JSON/CBOR-like data model 
+ * for embedded devices - columnar extraction from record streams.
+ * 
+ * Copyright (c) 2025 Aleš Hakl
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <smoltlv_extract.h>
+#include <string.h>
+#include <stdlib.h>
+#ifndef SMOLTLV_NO_THREADS
+#include <pthread.h>
+#endif
+
+#define EXTRACT_MAX_THREADS 64u
+
+typedef struct ExtractRecord_s {
+    SmolTLV_Item record;
+    SmolTLV_Item table;
+} ExtractRecord;
+
+/*
+ * Header-only walk over the stream, records the position of each record
+ * together with string table in effect (out can be NULL for counting).
+ */
+static SmolTLV_Status index_records(const uint8_t *buffer,
+                                    size_t size,
+                                    ExtractRecord *out,
+                                    size_t *out_count) {
+    SmolTLV_Cursor cursor;
+    SmolTLV_Item item;
+    SmolTLV_Item table = { NULL };
+    SmolTLV_Status status;
+    size_t count = 0;
+
+    SmolTLV_Cursor_init(&cursor, buffer, size);
+    while ((status = SmolTLV_Cursor_next(&cursor, &item)) == SMOLTLV_STATUS_OK) {
+        if (SmolTLV_Item_get_type(item) == SMOLTLV_TYPE_STRING_TABLE) {
+            table = item;
+            continue;
+        }
+        if (out) {
+            out[count].record = item;
+            out[count].table = table;
+        }
+        count++;
+    }
+
+    if (status != SMOLTLV_STATUS_END) {
+        return status;
+    }
+
+    *out_count = count;
+    return SMOLTLV_STATUS_OK;
+}
+
+SmolTLV_Status SmolTLV_extract_count(const uint8_t *buffer,
+                                     size_t size,
+                                     size_t *out_count) {
+    if (!buffer || !out_count) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+    return index_records(buffer, size, NULL, out_count);
+}
+
+static size_t column_element_size(SmolTLV_ColumnType type) {
+    switch (type) {
+    case SMOLTLV_COLUMN_INT64:  return sizeof(int64_t);
+    case SMOLTLV_COLUMN_DOUBLE: return sizeof(double);
+    case SMOLTLV_COLUMN_BOOL:   return sizeof(uint8_t);
+    case SMOLTLV_COLUMN_ITEM:   return sizeof(SmolTLV_Item);
+    default:                    return 0u;
+    }
+}
+
+static bool convert_value(SmolTLV_Item item,
+                          SmolTLV_ColumnType type,
+                          void *out) {
+    switch (type) {
+    case SMOLTLV_COLUMN_INT64:
+        return SmolTLV_Item_as_int(item, (int64_t *)out);
+
+    case SMOLTLV_COLUMN_DOUBLE: {
+        int64_t int_value;
+        size_t count;
+        if (SmolTLV_Item_as_int(item, &int_value)) {
+            *(double *)out = (double)int_value;
+            return true;
+        }
+        if (SmolTLV_Item_array_count(item, &count) && count == 1u) {
+            return SmolTLV_Item_array_get_float(item, 0, (double *)out);
+        }
+        return false;
+    }
+
+    case SMOLTLV_COLUMN_BOOL: {
+        bool value;
+        if (!SmolTLV_Item_as_bool(item, &value)) {
+            return false;
+        }
+        *(uint8_t *)out = value ? 1u : 0u;
+        return true;
+    }
+
+    case SMOLTLV_COLUMN_ITEM:
+        *(SmolTLV_Item *)out = item;
+        return true;
+    }
+
+    return false;
+}
+
+typedef enum ExtractPhase_e {
+    EXTRACT_PHASE_FILTER,
+    EXTRACT_PHASE_FILL,
+} ExtractPhase;
+
+typedef struct ExtractJob_s {
+    const SmolTLV_Extract *extract;
+    const ExtractRecord *records;
+    const size_t *selection;
+    uint8_t *selected;
+    ExtractPhase phase;
+    size_t begin;
+    size_t end;
+    /** Path keys of all columns one after another, resolved against
+     * keys_table, NULL when they could not be allocated */
+    SmolTLV_Key *keys;
+    const uint8_t *keys_table;
+    bool keys_resolved;
+} ExtractJob;
+
+static size_t path_length(const char *const *path) {
+    size_t length = 0;
+    while (path[length]) {
+        length++;
+    }
+    return length;
+}
+
+/** Resolves path keys against string table of record when it differs
+ * from the previous one, records of a stream usually share one table */
+static void resolve_keys(ExtractJob *job, const ExtractRecord *record) {
+    if (job->keys_resolved && job->keys_table == record->table.pointer) {
+        return;
+    }
+
+    SmolTLV_StringTable table;
+    SmolTLV_StringTable_init(&table, record->table);
+    SmolTLV_Key *key = job->keys;
+    for (size_t i = 0; i < job->extract->column_count; i++) {
+        for (const char *const *path = job->extract->columns[i].path; *path; path++) {
+            SmolTLV_Key_init(key++, &table, *path);
+        }
+    }
+    job->keys_table = record->table.pointer;
+    job->keys_resolved = true;
+}
+
+static bool get_path_keys(SmolTLV_Item item, const SmolTLV_Key *keys, size_t count, SmolTLV_Item *out) {
+    for (size_t i = 0; i < count; i++) {
+        if (!SmolTLV_Item_dict_get_key(item, &keys[i], &item)) {
+            return false;
+        }
+    }
+    *out = item;
+    return true;
+}
+
+static void extract_row(ExtractJob *job,
+                        const ExtractRecord *record,
+                        size_t row) {
+    const SmolTLV_Extract *extract = job->extract;
+    SmolTLV_StringTable table;
+    SmolTLV_StringTable_init(&table, record->table);
+    if (job->keys) {
+        resolve_keys(job, record);
+    }
+
+    const SmolTLV_Key *keys = job->keys;
+    for (size_t i = 0; i < extract->column_count; i++) {
+        const SmolTLV_ExtractColumn *column = &extract->columns[i];
+        size_t element_size = column_element_size(column->type);
+        uint8_t *value = (uint8_t *)column->values + row * element_size;
+        SmolTLV_Item item;
+        bool found;
+
+        if (keys) {
+            size_t length = path_length(column->path);
+            found = get_path_keys(record->record, keys, length, &item);
+            keys += length;
+        } else {
+            found = SmolTLV_Item_get_path(record->record, &table, column->path, &item);
+        }
+        bool valid = found && convert_value(item, column->type, value);
+        if (!valid) {
+            memset(value, 0, element_size);
+        }
+
+        if (column->validity) {
+            uint8_t mask = (uint8_t)(1u << (row & 7u));
+            if (valid) {
+                column->validity[row >> 3] |= mask;
+            } else {
+                column->validity[row >> 3] &= (uint8_t)~mask;
+            }
+        }
+    }
+}
+
+static void *extract_worker(void *arg) {
+    ExtractJob *job = (ExtractJob *)arg;
+    const SmolTLV_Extract *extract = job->extract;
+
+    if (job->phase == EXTRACT_PHASE_FILL) {
+        // Without memory for keys paths are resolved for every row
+        size_t key_count = 0;
+        for (size_t i = 0; i < extract->column_count; i++) {
+            key_count += path_length(extract->columns[i].path);
+        }
+        job->keys = (SmolTLV_Key *)malloc((key_count ? key_count : 1u) * sizeof(SmolTLV_Key));
+        job->keys_resolved = false;
+    }
+
+    for (size_t i = job->begin; i < job->end; i++) {
+        if (job->phase == EXTRACT_PHASE_FILTER) {
+            job->selected[i] = extract->predicate(job->records[i].record,
+                                                  extract->predicate_context);
+        } else {
+            size_t index = job->selection ? job->selection[i] : i;
+            extract_row(job, &job->records[index], i);
+        }
+    }
+
+    free(job->keys);
+    job->keys = NULL;
+    return NULL;
+}
+
+/*
+ * Splits [0, count) between threads. Ranges of the fill phase are aligned
+ * to 8 rows so that no two threads share a byte of validity bitmap.
+ */
+static void run_jobs(const ExtractJob *template, size_t count) {
+    ExtractJob jobs[EXTRACT_MAX_THREADS];
+    size_t thread_count = template->extract->thread_count;
+    if (thread_count < 1u) {
+        thread_count = 1u;
+    }
+    if (thread_count > EXTRACT_MAX_THREADS) {
+        thread_count = EXTRACT_MAX_THREADS;
+    }
+
+    size_t chunk = (count + thread_count - 1u) / thread_count;
+    chunk = (chunk + 7u) & ~(size_t)7u;
+
+    size_t job_count = 0;
+    for (size_t begin = 0; begin < count; begin += chunk) {
+        jobs[job_count] = *template;
+        jobs[job_count].begin = begin;
+        jobs[job_count].end = (count - begin > chunk) ? begin + chunk : count;
+        job_count++;
+    }
+
+#ifndef SMOLTLV_NO_THREADS
+    pthread_t threads[EXTRACT_MAX_THREADS];
+    bool started[EXTRACT_MAX_THREADS];
+
+    for (size_t i = 1; i < job_count; i++) {
+        started[i] = pthread_create(&threads[i], NULL, extract_worker, &jobs[i]) == 0;
+        if (!started[i]) {
+            extract_worker(&jobs[i]);
+        }
+    }
+    if (job_count > 0u) {
+        extract_worker(&jobs[0]);
+    }
+    for (size_t i = 1; i < job_count; i++) {
+        if (started[i]) {
+            pthread_join(threads[i], NULL);
+        }
+    }
+#else
+    for (size_t i = 0; i < job_count; i++) {
+        extract_worker(&jobs[i]);
+    }
+#endif
+}
+
+SmolTLV_Status SmolTLV_extract(const SmolTLV_Extract *extract,
+                               const uint8_t *buffer,
+                               size_t size,
+                               size_t capacity,
+                               size_t *out_rows) {
+    if (!extract || !buffer || !out_rows) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    for (size_t i = 0; i < extract->column_count; i++) {
+        const SmolTLV_ExtractColumn *column = &extract->columns[i];
+        if (!column->path || !column->values ||
+            column_element_size(column->type) == 0u) {
+            return SMOLTLV_STATUS_INVALID_ARGUMENT;
+        }
+    }
+
+    size_t record_count;
+    SmolTLV_Status status = index_records(buffer, size, NULL, &record_count);
+    if (status != SMOLTLV_STATUS_OK) {
+        return status;
+    }
+
+    if (!extract->predicate && record_count > capacity) {
+        *out_rows = record_count;
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    ExtractRecord *records = (ExtractRecord *)malloc(
+        (record_count ? record_count : 1u) * sizeof(ExtractRecord)
+    );
+    if (!records) {
+        return SMOLTLV_STATUS_OUT_OF_MEMORY;
+    }
+    index_records(buffer, size, records, &record_count);
+
+    ExtractJob job;
+    memset(&job, 0, sizeof(job));
+    job.extract = extract;
+    job.records = records;
+
+    size_t row_count = record_count;
+    size_t *selection = NULL;
+
+    if (extract->predicate) {
+        uint8_t *selected = (uint8_t *)malloc(record_count ? record_count : 1u);
+        if (!selected) {
+            free(records);
+            return SMOLTLV_STATUS_OUT_OF_MEMORY;
+        }
+
+        job.phase = EXTRACT_PHASE_FILTER;
+        job.selected = selected;
+        run_jobs(&job, record_count);
+
+        row_count = 0;
+        for (size_t i = 0; i < record_count; i++) {
+            row_count += selected[i];
+        }
+
+        if (row_count > capacity) {
+            free(selected);
+            free(records);
+            *out_rows = row_count;
+            return SMOLTLV_STATUS_INVALID_ARGUMENT;
+        }
+
+        selection = (size_t *)malloc((row_count ? row_count : 1u) * sizeof(size_t));
+        if (!selection) {
+            free(selected);
+            free(records);
+            return SMOLTLV_STATUS_OUT_OF_MEMORY;
+        }
+
+        size_t row = 0;
+        for (size_t i = 0; i < record_count; i++) {
+            if (selected[i]) {
+                selection[row++] = i;
+            }
+        }
+        free(selected);
+    }
+
+    job.phase = EXTRACT_PHASE_FILL;
+    job.selection = selection;
+    run_jobs(&job, row_count);
+
+    free(selection);
+    free(records);
+    *out_rows = row_count;
+    return SMOLTLV_STATUS_OK;
+}
@@ -0,0 +1,94 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil -*-
+ * 
+ * SmolTLV - Simple serialization format for JSON/CBOR-like data model 
+ * for embedded devices - columnar extraction from record streams.
+ * 
+ * Copyright (c) 2025 Aleš Hakl
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef H__SMOLTLV_EXTRACT
+#define H__SMOLTLV_EXTRACT
+
+#include <smoltlv.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Extracts selected fields from a stream of top-level records (usually
+ * DICT items, STRING_TABLE items in the stream apply to records following
+ * them) into flat column arrays with validity bitmaps.
+ *
+ * Missing values and values not convertible to the column type are stored
+ * as zero and marked invalid in the bitmap.
+ */
+
+typedef enum SmolTLV_ColumnType_e {
+    SMOLTLV_COLUMN_INT64,   /* int64_t, from INT items */
+    SMOLTLV_COLUMN_DOUBLE,  /* double, from INT items and 1 element float arrays */
+    SMOLTLV_COLUMN_BOOL,    /* uint8_t 0/1 */
+    SMOLTLV_COLUMN_ITEM,    /* SmolTLV_Item pointing into the input buffer */
+} SmolTLV_ColumnType;
+
+typedef struct SmolTLV_ExtractColumn_s {
+    /** NULL terminated list of dict keys */
+    const char *const *path;
+    SmolTLV_ColumnType type;
+    /** Array of capacity elements of column type */
+    void *values;
+    /** Optional bitmap of (capacity + 7) / 8 bytes, bit i (LSB first) set
+     * when row i is valid */
+    uint8_t *validity;
+} SmolTLV_ExtractColumn;
+
+/** Record filter, records for which predicate returns false are skipped,
+ * called concurrently from worker threads */
+typedef bool (*SmolTLV_ExtractPredicate)(SmolTLV_Item record, void *context);
+
+typedef struct SmolTLV_Extract_s {
+    SmolTLV_ExtractColumn *columns;
+    size_t column_count;
+    SmolTLV_ExtractPredicate predicate;
+    void *predicate_context;
+    /** Number of worker threads, 0 or 1 extracts in calling thread */
+    unsigned thread_count;
+} SmolTLV_Extract;
+
+/** Number of records in stream */
+extern SmolTLV_Status SmolTLV_extract_count(const uint8_t *buffer,
+                                            size_t size,
+                                            size_t *out_count);
+
+/** Fills columns from records in buffer. When selected rows do not fit
+ * into capacity, returns SMOLTLV_STATUS_INVALID_ARGUMENT and sets out_rows
+ * to required capacity. */
+extern SmolTLV_Status SmolTLV_extract(const SmolTLV_Extract *extract,
+                                      const uint8_t *buffer,
+                                      size_t size,
+                                      size_t capacity,
+                                      size_t *out_rows);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // H__SMOLTLV_EXTRACT
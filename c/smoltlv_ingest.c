@@ -0,0 +1,615 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil -*-
+ * 
+ * SmolTLV - Simple serialization format for JSON/CBOR-like data model 
+ * for embedded devices - batched ingestion.
+ * 
+ * Copyright (c) 2025 Aleš Hakl
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#define _GNU_SOURCE
+
+#include <smoltlv_ingest.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+#ifndef SMOLTLV_NO_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+
+#define INGEST_MIN_BUFFER_SIZE 64u
+#define INGEST_EPOLL_EVENTS 64
+
+typedef struct IngestSource_s {
+    SmolTLV_IngestSource source;
+    uint8_t *buffer;
+    size_t capacity;
+    /** Unconsumed data is buffer[start, end) */
+    size_t start;
+    size_t end;
+    bool done;
+    /** Buffer registered with the ring at source index */
+    bool fixed;
+    /** Waited for with epoll (regular files are always readable) */
+    bool polled;
+} IngestSource;
+
+struct SmolTLV_Ingest_s {
+    IngestSource *sources;
+    size_t source_count;
+    size_t source_capacity;
+    size_t buffer_size;
+    /** Sources not done */
+    size_t active;
+    SmolTLV_IngestStats stats;
+
+    /** Sources waiting for a read, circular */
+    size_t *queue;
+    size_t queue_head;
+    size_t queue_count;
+    size_t queue_capacity;
+
+    int epoll_fd;
+    size_t polled;
+
+    /** -1 without io_uring */
+    int ring_fd;
+#ifndef SMOLTLV_NO_IO_URING
+    unsigned entries;
+    unsigned in_flight;
+    unsigned fixed_count;
+    void *sq_ring;
+    size_t sq_ring_size;
+    void *cq_ring;
+    size_t cq_ring_size;
+    struct io_uring_sqe *sqes;
+    size_t sqes_size;
+    unsigned *sq_head;
+    unsigned *sq_tail;
+    unsigned *sq_array;
+    unsigned sq_mask;
+    /** SQ tail not yet published to the kernel */
+    unsigned sq_local_tail;
+    unsigned *cq_head;
+    unsigned *cq_tail;
+    struct io_uring_cqe *cqes;
+    unsigned cq_mask;
+#endif
+};
+
+static void queue_push(SmolTLV_Ingest *ingest, size_t index) {
+    size_t slot = (ingest->queue_head + ingest->queue_count) % ingest->queue_capacity;
+    ingest->queue[slot] = index;
+    ingest->queue_count++;
+}
+
+static size_t queue_pop(SmolTLV_Ingest *ingest) {
+    size_t index = ingest->queue[ingest->queue_head];
+    ingest->queue_head = (ingest->queue_head + 1u) % ingest->queue_capacity;
+    ingest->queue_count--;
+    return index;
+}
+
+/*
+ * io_uring through raw system calls
+ */
+
+#ifndef SMOLTLV_NO_IO_URING
+
+static int ring_setup(unsigned entries, struct io_uring_params *params) {
+    return (int)syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int ring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+static int ring_register(int fd, unsigned opcode, const void *arg, unsigned nr_args) {
+    return (int)syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+}
+
+/** Sets registered buffer slot, NULL buffer clears it */
+static bool ring_register_buffer(SmolTLV_Ingest *ingest,
+                                 size_t index,
+                                 void *buffer,
+                                 size_t length) {
+    struct iovec iov = { buffer, length };
+    struct io_uring_rsrc_update2 update;
+    memset(&update, 0, sizeof(update));
+    update.offset = (uint32_t)index;
+    update.data = (uint64_t)(uintptr_t)&iov;
+    update.nr = 1;
+    return ring_register(ingest->ring_fd, IORING_REGISTER_BUFFERS_UPDATE,
+                         &update, sizeof(update)) >= 0;
+}
+
+static void ring_destroy(SmolTLV_Ingest *ingest) {
+    if (ingest->sqes) {
+        munmap(ingest->sqes, ingest->sqes_size);
+    }
+    if (ingest->cq_ring && ingest->cq_ring != ingest->sq_ring) {
+        munmap(ingest->cq_ring, ingest->cq_ring_size);
+    }
+    if (ingest->sq_ring) {
+        munmap(ingest->sq_ring, ingest->sq_ring_size);
+    }
+    if (ingest->ring_fd >= 0) {
+        close(ingest->ring_fd);
+    }
+    ingest->sqes = NULL;
+    ingest->cq_ring = NULL;
+    ingest->sq_ring = NULL;
+    ingest->ring_fd = -1;
+}
+
+/** False when io_uring is not available, ingest then uses epoll */
+static bool ring_init(SmolTLV_Ingest *ingest, unsigned depth, unsigned fixed_buffers) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    ingest->ring_fd = ring_setup(depth, &params);
+    if (ingest->ring_fd < 0) {
+        ingest->ring_fd = -1;
+        return false;
+    }
+    // Reads at file position need 5.6+
+    if (!(params.features & IORING_FEAT_RW_CUR_POS)) {
+        ring_destroy(ingest);
+        return false;
+    }
+
+    ingest->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ingest->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        if (ingest->cq_ring_size > ingest->sq_ring_size) {
+            ingest->sq_ring_size = ingest->cq_ring_size;
+        }
+        ingest->cq_ring_size = ingest->sq_ring_size;
+    }
+
+    void *sq_ring = mmap(NULL, ingest->sq_ring_size, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_POPULATE, ingest->ring_fd, IORING_OFF_SQ_RING);
+    if (sq_ring == MAP_FAILED) {
+        ring_destroy(ingest);
+        return false;
+    }
+    ingest->sq_ring = sq_ring;
+
+    void *cq_ring = sq_ring;
+    if (!(params.features & IORING_FEAT_SINGLE_MMAP)) {
+        cq_ring = mmap(NULL, ingest->cq_ring_size, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, ingest->ring_fd, IORING_OFF_CQ_RING);
+        if (cq_ring == MAP_FAILED) {
+            ring_destroy(ingest);
+            return false;
+        }
+    }
+    ingest->cq_ring = cq_ring;
+
+    ingest->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    void *sqes = mmap(NULL, ingest->sqes_size, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, ingest->ring_fd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        ring_destroy(ingest);
+        return false;
+    }
+    ingest->sqes = (struct io_uring_sqe *)sqes;
+
+    uint8_t *sq = (uint8_t *)sq_ring;
+    uint8_t *cq = (uint8_t *)cq_ring;
+    ingest->sq_head = (unsigned *)(sq + params.sq_off.head);
+    ingest->sq_tail = (unsigned *)(sq + params.sq_off.tail);
+    ingest->sq_array = (unsigned *)(sq + params.sq_off.array);
+    ingest->sq_mask = *(unsigned *)(sq + params.sq_off.ring_mask);
+    ingest->sq_local_tail = *ingest->sq_tail;
+    ingest->cq_head = (unsigned *)(cq + params.cq_off.head);
+    ingest->cq_tail = (unsigned *)(cq + params.cq_off.tail);
+    ingest->cqes = (struct io_uring_cqe *)(cq + params.cq_off.cqes);
+    ingest->cq_mask = *(unsigned *)(cq + params.cq_off.ring_mask);
+    ingest->entries = params.sq_entries;
+
+    // Sparse buffer table filled as sources are added (5.19+), reads
+    // fall back to IORING_OP_READ without it
+    if (fixed_buffers > 0) {
+        struct io_uring_rsrc_register reg;
+        memset(&reg, 0, sizeof(reg));
+        reg.nr = fixed_buffers;
+        reg.flags = IORING_RSRC_REGISTER_SPARSE;
+        if (ring_register(ingest->ring_fd, IORING_REGISTER_BUFFERS2, &reg, sizeof(reg)) == 0) {
+            ingest->fixed_count = fixed_buffers;
+        }
+    }
+    return true;
+}
+
+static void ring_queue_read(SmolTLV_Ingest *ingest, size_t index) {
+    IngestSource *source = &ingest->sources[index];
+    unsigned tail = ingest->sq_local_tail;
+    unsigned slot = tail & ingest->sq_mask;
+    struct io_uring_sqe *sqe = &ingest->sqes[slot];
+
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = source->fixed ? IORING_OP_READ_FIXED : IORING_OP_READ;
+    sqe->fd = source->source.fd;
+    // Current file position, ignored for pipes and sockets
+    sqe->off = (uint64_t)-1;
+    sqe->addr = (uint64_t)(uintptr_t)(source->buffer + source->end);
+    sqe->len = (uint32_t)(source->capacity - source->end);
+    sqe->buf_index = source->fixed ? (uint16_t)index : 0u;
+    sqe->user_data = index;
+    ingest->sq_array[slot] = slot;
+    ingest->sq_local_tail = tail + 1u;
+    ingest->in_flight++;
+}
+
+#endif
+
+/*
+ * Framing
+ */
+
+static void ingest_finish(SmolTLV_Ingest *ingest,
+                          IngestSource *source,
+                          SmolTLV_Status status,
+                          int error) {
+    source->done = true;
+    ingest->active--;
+    if (source->polled) {
+        epoll_ctl(ingest->epoll_fd, EPOLL_CTL_DEL, source->source.fd, NULL);
+        source->polled = false;
+        ingest->polled--;
+    }
+#ifndef SMOLTLV_NO_IO_URING
+    if (source->fixed) {
+        ring_register_buffer(ingest, (size_t)(source - ingest->sources), NULL, 0);
+        source->fixed = false;
+    }
+#endif
+    free(source->buffer);
+    source->buffer = NULL;
+
+    if (source->source.on_end) {
+        source->source.on_end(status, error, source->source.context);
+    }
+}
+
+/** Moves partial item to buffer start and grows buffer to fit it */
+static bool ingest_make_room(SmolTLV_Ingest *ingest, IngestSource *source) {
+    size_t pending = source->end - source->start;
+    if (source->start > 0) {
+        memmove(source->buffer, source->buffer + source->start, pending);
+        source->start = 0;
+        source->end = pending;
+    }
+    if (pending < 4u) {
+        return true;
+    }
+
+    // Header of pending item was validated by SmolTLV_Cursor_next
+    SmolTLV_Item item = { source->buffer };
+    size_t needed = 4u + (size_t)SmolTLV_Item_get_length(item);
+    if (needed <= source->capacity) {
+        return true;
+    }
+
+    size_t capacity = source->capacity;
+    while (capacity < needed) {
+        capacity *= 2u;
+    }
+    uint8_t *buffer = (uint8_t *)realloc(source->buffer, capacity);
+    if (!buffer) {
+        ingest_finish(ingest, source, SMOLTLV_STATUS_OUT_OF_MEMORY, 0);
+        return false;
+    }
+    source->buffer = buffer;
+    source->capacity = capacity;
+#ifndef SMOLTLV_NO_IO_URING
+    if (source->fixed) {
+        source->fixed = ring_register_buffer(ingest, (size_t)(source - ingest->sources),
+                                             buffer, capacity);
+    }
+#endif
+    return true;
+}
+
+/** Passes complete items of read (result is byte count or -errno) to
+ * callback, false when source ended */
+static bool ingest_complete(SmolTLV_Ingest *ingest, IngestSource *source, ssize_t result) {
+    ingest->stats.reads++;
+    if (result < 0) {
+        int error = (int)-result;
+        if (error == EAGAIN || error == EINTR) {
+            return true;
+        }
+        ingest_finish(ingest, source, SMOLTLV_STATUS_INVALID_STATE, error);
+        return false;
+    }
+    if (result == 0) {
+        ingest_finish(ingest, source,
+                      source->end > source->start ? SMOLTLV_STATUS_NEED_MORE_DATA
+                                                  : SMOLTLV_STATUS_OK,
+                      0);
+        return false;
+    }
+    source->end += (size_t)result;
+    ingest->stats.bytes += (size_t)result;
+
+    SmolTLV_Cursor cursor;
+    SmolTLV_Item item;
+    SmolTLV_Status status;
+    SmolTLV_Cursor_init(&cursor, source->buffer, source->end);
+    cursor.position = source->start;
+    while ((status = SmolTLV_Cursor_next(&cursor, &item)) == SMOLTLV_STATUS_OK) {
+        ingest->stats.items++;
+        status = source->source.on_item(item, source->source.context);
+        if (status != SMOLTLV_STATUS_OK) {
+            ingest_finish(ingest, source, status, 0);
+            return false;
+        }
+    }
+    if (status == SMOLTLV_STATUS_INVALID_FORMAT) {
+        ingest_finish(ingest, source, SMOLTLV_STATUS_INVALID_FORMAT, 0);
+        return false;
+    }
+
+    source->start = cursor.position;
+    return ingest_make_room(ingest, source);
+}
+
+/** Single read(2) of source, false when source ended */
+static bool ingest_read(SmolTLV_Ingest *ingest, size_t index) {
+    IngestSource *source = &ingest->sources[index];
+    ssize_t result = read(source->source.fd,
+                          source->buffer + source->end,
+                          source->capacity - source->end);
+    ingest->stats.syscalls++;
+    return ingest_complete(ingest, source, result < 0 ? -(ssize_t)errno : result);
+}
+
+/*
+ * Event loops
+ */
+
+#ifndef SMOLTLV_NO_IO_URING
+static SmolTLV_Status ingest_run_ring(SmolTLV_Ingest *ingest) {
+    while (ingest->active > 0) {
+        while (ingest->queue_count > 0 && ingest->in_flight < ingest->entries) {
+            ring_queue_read(ingest, queue_pop(ingest));
+        }
+        __atomic_store_n(ingest->sq_tail, ingest->sq_local_tail, __ATOMIC_RELEASE);
+
+        // One system call submits all queued reads and waits for any
+        unsigned to_submit = ingest->sq_local_tail - __atomic_load_n(ingest->sq_head, __ATOMIC_ACQUIRE);
+        int result = ring_enter(ingest->ring_fd, to_submit, 1u, IORING_ENTER_GETEVENTS);
+        ingest->stats.syscalls++;
+        if (result < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+            return SMOLTLV_STATUS_INVALID_STATE;
+        }
+
+        unsigned head = *ingest->cq_head;
+        unsigned tail = __atomic_load_n(ingest->cq_tail, __ATOMIC_ACQUIRE);
+        while (head != tail) {
+            const struct io_uring_cqe *cqe = &ingest->cqes[head & ingest->cq_mask];
+            size_t index = (size_t)cqe->user_data;
+            ssize_t read_result = cqe->res;
+            head++;
+            __atomic_store_n(ingest->cq_head, head, __ATOMIC_RELEASE);
+
+            ingest->in_flight--;
+            if (ingest_complete(ingest, &ingest->sources[index], read_result)) {
+                queue_push(ingest, index);
+            }
+        }
+    }
+    return SMOLTLV_STATUS_OK;
+}
+#endif
+
+static SmolTLV_Status ingest_run_epoll(SmolTLV_Ingest *ingest) {
+    if (ingest->epoll_fd < 0) {
+        ingest->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        if (ingest->epoll_fd < 0) {
+            return SMOLTLV_STATUS_INVALID_STATE;
+        }
+    }
+
+    // Level triggered, one read per readiness. Regular files cannot be
+    // polled and stay in the queue.
+    size_t count = ingest->queue_count;
+    for (size_t i = 0; i < count; i++) {
+        size_t index = queue_pop(ingest);
+        struct epoll_event event;
+        memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN;
+        event.data.u64 = index;
+        if (epoll_ctl(ingest->epoll_fd, EPOLL_CTL_ADD, ingest->sources[index].source.fd, &event) == 0) {
+            ingest->sources[index].polled = true;
+            ingest->polled++;
+        } else {
+            queue_push(ingest, index);
+        }
+    }
+
+    struct epoll_event events[INGEST_EPOLL_EVENTS];
+    while (ingest->active > 0) {
+        count = ingest->queue_count;
+        for (size_t i = 0; i < count; i++) {
+            size_t index = queue_pop(ingest);
+            if (ingest_read(ingest, index)) {
+                queue_push(ingest, index);
+            }
+        }
+        if (ingest->polled == 0) {
+            continue;
+        }
+
+        int ready = epoll_wait(ingest->epoll_fd, events, INGEST_EPOLL_EVENTS,
+                               ingest->queue_count > 0 ? 0 : -1);
+        ingest->stats.syscalls++;
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return SMOLTLV_STATUS_INVALID_STATE;
+        }
+        for (int i = 0; i < ready; i++) {
+            size_t index = (size_t)events[i].data.u64;
+            if (!ingest->sources[index].done) {
+                ingest_read(ingest, index);
+            }
+        }
+    }
+    return SMOLTLV_STATUS_OK;
+}
+
+/*
+ * Public API
+ */
+
+SmolTLV_Status SmolTLV_Ingest_create(const SmolTLV_IngestConfig *config,
+                                     SmolTLV_Ingest **out) {
+    if (!out) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    SmolTLV_Ingest *ingest = (SmolTLV_Ingest *)calloc(1, sizeof(SmolTLV_Ingest));
+    if (!ingest) {
+        return SMOLTLV_STATUS_OUT_OF_MEMORY;
+    }
+    ingest->epoll_fd = -1;
+    ingest->ring_fd = -1;
+    ingest->buffer_size = config && config->buffer_size
+        ? config->buffer_size : SMOLTLV_INGEST_DEFAULT_BUFFER_SIZE;
+    if (ingest->buffer_size < INGEST_MIN_BUFFER_SIZE) {
+        ingest->buffer_size = INGEST_MIN_BUFFER_SIZE;
+    }
+
+#ifndef SMOLTLV_NO_IO_URING
+    if (!config || !config->no_io_uring) {
+        unsigned depth = config && config->queue_depth
+            ? config->queue_depth : SMOLTLV_INGEST_DEFAULT_QUEUE_DEPTH;
+        unsigned fixed_buffers = config
+            ? config->fixed_buffers : SMOLTLV_INGEST_DEFAULT_FIXED_BUFFERS;
+        ring_init(ingest, depth, fixed_buffers);
+    }
+#endif
+
+    *out = ingest;
+    return SMOLTLV_STATUS_OK;
+}
+
+void SmolTLV_Ingest_destroy(SmolTLV_Ingest *ingest) {
+    if (!ingest) {
+        return;
+    }
+
+    for (size_t i = 0; i < ingest->source_count; i++) {
+        free(ingest->sources[i].buffer);
+    }
+    free(ingest->sources);
+    free(ingest->queue);
+    if (ingest->epoll_fd >= 0) {
+        close(ingest->epoll_fd);
+    }
+#ifndef SMOLTLV_NO_IO_URING
+    ring_destroy(ingest);
+#endif
+    free(ingest);
+}
+
+bool SmolTLV_Ingest_uses_io_uring(const SmolTLV_Ingest *ingest) {
+    return ingest && ingest->ring_fd >= 0;
+}
+
+SmolTLV_Status SmolTLV_Ingest_add(SmolTLV_Ingest *ingest,
+                                  const SmolTLV_IngestSource *source) {
+    if (!ingest || !source || source->fd < 0 || !source->on_item) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    if (ingest->source_count == ingest->source_capacity) {
+        size_t capacity = ingest->source_capacity ? 2u * ingest->source_capacity : 16u;
+        IngestSource *sources = (IngestSource *)realloc(ingest->sources,
+                                                        capacity * sizeof(IngestSource));
+        if (!sources) {
+            return SMOLTLV_STATUS_OUT_OF_MEMORY;
+        }
+        ingest->sources = sources;
+        ingest->source_capacity = capacity;
+    }
+
+    size_t index = ingest->source_count;
+    IngestSource *entry = &ingest->sources[index];
+    memset(entry, 0, sizeof(*entry));
+    entry->source = *source;
+    entry->capacity = ingest->buffer_size;
+    entry->buffer = (uint8_t *)malloc(entry->capacity);
+    if (!entry->buffer) {
+        return SMOLTLV_STATUS_OUT_OF_MEMORY;
+    }
+#ifndef SMOLTLV_NO_IO_URING
+    if (ingest->ring_fd >= 0 && index < ingest->fixed_count) {
+        entry->fixed = ring_register_buffer(ingest, index, entry->buffer, entry->capacity);
+    }
+#endif
+    ingest->source_count++;
+    return SMOLTLV_STATUS_OK;
+}
+
+SmolTLV_Status SmolTLV_Ingest_run(SmolTLV_Ingest *ingest) {
+    if (!ingest) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    if (ingest->queue_capacity < ingest->source_count) {
+        size_t *queue = (size_t *)realloc(ingest->queue, ingest->source_count * sizeof(size_t));
+        if (!queue) {
+            return SMOLTLV_STATUS_OUT_OF_MEMORY;
+        }
+        ingest->queue = queue;
+        ingest->queue_capacity = ingest->source_count;
+    }
+    ingest->queue_head = 0;
+    ingest->queue_count = 0;
+    for (size_t i = 0; i < ingest->source_count; i++) {
+        if (!ingest->sources[i].done) {
+            queue_push(ingest, i);
+        }
+    }
+    ingest->active = ingest->queue_count;
+
+#ifndef SMOLTLV_NO_IO_URING
+    if (ingest->ring_fd >= 0) {
+        return ingest_run_ring(ingest);
+    }
+#endif
+    return ingest_run_epoll(ingest);
+}
+
+void SmolTLV_Ingest_get_stats(const SmolTLV_Ingest *ingest, SmolTLV_IngestStats *out) {
+    if (!ingest || !out) {
+        return;
+    }
+    *out = ingest->stats;
+}
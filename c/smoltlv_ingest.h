@@ -0,0 +1,128 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil -*-
+ * 
+ * SmolTLV - Simple serialization format for JSON/CBOR-like data model 
+ * for embedded devices - batched ingestion.
+ * 
+ * Copyright (c) 2025 Aleš Hakl
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef H__SMOLTLV_INGEST
+#define H__SMOLTLV_INGEST
+
+#include <smoltlv.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Ingestion of top-level items from many files, pipes and sockets
+ * (Linux). Every source is read into its own buffer, one read per source
+ * in flight; complete items are passed to the source's callback pointing
+ * into the buffer, partial item at the end waits for the next read.
+ * Buffer grows when a single item does not fit.
+ *
+ * With io_uring, reads of all sources are submitted and reaped through
+ * one ring, a single io_uring_enter per batch. Source buffers are
+ * registered with the ring when the kernel allows it (READ_FIXED),
+ * otherwise plain reads are used. Without io_uring (older kernel,
+ * blocked by seccomp, config.no_io_uring or SMOLTLV_NO_IO_URING)
+ * pollable sources are waited for with epoll and read with read(2),
+ * regular files are read directly.
+ *
+ * Files are read from their current position. Descriptors are not
+ * closed. STRING_TABLE items are passed to the callback like any other
+ * item.
+ */
+
+typedef struct SmolTLV_Ingest_s SmolTLV_Ingest;
+
+/** Called for every complete top-level item, item is valid only during
+ * the call. Status other than SMOLTLV_STATUS_OK stops reading the
+ * source. */
+typedef SmolTLV_Status (*SmolTLV_IngestItemFunction)(SmolTLV_Item item,
+                                                     void *context);
+/** Called once when source ends: SMOLTLV_STATUS_OK at end of input after
+ * a complete item, SMOLTLV_STATUS_NEED_MORE_DATA for truncated last item,
+ * SMOLTLV_STATUS_INVALID_FORMAT, SMOLTLV_STATUS_INVALID_STATE for read
+ * errors (error is errno, 0 otherwise) or status of item callback. */
+typedef void (*SmolTLV_IngestEndFunction)(SmolTLV_Status status,
+                                          int error,
+                                          void *context);
+
+typedef struct SmolTLV_IngestSource_s {
+    int fd;
+    SmolTLV_IngestItemFunction on_item;
+    /** Can be NULL */
+    SmolTLV_IngestEndFunction on_end;
+    void *context;
+} SmolTLV_IngestSource;
+
+typedef struct SmolTLV_IngestConfig_s {
+    /** Reads in flight (io_uring queue size) */
+    unsigned queue_depth;
+    /** Initial buffer size of a source */
+    size_t buffer_size;
+    /** Sources with registered buffers, later sources use plain reads */
+    unsigned fixed_buffers;
+    /** Use epoll and read even when io_uring is available */
+    bool no_io_uring;
+} SmolTLV_IngestConfig;
+
+#define SMOLTLV_INGEST_DEFAULT_QUEUE_DEPTH 256u
+#define SMOLTLV_INGEST_DEFAULT_BUFFER_SIZE (64u * 1024u)
+#define SMOLTLV_INGEST_DEFAULT_FIXED_BUFFERS 1024u
+
+typedef struct SmolTLV_IngestStats_s {
+    /** Items passed to callbacks */
+    size_t items;
+    size_t bytes;
+    /** Completed reads */
+    size_t reads;
+    /** io_uring_enter, epoll_wait and read calls */
+    size_t syscalls;
+} SmolTLV_IngestStats;
+
+/** Config can be NULL for defaults */
+extern SmolTLV_Status SmolTLV_Ingest_create(const SmolTLV_IngestConfig *config,
+                                            SmolTLV_Ingest **out);
+extern void SmolTLV_Ingest_destroy(SmolTLV_Ingest *ingest);
+
+/** True when reads go through io_uring */
+extern bool SmolTLV_Ingest_uses_io_uring(const SmolTLV_Ingest *ingest);
+
+/** Adds source read by the next SmolTLV_Ingest_run, must not be called
+ * from callbacks */
+extern SmolTLV_Status SmolTLV_Ingest_add(SmolTLV_Ingest *ingest,
+                                         const SmolTLV_IngestSource *source);
+
+/** Reads all sources until they end. Returns SMOLTLV_STATUS_INVALID_STATE
+ * when waiting for reads fails, per source results go to on_end. */
+extern SmolTLV_Status SmolTLV_Ingest_run(SmolTLV_Ingest *ingest);
+
+extern void SmolTLV_Ingest_get_stats(const SmolTLV_Ingest *ingest,
+                                     SmolTLV_IngestStats *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // H__SMOLTLV_INGEST
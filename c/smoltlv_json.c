@@ -0,0 +1,1026 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil -*-
+ * 
+ * SmolTLV - Simple serialization format for JSON/CBOR-like data model 
+ * for embedded devices - JSON transcoding.
+ * 
+ * Copyright (c) 2025 Aleš Hakl
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <smoltlv_json.h>
+#include <smoltlv_writer.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#define JSON_NUMBER_SIZE 64u
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define JSON_SWAR_DIGITS 1
+#endif
+
+static bool is_whitespace(uint8_t c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+static bool is_digit(uint8_t c) {
+    return (uint8_t)(c - '0') < 10u;
+}
+
+/*
+ * Structural scanning, with SSE2 16 bytes are classified per step
+ */
+
+/** First byte in [p, end) which is '"', '\\' or a control character */
+static const uint8_t *scan_string(const uint8_t *p, const uint8_t *end) {
+#ifdef __SSE2__
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i control = _mm_set1_epi8(0x1F);
+    while (end - p >= 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)p);
+        __m128i special = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+            _mm_cmpeq_epi8(_mm_max_epu8(chunk, control), control)
+        );
+        int mask = _mm_movemask_epi8(special);
+        if (mask != 0) {
+            return p + __builtin_ctz((unsigned)mask);
+        }
+        p += 16;
+    }
+#endif
+    while (p < end && *p != '"' && *p != '\\' && *p >= 0x20u) {
+        p++;
+    }
+    return p;
+}
+
+static const uint8_t *skip_whitespace(const uint8_t *p, const uint8_t *end) {
+    while (p < end && is_whitespace(*p)) {
+#ifdef __SSE2__
+        // Long runs come from indentation of pretty printed documents
+        if (end - p >= 16) {
+            __m128i chunk = _mm_loadu_si128((const __m128i *)p);
+            __m128i space = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(' ')),
+                             _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\n'))),
+                _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\r')),
+                             _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\t')))
+            );
+            unsigned mask = ~(unsigned)_mm_movemask_epi8(space) & 0xFFFFu;
+            if (mask != 0u) {
+                return p + __builtin_ctz(mask);
+            }
+            p += 16;
+            continue;
+        }
+#endif
+        p++;
+    }
+    return p;
+}
+
+/*
+ * JSON -> SmolTLV
+ */
+
+#ifndef SMOLTLV_NO_ENCODER
+
+typedef struct JsonParser_s {
+    const uint8_t *p;
+    const uint8_t *end;
+    SmolTLV_Encoder *encoder;
+    /** Unescaped string */
+    uint8_t *scratch;
+    size_t scratch_length;
+    size_t scratch_capacity;
+} JsonParser;
+
+static bool scratch_append(JsonParser *parser, const uint8_t *data, size_t length) {
+    if (length == 0u) {
+        return true;
+    }
+    if (parser->scratch_length + length > parser->scratch_capacity) {
+        size_t capacity = parser->scratch_capacity ? parser->scratch_capacity * 2u : 256u;
+        while (capacity < parser->scratch_length + length) {
+            capacity *= 2u;
+        }
+        uint8_t *scratch = (uint8_t *)realloc(parser->scratch, capacity);
+        if (!scratch) {
+            return false;
+        }
+        parser->scratch = scratch;
+        parser->scratch_capacity = capacity;
+    }
+    memcpy(parser->scratch + parser->scratch_length, data, length);
+    parser->scratch_length += length;
+    return true;
+}
+
+static bool parse_hex4(const uint8_t *p, const uint8_t *end, uint32_t *out) {
+    if (end - p < 4) {
+        return false;
+    }
+    uint32_t value = 0;
+    for (size_t i = 0; i < 4u; i++) {
+        uint8_t c = p[i];
+        uint32_t digit;
+        if (is_digit(c)) {
+            digit = (uint32_t)(c - '0');
+        } else if (c >= 'a' && c <= 'f') {
+            digit = (uint32_t)(c - 'a' + 10);
+        } else if (c >= 'A' && c <= 'F') {
+            digit = (uint32_t)(c - 'A' + 10);
+        } else {
+            return false;
+        }
+        value = (value << 4) | digit;
+    }
+    *out = value;
+    return true;
+}
+
+static size_t utf8_encode(uint32_t code_point, uint8_t *out) {
+    if (code_point < 0x80u) {
+        out[0] = (uint8_t)code_point;
+        return 1;
+    }
+    if (code_point < 0x800u) {
+        out[0] = (uint8_t)(0xC0u | (code_point >> 6));
+        out[1] = (uint8_t)(0x80u | (code_point & 0x3Fu));
+        return 2;
+    }
+    if (code_point < 0x10000u) {
+        out[0] = (uint8_t)(0xE0u | (code_point >> 12));
+        out[1] = (uint8_t)(0x80u | ((code_point >> 6) & 0x3Fu));
+        out[2] = (uint8_t)(0x80u | (code_point & 0x3Fu));
+        return 3;
+    }
+    out[0] = (uint8_t)(0xF0u | (code_point >> 18));
+    out[1] = (uint8_t)(0x80u | ((code_point >> 12) & 0x3Fu));
+    out[2] = (uint8_t)(0x80u | ((code_point >> 6) & 0x3Fu));
+    out[3] = (uint8_t)(0x80u | (code_point & 0x3Fu));
+    return 4;
+}
+
+/** Decodes escape sequence after backslash at p, appends it to scratch */
+static SmolTLV_Status parse_escape(JsonParser *parser) {
+    const uint8_t *p = parser->p + 1;
+    if (p >= parser->end) {
+        return SMOLTLV_STATUS_INVALID_FORMAT;
+    }
+
+    uint8_t utf8[4];
+    size_t length = 1;
+    switch (*p) {
+    case '"':  utf8[0] = '"'; break;
+    case '\\': utf8[0] = '\\'; break;
+    case '/':  utf8[0] = '/'; break;
+    case 'b':  utf8[0] = '\b'; break;
+    case 'f':  utf8[0] = '\f'; break;
+    case 'n':  utf8[0] = '\n'; break;
+    case 'r':  utf8[0] = '\r'; break;
+    case 't':  utf8[0] = '\t'; break;
+    case 'u': {
+        uint32_t code_point, low;
+        if (!parse_hex4(p + 1, parser->end, &code_point)) {
+            return SMOLTLV_STATUS_INVALID_FORMAT;
+        }
+        p += 4;
+        if (code_point >= 0xDC00u && code_point <= 0xDFFFu) {
+            return SMOLTLV_STATUS_INVALID_FORMAT;
+        }
+        if (code_point >= 0xD800u && code_point <= 0xDBFFu) {
+            // Surrogate pair
+            if (parser->end - p < 7 || p[1] != '\\' || p[2] != 'u' ||
+                !parse_hex4(p + 3, parser->end, &low) ||
+                low < 0xDC00u || low > 0xDFFFu) {
+                return SMOLTLV_STATUS_INVALID_FORMAT;
+            }
+            code_point = 0x10000u + ((code_point - 0xD800u) << 10) + (low - 0xDC00u);
+            p += 6;
+        }
+        length = utf8_encode(code_point, utf8);
+        break;
+    }
+    default:
+        return SMOLTLV_STATUS_INVALID_FORMAT;
+    }
+
+    if (!scratch_append(parser, utf8, length)) {
+        return SMOLTLV_STATUS_OUT_OF_MEMORY;
+    }
+    parser->p = p + 1;
+    return SMOLTLV_STATUS_OK;
+}
+
+/** Parses string at opening quote, result points into input when there
+ * are no escapes and to scratch otherwise */
+static SmolTLV_Status parse_string(JsonParser *parser,
+                                   const uint8_t **out,
+                                   size_t *out_length) {
+    const uint8_t *start = parser->p + 1;
+    const uint8_t *s = scan_string(start, parser->end);
+    if (s < parser->end && *s == '"') {
+        *out = start;
+        *out_length = (size_t)(s - start);
+        parser->p = s + 1;
+        return SMOLTLV_STATUS_OK;
+    }
+
+    parser->scratch_length = 0;
+    for (;;) {
+        if (s >= parser->end || *s < 0x20u) {
+            parser->p = s;
+            return SMOLTLV_STATUS_INVALID_FORMAT;
+        }
+        if (!scratch_append(parser, start, (size_t)(s - start))) {
+            return SMOLTLV_STATUS_OUT_OF_MEMORY;
+        }
+        if (*s == '"') {
+            break;
+        }
+
+        parser->p = s;
+        SmolTLV_Status status = parse_escape(parser);
+        if (status != SMOLTLV_STATUS_OK) {
+            return status;
+        }
+        start = parser->p;
+        s = scan_string(start, parser->end);
+    }
+
+    *out = parser->scratch;
+    *out_length = parser->scratch_length;
+    parser->p = s + 1;
+    return SMOLTLV_STATUS_OK;
+}
+
+static SmolTLV_Status parse_string_item(JsonParser *parser) {
+    const uint8_t *string;
+    size_t length;
+    SmolTLV_Status status = parse_string(parser, &string, &length);
+    if (status != SMOLTLV_STATUS_OK) {
+        return status;
+    }
+    return SmolTLV_Encoder_write_primitive(parser->encoder, SMOLTLV_TYPE_STRING,
+                                           string, length);
+}
+
+#ifdef JSON_SWAR_DIGITS
+static bool is_eight_digits(uint64_t value) {
+    return ((value & 0xF0F0F0F0F0F0F0F0ull) |
+            (((value + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull) >> 4))
+        == 0x3333333333333333ull;
+}
+
+/** Converts 8 ASCII digits loaded in little-endian order */
+static uint64_t parse_eight_digits(uint64_t value) {
+    value -= 0x3030303030303030ull;
+    value = (value * 10u) + (value >> 8);
+    value = (((value & 0x000000FF000000FFull) * (100u + (1000000ull << 32))) +
+             (((value >> 16) & 0x000000FF000000FFull) * (1u + (10000ull << 32)))) >> 32;
+    return value;
+}
+#endif
+
+static SmolTLV_Status parse_number(JsonParser *parser) {
+    const uint8_t *p = parser->p;
+    const uint8_t *end = parser->end;
+    const uint8_t *start = p;
+    bool negative = false;
+
+    if (*p == '-') {
+        negative = true;
+        p++;
+    }
+    if (p >= end || !is_digit(*p)) {
+        parser->p = p;
+        return SMOLTLV_STATUS_INVALID_FORMAT;
+    }
+
+    const uint8_t *digits = p;
+    uint64_t value = 0;
+    if (*p == '0') {
+        p++;
+    } else {
+#ifdef JSON_SWAR_DIGITS
+        uint64_t chunk;
+        while (end - p >= 8) {
+            memcpy(&chunk, p, 8);
+            if (!is_eight_digits(chunk)) {
+                break;
+            }
+            value = value * 100000000u + parse_eight_digits(chunk);
+            p += 8;
+        }
+#endif
+        while (p < end && is_digit(*p)) {
+            value = value * 10u + (uint64_t)(*p - '0');
+            p++;
+        }
+    }
+    size_t digit_count = (size_t)(p - digits);
+
+    bool is_float = false;
+    if (p < end && *p == '.') {
+        p++;
+        if (p >= end || !is_digit(*p)) {
+            parser->p = p;
+            return SMOLTLV_STATUS_INVALID_FORMAT;
+        }
+        while (p < end && is_digit(*p)) {
+            p++;
+        }
+        is_float = true;
+    }
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        p++;
+        if (p < end && (*p == '+' || *p == '-')) {
+            p++;
+        }
+        if (p >= end || !is_digit(*p)) {
+            parser->p = p;
+            return SMOLTLV_STATUS_INVALID_FORMAT;
+        }
+        while (p < end && is_digit(*p)) {
+            p++;
+        }
+        is_float = true;
+    }
+    parser->p = p;
+
+    // Up to 19 digits the accumulated value did not wrap
+    if (!is_float && digit_count <= 19u) {
+        if (!negative && value <= (uint64_t)INT64_MAX) {
+            return SmolTLV_Encoder_write_int(parser->encoder, (int64_t)value);
+        }
+        if (negative && value <= (uint64_t)INT64_MAX + 1u) {
+            return SmolTLV_Encoder_write_int(parser->encoder, (int64_t)(0u - value));
+        }
+    }
+
+    // Other numbers through strtod, which needs terminated copy
+    char buffer[JSON_NUMBER_SIZE];
+    size_t length = (size_t)(p - start);
+    char *number = length < sizeof(buffer) ? buffer : (char *)malloc(length + 1u);
+    if (!number) {
+        return SMOLTLV_STATUS_OUT_OF_MEMORY;
+    }
+    memcpy(number, start, length);
+    number[length] = '\0';
+    double float_value = strtod(number, NULL);
+    if (number != buffer) {
+        free(number);
+    }
+
+    return SmolTLV_Encoder_write_double_array(parser->encoder, &float_value, 1);
+}
+
+static SmolTLV_Status parse_literal(JsonParser *parser) {
+    static const char *const literals[3] = { "null", "true", "false" };
+    for (size_t i = 0; i < 3u; i++) {
+        size_t length = strlen(literals[i]);
+        if ((size_t)(parser->end - parser->p) >= length &&
+            memcmp(parser->p, literals[i], length) == 0) {
+            parser->p += length;
+            return i == 0u ? SmolTLV_Encoder_write_null(parser->encoder)
+                           : SmolTLV_Encoder_write_bool(parser->encoder, i == 1u);
+        }
+    }
+    return SMOLTLV_STATUS_INVALID_FORMAT;
+}
+
+/** Parses dict key and the following colon */
+static SmolTLV_Status parse_key(JsonParser *parser) {
+    parser->p = skip_whitespace(parser->p, parser->end);
+    if (parser->p >= parser->end || *parser->p != '"') {
+        return SMOLTLV_STATUS_INVALID_FORMAT;
+    }
+
+    SmolTLV_Status status = parse_string_item(parser);
+    if (status != SMOLTLV_STATUS_OK) {
+        return status;
+    }
+
+    parser->p = skip_whitespace(parser->p, parser->end);
+    if (parser->p >= parser->end || *parser->p != ':') {
+        return SMOLTLV_STATUS_INVALID_FORMAT;
+    }
+    parser->p++;
+    return SMOLTLV_STATUS_OK;
+}
+
+/*
+ * Parses one top-level value. Nesting is tracked in an explicit stack of
+ * open brackets, so deep documents do not recurse.
+ */
+static SmolTLV_Status parse_value(JsonParser *parser) {
+    uint8_t stack[SMOLTLV_JSON_MAX_DEPTH];
+    size_t depth = 0;
+    SmolTLV_Status status;
+
+    for (;;) {
+        parser->p = skip_whitespace(parser->p, parser->end);
+        if (parser->p >= parser->end) {
+            return SMOLTLV_STATUS_INVALID_FORMAT;
+        }
+
+        uint8_t c = *parser->p;
+        switch (c) {
+        case '{':
+        case '[': {
+            uint8_t close = c == '{' ? '}' : ']';
+            if (depth >= SMOLTLV_JSON_MAX_DEPTH) {
+                return SMOLTLV_STATUS_INVALID_FORMAT;
+            }
+            status = c == '{' ? SmolTLV_Encoder_start_dict(parser->encoder)
+                              : SmolTLV_Encoder_start_list(parser->encoder);
+            if (status != SMOLTLV_STATUS_OK) {
+                return status;
+            }
+
+            parser->p = skip_whitespace(parser->p + 1, parser->end);
+            if (parser->p < parser->end && *parser->p == close) {
+                parser->p++;
+                status = SmolTLV_Encoder_end(parser->encoder);
+                break;
+            }
+
+            stack[depth++] = c;
+            if (c == '{') {
+                status = parse_key(parser);
+                if (status != SMOLTLV_STATUS_OK) {
+                    return status;
+                }
+            }
+            continue;
+        }
+        case '"':
+            status = parse_string_item(parser);
+            break;
+        case 'n':
+        case 't':
+        case 'f':
+            status = parse_literal(parser);
+            break;
+        default:
+            if (c != '-' && !is_digit(c)) {
+                return SMOLTLV_STATUS_INVALID_FORMAT;
+            }
+            status = parse_number(parser);
+            break;
+        }
+
+        if (status != SMOLTLV_STATUS_OK) {
+            return status;
+        }
+
+        // Value is complete, close containers up to next separator
+        for (;;) {
+            if (depth == 0u) {
+                return SMOLTLV_STATUS_OK;
+            }
+
+            parser->p = skip_whitespace(parser->p, parser->end);
+            if (parser->p >= parser->end) {
+                return SMOLTLV_STATUS_INVALID_FORMAT;
+            }
+
+            uint8_t open = stack[depth - 1u];
+            c = *parser->p;
+            if (c == ',') {
+                parser->p++;
+                status = open == '{' ? parse_key(parser) : SMOLTLV_STATUS_OK;
+                if (status != SMOLTLV_STATUS_OK) {
+                    return status;
+                }
+                break;
+            }
+            if ((open == '[' && c == ']') || (open == '{' && c == '}')) {
+                parser->p++;
+                depth--;
+                status = SmolTLV_Encoder_end(parser->encoder);
+                if (status != SMOLTLV_STATUS_OK) {
+                    return status;
+                }
+                continue;
+            }
+            return SMOLTLV_STATUS_INVALID_FORMAT;
+        }
+    }
+}
+
+SmolTLV_Status SmolTLV_json_encode(const char *json,
+                                   size_t length,
+                                   SmolTLV_Encoder *encoder,
+                                   size_t *out_error_offset) {
+    if ((!json && length > 0u) || !encoder) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    JsonParser parser;
+    memset(&parser, 0, sizeof(parser));
+    parser.p = (const uint8_t *)json;
+    parser.end = parser.p + length;
+    parser.encoder = encoder;
+
+    SmolTLV_Status status = SMOLTLV_STATUS_OK;
+    for (;;) {
+        parser.p = skip_whitespace(parser.p, parser.end);
+        if (parser.p >= parser.end) {
+            break;
+        }
+
+        status = parse_value(&parser);
+        if (status != SMOLTLV_STATUS_OK) {
+            break;
+        }
+
+        // Scalars have to be delimited from the following value
+        uint8_t last = parser.p[-1];
+        if (parser.p < parser.end && !is_whitespace(*parser.p) &&
+            last != '}' && last != ']' && last != '"') {
+            status = SMOLTLV_STATUS_INVALID_FORMAT;
+            break;
+        }
+    }
+
+    if (status == SMOLTLV_STATUS_INVALID_FORMAT && out_error_offset) {
+        *out_error_offset = (size_t)(parser.p - (const uint8_t *)json);
+    }
+    free(parser.scratch);
+    return status;
+}
+
+#endif /* SMOLTLV_NO_ENCODER */
+
+/*
+ * SmolTLV -> JSON
+ */
+
+static void writer_char(TranscodeWriter *writer, char c) {
+    *writer_reserve(writer, 1u) = (uint8_t)c;
+    writer->used++;
+}
+
+static void writer_escaped(TranscodeWriter *writer, const uint8_t *p, size_t length) {
+    static const char hex[] = "0123456789abcdef";
+    const uint8_t *end = p + length;
+    while (p < end) {
+        const uint8_t *s = scan_string(p, end);
+        writer_bytes(writer, p, (size_t)(s - p));
+        if (s >= end) {
+            break;
+        }
+
+        uint8_t *out = writer_reserve(writer, 6u);
+        size_t escape_length = 2;
+        out[0] = '\\';
+        switch (*s) {
+        case '"':  out[1] = '"'; break;
+        case '\\': out[1] = '\\'; break;
+        case '\b': out[1] = 'b'; break;
+        case '\f': out[1] = 'f'; break;
+        case '\n': out[1] = 'n'; break;
+        case '\r': out[1] = 'r'; break;
+        case '\t': out[1] = 't'; break;
+        default:
+            memcpy(out + 1, "u00", 3);
+            out[4] = (uint8_t)hex[*s >> 4];
+            out[5] = (uint8_t)hex[*s & 0x0Fu];
+            escape_length = 6;
+            break;
+        }
+        writer->used += escape_length;
+        p = s + 1;
+    }
+}
+
+static void writer_string(TranscodeWriter *writer, const uint8_t *p, size_t length) {
+    writer_char(writer, '"');
+    writer_escaped(writer, p, length);
+    writer_char(writer, '"');
+}
+
+static const char digit_pairs[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+static void writer_int(TranscodeWriter *writer, int64_t value) {
+    uint8_t digits[20];
+    size_t i = sizeof(digits);
+    uint64_t magnitude = value < 0 ? 0u - (uint64_t)value : (uint64_t)value;
+
+    while (magnitude >= 100u) {
+        size_t pair = (size_t)(magnitude % 100u) * 2u;
+        magnitude /= 100u;
+        digits[--i] = (uint8_t)digit_pairs[pair + 1u];
+        digits[--i] = (uint8_t)digit_pairs[pair];
+    }
+    if (magnitude >= 10u) {
+        digits[--i] = (uint8_t)digit_pairs[magnitude * 2u + 1u];
+        digits[--i] = (uint8_t)digit_pairs[magnitude * 2u];
+    } else {
+        digits[--i] = (uint8_t)('0' + magnitude);
+    }
+
+    uint8_t *out = writer_reserve(writer, 21u);
+    size_t length = 0;
+    if (value < 0) {
+        out[length++] = '-';
+    }
+    memcpy(out + length, digits + i, sizeof(digits) - i);
+    writer->used += length + sizeof(digits) - i;
+}
+
+/** Shortest representation reading back to the same value, ".0" marks
+ * integral values as floats */
+static void writer_float(TranscodeWriter *writer, double value, bool single) {
+    if (!isfinite(value)) {
+        writer_bytes(writer, "null", 4);
+        return;
+    }
+
+    char buffer[JSON_NUMBER_SIZE];
+    int length = 0;
+    for (int precision = single ? 6 : 15; precision <= (single ? 9 : 17); precision++) {
+        length = snprintf(buffer, sizeof(buffer), "%.*g", precision, value);
+        double parsed = strtod(buffer, NULL);
+        if (single ? (float)parsed == (float)value : parsed == value) {
+            break;
+        }
+    }
+
+    if (strspn(buffer, "-0123456789") == (size_t)length) {
+        buffer[length++] = '.';
+        buffer[length++] = '0';
+    }
+    writer_bytes(writer, buffer, (size_t)length);
+}
+
+typedef struct Base64_s {
+    uint8_t carry[2];
+    size_t carry_length;
+} Base64;
+
+static void base64_block(TranscodeWriter *writer, const uint8_t *p, size_t length) {
+    static const char alphabet[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    uint8_t *out = writer_reserve(writer, 4u);
+    uint32_t bits = (uint32_t)p[0] << 16;
+    if (length > 1u) {
+        bits |= (uint32_t)p[1] << 8;
+    }
+    if (length > 2u) {
+        bits |= p[2];
+    }
+    out[0] = (uint8_t)alphabet[(bits >> 18) & 0x3Fu];
+    out[1] = (uint8_t)alphabet[(bits >> 12) & 0x3Fu];
+    out[2] = length > 1u ? (uint8_t)alphabet[(bits >> 6) & 0x3Fu] : '=';
+    out[3] = length > 2u ? (uint8_t)alphabet[bits & 0x3Fu] : '=';
+    writer->used += 4u;
+}
+
+/** Encodes data, up to 2 trailing bytes are carried to the next call */
+static void base64_write(TranscodeWriter *writer, Base64 *state, const uint8_t *p, size_t length) {
+    while (state->carry_length > 0u && state->carry_length < 3u && length > 0u) {
+        if (state->carry_length == 2u) {
+            uint8_t block[3] = { state->carry[0], state->carry[1], *p };
+            base64_block(writer, block, 3);
+            state->carry_length = 0;
+        } else {
+            state->carry[state->carry_length++] = *p;
+        }
+        p++;
+        length--;
+    }
+
+    while (length >= 3u) {
+        base64_block(writer, p, 3);
+        p += 3;
+        length -= 3u;
+    }
+    memcpy(state->carry + state->carry_length, p, length);
+    state->carry_length += length;
+}
+
+static void base64_finish(TranscodeWriter *writer, Base64 *state) {
+    if (state->carry_length > 0u) {
+        base64_block(writer, state->carry, state->carry_length);
+        state->carry_length = 0;
+    }
+}
+
+/** Writes STRING or resolved STRING_REF item */
+static void writer_key(TranscodeWriter *writer, SmolTLV_Item key) {
+    if (writer_resolve_string(writer, key, &key)) {
+        writer_string(writer, SmolTLV_Item_get_value(key), SmolTLV_Item_get_length(key));
+    }
+}
+
+static double load_float_element(const uint8_t *p, size_t size) {
+    if (size == 4u) {
+        uint32_t bits = (uint32_t)load_element(p, 4);
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+    uint64_t bits = load_element(p, 8);
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static bool is_float_array(SmolTLV_Type type) {
+    return type == SMOLTLV_TYPE_ARRAY_FLOAT32 || type == SMOLTLV_TYPE_ARRAY_FLOAT64;
+}
+
+static void writer_array(TranscodeWriter *writer, SmolTLV_Item item) {
+    SmolTLV_Type type = SmolTLV_Item_get_type(item);
+    size_t element_size = SmolTLV_Type_array_element_size(type);
+    size_t count = SmolTLV_Item_get_length(item) / element_size;
+    const uint8_t *p = SmolTLV_Item_get_value(item);
+
+    if (is_float_array(type) && count == 1u) {
+        writer_float(writer, load_float_element(p, element_size), element_size == 4u);
+        return;
+    }
+
+    writer_char(writer, '[');
+    for (size_t i = 0; i < count; i++, p += element_size) {
+        if (i > 0u) {
+            writer_char(writer, ',');
+        }
+        if (is_float_array(type)) {
+            writer_float(writer, load_float_element(p, element_size), element_size == 4u);
+        } else {
+            writer_int(writer, load_int_element(p, element_size));
+        }
+    }
+    writer_char(writer, ']');
+}
+
+static void writer_delta(TranscodeWriter *writer, SmolTLV_Item item) {
+    SmolTLV_Item array;
+    if (!SmolTLV_Item_delta_array(item, &array)) {
+        writer->status = SMOLTLV_STATUS_INVALID_FORMAT;
+        return;
+    }
+
+    size_t element_size = SmolTLV_Type_array_element_size(SmolTLV_Item_get_type(array));
+    size_t count = SmolTLV_Item_get_length(array) / element_size;
+    const uint8_t *p = SmolTLV_Item_get_value(array);
+    uint64_t sum = 0;
+
+    writer_char(writer, '[');
+    for (size_t i = 0; i < count; i++, p += element_size) {
+        if (i > 0u) {
+            writer_char(writer, ',');
+        }
+        sum += (uint64_t)load_int_element(p, element_size);
+        writer_int(writer, (int64_t)sum);
+    }
+    writer_char(writer, ']');
+}
+
+static void writer_item(TranscodeWriter *writer, SmolTLV_Item item, size_t depth);
+
+/** Rows of record batch as array of objects */
+static void writer_batch(TranscodeWriter *writer, SmolTLV_Item item, size_t depth) {
+    SmolTLV_BatchReader reader;
+    if (!writer_start_batch(writer, item, &reader)) {
+        return;
+    }
+
+    writer_char(writer, '[');
+    while (writer_next_row(writer, &reader)) {
+        if (reader.row > 1u) {
+            writer_char(writer, ',');
+        }
+        writer_char(writer, '{');
+        for (size_t i = 0; i < reader.batch.column_count; i++) {
+            const SmolTLV_BatchReaderColumn *column = &reader.columns[i];
+            if (i > 0u) {
+                writer_char(writer, ',');
+            }
+            writer_key(writer, column->key);
+            writer_char(writer, ':');
+            if (column->item.pointer) {
+                writer_item(writer, column->item, depth + 2u);
+            } else {
+                writer_int(writer, column->int_value);
+            }
+        }
+        writer_char(writer, '}');
+    }
+    writer_char(writer, ']');
+    free(reader.columns);
+}
+
+static void writer_container(TranscodeWriter *writer, SmolTLV_Item item, size_t depth, bool is_dict) {
+    SmolTLV_Cursor cursor;
+    SmolTLV_Item entry;
+    SmolTLV_Status status;
+    size_t index = 0;
+
+    writer_char(writer, is_dict ? '{' : '[');
+    SmolTLV_Cursor_for_item(&cursor, item);
+    while (writer->status == SMOLTLV_STATUS_OK &&
+           (status = SmolTLV_Cursor_next(&cursor, &entry)) == SMOLTLV_STATUS_OK) {
+        if (!is_dict) {
+            if (index > 0u) {
+                writer_char(writer, ',');
+            }
+            writer_item(writer, entry, depth + 1u);
+        } else if (index % 2u == 0u) {
+            if (index > 0u) {
+                writer_char(writer, ',');
+            }
+            writer_key(writer, entry);
+            writer_char(writer, ':');
+        } else {
+            writer_item(writer, entry, depth + 1u);
+        }
+        index++;
+    }
+
+    if (writer->status == SMOLTLV_STATUS_OK &&
+        (status != SMOLTLV_STATUS_END || (is_dict && index % 2u != 0u))) {
+        writer->status = SMOLTLV_STATUS_INVALID_FORMAT;
+    }
+    writer_char(writer, is_dict ? '}' : ']');
+}
+
+static void writer_item(TranscodeWriter *writer, SmolTLV_Item item, size_t depth) {
+    if (writer->status != SMOLTLV_STATUS_OK) {
+        return;
+    }
+    if (depth > SMOLTLV_JSON_MAX_DEPTH) {
+        writer->status = SMOLTLV_STATUS_INVALID_FORMAT;
+        return;
+    }
+
+    const uint8_t *value = SmolTLV_Item_get_value(item);
+    size_t length = SmolTLV_Item_get_length(item);
+    SmolTLV_Type type = SmolTLV_Item_get_type(item);
+
+    switch (type) {
+    case SMOLTLV_TYPE_NULL:
+        writer_bytes(writer, "null", 4);
+        break;
+    case SMOLTLV_TYPE_BOOL_TRUE:
+        writer_bytes(writer, "true", 4);
+        break;
+    case SMOLTLV_TYPE_BOOL_FALSE:
+        writer_bytes(writer, "false", 5);
+        break;
+    case SMOLTLV_TYPE_INT:
+        if (length != 8u) {
+            writer->status = SMOLTLV_STATUS_INVALID_FORMAT;
+            break;
+        }
+        writer_int(writer, (int64_t)load_element(value, 8));
+        break;
+    case SMOLTLV_TYPE_BYTES: {
+        Base64 state = { { 0 }, 0 };
+        writer_char(writer, '"');
+        base64_write(writer, &state, value, length);
+        base64_finish(writer, &state);
+        writer_char(writer, '"');
+        break;
+    }
+    case SMOLTLV_TYPE_STRING:
+        writer_string(writer, value, length);
+        break;
+    case SMOLTLV_TYPE_STRING_REF:
+        writer_key(writer, item);
+        break;
+    case SMOLTLV_TYPE_LIST:
+        writer_container(writer, item, depth, false);
+        break;
+    case SMOLTLV_TYPE_DICT:
+        writer_container(writer, item, depth, true);
+        break;
+    case SMOLTLV_TYPE_ARRAY_INT8:
+    case SMOLTLV_TYPE_ARRAY_INT16:
+    case SMOLTLV_TYPE_ARRAY_INT32:
+    case SMOLTLV_TYPE_ARRAY_INT64:
+    case SMOLTLV_TYPE_ARRAY_FLOAT32:
+    case SMOLTLV_TYPE_ARRAY_FLOAT64:
+        writer_array(writer, item);
+        break;
+    case SMOLTLV_TYPE_DELTA:
+        writer_delta(writer, item);
+        break;
+    case SMOLTLV_TYPE_RECORD_BATCH:
+        writer_batch(writer, item, depth);
+        break;
+    default:
+        writer->status = SMOLTLV_STATUS_INVALID_FORMAT;
+        break;
+    }
+}
+
+/** Joins chunked value starting at cursor into one JSON string */
+static void writer_chunks(TranscodeWriter *writer, SmolTLV_Cursor *cursor) {
+    SmolTLV_ChunkReader reader;
+    SmolTLV_Status status;
+    Base64 state = { { 0 }, 0 };
+    const uint8_t *chunk;
+    size_t length;
+
+    SmolTLV_ChunkReader_init(&reader, cursor);
+    writer_char(writer, '"');
+    while ((status = SmolTLV_ChunkReader_next(&reader, &chunk, &length)) == SMOLTLV_STATUS_OK) {
+        if (reader.type == SMOLTLV_TYPE_STRING) {
+            writer_escaped(writer, chunk, length);
+        } else {
+            base64_write(writer, &state, chunk, length);
+        }
+    }
+    base64_finish(writer, &state);
+    writer_char(writer, '"');
+
+    if (status != SMOLTLV_STATUS_END && writer->status == SMOLTLV_STATUS_OK) {
+        writer->status = status;
+    }
+}
+
+SmolTLV_Status SmolTLV_json_write(const uint8_t *buffer,
+                                  size_t size,
+                                  SmolTLV_WriteFunction write,
+                                  void *context) {
+    if ((!buffer && size > 0u) || !write) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    TranscodeWriter writer;
+    writer_init(&writer, write, context);
+
+    SmolTLV_Cursor cursor;
+    SmolTLV_Item item;
+    SmolTLV_Status status = SMOLTLV_STATUS_END;
+    SmolTLV_Cursor_init(&cursor, buffer, size);
+    while (writer.status == SMOLTLV_STATUS_OK &&
+           (status = SmolTLV_Cursor_next(&cursor, &item)) == SMOLTLV_STATUS_OK) {
+        SmolTLV_Type type = SmolTLV_Item_get_type(item);
+        if (type == SMOLTLV_TYPE_STRING_TABLE) {
+            writer_set_table(&writer, item);
+            continue;
+        }
+
+        if (type == SMOLTLV_TYPE_BYTES_CHUNK || type == SMOLTLV_TYPE_STRING_CHUNK) {
+            cursor.position = (size_t)(item.pointer - buffer);
+            writer_chunks(&writer, &cursor);
+        } else {
+            writer_item(&writer, item, 1u);
+        }
+        writer_char(&writer, '\n');
+    }
+
+    if (writer.status == SMOLTLV_STATUS_OK && status != SMOLTLV_STATUS_END) {
+        writer.status = status;
+    }
+    return writer_finish(&writer);
+}
+
+SmolTLV_Status SmolTLV_json_write_item(SmolTLV_Item item,
+                                       const SmolTLV_StringTable *table,
+                                       SmolTLV_WriteFunction write,
+                                       void *context) {
+    if (!item.pointer || !write) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    TranscodeWriter writer;
+    writer_init(&writer, write, context);
+    if (table && table->item.pointer) {
+        writer_set_table(&writer, table->item);
+    }
+    writer_item(&writer, item, 1u);
+    return writer_finish(&writer);
+}
@@ -0,0 +1,83 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil -*-
+ * 
+ * SmolTLV - Simple serialization format for JSON/CBOR-like data model 
+ * for embedded devices - JSON transcoding.
+ * 
+ * Copyright (c) 2025 Aleš Hakl
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef H__SMOLTLV_JSON
+#define H__SMOLTLV_JSON
+
+#include <smoltlv.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * JSON transcoding without intermediate trees. Sequence of JSON values 
+ * (e.g. newline delimited JSON) maps to sequence of top-level items and 
+ * back, one JSON value per line.
+ *
+ * JSON -> SmolTLV: integers fitting int64 are INT, other numbers are 
+ * single element ARRAY_FLOAT64, strings are STRING.
+ *
+ * SmolTLV -> JSON: BYTES are base64 strings, typed arrays and DELTA are 
+ * arrays of numbers (single element float arrays are plain numbers), 
+ * record batches are arrays of row objects, STRING_REF keys are resolved 
+ * through string table, chunked values are joined. Non-finite floats are 
+ * written as null, dict keys other than strings are a format error.
+ */
+
+#ifndef SMOLTLV_JSON_MAX_DEPTH
+#define SMOLTLV_JSON_MAX_DEPTH 1024u
+#endif
+
+#ifndef SMOLTLV_NO_ENCODER
+/** Encodes all JSON values in json into encoder. On format error returns 
+ * SMOLTLV_STATUS_INVALID_FORMAT and sets out_error_offset (can be NULL), 
+ * values before the error stay written. */
+extern SmolTLV_Status SmolTLV_json_encode(const char *json,
+                                          size_t length,
+                                          SmolTLV_Encoder *encoder,
+                                          size_t *out_error_offset);
+#endif
+
+/** Writes top-level items of buffer as JSON through write, output is 
+ * passed in blocks of a few KB */
+extern SmolTLV_Status SmolTLV_json_write(const uint8_t *buffer,
+                                         size_t size,
+                                         SmolTLV_WriteFunction write,
+                                         void *context);
+
+/** Writes single item (and its content) as JSON, table resolves STRING_REF 
+ * keys and can be NULL */
+extern SmolTLV_Status SmolTLV_json_write_item(SmolTLV_Item item,
+                                              const SmolTLV_StringTable *table,
+                                              SmolTLV_WriteFunction write,
+                                              void *context);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // H__SMOLTLV_JSON
@@ -0,0 +1,250 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil -*-
+ * 
+ * SmolTLV - Simple serialization format for JSON/CBOR-like data model 
+ * for embedded devices - parallel list encoding.
+ * 
+ * Copyright (c) 2025 Aleš Hakl
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <smoltlv_parallel.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#ifndef SMOLTLV_NO_THREADS
+#include <pthread.h>
+#endif
+
+#define PARALLEL_MAX_THREADS 64u
+#define PARALLEL_INITIAL_SIZE 4096u
+
+#ifndef IOV_MAX
+#define IOV_MAX 16
+#endif
+
+typedef struct ParallelJob_s {
+    const SmolTLV_ParallelList *list;
+    size_t begin;
+    size_t end;
+    /** Finalized chunk, owned by job */
+    const uint8_t *buffer;
+    size_t size;
+    SmolTLV_Status status;
+} ParallelJob;
+
+static void *parallel_worker(void *arg) {
+    ParallelJob *job = (ParallelJob *)arg;
+
+    SmolTLV_Encoder *encoder = SmolTLV_Encoder_create_with_size(PARALLEL_INITIAL_SIZE);
+    if (!encoder) {
+        job->status = SMOLTLV_STATUS_OUT_OF_MEMORY;
+        return NULL;
+    }
+
+    job->status = job->list->encode(encoder, job->begin, job->end, job->list->context);
+    if (job->status == SMOLTLV_STATUS_OK) {
+        // Fails when the slice left a container open
+        job->status = SmolTLV_Encoder_finalize(encoder, &job->buffer, &job->size);
+    }
+    SmolTLV_Encoder_destroy(encoder);
+    return NULL;
+}
+
+static void free_chunks(ParallelJob *jobs, size_t job_count) {
+    for (size_t i = 0; i < job_count; i++) {
+        free((void *)jobs[i].buffer);
+        jobs[i].buffer = NULL;
+    }
+}
+
+/*
+ * Encodes slices of the list in parallel, on success jobs hold chunks in
+ * list order and out_length is the LIST content length.
+ */
+static SmolTLV_Status encode_chunks(const SmolTLV_ParallelList *list,
+                                    ParallelJob *jobs,
+                                    size_t *out_job_count,
+                                    size_t *out_length) {
+    size_t thread_count = list->thread_count;
+    if (thread_count < 1u) {
+        thread_count = 1u;
+    }
+    if (thread_count > PARALLEL_MAX_THREADS) {
+        thread_count = PARALLEL_MAX_THREADS;
+    }
+
+    size_t chunk = (list->count + thread_count - 1u) / thread_count;
+    size_t job_count = 0;
+    for (size_t begin = 0; begin < list->count; begin += chunk) {
+        memset(&jobs[job_count], 0, sizeof(ParallelJob));
+        jobs[job_count].list = list;
+        jobs[job_count].begin = begin;
+        jobs[job_count].end = (list->count - begin > chunk) ? begin + chunk : list->count;
+        job_count++;
+    }
+
+#ifndef SMOLTLV_NO_THREADS
+    pthread_t threads[PARALLEL_MAX_THREADS];
+    bool started[PARALLEL_MAX_THREADS];
+
+    for (size_t i = 1; i < job_count; i++) {
+        started[i] = pthread_create(&threads[i], NULL, parallel_worker, &jobs[i]) == 0;
+        if (!started[i]) {
+            parallel_worker(&jobs[i]);
+        }
+    }
+    if (job_count > 0u) {
+        parallel_worker(&jobs[0]);
+    }
+    for (size_t i = 1; i < job_count; i++) {
+        if (started[i]) {
+            pthread_join(threads[i], NULL);
+        }
+    }
+#else
+    for (size_t i = 0; i < job_count; i++) {
+        parallel_worker(&jobs[i]);
+    }
+#endif
+
+    size_t length = 0;
+    SmolTLV_Status status = SMOLTLV_STATUS_OK;
+    for (size_t i = 0; i < job_count; i++) {
+        if (jobs[i].status != SMOLTLV_STATUS_OK) {
+            if (status == SMOLTLV_STATUS_OK) {
+                status = jobs[i].status;
+            }
+            continue;
+        }
+        length += jobs[i].size;
+    }
+
+    if (status == SMOLTLV_STATUS_OK && length > SMOLTLV_MAX_LENGTH) {
+        status = SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    if (status != SMOLTLV_STATUS_OK) {
+        free_chunks(jobs, job_count);
+        return status;
+    }
+
+    *out_job_count = job_count;
+    *out_length = length;
+    return SMOLTLV_STATUS_OK;
+}
+
+SmolTLV_Status SmolTLV_ParallelList_encode(const SmolTLV_ParallelList *list,
+                                           SmolTLV_Encoder *encoder) {
+    if (!list || !list->encode || !encoder) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    ParallelJob jobs[PARALLEL_MAX_THREADS];
+    size_t job_count, length;
+    SmolTLV_Status status = encode_chunks(list, jobs, &job_count, &length);
+    if (status != SMOLTLV_STATUS_OK) {
+        return status;
+    }
+
+    status = SmolTLV_Encoder_start_list(encoder);
+    for (size_t i = 0; i < job_count && status == SMOLTLV_STATUS_OK; i++) {
+        status = SmolTLV_Encoder_write_items(encoder, jobs[i].buffer, jobs[i].size);
+    }
+    if (status == SMOLTLV_STATUS_OK) {
+        status = SmolTLV_Encoder_end(encoder);
+    }
+
+    free_chunks(jobs, job_count);
+    return status;
+}
+
+/*
+ * Writes all of iov, advancing over partial writes. Returns false with 
+ * errno set on error.
+ */
+static bool write_iov(int fd, struct iovec *iov, size_t count) {
+    while (count > 0u) {
+        int batch = count > (size_t)IOV_MAX ? IOV_MAX : (int)count;
+        ssize_t written = writev(fd, iov, batch);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+
+        size_t left = (size_t)written;
+        while (count > 0u && left >= iov->iov_len) {
+            left -= iov->iov_len;
+            iov++;
+            count--;
+        }
+        if (count > 0u) {
+            if (written == 0) {
+                errno = EIO;
+                return false;
+            }
+            iov->iov_base = (uint8_t *)iov->iov_base + left;
+            iov->iov_len -= left;
+        }
+    }
+    return true;
+}
+
+SmolTLV_Status SmolTLV_ParallelList_write_fd(const SmolTLV_ParallelList *list,
+                                             int fd) {
+    if (!list || !list->encode || fd < 0) {
+        return SMOLTLV_STATUS_INVALID_ARGUMENT;
+    }
+
+    ParallelJob jobs[PARALLEL_MAX_THREADS];
+    size_t job_count, length;
+    SmolTLV_Status status = encode_chunks(list, jobs, &job_count, &length);
+    if (status != SMOLTLV_STATUS_OK) {
+        return status;
+    }
+
+    uint8_t header[4] = {
+        (uint8_t)SMOLTLV_TYPE_LIST,
+        (uint8_t)((length >> 16) & 0xFFu),
+        (uint8_t)((length >> 8) & 0xFFu),
+        (uint8_t)(length & 0xFFu),
+    };
+
+    struct iovec iov[PARALLEL_MAX_THREADS + 1u];
+    iov[0].iov_base = header;
+    iov[0].iov_len = sizeof(header);
+    for (size_t i = 0; i < job_count; i++) {
+        iov[i + 1u].iov_base = (void *)jobs[i].buffer;
+        iov[i + 1u].iov_len = jobs[i].size;
+    }
+
+    if (!write_iov(fd, iov, job_count + 1u)) {
+        status = SMOLTLV_STATUS_INVALID_STATE;
+    }
+
+    free_chunks(jobs, job_count);
+    return status;
+}
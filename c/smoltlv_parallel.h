@@ -0,0 +1,75 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil -*-
+ * 
+ * SmolTLV - Simple serialization format for JSON/CBOR-like data model 
+ * for embedded devices - parallel list encoding.
+ * 
+ * Copyright (c) 2025 Aleš Hakl
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef H__SMOLTLV_PARALLEL
+#define H__SMOLTLV_PARALLEL
+
+#include <smoltlv.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Parallel LIST builder. Elements are split into contiguous slices, each
+ * encoded by a worker thread into its own encoder, and the chunks are
+ * spliced in order behind a single LIST header. Output is byte-identical
+ * to encoding the elements serially.
+ *
+ * Whole list still has to fit into SMOLTLV_MAX_LENGTH.
+ */
+
+/** Encodes elements [begin, end) as top-level items into encoder, called
+ * concurrently from worker threads (each with its own encoder) */
+typedef SmolTLV_Status (*SmolTLV_ListEncodeFunction)(SmolTLV_Encoder *encoder,
+                                                     size_t begin,
+                                                     size_t end,
+                                                     void *context);
+
+typedef struct SmolTLV_ParallelList_s {
+    SmolTLV_ListEncodeFunction encode;
+    void *context;
+    /** Number of list elements */
+    size_t count;
+    /** Number of worker threads, 0 or 1 encodes in calling thread */
+    unsigned thread_count;
+} SmolTLV_ParallelList;
+
+/** Writes the LIST into encoder (possibly nested in open container) */
+extern SmolTLV_Status SmolTLV_ParallelList_encode(const SmolTLV_ParallelList *list,
+                                                  SmolTLV_Encoder *encoder);
+
+/** Writes the LIST to file descriptor with vectored writes, without
+ * copying the chunks into one buffer. Returns SMOLTLV_STATUS_INVALID_STATE
+ * with errno set when write fails. */
+extern SmolTLV_Status SmolTLV_ParallelList_write_fd(const SmolTLV_ParallelList *list,
+                                                    int fd);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // H__SMOLTLV_PARALLEL
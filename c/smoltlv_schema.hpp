@@ -0,0 +1,472 @@
+/* -*- mode: c++; c-basic-offset: 4; indent-tabs-mode: nil -*-
+ * 
+ * SmolTLV - Simple serialization format for JSON/CBOR-like data model 
+ * for embedded devices - compile-time schema binding for C++ structs.
+ * 
+ * Copyright (c) 2025 Aleš Hakl
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef H__SMOLTLV_SCHEMA_HPP
+#define H__SMOLTLV_SCHEMA_HPP
+
+#include <smoltlv.hpp>
+
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+/*
+ * Compile-time schema binding for C++ structs. A struct is described once
+ * with SMOLTLV_SCHEMA at global scope:
+ *
+ *     struct Point { int32_t x; int32_t y; std::string label; };
+ *     SMOLTLV_SCHEMA(Point,
+ *         SMOLTLV_FIELD(Point, x),
+ *         SMOLTLV_FIELD(Point, y),
+ *         SMOLTLV_FIELD_NAMED(Point, label, "name"))
+ *
+ * and is then encoded as a DICT with smoltlv::schema::encode() and decoded
+ * with smoltlv::schema::decode().
+ *
+ * Supported member types and their encoding:
+ *   bool                      BOOL_TRUE / BOOL_FALSE
+ *   integers                  INT (uint64_t is stored as two's complement)
+ *   float, double             ARRAY_FLOAT64 with one element
+ *   std::string, string_view  STRING (decoded string_view borrows buffer)
+ *   std::vector<arithmetic>   typed array of matching element size
+ *   std::optional<T>          NULL when empty
+ *   structs with a schema     nested DICT
+ *
+ * Encoding computes the exact size first and writes directly into caller
+ * provided memory without allocations. Decoding is a single pass over the
+ * dict entries, each key is dispatched to its field by length and content.
+ * Unknown keys and keys encoded as STRING_REF are skipped, fields missing
+ * from the dict keep their previous value.
+ */
+
+namespace smoltlv {
+namespace schema {
+
+/** Specialized by SMOLTLV_SCHEMA, provides static constexpr tuple fields */
+template <typename T>
+struct Descriptor;
+
+template <typename T, typename M>
+struct Field {
+    using Struct = T;
+    using Member = M;
+
+    std::string_view key;
+    M T::*member;
+};
+
+template <typename T, typename M>
+constexpr Field<T, M> field(std::string_view key, M T::*member) noexcept {
+    return Field<T, M>{ key, member };
+}
+
+template <typename T, typename = void>
+struct has_schema : std::false_type {};
+
+template <typename T>
+struct has_schema<T, std::void_t<decltype(Descriptor<T>::fields)>> : std::true_type {};
+
+namespace detail {
+
+constexpr size_t max_length = 0xFFFFFFu;
+
+inline uint8_t *put_header(uint8_t *p, uint8_t type, size_t length) noexcept {
+    p[0] = type;
+    p[1] = static_cast<uint8_t>(length >> 16);
+    p[2] = static_cast<uint8_t>(length >> 8);
+    p[3] = static_cast<uint8_t>(length);
+    return p + 4;
+}
+
+inline uint8_t *put_be(uint8_t *p, uint64_t value, size_t size) noexcept {
+    for (size_t i = size; i > 0; i--) {
+        p[i - 1] = static_cast<uint8_t>(value);
+        value >>= 8;
+    }
+    return p + size;
+}
+
+template <typename E>
+constexpr uint8_t array_type() noexcept {
+    if constexpr (std::is_floating_point_v<E>) {
+        return sizeof(E) == 4 ? SMOLTLV_TYPE_ARRAY_FLOAT32 : SMOLTLV_TYPE_ARRAY_FLOAT64;
+    } else {
+        return sizeof(E) == 1 ? SMOLTLV_TYPE_ARRAY_INT8
+             : sizeof(E) == 2 ? SMOLTLV_TYPE_ARRAY_INT16
+             : sizeof(E) == 4 ? SMOLTLV_TYPE_ARRAY_INT32
+             : SMOLTLV_TYPE_ARRAY_INT64;
+    }
+}
+
+template <typename E>
+inline uint64_t element_bits(E value) noexcept {
+    if constexpr (std::is_floating_point_v<E>) {
+        std::conditional_t<sizeof(E) == 4, uint32_t, uint64_t> bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    } else {
+        return static_cast<uint64_t>(value);
+    }
+}
+
+template <typename E>
+inline E element_from_bits(uint64_t bits) noexcept {
+    if constexpr (std::is_floating_point_v<E>) {
+        std::conditional_t<sizeof(E) == 4, uint32_t, uint64_t> narrow =
+            static_cast<decltype(narrow)>(bits);
+        E value;
+        std::memcpy(&value, &narrow, sizeof(value));
+        return value;
+    } else {
+        return static_cast<E>(bits);
+    }
+}
+
+inline uint8_t *put_bytes(uint8_t *p, uint8_t type, const void *data, size_t size) noexcept {
+    if (!p || size > max_length) {
+        return nullptr;
+    }
+    p = put_header(p, type, size);
+    if (size > 0) {
+        std::memcpy(p, data, size);
+    }
+    return p + size;
+}
+
+} // namespace detail
+
+/**
+ * Per-type encoding rules: size() is the encoded size including header,
+ * write() returns the end of written item or nullptr when a length does not
+ * fit into 24 bits, read() returns false on type mismatch.
+ */
+template <typename V, typename = void>
+struct Codec;
+
+template <>
+struct Codec<bool> {
+    static constexpr size_t size(bool) noexcept { return 4; }
+
+    static uint8_t *write(uint8_t *p, bool value) noexcept {
+        return p ? detail::put_header(p, value ? SMOLTLV_TYPE_BOOL_TRUE : SMOLTLV_TYPE_BOOL_FALSE, 0) : nullptr;
+    }
+
+    static bool read(Item item, bool &out) noexcept {
+        auto value = item.as_bool();
+        if (!value) {
+            return false;
+        }
+        out = *value;
+        return true;
+    }
+};
+
+template <typename V>
+struct Codec<V, std::enable_if_t<std::is_integral_v<V> && !std::is_same_v<V, bool>>> {
+    static constexpr size_t size(V) noexcept { return 12; }
+
+    static uint8_t *write(uint8_t *p, V value) noexcept {
+        if (!p) {
+            return nullptr;
+        }
+        p = detail::put_header(p, SMOLTLV_TYPE_INT, 8);
+        return detail::put_be(p, static_cast<uint64_t>(static_cast<std::conditional_t<
+            std::is_signed_v<V>, int64_t, uint64_t>>(value)), 8);
+    }
+
+    static bool read(Item item, V &out) noexcept {
+        auto value = item.as_int();
+        if (!value) {
+            return false;
+        }
+        if constexpr (sizeof(V) == 8) {
+            out = static_cast<V>(*value);
+        } else if constexpr (std::is_signed_v<V>) {
+            if (*value < std::numeric_limits<V>::min() || *value > std::numeric_limits<V>::max()) {
+                return false;
+            }
+            out = static_cast<V>(*value);
+        } else {
+            if (*value < 0 || static_cast<uint64_t>(*value) > std::numeric_limits<V>::max()) {
+                return false;
+            }
+            out = static_cast<V>(*value);
+        }
+        return true;
+    }
+};
+
+template <typename V>
+struct Codec<V, std::enable_if_t<std::is_floating_point_v<V>>> {
+    static constexpr size_t size(V) noexcept { return 12; }
+
+    static uint8_t *write(uint8_t *p, V value) noexcept {
+        if (!p) {
+            return nullptr;
+        }
+        p = detail::put_header(p, SMOLTLV_TYPE_ARRAY_FLOAT64, 8);
+        return detail::put_be(p, detail::element_bits(static_cast<double>(value)), 8);
+    }
+
+    /** Accepts INT and one element FLOAT32/FLOAT64 arrays */
+    static bool read(Item item, V &out) noexcept {
+        if (auto value = item.as_int()) {
+            out = static_cast<V>(*value);
+            return true;
+        }
+        if (item.type() == SMOLTLV_TYPE_ARRAY_FLOAT64 && item.length() == 8) {
+            out = static_cast<V>(detail::element_from_bits<double>(::smoltlv::detail::load_be(item.value(), 8)));
+            return true;
+        }
+        if (item.type() == SMOLTLV_TYPE_ARRAY_FLOAT32 && item.length() == 4) {
+            out = static_cast<V>(detail::element_from_bits<float>(::smoltlv::detail::load_be(item.value(), 4)));
+            return true;
+        }
+        return false;
+    }
+};
+
+template <>
+struct Codec<std::string_view> {
+    static size_t size(std::string_view value) noexcept { return 4 + value.size(); }
+
+    static uint8_t *write(uint8_t *p, std::string_view value) noexcept {
+        return detail::put_bytes(p, SMOLTLV_TYPE_STRING, value.data(), value.size());
+    }
+
+    static bool read(Item item, std::string_view &out) noexcept {
+        auto value = item.as_string();
+        if (!value) {
+            return false;
+        }
+        out = *value;
+        return true;
+    }
+};
+
+template <>
+struct Codec<std::string> {
+    static size_t size(const std::string &value) noexcept { return 4 + value.size(); }
+
+    static uint8_t *write(uint8_t *p, const std::string &value) noexcept {
+        return detail::put_bytes(p, SMOLTLV_TYPE_STRING, value.data(), value.size());
+    }
+
+    static bool read(Item item, std::string &out) {
+        auto value = item.as_string();
+        if (!value) {
+            return false;
+        }
+        out.assign(value->data(), value->size());
+        return true;
+    }
+};
+
+template <typename E>
+struct Codec<std::vector<E>, std::enable_if_t<std::is_arithmetic_v<E> && !std::is_same_v<E, bool>>> {
+    static size_t size(const std::vector<E> &value) noexcept {
+        return 4 + value.size() * sizeof(E);
+    }
+
+    static uint8_t *write(uint8_t *p, const std::vector<E> &value) noexcept {
+        size_t length = value.size() * sizeof(E);
+        if (!p || length > detail::max_length) {
+            return nullptr;
+        }
+        p = detail::put_header(p, detail::array_type<E>(), length);
+        for (E element : value) {
+            p = detail::put_be(p, detail::element_bits(element), sizeof(E));
+        }
+        return p;
+    }
+
+    static bool read(Item item, std::vector<E> &out) {
+        if (item.type_raw() != detail::array_type<E>()) {
+            return false;
+        }
+        size_t count = item.length() / sizeof(E);
+        out.resize(count);
+        for (size_t i = 0; i < count; i++) {
+            uint64_t bits = ::smoltlv::detail::load_be(item.value() + i * sizeof(E), sizeof(E));
+            out[i] = detail::element_from_bits<E>(bits);
+        }
+        return true;
+    }
+};
+
+template <typename V>
+struct Codec<std::optional<V>> {
+    static size_t size(const std::optional<V> &value) noexcept {
+        return value ? Codec<V>::size(*value) : 4;
+    }
+
+    static uint8_t *write(uint8_t *p, const std::optional<V> &value) noexcept {
+        if (!value) {
+            return p ? detail::put_header(p, SMOLTLV_TYPE_NULL, 0) : nullptr;
+        }
+        return Codec<V>::write(p, *value);
+    }
+
+    static bool read(Item item, std::optional<V> &out) {
+        if (item.is_null()) {
+            out.reset();
+            return true;
+        }
+        V value{};
+        if (!Codec<V>::read(item, value)) {
+            return false;
+        }
+        out = std::move(value);
+        return true;
+    }
+};
+
+template <typename T>
+struct Codec<T, std::enable_if_t<has_schema<T>::value>> {
+    static size_t size(const T &value) noexcept {
+        return std::apply([&](const auto &...fields) {
+            return (static_cast<size_t>(4) + ... + (4 + fields.key.size() +
+                Codec<typename std::decay_t<decltype(fields)>::Member>::size(value.*fields.member)));
+        }, Descriptor<T>::fields);
+    }
+
+    static uint8_t *write(uint8_t *p, const T &value) noexcept {
+        if (!p) {
+            return nullptr;
+        }
+        uint8_t *start = p;
+        p += 4;
+        std::apply([&](const auto &...fields) {
+            ((p = Codec<typename std::decay_t<decltype(fields)>::Member>::write(
+                  detail::put_bytes(p, SMOLTLV_TYPE_STRING, fields.key.data(), fields.key.size()),
+                  value.*fields.member)), ...);
+        }, Descriptor<T>::fields);
+
+        // Length is backpatched once content is written
+        if (!p || static_cast<size_t>(p - start - 4) > detail::max_length) {
+            return nullptr;
+        }
+        detail::put_header(start, SMOLTLV_TYPE_DICT, static_cast<size_t>(p - start - 4));
+        return p;
+    }
+
+    static bool read(Item item, T &out) {
+        if (item.type() != SMOLTLV_TYPE_DICT) {
+            return false;
+        }
+
+        const uint8_t *p = item.value();
+        const uint8_t *end = p + item.length();
+        while (p < end) {
+            size_t key_size = ::smoltlv::detail::check_item(p, static_cast<size_t>(end - p), true);
+            if (key_size == 0 || key_size == static_cast<size_t>(end - p)) {
+                return false;
+            }
+            const uint8_t *value_pointer = p + key_size;
+            size_t value_size = ::smoltlv::detail::check_item(value_pointer, static_cast<size_t>(end - value_pointer), true);
+            if (value_size == 0) {
+                return false;
+            }
+
+            Item key(p);
+            if (key.type() == SMOLTLV_TYPE_STRING && !dispatch(key, Item(value_pointer), out)) {
+                return false;
+            }
+            p = value_pointer + value_size;
+        }
+        return true;
+    }
+
+private:
+    /** Finds field for key and decodes value into it, false on mismatch */
+    static bool dispatch(Item key, Item value, T &out) {
+        bool ok = true;
+        std::string_view name(reinterpret_cast<const char *>(key.value()), key.length());
+        std::apply([&](const auto &...fields) {
+            (void)((name == fields.key &&
+                    (ok = Codec<typename std::decay_t<decltype(fields)>::Member>::read(
+                         value, out.*fields.member), true)) || ...);
+        }, Descriptor<T>::fields);
+        return ok;
+    }
+};
+
+/** Exact encoded size of value including DICT header */
+template <typename T>
+size_t encoded_size(const T &value) noexcept {
+    return Codec<T>::size(value);
+}
+
+/** Encodes value into buffer, returns number of bytes written or 0 when
+ * buffer is too small or some length does not fit into 24 bits */
+template <typename T>
+size_t encode(const T &value, uint8_t *buffer, size_t capacity) noexcept {
+    size_t size = encoded_size(value);
+    if (!buffer || size > capacity) {
+        return 0;
+    }
+    uint8_t *end = Codec<T>::write(buffer, value);
+    return end ? static_cast<size_t>(end - buffer) : 0;
+}
+
+template <typename T>
+bool decode(Item item, T &out) {
+    return item && Codec<T>::read(item, out);
+}
+
+/** Decodes first item of buffer */
+template <typename T>
+bool decode(const uint8_t *buffer, size_t size, T &out) {
+    if (!buffer || ::smoltlv::detail::check_item(buffer, size, false) == 0) {
+        return false;
+    }
+    return Codec<T>::read(Item(buffer), out);
+}
+
+} // namespace schema
+} // namespace smoltlv
+
+#define SMOLTLV_FIELD(T, member) \
+    ::smoltlv::schema::field(#member, &T::member)
+
+#define SMOLTLV_FIELD_NAMED(T, member, key) \
+    ::smoltlv::schema::field(key, &T::member)
+
+/** Must be used at global scope */
+#define SMOLTLV_SCHEMA(T, ...)                                          \
+    namespace smoltlv { namespace schema {                              \
+    template <>                                                         \
+    struct Descriptor<T> {                                              \
+        static constexpr auto fields = std::make_tuple(__VA_ARGS__);    \
+    };                                                                  \
+    } }
+
+#endif // H__SMOLTLV_SCHEMA_HPP
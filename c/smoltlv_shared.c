@@ -0,0 +1,479 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil -*-
+ * 
+ * SmolTLV - Simple serialization format for JSON/CBOR-like data model 
+ * for embedded devices - shared document.
+ * 
+ * Copyright (c) 2025 Aleš Hakl
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <smoltlv_shared.h>
+#include <stdlib.h>
+#include <string.h>
+#ifndef SMOLTLV_NO_THREADS
+#include <stdatomic.h>
+#endif
+
+#ifndef SMOLTLV_NO_THREADS
+#define SHARED_ATOMIC(type) _Atomic(type)
+#define shared_init(object, value) atomic_init(object, value)
+#define shared_load(object) atomic_load_explicit(object, memory_order_acquire)
+#define shared_store(object, value) atomic_store_explicit(object, value, memory_order_release)
+#define shared_add(object, value) atomic_fetch_add_explicit(object, value, memory_order_relaxed)
+#define shared_sub(object, value) atomic_fetch_sub_explicit(object, value, memory_order_relaxed)
+#define shared_publish(object, expected, desired) \
+    atomic_compare_exchange_strong_explicit(object, expected, desired, \
+                                            memory_order_acq_rel, memory_order_acquire)
+#else
+#define SHARED_ATOMIC(type) type
+#define shared_init(object, value) (*(object) = (value))
+#define shared_load(object) (*(object))
+#define shared_store(object, value) (*(object) = (value))
+#define shared_add(object, value) ((*(object) += (value)) - (value))
+#define shared_sub(object, value) ((*(object) -= (value)) + (value))
+#define shared_publish(object, expected, desired) \
+    (*(object) == *(expected) ? (*(object) = (desired), true) : (*(expected) = *(object), false))
+#endif
+
+/** Slots probed for a container before falling back to scan */
+#define SHARED_MAX_PROBES 8u
+
+typedef enum SharedIndexKind_e {
+    /** Container is scanned, marker saves counting it again */
+    SHARED_INDEX_NONE,
+    /** Container is scanned, its index did not fit the budget */
+    SHARED_INDEX_OVER_BUDGET,
+    SHARED_INDEX_LIST,
+    SHARED_INDEX_DICT,
+} SharedIndexKind;
+
+typedef struct SharedDictEntry_s {
+    /** Key bytes (in dict or string table), NULL for free entry */
+    const uint8_t *key;
+    uint32_t key_length;
+    uint32_t hash;
+    /** Value offset from dict content */
+    uint32_t value;
+} SharedDictEntry;
+
+typedef struct SharedIndex_s {
+    /** Offset of container in document */
+    size_t offset;
+    SharedIndexKind kind;
+    /** List items, or dict entries (power of two) */
+    size_t count;
+    /** Allocation size, charged to memory budget */
+    size_t memory;
+    /** Item offsets from list content (uint32_t) or SharedDictEntry */
+    void *entries;
+} SharedIndex;
+
+struct SmolTLV_SharedDocument_s {
+    const uint8_t *buffer;
+    size_t size;
+    SmolTLV_StringTable table;
+    SmolTLV_Item *strings;
+    size_t string_count;
+    SmolTLV_Item root;
+
+    size_t memory_budget;
+    size_t min_entries;
+    size_t slot_mask;
+    SHARED_ATOMIC(SharedIndex *) *slots;
+
+    SHARED_ATOMIC(size_t) memory_used;
+    SHARED_ATOMIC(size_t) indexes;
+    SHARED_ATOMIC(size_t) lost_races;
+    SHARED_ATOMIC(size_t) over_budget;
+};
+
+/** FNV-1a */
+static uint32_t hash_key(const uint8_t *key, size_t length) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ key[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static size_t hash_offset(size_t offset) {
+    return (size_t)(((uint64_t)offset * 0x9E3779B97F4A7C15ull) >> 32);
+}
+
+static size_t round_up_power_of_two(size_t value) {
+    size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+/** Resolves STRING_REF key, false for keys that are not strings */
+static bool resolve_key(const SmolTLV_SharedDocument *document,
+                        SmolTLV_Item key,
+                        SmolTLV_Item *out) {
+    uint32_t id;
+    if (SmolTLV_Item_as_string_ref(key, &id)) {
+        if (id >= document->string_count) {
+            return false;
+        }
+        key = document->strings[id];
+    }
+    *out = key;
+    return SmolTLV_Item_get_type(key) == SMOLTLV_TYPE_STRING;
+}
+
+/** Charges memory to budget, false when it does not fit */
+static bool shared_reserve(SmolTLV_SharedDocument *document, size_t memory) {
+    size_t used = shared_add(&document->memory_used, memory) + memory;
+    if (document->memory_budget > 0u && used > document->memory_budget) {
+        (void)shared_sub(&document->memory_used, memory);
+        return false;
+    }
+    return true;
+}
+
+/** Counts container items, false when it cannot be indexed (malformed,
+ * odd dict or dict with keys other than strings) */
+static bool count_items(const SmolTLV_SharedDocument *document,
+                        SmolTLV_Item container,
+                        size_t *out_count) {
+    bool is_dict = SmolTLV_Item_get_type(container) == SMOLTLV_TYPE_DICT;
+    SmolTLV_Cursor cursor;
+    SmolTLV_Item item, key;
+    SmolTLV_Status status;
+    size_t count = 0;
+
+    SmolTLV_Cursor_for_item(&cursor, container);
+    while ((status = SmolTLV_Cursor_next(&cursor, &item)) == SMOLTLV_STATUS_OK) {
+        if (is_dict && count % 2u == 0u && !resolve_key(document, item, &key)) {
+            return false;
+        }
+        count++;
+    }
+
+    *out_count = count;
+    return status == SMOLTLV_STATUS_END && (!is_dict || count % 2u == 0u);
+}
+
+static void fill_list(SharedIndex *index, SmolTLV_Item list) {
+    const uint8_t *base = SmolTLV_Item_get_value(list);
+    uint32_t *items = (uint32_t *)index->entries;
+    SmolTLV_Cursor cursor;
+    SmolTLV_Item item;
+    size_t i = 0;
+
+    SmolTLV_Cursor_for_item(&cursor, list);
+    while (SmolTLV_Cursor_next(&cursor, &item) == SMOLTLV_STATUS_OK) {
+        items[i++] = (uint32_t)(item.pointer - base);
+    }
+}
+
+static void fill_dict(const SmolTLV_SharedDocument *document, SharedIndex *index, SmolTLV_Item dict) {
+    const uint8_t *base = SmolTLV_Item_get_value(dict);
+    SharedDictEntry *entries = (SharedDictEntry *)index->entries;
+    size_t mask = index->count - 1u;
+    SmolTLV_Cursor cursor;
+    SmolTLV_Item key, value;
+
+    memset(entries, 0, index->count * sizeof(SharedDictEntry));
+    SmolTLV_Cursor_for_item(&cursor, dict);
+    while (SmolTLV_Cursor_next(&cursor, &key) == SMOLTLV_STATUS_OK &&
+           SmolTLV_Cursor_next(&cursor, &value) == SMOLTLV_STATUS_OK) {
+        resolve_key(document, key, &key);
+        const uint8_t *bytes = SmolTLV_Item_get_value(key);
+        uint32_t length = SmolTLV_Item_get_length(key);
+        uint32_t hash = hash_key(bytes, length);
+
+        // First occurrence of a key wins, as in linear scan
+        size_t slot = hash & mask;
+        while (entries[slot].key &&
+               !(entries[slot].hash == hash && entries[slot].key_length == length &&
+                 memcmp(entries[slot].key, bytes, length) == 0)) {
+            slot = (slot + 1u) & mask;
+        }
+        if (!entries[slot].key) {
+            entries[slot].key = bytes;
+            entries[slot].key_length = length;
+            entries[slot].hash = hash;
+            entries[slot].value = (uint32_t)(value.pointer - base);
+        }
+    }
+}
+
+/** Builds index (or scan marker) of container, NULL when out of memory */
+static SharedIndex *build_index(SmolTLV_SharedDocument *document,
+                                SmolTLV_Item container,
+                                size_t offset) {
+    SharedIndexKind kind = SmolTLV_Item_get_type(container) == SMOLTLV_TYPE_DICT
+        ? SHARED_INDEX_DICT : SHARED_INDEX_LIST;
+    size_t count = 0, payload = 0;
+
+    if (!count_items(document, container, &count) || count < document->min_entries) {
+        kind = SHARED_INDEX_NONE;
+    } else if (kind == SHARED_INDEX_DICT) {
+        // Load factor at most 1/2
+        count = round_up_power_of_two(count < 2u ? 2u : count);
+        payload = count * sizeof(SharedDictEntry);
+    } else {
+        payload = count * sizeof(uint32_t);
+    }
+
+    size_t memory = sizeof(SharedIndex) + payload;
+    if (kind != SHARED_INDEX_NONE && !shared_reserve(document, memory)) {
+        // Only this container is scanned, smaller ones may still fit
+        kind = SHARED_INDEX_OVER_BUDGET;
+        count = 0;
+        memory = sizeof(SharedIndex);
+    }
+    if (kind == SHARED_INDEX_NONE || kind == SHARED_INDEX_OVER_BUDGET) {
+        // Markers are bounded by slot count, not by budget
+        (void)shared_add(&document->memory_used, memory);
+    }
+    SharedIndex *index = (SharedIndex *)malloc(memory);
+    if (!index) {
+        (void)shared_sub(&document->memory_used, memory);
+        return NULL;
+    }
+
+    index->offset = offset;
+    index->kind = kind;
+    index->count = count;
+    index->memory = memory;
+    index->entries = index + 1;
+    if (kind == SHARED_INDEX_LIST) {
+        fill_list(index, container);
+    } else if (kind == SHARED_INDEX_DICT) {
+        fill_dict(document, index, container);
+    }
+    return index;
+}
+
+/** Published index of container, built on first access. NULL when the
+ * container is to be scanned. */
+static const SharedIndex *shared_index(SmolTLV_SharedDocument *document,
+                                       SmolTLV_Item container) {
+    if (container.pointer < document->buffer ||
+        container.pointer >= document->buffer + document->size) {
+        return NULL;
+    }
+
+    size_t offset = (size_t)(container.pointer - document->buffer);
+    size_t slot = hash_offset(offset) & document->slot_mask;
+    for (size_t probe = 0; probe < SHARED_MAX_PROBES; probe++) {
+        SharedIndex *index = shared_load(&document->slots[slot]);
+        if (!index) {
+            SharedIndex *built = build_index(document, container, offset);
+            if (!built) {
+                return NULL;
+            }
+
+            index = NULL;
+            if (shared_publish(&document->slots[slot], &index, built)) {
+                (void)shared_add(&document->indexes, 1u);
+                if (built->kind == SHARED_INDEX_OVER_BUDGET) {
+                    (void)shared_add(&document->over_budget, 1u);
+                }
+                index = built;
+            } else {
+                // Another thread published first, its index is used
+                (void)shared_add(&document->lost_races, 1u);
+                (void)shared_sub(&document->memory_used, built->memory);
+                free(built);
+            }
+        }
+
+        if (index->offset == offset) {
+            return index->kind == SHARED_INDEX_LIST || index->kind == SHARED_INDEX_DICT ? index : NULL;
+        }
+        slot = (slot + 1u) & document->slot_mask;
+    }
+    return NULL;
+}
+
+SmolTLV_SharedDocument *SmolTLV_SharedDocument_create(const uint8_t *buffer,
+                                                      size_t size,
+                                                      const SmolTLV_SharedConfig *config) {
+    if (!buffer && size > 0u) {
+        return NULL;
+    }
+
+    SmolTLV_SharedDocument *document =
+        (SmolTLV_SharedDocument *)calloc(1, sizeof(SmolTLV_SharedDocument));
+    if (!document) {
+        return NULL;
+    }
+    document->buffer = buffer;
+    document->size = size;
+    document->memory_budget = config ? config->memory_budget : SMOLTLV_SHARED_DEFAULT_BUDGET;
+    document->min_entries = config ? config->min_entries : SMOLTLV_SHARED_DEFAULT_MIN_ENTRIES;
+
+    size_t slot_count = round_up_power_of_two(
+        config && config->slot_count ? config->slot_count : SMOLTLV_SHARED_DEFAULT_SLOTS);
+    document->slot_mask = slot_count - 1u;
+    document->slots = (SHARED_ATOMIC(SharedIndex *) *)malloc(slot_count * sizeof(*document->slots));
+    if (!document->slots) {
+        free(document);
+        return NULL;
+    }
+    for (size_t i = 0; i < slot_count; i++) {
+        shared_init(&document->slots[i], NULL);
+    }
+    shared_init(&document->memory_used, 0u);
+    shared_init(&document->indexes, 0u);
+    shared_init(&document->lost_races, 0u);
+    shared_init(&document->over_budget, 0u);
+
+    // Leading string table resolves STRING_REF keys
+    SmolTLV_Cursor cursor;
+    SmolTLV_Item item;
+    SmolTLV_Cursor_init(&cursor, buffer, size);
+    while (SmolTLV_Cursor_next(&cursor, &item) == SMOLTLV_STATUS_OK) {
+        if (SmolTLV_Item_get_type(item) != SMOLTLV_TYPE_STRING_TABLE) {
+            document->root = item;
+            break;
+        }
+        if (document->table.item.pointer) {
+            continue;
+        }
+
+        SmolTLV_Cursor entries;
+        SmolTLV_Item entry;
+        size_t count = 0;
+        SmolTLV_StringTable_init(&document->table, item);
+        SmolTLV_Cursor_for_item(&entries, item);
+        while (SmolTLV_Cursor_next(&entries, &entry) == SMOLTLV_STATUS_OK) {
+            count++;
+        }
+        document->strings = (SmolTLV_Item *)malloc((count ? count : 1u) * sizeof(SmolTLV_Item));
+        if (!document->strings) {
+            SmolTLV_SharedDocument_destroy(document);
+            return NULL;
+        }
+        SmolTLV_Cursor_for_item(&entries, item);
+        while (SmolTLV_Cursor_next(&entries, &entry) == SMOLTLV_STATUS_OK) {
+            document->strings[document->string_count++] = entry;
+        }
+    }
+    return document;
+}
+
+void SmolTLV_SharedDocument_clear(SmolTLV_SharedDocument *document) {
+    if (!document) {
+        return;
+    }
+
+    for (size_t i = 0; i <= document->slot_mask; i++) {
+        free(shared_load(&document->slots[i]));
+        shared_store(&document->slots[i], NULL);
+    }
+    shared_store(&document->memory_used, 0u);
+    shared_store(&document->indexes, 0u);
+    shared_store(&document->over_budget, 0u);
+}
+
+void SmolTLV_SharedDocument_destroy(SmolTLV_SharedDocument *document) {
+    if (!document) {
+        return;
+    }
+
+    if (document->slots) {
+        SmolTLV_SharedDocument_clear(document);
+        free((void *)document->slots);
+    }
+    free(document->strings);
+    free(document);
+}
+
+bool SmolTLV_SharedDocument_get_root(const SmolTLV_SharedDocument *document,
+                                     SmolTLV_Item *out) {
+    if (!document || !document->root.pointer) {
+        return false;
+    }
+    if (out) {
+        *out = document->root;
+    }
+    return true;
+}
+
+bool SmolTLV_SharedDocument_dict_get(SmolTLV_SharedDocument *document,
+                                     SmolTLV_Item dict_item,
+                                     const char *key,
+                                     SmolTLV_Item *out) {
+    if (!document || !key || SmolTLV_Item_get_type(dict_item) != SMOLTLV_TYPE_DICT) {
+        return false;
+    }
+
+    const SharedIndex *index = shared_index(document, dict_item);
+    if (!index) {
+        return SmolTLV_Item_dict_get_interned(dict_item, &document->table, key, out);
+    }
+
+    const SharedDictEntry *entries = (const SharedDictEntry *)index->entries;
+    size_t length = strlen(key);
+    uint32_t hash = hash_key((const uint8_t *)key, length);
+    size_t mask = index->count - 1u;
+    for (size_t slot = hash & mask; entries[slot].key; slot = (slot + 1u) & mask) {
+        const SharedDictEntry *entry = &entries[slot];
+        if (entry->hash == hash && entry->key_length == length &&
+            memcmp(entry->key, key, length) == 0) {
+            if (out) {
+                out->pointer = SmolTLV_Item_get_value(dict_item) + entry->value;
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+bool SmolTLV_SharedDocument_list_at(SmolTLV_SharedDocument *document,
+                                    SmolTLV_Item list_item,
+                                    size_t index,
+                                    SmolTLV_Item *out) {
+    if (!document || SmolTLV_Item_get_type(list_item) != SMOLTLV_TYPE_LIST) {
+        return false;
+    }
+
+    const SharedIndex *list_index = shared_index(document, list_item);
+    if (!list_index) {
+        return SmolTLV_Item_list_at(list_item, index, out);
+    }
+
+    if (index >= list_index->count) {
+        return false;
+    }
+    if (out) {
+        out->pointer = SmolTLV_Item_get_value(list_item) + ((const uint32_t *)list_index->entries)[index];
+    }
+    return true;
+}
+
+void SmolTLV_SharedDocument_get_stats(const SmolTLV_SharedDocument *document,
+                                      SmolTLV_SharedStats *out) {
+    if (!document || !out) {
+        return;
+    }
+    // Counters are only read, casts drop const for atomic loads
+    SmolTLV_SharedDocument *mutable_document = (SmolTLV_SharedDocument *)document;
+    out->indexes = shared_load(&mutable_document->indexes);
+    out->memory_used = shared_load(&mutable_document->memory_used);
+    out->lost_races = shared_load(&mutable_document->lost_races);
+    out->over_budget = shared_load(&mutable_document->over_budget);
+}
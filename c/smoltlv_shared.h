@@ -0,0 +1,118 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil -*-
+ * 
+ * SmolTLV - Simple serialization format for JSON/CBOR-like data model 
+ * for embedded devices - shared document.
+ * 
+ * Copyright (c) 2025 Aleš Hakl
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef H__SMOLTLV_SHARED
+#define H__SMOLTLV_SHARED
+
+#include <smoltlv.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Shared read-only document. Lookups from any number of threads build a
+ * lookup index of the dict or list on first access (hash table of keys,
+ * offsets of list items) and publish it into a fixed slot table with
+ * compare-and-swap: first builder wins, losers free their copy and use
+ * the published one. Readers take no locks.
+ *
+ * Index memory is bounded by memory_budget. A container whose index does
+ * not fit gets a small marker and is scanned, containers found later are
+ * still indexed while the rest of the budget lasts. Containers with fewer
+ * than min_entries items, or colliding in a full slot table, are scanned
+ * too. Indexes are not evicted, readers hold no references that would
+ * make freeing one safe: published indexes live until
+ * SmolTLV_SharedDocument_clear or destroy, which must not run
+ * concurrently with lookups.
+ *
+ * STRING_REF keys are resolved through the string table when buffer
+ * starts with one, dicts with keys other than strings are scanned.
+ */
+
+typedef struct SmolTLV_SharedDocument_s SmolTLV_SharedDocument;
+
+typedef struct SmolTLV_SharedConfig_s {
+    /** Bytes available for indexes, 0 means unlimited */
+    size_t memory_budget;
+    /** Containers with fewer items are scanned */
+    size_t min_entries;
+    /** Index slots (rounded up to power of two), bounds the number of
+     * indexed containers */
+    size_t slot_count;
+} SmolTLV_SharedConfig;
+
+#define SMOLTLV_SHARED_DEFAULT_BUDGET (16u * 1024u * 1024u)
+#define SMOLTLV_SHARED_DEFAULT_MIN_ENTRIES 16u
+#define SMOLTLV_SHARED_DEFAULT_SLOTS 4096u
+
+typedef struct SmolTLV_SharedStats_s {
+    /** Published indexes and scan markers */
+    size_t indexes;
+    /** Bytes held by published indexes */
+    size_t memory_used;
+    /** Indexes built by a thread that lost the publishing race */
+    size_t lost_races;
+    /** Containers scanned because their index did not fit the budget */
+    size_t over_budget;
+} SmolTLV_SharedStats;
+
+/** Document over buffer, which has to outlive it. Config can be NULL 
+ * for defaults. */
+extern SmolTLV_SharedDocument *SmolTLV_SharedDocument_create(
+    const uint8_t *buffer,
+    size_t size,
+    const SmolTLV_SharedConfig *config
+);
+extern void SmolTLV_SharedDocument_destroy(SmolTLV_SharedDocument *document);
+
+/** First top-level item other than string table */
+extern bool SmolTLV_SharedDocument_get_root(const SmolTLV_SharedDocument *document,
+                                            SmolTLV_Item *out);
+
+/** Same results as SmolTLV_Item_dict_get_interned with the document's 
+ * string table, item has to point into the document */
+extern bool SmolTLV_SharedDocument_dict_get(SmolTLV_SharedDocument *document,
+                                            SmolTLV_Item dict_item,
+                                            const char *key,
+                                            SmolTLV_Item *out);
+/** Same results as SmolTLV_Item_list_at */
+extern bool SmolTLV_SharedDocument_list_at(SmolTLV_SharedDocument *document,
+                                           SmolTLV_Item list_item,
+                                           size_t index,
+                                           SmolTLV_Item *out);
+
+/** Frees all indexes, not safe while other threads do lookups */
+extern void SmolTLV_SharedDocument_clear(SmolTLV_SharedDocument *document);
+
+extern void SmolTLV_SharedDocument_get_stats(const SmolTLV_SharedDocument *document,
+                                             SmolTLV_SharedStats *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // H__SMOLTLV_SHARED
@@ -0,0 +1,205 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil -*-
+ * 
+ * SmolTLV - Simple serialization format for JSON/CBOR-like data model 
+ * for embedded devices - shared transcoder output.
+ * 
+ * Copyright (c) 2025 Aleš Hakl
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef H__SMOLTLV_WRITER
+#define H__SMOLTLV_WRITER
+
+/*
+ * Buffered output shared by the JSON and CBOR transcoders. Internal, not
+ * part of the public API: functions are static inline so that each
+ * transcoder stays a single object file.
+ *
+ * Errors are sticky, the first failing status is kept in the writer and
+ * later output is dropped, so writing functions return nothing and
+ * callers check status where it matters.
+ */
+
+#include <smoltlv.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TRANSCODE_OUTPUT_SIZE 4096u
+
+typedef struct TranscodeWriter_s {
+    SmolTLV_WriteFunction write;
+    void *context;
+    SmolTLV_Status status;
+    /** Entries of string table in effect */
+    SmolTLV_Item *strings;
+    size_t string_count;
+    size_t used;
+    uint8_t output[TRANSCODE_OUTPUT_SIZE];
+} TranscodeWriter;
+
+static inline void writer_init(TranscodeWriter *writer, SmolTLV_WriteFunction write, void *context) {
+    writer->write = write;
+    writer->context = context;
+    writer->status = SMOLTLV_STATUS_OK;
+    writer->strings = NULL;
+    writer->string_count = 0;
+    writer->used = 0;
+}
+
+static inline void writer_flush(TranscodeWriter *writer) {
+    if (writer->used > 0u && writer->status == SMOLTLV_STATUS_OK) {
+        writer->status = writer->write(writer->output, writer->used, writer->context);
+    }
+    writer->used = 0;
+}
+
+/** At least size (<= TRANSCODE_OUTPUT_SIZE) bytes of output space */
+static inline uint8_t *writer_reserve(TranscodeWriter *writer, size_t size) {
+    if (writer->used + size > TRANSCODE_OUTPUT_SIZE) {
+        writer_flush(writer);
+    }
+    return writer->output + writer->used;
+}
+
+/** Data larger than the buffer goes to write function directly */
+static inline void writer_bytes(TranscodeWriter *writer, const void *data, size_t length) {
+    if (writer->used + length > TRANSCODE_OUTPUT_SIZE) {
+        writer_flush(writer);
+        if (length > TRANSCODE_OUTPUT_SIZE) {
+            if (writer->status == SMOLTLV_STATUS_OK) {
+                writer->status = writer->write((const uint8_t *)data, length, writer->context);
+            }
+            return;
+        }
+    }
+    memcpy(writer->output + writer->used, data, length);
+    writer->used += length;
+}
+
+static inline SmolTLV_Status writer_finish(TranscodeWriter *writer) {
+    writer_flush(writer);
+    free(writer->strings);
+    return writer->status;
+}
+
+/** Caches entries of string table item for STRING_REF lookups */
+static inline void writer_set_table(TranscodeWriter *writer, SmolTLV_Item table) {
+    SmolTLV_Cursor cursor;
+    SmolTLV_Item entry;
+    size_t count = 0;
+
+    free(writer->strings);
+    writer->strings = NULL;
+    writer->string_count = 0;
+
+    SmolTLV_Cursor_for_item(&cursor, table);
+    while (SmolTLV_Cursor_next(&cursor, &entry) == SMOLTLV_STATUS_OK) {
+        count++;
+    }
+    if (count == 0u) {
+        return;
+    }
+
+    writer->strings = (SmolTLV_Item *)malloc(count * sizeof(SmolTLV_Item));
+    if (!writer->strings) {
+        writer->status = SMOLTLV_STATUS_OUT_OF_MEMORY;
+        return;
+    }
+
+    SmolTLV_Cursor_for_item(&cursor, table);
+    while (SmolTLV_Cursor_next(&cursor, &entry) == SMOLTLV_STATUS_OK) {
+        writer->strings[writer->string_count++] = entry;
+    }
+}
+
+/** STRING item of STRING or STRING_REF, false (with INVALID_FORMAT
+ * status) for other items and unknown references */
+static inline bool writer_resolve_string(TranscodeWriter *writer, SmolTLV_Item item, SmolTLV_Item *out) {
+    uint32_t id;
+    if (SmolTLV_Item_as_string_ref(item, &id)) {
+        if (id >= writer->string_count) {
+            writer->status = SMOLTLV_STATUS_INVALID_FORMAT;
+            return false;
+        }
+        item = writer->strings[id];
+    }
+    if (SmolTLV_Item_get_type(item) != SMOLTLV_TYPE_STRING) {
+        writer->status = SMOLTLV_STATUS_INVALID_FORMAT;
+        return false;
+    }
+    *out = item;
+    return true;
+}
+
+/** Big-endian unsigned value of size bytes */
+static inline uint64_t load_element(const uint8_t *p, size_t size) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < size; i++) {
+        value = (value << 8) | p[i];
+    }
+    return value;
+}
+
+/** Sign-extended element of integer array */
+static inline int64_t load_int_element(const uint8_t *p, size_t size) {
+    uint64_t value = load_element(p, size);
+    uint64_t sign = (uint64_t)1u << (size * 8u - 1u);
+    return (int64_t)((value ^ sign) - sign);
+}
+
+/** Reader over rows of record batch item with columns allocated for it,
+ * free reader->columns when done. False (with status set) for invalid
+ * batch. */
+static inline bool writer_start_batch(TranscodeWriter *writer, SmolTLV_Item item, SmolTLV_BatchReader *reader) {
+    SmolTLV_Batch batch;
+    if (SmolTLV_Batch_init(&batch, item) != SMOLTLV_STATUS_OK) {
+        writer->status = SMOLTLV_STATUS_INVALID_FORMAT;
+        return false;
+    }
+
+    size_t capacity = batch.column_count ? batch.column_count : 1u;
+    SmolTLV_BatchReaderColumn *columns =
+        (SmolTLV_BatchReaderColumn *)malloc(capacity * sizeof(SmolTLV_BatchReaderColumn));
+    if (!columns) {
+        writer->status = SMOLTLV_STATUS_OUT_OF_MEMORY;
+        return false;
+    }
+    if (SmolTLV_BatchReader_init(reader, &batch, columns, capacity) != SMOLTLV_STATUS_OK) {
+        writer->status = SMOLTLV_STATUS_INVALID_FORMAT;
+        free(columns);
+        return false;
+    }
+    return true;
+}
+
+/** Moves reader to next row, false after last row or on error (with
+ * status set) */
+static inline bool writer_next_row(TranscodeWriter *writer, SmolTLV_BatchReader *reader) {
+    if (writer->status != SMOLTLV_STATUS_OK) {
+        return false;
+    }
+    SmolTLV_Status status = SmolTLV_BatchReader_next(reader);
+    if (status != SMOLTLV_STATUS_OK && status != SMOLTLV_STATUS_END) {
+        writer->status = status;
+    }
+    return status == SMOLTLV_STATUS_OK;
+}
+
+#endif // H__SMOLTLV_WRITER
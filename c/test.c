@@ -1,8 +1,21 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include <smoltlv.h>
+#include <smoltlv_archive.h>
+#include <smoltlv_cbor.h>
+#include <smoltlv_diff.h>
+#include <smoltlv_dom.h>
+#include <smoltlv_extract.h>
+#include <smoltlv_ingest.h>
+#include <smoltlv_json.h>
+#include <smoltlv_parallel.h>
+#include <smoltlv_shared.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <string.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <unistd.h>
 
 uint8_t test_null[] = {
     0x00, 0x00, 0x00, 0x00
@@ -102,7 +115,7 @@ void test_decode_integer() {
     if (value == 42) {
         printf("Successfully decoded integer 42\n");
     } else {
-        printf("Decoded integer is %lld, expected 42\n", value);
+        printf("Decoded integer is %lld, expected 42\n", (long long)value);
     }
 }
 
@@ -131,7 +144,7 @@ void test_decode_negative_integer() {
     if (value == -42) {
         printf("Successfully decoded integer -42\n");
     } else {
-        printf("Decoded integer is %lld, expected -42\n", value);
+        printf("Decoded integer is %lld, expected -42\n", (long long)value);
     }
 }
 
@@ -403,6 +416,2363 @@ void test_encode_dict(){
     SmolTLV_Encoder_destroy(encoder);
 }
 
+uint8_t test_int16_array[] = {
+    0x09, 0x00, 0x00, 0x06, // Type: ARRAY_INT16, Length: 6
+    0x00, 0x01,             // 1
+    0xFF, 0xFE,             // -2
+    0x12, 0x34              // 0x1234
+};
+
+void test_decode_array() {
+    SmolTLV_Cursor cursor;
+    SmolTLV_Cursor_init(&cursor, test_int16_array, sizeof(test_int16_array));
+
+    SmolTLV_Item item;
+    SmolTLV_Status status = SmolTLV_Cursor_next(&cursor, &item);
+    if (status != SMOLTLV_STATUS_OK) {
+        printf("Failed to decode array item: %d\n", status);
+        return;
+    }
+
+    size_t count;
+    if (!SmolTLV_Item_array_count(item, &count) || count != 3) {
+        printf("Decoded item is not an array of 3 elements\n");
+        return;
+    }
+
+    int64_t value;
+    if (!SmolTLV_Item_array_get_int(item, 1, &value) || value != -2) {
+        printf("Second array element is not -2\n");
+        return;
+    }
+
+    int16_t values[3];
+    if (!SmolTLV_Item_array_copy(item, values, 3)) {
+        printf("Failed to copy array\n");
+        return;
+    }
+
+    if (values[0] != 1 || values[1] != -2 || values[2] != 0x1234) {
+        printf("Copied array does not match expected values\n");
+        return;
+    }
+
+    uint8_t bad_array[] = {
+        0x0A, 0x00, 0x00, 0x06, // ARRAY_INT32 with length not multiple of 4
+        0x00, 0x00, 0x00, 0x01, 0x00, 0x00
+    };
+    SmolTLV_Cursor_init(&cursor, bad_array, sizeof(bad_array));
+    status = SmolTLV_Cursor_next(&cursor, &item);
+    if (status != SMOLTLV_STATUS_INVALID_FORMAT) {
+        printf("Misaligned array was not rejected: %d\n", status);
+        return;
+    }
+
+    printf("Successfully decoded int16 array [1, -2, 0x1234]\n");
+}
+
+void test_encode_array() {
+    SmolTLV_Encoder *encoder = SmolTLV_Encoder_create();
+    if (!encoder) {
+        printf("Failed to create encoder\n");
+        return;
+    }
+
+    int16_t values[] = { 1, -2, 0x1234 };
+    SmolTLV_Status status = SmolTLV_Encoder_write_int16_array(encoder, values, 3);
+    if (status != SMOLTLV_STATUS_OK) {
+        printf("Failed to encode array: %d\n", status);
+        SmolTLV_Encoder_destroy(encoder);
+        return;
+    }
+
+    double doubles[] = { 1.5, -0.25 };
+    status = SmolTLV_Encoder_write_double_array(encoder, doubles, 2);
+    if (status != SMOLTLV_STATUS_OK) {
+        printf("Failed to encode double array: %d\n", status);
+        SmolTLV_Encoder_destroy(encoder);
+        return;
+    }
+
+    const uint8_t *buffer;
+    size_t size;
+    status = SmolTLV_Encoder_finalize(encoder, &buffer, &size);
+    if (status != SMOLTLV_STATUS_OK) {
+        printf("Failed to finalize encoding: %d\n", status);
+        SmolTLV_Encoder_destroy(encoder);
+        return;
+    }
+
+    printf("Successfully encoded arrays, size: %zu\n", size);
+
+    if (size != sizeof(test_int16_array) + 20 || 
+        memcmp(buffer, test_int16_array, sizeof(test_int16_array)) != 0) {
+        printf("Encoded int16 array does not match expected output\n");
+    } else {
+        SmolTLV_Cursor cursor;
+        SmolTLV_Item item;
+        double value;
+        SmolTLV_Cursor_init(&cursor, buffer, size);
+        SmolTLV_Cursor_next(&cursor, &item);
+        if (SmolTLV_Cursor_next(&cursor, &item) != SMOLTLV_STATUS_OK ||
+            !SmolTLV_Item_array_get_float(item, 1, &value) || value != -0.25) {
+            printf("Encoded double array does not match expected output\n");
+        } else {
+            printf("Encoded arrays match expected output\n");
+        }
+    }
+
+    free((void*)buffer);
+    SmolTLV_Encoder_destroy(encoder);
+}
+
+/** Keys resolved once give the same results as interned lookups */
+static bool test_string_table_keys(SmolTLV_Item dict_item, const SmolTLV_StringTable *table) {
+    static const char *const names[] = { "name", "age", "city", "missing" };
+    SmolTLV_Key key;
+    SmolTLV_Item item, expected;
+    for (size_t i = 0; i < 4; i++) {
+        bool found = SmolTLV_Item_dict_get_interned(dict_item, table, names[i], &expected);
+        if (!SmolTLV_Key_init(&key, table, names[i]) || key.has_id != (i < 2) ||
+            SmolTLV_Item_dict_get_key(dict_item, &key, &item) != found ||
+            (found && item.pointer != expected.pointer)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/** Keys of a large table (with a duplicate entry) are written as
+ * references to their first entry */
+static bool test_string_table_index() {
+    static char names[301][8];
+    const char *strings[301];
+    for (size_t i = 0; i < 300; i++) {
+        snprintf(names[i], sizeof(names[i]), "k%zu", i);
+        strings[i] = names[i];
+    }
+    strings[300] = "k5";
+
+    SmolTLV_Encoder *encoder = SmolTLV_Encoder_create();
+    SmolTLV_Encoder_write_string_table(encoder, strings, 301);
+    SmolTLV_Encoder_start_list(encoder);
+    SmolTLV_Encoder_write_key(encoder, "k299");
+    SmolTLV_Encoder_write_key(encoder, "k5");
+    SmolTLV_Encoder_write_key(encoder, "k");
+    SmolTLV_Encoder_end(encoder);
+
+    const uint8_t *buffer;
+    size_t size;
+    bool ok = SmolTLV_Encoder_finalize(encoder, &buffer, &size) == SMOLTLV_STATUS_OK;
+    SmolTLV_Encoder_destroy(encoder);
+    if (!ok) {
+        return false;
+    }
+
+    SmolTLV_Cursor cursor;
+    SmolTLV_Item list, item;
+    uint32_t id;
+    SmolTLV_Cursor_init(&cursor, buffer, size);
+    ok = SmolTLV_Cursor_next(&cursor, &list) == SMOLTLV_STATUS_OK &&
+         SmolTLV_Cursor_next(&cursor, &list) == SMOLTLV_STATUS_OK &&
+         SmolTLV_Item_list_at(list, 0, &item) && SmolTLV_Item_as_string_ref(item, &id) && id == 299 &&
+         SmolTLV_Item_list_at(list, 1, &item) && SmolTLV_Item_as_string_ref(item, &id) && id == 5 &&
+         SmolTLV_Item_list_at(list, 2, &item) && SmolTLV_Item_strcmp(item, "k");
+    free((void*)buffer);
+    return ok;
+}
+
+void test_string_table() {
+    SmolTLV_Encoder *encoder = SmolTLV_Encoder_create();
+    if (!encoder) {
+        printf("Failed to create encoder\n");
+        return;
+    }
+
+    const char *keys[] = { "name", "age" };
+    SmolTLV_Status status = SmolTLV_Encoder_write_string_table(encoder, keys, 2);
+    if (status != SMOLTLV_STATUS_OK) {
+        printf("Failed to write string table: %d\n", status);
+        SmolTLV_Encoder_destroy(encoder);
+        return;
+    }
+
+    SmolTLV_Encoder_start_dict(encoder);
+    SmolTLV_Encoder_write_key(encoder, "name");
+    SmolTLV_Encoder_write_string(encoder, "Alice");
+    SmolTLV_Encoder_write_key(encoder, "age");
+    SmolTLV_Encoder_write_int(encoder, 30);
+    SmolTLV_Encoder_write_key(encoder, "city");
+    SmolTLV_Encoder_write_string(encoder, "Prague");
+    status = SmolTLV_Encoder_end(encoder);
+    if (status != SMOLTLV_STATUS_OK) {
+        printf("Failed to end dict: %d\n", status);
+        SmolTLV_Encoder_destroy(encoder);
+        return;
+    }
+
+    const uint8_t *buffer;
+    size_t size;
+    status = SmolTLV_Encoder_finalize(encoder, &buffer, &size);
+    if (status != SMOLTLV_STATUS_OK) {
+        printf("Failed to finalize encoding: %d\n", status);
+        SmolTLV_Encoder_destroy(encoder);
+        return;
+    }
+
+    SmolTLV_Cursor cursor;
+    SmolTLV_Item table_item, dict_item, item;
+    SmolTLV_StringTable table;
+    SmolTLV_Cursor_init(&cursor, buffer, size);
+
+    if (SmolTLV_Cursor_next(&cursor, &table_item) != SMOLTLV_STATUS_OK ||
+        !SmolTLV_StringTable_init(&table, table_item) ||
+        SmolTLV_Cursor_next(&cursor, &dict_item) != SMOLTLV_STATUS_OK) {
+        printf("Failed to decode string table document\n");
+    } else {
+        int64_t age;
+        uint32_t id;
+        if (!SmolTLV_Item_dict_get_interned(dict_item, &table, "age", &item) ||
+            !SmolTLV_Item_as_int(item, &age) || age != 30) {
+            printf("Interned lookup of 'age' failed\n");
+        } else if (!SmolTLV_Item_dict_get_interned(dict_item, &table, "city", &item) ||
+                   !SmolTLV_Item_strcmp(item, "Prague")) {
+            printf("Interned lookup of non-interned 'city' failed\n");
+        } else if (!SmolTLV_StringTable_find(&table, "name", &id) || id != 0 ||
+                   !SmolTLV_Item_dict_get_id(dict_item, id, &item) ||
+                   !SmolTLV_Item_strcmp(item, "Alice")) {
+            printf("Lookup of 'name' by id failed\n");
+        } else if (!SmolTLV_Item_dict_get(dict_item, "city", &item) ||
+                   SmolTLV_Item_dict_get(dict_item, "name", &item)) {
+            printf("Plain lookup in interned dict failed\n");
+        } else if (!test_string_table_keys(dict_item, &table)) {
+            printf("Lookup by resolved key failed\n");
+        } else if (!test_string_table_index()) {
+            printf("Large string table keys not interned\n");
+        } else {
+            printf("Successfully encoded and decoded dict with string table, size: %zu\n", size);
+        }
+    }
+
+    free((void*)buffer);
+    SmolTLV_Encoder_destroy(encoder);
+}
+
+void test_record_batch() {
+    SmolTLV_Encoder *encoder = SmolTLV_Encoder_create();
+    if (!encoder) {
+        printf("Failed to create encoder\n");
+        return;
+    }
+
+    int64_t timestamps[] = { 1700000000000, 1700000000010, 1700000000020, 1700000000031 };
+    int16_t temperatures[] = { 215, 216, 216, 214 };
+
+    SmolTLV_Encoder_start_batch(encoder);
+    SmolTLV_Encoder_start_list(encoder);
+    SmolTLV_Encoder_write_string(encoder, "ts");
+    SmolTLV_Encoder_write_string(encoder, "temp");
+    SmolTLV_Encoder_write_string(encoder, "status");
+    SmolTLV_Encoder_end(encoder);
+    SmolTLV_Encoder_write_delta_column(encoder, timestamps, 4);
+    SmolTLV_Encoder_write_int16_array(encoder, temperatures, 4);
+    SmolTLV_Encoder_start_list(encoder);
+    SmolTLV_Encoder_write_string(encoder, "ok");
+    SmolTLV_Encoder_write_string(encoder, "ok");
+    SmolTLV_Encoder_write_string(encoder, "warn");
+    SmolTLV_Encoder_write_string(encoder, "ok");
+    SmolTLV_Encoder_end(encoder);
+    SmolTLV_Status status = SmolTLV_Encoder_end(encoder);
+    if (status != SMOLTLV_STATUS_OK) {
+        printf("Failed to encode record batch: %d\n", status);
+        SmolTLV_Encoder_destroy(encoder);
+        return;
+    }
+
+    const uint8_t *buffer;
+    size_t size;
+    status = SmolTLV_Encoder_finalize(encoder, &buffer, &size);
+    SmolTLV_Encoder_destroy(encoder);
+    if (status != SMOLTLV_STATUS_OK) {
+        printf("Failed to finalize encoding: %d\n", status);
+        return;
+    }
+
+    SmolTLV_Cursor cursor;
+    SmolTLV_Item item;
+    SmolTLV_Batch batch;
+    SmolTLV_Cursor_init(&cursor, buffer, size);
+    SmolTLV_Cursor_next(&cursor, &item);
+    status = SmolTLV_Batch_init(&batch, item);
+    if (status != SMOLTLV_STATUS_OK || batch.column_count != 3 || batch.row_count != 4) {
+        printf("Failed to decode record batch: %d\n", status);
+        free((void*)buffer);
+        return;
+    }
+
+    size_t index;
+    SmolTLV_Item column;
+    int64_t values[4];
+    if (!SmolTLV_Batch_find_column(&batch, NULL, "ts", &index) ||
+        !SmolTLV_Batch_get_column(&batch, index, NULL, &column) ||
+        SmolTLV_Item_get_type(column) != SMOLTLV_TYPE_DELTA ||
+        !SmolTLV_Column_decode_int(column, values, 4) ||
+        memcmp(values, timestamps, sizeof(values)) != 0) {
+        printf("Delta column 'ts' does not match\n");
+        free((void*)buffer);
+        return;
+    }
+
+    // Rows in one pass, DELTA column summed as rows advance
+    SmolTLV_BatchReaderColumn reader_columns[3];
+    SmolTLV_BatchReader reader;
+    bool rows_ok = SmolTLV_BatchReader_init(&reader, &batch, reader_columns, 2) == SMOLTLV_STATUS_INVALID_ARGUMENT &&
+                   SmolTLV_BatchReader_init(&reader, &batch, reader_columns, 3) == SMOLTLV_STATUS_OK;
+    for (size_t row = 0; rows_ok && row < 4; row++) {
+        rows_ok = SmolTLV_BatchReader_next(&reader) == SMOLTLV_STATUS_OK &&
+                  reader_columns[0].int_value == timestamps[row] &&
+                  reader_columns[1].int_value == temperatures[row] &&
+                  SmolTLV_Item_get_type(reader_columns[2].item) == SMOLTLV_TYPE_STRING;
+    }
+    if (!rows_ok || SmolTLV_BatchReader_next(&reader) != SMOLTLV_STATUS_END) {
+        printf("Batch reader rows do not match\n");
+        free((void*)buffer);
+        return;
+    }
+
+    // Schema with interned keys
+    static const char *const schema_keys[] = { "ts", "temp" };
+    SmolTLV_StringTable table;
+    SmolTLV_Batch interned;
+    encoder = SmolTLV_Encoder_create();
+    SmolTLV_Encoder_write_string_table(encoder, schema_keys, 2);
+    SmolTLV_Encoder_start_batch(encoder);
+    SmolTLV_Encoder_start_list(encoder);
+    SmolTLV_Encoder_write_string_ref(encoder, 0);
+    SmolTLV_Encoder_write_string_ref(encoder, 1);
+    SmolTLV_Encoder_end(encoder);
+    SmolTLV_Encoder_write_delta_column(encoder, timestamps, 4);
+    SmolTLV_Encoder_write_int16_array(encoder, temperatures, 4);
+    SmolTLV_Encoder_end(encoder);
+    const uint8_t *interned_buffer;
+    size_t interned_size;
+    SmolTLV_Item table_item;
+    rows_ok = SmolTLV_Encoder_finalize(encoder, &interned_buffer, &interned_size) == SMOLTLV_STATUS_OK;
+    SmolTLV_Encoder_destroy(encoder);
+    if (rows_ok) {
+        SmolTLV_Cursor_init(&cursor, interned_buffer, interned_size);
+        SmolTLV_Cursor_next(&cursor, &table_item);
+        SmolTLV_Cursor_next(&cursor, &item);
+        rows_ok = SmolTLV_StringTable_init(&table, table_item) &&
+                  SmolTLV_Batch_init(&interned, item) == SMOLTLV_STATUS_OK &&
+                  SmolTLV_Batch_find_column(&interned, &table, "temp", &index) && index == 1 &&
+                  !SmolTLV_Batch_find_column(&interned, NULL, "temp", &index) &&
+                  !SmolTLV_Batch_find_column(&interned, &table, "status", &index);
+        free((void*)interned_buffer);
+    }
+    if (!rows_ok) {
+        printf("Interned batch column not found\n");
+        free((void*)buffer);
+        return;
+    }
+
+    encoder = SmolTLV_Encoder_create();
+    status = SmolTLV_Batch_write_row(&batch, 2, encoder);
+    const uint8_t *row_buffer;
+    size_t row_size;
+    if (status != SMOLTLV_STATUS_OK ||
+        SmolTLV_Encoder_finalize(encoder, &row_buffer, &row_size) != SMOLTLV_STATUS_OK) {
+        printf("Failed to reconstruct row: %d\n", status);
+    } else {
+        int64_t ts, temp;
+        SmolTLV_Item row, value;
+        SmolTLV_Cursor_init(&cursor, row_buffer, row_size);
+        SmolTLV_Cursor_next(&cursor, &row);
+        if (!SmolTLV_Item_dict_get(row, "ts", &value) || 
+            !SmolTLV_Item_as_int(value, &ts) || ts != timestamps[2] ||
+            !SmolTLV_Item_dict_get(row, "temp", &value) || 
+            !SmolTLV_Item_as_int(value, &temp) || temp != 216 ||
+            !SmolTLV_Item_dict_get(row, "status", &value) || 
+            !SmolTLV_Item_strcmp(value, "warn")) {
+            printf("Reconstructed row does not match\n");
+        } else {
+            printf("Successfully decoded record batch, size: %zu\n", size);
+        }
+        free((void*)row_buffer);
+    }
+
+    SmolTLV_Encoder_destroy(encoder);
+    free((void*)buffer);
+}
+
+static bool skip_id_2(SmolTLV_Item record, void *context) {
+    (void)context;
+    SmolTLV_Item item;
+    int64_t id;
+    return !(SmolTLV_Item_dict_get(record, "id", &item) && 
+             SmolTLV_Item_as_int(item, &id) && id == 2);
+}
+
+void test_extract() {
+    SmolTLV_Encoder *encoder = SmolTLV_Encoder_create();
+    if (!encoder) {
+        printf("Failed to create encoder\n");
+        return;
+    }
+
+    for (int i = 0; i < 20; i++) {
+        SmolTLV_Encoder_start_dict(encoder);
+        SmolTLV_Encoder_write_string(encoder, "id");
+        SmolTLV_Encoder_write_int(encoder, i);
+        if (i % 3 != 0) {
+            SmolTLV_Encoder_write_string(encoder, "meta");
+            SmolTLV_Encoder_start_dict(encoder);
+            SmolTLV_Encoder_write_string(encoder, "score");
+            SmolTLV_Encoder_write_int(encoder, i * 10);
+            SmolTLV_Encoder_end(encoder);
+        }
+        SmolTLV_Encoder_end(encoder);
+    }
+
+    const uint8_t *buffer;
+    size_t size;
+    SmolTLV_Status status = SmolTLV_Encoder_finalize(encoder, &buffer, &size);
+    SmolTLV_Encoder_destroy(encoder);
+    if (status != SMOLTLV_STATUS_OK) {
+        printf("Failed to finalize encoding: %d\n", status);
+        return;
+    }
+
+    const char *id_path[] = { "id", NULL };
+    const char *score_path[] = { "meta", "score", NULL };
+    int64_t ids[20];
+    double scores[20];
+    uint8_t score_validity[3];
+
+    SmolTLV_ExtractColumn columns[] = {
+        { id_path, SMOLTLV_COLUMN_INT64, ids, NULL },
+        { score_path, SMOLTLV_COLUMN_DOUBLE, scores, score_validity },
+    };
+    SmolTLV_Extract extract = { columns, 2, skip_id_2, NULL, 4 };
+
+    size_t rows;
+    status = SmolTLV_extract(&extract, buffer, size, 20, &rows);
+    if (status != SMOLTLV_STATUS_OK || rows != 19) {
+        printf("Failed to extract columns: %d\n", status);
+        free((void*)buffer);
+        return;
+    }
+
+    bool ok = true;
+    for (size_t row = 0; row < rows; row++) {
+        int64_t id = (int64_t)(row < 2 ? row : row + 1);
+        bool valid = (score_validity[row / 8] >> (row % 8)) & 1;
+        if (ids[row] != id || valid != (id % 3 != 0) || 
+            (valid && scores[row] != (double)(id * 10))) {
+            ok = false;
+        }
+    }
+
+    status = SmolTLV_extract(&extract, buffer, size, 10, &rows);
+    if (status != SMOLTLV_STATUS_INVALID_ARGUMENT || rows != 19) {
+        ok = false;
+    }
+
+    if (ok) {
+        printf("Successfully extracted %zu rows into columns\n", (size_t)19);
+    } else {
+        printf("Extracted columns do not match expected values\n");
+    }
+    free((void*)buffer);
+}
+
+static SmolTLV_Status encode_patch_doc(SmolTLV_Encoder *encoder, 
+                                       bool patched) {
+    SmolTLV_Encoder_start_dict(encoder);
+    SmolTLV_Encoder_write_string(encoder, "ts");
+    SmolTLV_Encoder_write_int(encoder, patched ? 1700000000 : 1);
+    SmolTLV_Encoder_write_string(encoder, "route");
+    SmolTLV_Encoder_write_string(encoder, patched ? "gateway-2" : "a");
+    if (!patched) {
+        SmolTLV_Encoder_write_string(encoder, "flags");
+        SmolTLV_Encoder_start_list(encoder);
+        SmolTLV_Encoder_write_bool(encoder, true);
+        SmolTLV_Encoder_end(encoder);
+    }
+    SmolTLV_Encoder_write_string(encoder, "nested");
+    SmolTLV_Encoder_start_dict(encoder);
+    SmolTLV_Encoder_write_string(encoder, "list");
+    SmolTLV_Encoder_start_list(encoder);
+    if (patched) {
+        SmolTLV_Encoder_write_null(encoder);
+    }
+    SmolTLV_Encoder_write_bool(encoder, !patched);
+    SmolTLV_Encoder_end(encoder);
+    if (patched) {
+        SmolTLV_Encoder_write_string(encoder, "hops");
+        SmolTLV_Encoder_write_int(encoder, 3);
+    }
+    SmolTLV_Encoder_end(encoder);
+    return SmolTLV_Encoder_end(encoder);
+}
+
+void test_patch() {
+    SmolTLV_Encoder *encoder = SmolTLV_Encoder_create();
+    SmolTLV_Encoder *expected_encoder = SmolTLV_Encoder_create();
+    const uint8_t *buffer, *expected;
+    size_t size, expected_size;
+
+    if (encode_patch_doc(encoder, false) != SMOLTLV_STATUS_OK ||
+        SmolTLV_Encoder_finalize(encoder, &buffer, &size) != SMOLTLV_STATUS_OK ||
+        encode_patch_doc(expected_encoder, true) != SMOLTLV_STATUS_OK ||
+        SmolTLV_Encoder_finalize(expected_encoder, &expected, &expected_size) != SMOLTLV_STATUS_OK) {
+        printf("Failed to encode patch test documents\n");
+        SmolTLV_Encoder_destroy(encoder);
+        SmolTLV_Encoder_destroy(expected_encoder);
+        return;
+    }
+    SmolTLV_Encoder_destroy(encoder);
+    SmolTLV_Encoder_destroy(expected_encoder);
+
+    uint8_t patch_buffer[256];
+    uint8_t null_item[] = { 0x00, 0x00, 0x00, 0x00 };
+    uint8_t int_item[] = { 0x03, 0x00, 0x00, 0x08, 0, 0, 0, 0, 0, 0, 0, 3 };
+    SmolTLV_Patch patch;
+    SmolTLV_Cursor cursor;
+    SmolTLV_Item root, item;
+    SmolTLV_Status status;
+
+    memcpy(patch_buffer, buffer, size);
+    SmolTLV_Patch_init(&patch, patch_buffer, size, sizeof(patch_buffer));
+
+#define PATCH_STEP(call) \
+    SmolTLV_Cursor_init(&cursor, patch.buffer, patch.size); \
+    SmolTLV_Cursor_next(&cursor, &root); \
+    status = (call); \
+    if (status != SMOLTLV_STATUS_OK) { \
+        printf("Patch step failed: %s: %d\n", #call, status); \
+        free((void*)buffer); \
+        free((void*)expected); \
+        return; \
+    }
+
+    PATCH_STEP((SmolTLV_Item_dict_get(root, "ts", &item), 
+                SmolTLV_Patch_set_int(&patch, item, 1700000000)));
+    PATCH_STEP((SmolTLV_Item_get_path(root, NULL, (const char *[]){ "nested", "list", NULL }, &item),
+                SmolTLV_Item_list_at(item, 0, &item),
+                SmolTLV_Patch_set_bool(&patch, item, false)));
+    PATCH_STEP((SmolTLV_Item_dict_get(root, "route", &item), 
+                SmolTLV_Patch_set_string(&patch, item, "gateway-2")));
+    PATCH_STEP(SmolTLV_Patch_dict_remove(&patch, root, "flags"));
+    PATCH_STEP((SmolTLV_Item_dict_get(root, "nested", &item), 
+                SmolTLV_Patch_dict_set(&patch, item, "hops", int_item, sizeof(int_item))));
+    PATCH_STEP((SmolTLV_Item_get_path(root, NULL, (const char *[]){ "nested", "list", NULL }, &item),
+                SmolTLV_Patch_list_insert(&patch, item, 0, null_item, sizeof(null_item))));
+#undef PATCH_STEP
+
+    if (patch.size != expected_size || memcmp(patch.buffer, expected, expected_size) != 0) {
+        printf("Patched document does not match expected output\n");
+    } else {
+        printf("Successfully patched document, size: %zu -> %zu\n", size, patch.size);
+    }
+
+    free((void*)buffer);
+    free((void*)expected);
+}
+
+static SmolTLV_Status encode_projection_doc(SmolTLV_Encoder *encoder, 
+                                            bool projected) {
+    SmolTLV_Encoder_start_dict(encoder);
+    SmolTLV_Encoder_write_string(encoder, "id");
+    SmolTLV_Encoder_write_int(encoder, 7);
+    if (!projected) {
+        SmolTLV_Encoder_write_string(encoder, "payload");
+        SmolTLV_Encoder_write_bytes(encoder, (const uint8_t *)"0123456789", 10);
+    }
+    SmolTLV_Encoder_write_string(encoder, "meta");
+    SmolTLV_Encoder_start_dict(encoder);
+    if (!projected) {
+        SmolTLV_Encoder_write_string(encoder, "debug");
+        SmolTLV_Encoder_write_string(encoder, "verbose");
+    }
+    SmolTLV_Encoder_write_string(encoder, "route");
+    SmolTLV_Encoder_start_list(encoder);
+    SmolTLV_Encoder_write_string(encoder, "a");
+    SmolTLV_Encoder_write_string(encoder, "b");
+    SmolTLV_Encoder_end(encoder);
+    SmolTLV_Encoder_end(encoder);
+    return SmolTLV_Encoder_end(encoder);
+}
+
+void test_projection() {
+    SmolTLV_Encoder *encoder = SmolTLV_Encoder_create();
+    SmolTLV_Encoder *expected_encoder = SmolTLV_Encoder_create();
+    const uint8_t *buffer, *expected;
+    size_t size, expected_size;
+
+    if (encode_projection_doc(encoder, false) != SMOLTLV_STATUS_OK ||
+        SmolTLV_Encoder_finalize(encoder, &buffer, &size) != SMOLTLV_STATUS_OK ||
+        encode_projection_doc(expected_encoder, true) != SMOLTLV_STATUS_OK ||
+        SmolTLV_Encoder_finalize(expected_encoder, &expected, &expected_size) != SMOLTLV_STATUS_OK) {
+        printf("Failed to encode projection test documents\n");
+        SmolTLV_Encoder_destroy(encoder);
+        SmolTLV_Encoder_destroy(expected_encoder);
+        return;
+    }
+    SmolTLV_Encoder_destroy(encoder);
+    SmolTLV_Encoder_destroy(expected_encoder);
+
+    const char *id_path[] = { "id", NULL };
+    const char *route_path[] = { "meta", "route", NULL };
+    const char *missing_path[] = { "meta", "missing", NULL };
+    const char *const *paths[] = { id_path, route_path, missing_path };
+
+    SmolTLV_Cursor cursor;
+    SmolTLV_Item root;
+    SmolTLV_Cursor_init(&cursor, buffer, size);
+    SmolTLV_Cursor_next(&cursor, &root);
+
+    size_t projected_size;
+    SmolTLV_Status status = SmolTLV_Item_projection_size(root, NULL, paths, 3, 
+                                                         &projected_size);
+    if (status != SMOLTLV_STATUS_OK || projected_size != expected_size) {
+        printf("Projection size does not match: %d\n", status);
+        free((void*)buffer);
+        free((void*)expected);
+        return;
+    }
+
+    uint8_t output[128];
+    encoder = SmolTLV_Encoder_create_from_buffer(output, projected_size);
+    status = SmolTLV_Encoder_write_projection(encoder, root, NULL, paths, 3);
+    const uint8_t *projected;
+    if (status != SMOLTLV_STATUS_OK ||
+        SmolTLV_Encoder_finalize(encoder, &projected, &projected_size) != SMOLTLV_STATUS_OK) {
+        printf("Failed to write projection: %d\n", status);
+    } else if (projected_size != expected_size || 
+               memcmp(projected, expected, expected_size) != 0) {
+        printf("Projection does not match expected output\n");
+    } else {
+        printf("Successfully projected document, size: %zu -> %zu\n", size, projected_size);
+    }
+    SmolTLV_Encoder_destroy(encoder);
+
+    // Parent without any value on the paths is left out, {"meta": {}} 
+    // would be written otherwise
+    static const uint8_t empty[] = { SMOLTLV_TYPE_DICT, 0, 0, 0 };
+    const char *debug_path[] = { "meta", "debug", "level", NULL };
+    const char *const *missing_paths[] = { missing_path, debug_path };
+    status = SmolTLV_Item_projection_size(root, NULL, missing_paths, 2, &projected_size);
+    encoder = SmolTLV_Encoder_create_from_buffer(output, sizeof(output));
+    if (status != SMOLTLV_STATUS_OK || projected_size != sizeof(empty) ||
+        SmolTLV_Encoder_write_projection(encoder, root, NULL, missing_paths, 2) != SMOLTLV_STATUS_OK ||
+        SmolTLV_Encoder_finalize(encoder, &projected, &projected_size) != SMOLTLV_STATUS_OK ||
+        projected_size != sizeof(empty) || memcmp(projected, empty, sizeof(empty)) != 0) {
+        printf("Projection kept parent without matching values: %d %zu\n", status, projected_size);
+    }
+
+    SmolTLV_Encoder_destroy(encoder);
+    free((void*)buffer);
+    free((void*)expected);
+}
+
+static SmolTLV_Status encode_template_doc(SmolTLV_Encoder *encoder, 
+                                          int64_t seq, 
+                                          const char *name, 
+                                          size_t *slots) {
+    SmolTLV_Encoder_start_dict(encoder);
+    SmolTLV_Encoder_write_string(encoder, "seq");
+    slots[0] = SmolTLV_Encoder_get_position(encoder);
+    SmolTLV_Encoder_write_int(encoder, seq);
+    SmolTLV_Encoder_write_string(encoder, "ok");
+    slots[1] = SmolTLV_Encoder_get_position(encoder);
+    SmolTLV_Encoder_write_bool(encoder, false);
+    SmolTLV_Encoder_write_string(encoder, "body");
+    SmolTLV_Encoder_start_dict(encoder);
+    SmolTLV_Encoder_write_string(encoder, "name");
+    slots[2] = SmolTLV_Encoder_get_position(encoder);
+    SmolTLV_Encoder_write_string(encoder, name);
+    SmolTLV_Encoder_write_string(encoder, "tags");
+    SmolTLV_Encoder_start_list(encoder);
+    SmolTLV_Encoder_write_string(encoder, "a");
+    slots[3] = SmolTLV_Encoder_get_position(encoder);
+    SmolTLV_Encoder_write_int(encoder, 7);
+    SmolTLV_Encoder_end(encoder);
+    SmolTLV_Encoder_end(encoder);
+    SmolTLV_Encoder_write_string(encoder, "tail");
+    SmolTLV_Encoder_write_string(encoder, "end");
+    return SmolTLV_Encoder_end(encoder);
+}
+
+static void check_template(const SmolTLV_Template *tmpl, 
+                           const uint8_t *expected, 
+                           size_t expected_size) {
+    // Same-size stores into a copy
+    uint8_t message[128];
+    SmolTLV_Template_copy(tmpl, message);
+    if (SmolTLV_Template_store_int(tmpl, message, 0, 42) != SMOLTLV_STATUS_OK ||
+        SmolTLV_Template_store_bool(tmpl, message, 1, true) != SMOLTLV_STATUS_OK ||
+        SmolTLV_Template_store_value(tmpl, message, 2, (const uint8_t *)"abcd", 4) != SMOLTLV_STATUS_OK ||
+        SmolTLV_Template_store_value(tmpl, message, 2, (const uint8_t *)"abc", 3) == SMOLTLV_STATUS_OK ||
+        SmolTLV_Template_store_int(tmpl, message, 2, 1) == SMOLTLV_STATUS_OK) {
+        printf("Template stores do not match slot types\n");
+        return;
+    }
+
+    SmolTLV_Item root = { message }, item;
+    int64_t seq;
+    bool ok;
+    if (!SmolTLV_Item_dict_get(root, "seq", &item) || !SmolTLV_Item_as_int(item, &seq) || seq != 42 ||
+        !SmolTLV_Item_dict_get(root, "ok", &item) || !SmolTLV_Item_as_bool(item, &ok) || !ok ||
+        !SmolTLV_Item_dict_get(root, "body", &item) || !SmolTLV_Item_dict_get(item, "name", &item) ||
+        !SmolTLV_Item_strcmp(item, "abcd")) {
+        printf("Copied template does not contain stored values\n");
+        return;
+    }
+
+    // Size-changing render has to match direct encoding
+    uint8_t seq_value[8] = { 0, 0, 0, 0, 0, 0, 0, 42 };
+    SmolTLV_SlotValue values[4] = {
+        { seq_value, 8 },
+        { NULL, 0 },
+        { (const uint8_t *)"longer name", 11 },
+        { NULL, 0 },
+    };
+
+    size_t rendered_size;
+    SmolTLV_Status status = SmolTLV_Template_render(tmpl, values, message, 8, &rendered_size);
+    if (status != SMOLTLV_STATUS_INVALID_ARGUMENT || rendered_size != expected_size) {
+        printf("Render into short buffer did not report size: %d\n", status);
+        return;
+    }
+
+    status = SmolTLV_Template_render(tmpl, values, message, sizeof(message), &rendered_size);
+    if (status != SMOLTLV_STATUS_OK || rendered_size != expected_size ||
+        memcmp(message, expected, expected_size) != 0) {
+        printf("Rendered template does not match expected output: %d\n", status);
+        return;
+    }
+
+    printf("Successfully rendered template, size: %zu -> %zu\n", 
+           SmolTLV_Template_size(tmpl), rendered_size);
+}
+
+void test_template() {
+    SmolTLV_Encoder *encoder = SmolTLV_Encoder_create();
+    SmolTLV_Encoder *expected_encoder = SmolTLV_Encoder_create();
+    const uint8_t *buffer, *expected;
+    size_t size, expected_size;
+    size_t slots[4], expected_slots[4];
+
+    if (encode_template_doc(encoder, 0, "xxxx", slots) != SMOLTLV_STATUS_OK ||
+        SmolTLV_Encoder_finalize(encoder, &buffer, &size) != SMOLTLV_STATUS_OK ||
+        encode_template_doc(expected_encoder, 42, "longer name", expected_slots) != SMOLTLV_STATUS_OK ||
+        SmolTLV_Encoder_finalize(expected_encoder, &expected, &expected_size) != SMOLTLV_STATUS_OK) {
+        printf("Failed to encode template test documents\n");
+        SmolTLV_Encoder_destroy(encoder);
+        SmolTLV_Encoder_destroy(expected_encoder);
+        return;
+    }
+    SmolTLV_Encoder_destroy(encoder);
+    SmolTLV_Encoder_destroy(expected_encoder);
+
+    SmolTLV_Template *tmpl;
+    SmolTLV_Status status = SmolTLV_Template_create(buffer, size, slots, 4, &tmpl);
+    free((void*)buffer);
+    if (status != SMOLTLV_STATUS_OK) {
+        printf("Failed to create template: %d\n", status);
+        free((void*)expected);
+        return;
+    }
+
+    check_template(tmpl, expected, expected_size);
+    SmolTLV_Template_destroy(tmpl);
+    free((void*)expected);
+}
+
+typedef struct ChunkSink_s {
+    uint8_t *buffer;
+    size_t size;
+    size_t capacity;
+    size_t calls;
+} ChunkSink;
+
+static SmolTLV_Status chunk_sink_write(const uint8_t *data, size_t length, void *context) {
+    ChunkSink *sink = (ChunkSink *)context;
+    if (sink->size + length > sink->capacity) {
+        return SMOLTLV_STATUS_OUT_OF_MEMORY;
+    }
+    memcpy(sink->buffer + sink->size, data, length);
+    sink->size += length;
+    sink->calls++;
+    return SMOLTLV_STATUS_OK;
+}
+
+void test_chunked() {
+    size_t large = SMOLTLV_MAX_LENGTH + 10u;
+    uint8_t *data = (uint8_t *)malloc(large);
+    ChunkSink sink = { (uint8_t *)malloc(large + 64u), 0, large + 64u, 0 };
+    if (!data || !sink.buffer) {
+        printf("Failed to allocate chunked test data\n");
+        free(data);
+        free(sink.buffer);
+        return;
+    }
+    for (size_t i = 0; i < large; i++) {
+        data[i] = (uint8_t)(i * 7u);
+    }
+
+    // MAX_LENGTH + 10 bytes, then 5 more bytes, split into 3 chunks
+    SmolTLV_ChunkWriter writer;
+    SmolTLV_ChunkWriter_init(&writer, SMOLTLV_TYPE_BYTES, chunk_sink_write, &sink);
+    if (SmolTLV_ChunkWriter_write(&writer, data, large) != SMOLTLV_STATUS_OK ||
+        SmolTLV_ChunkWriter_write(&writer, data, 5) != SMOLTLV_STATUS_OK ||
+        SmolTLV_ChunkWriter_finish(&writer) != SMOLTLV_STATUS_OK ||
+        sink.size != large + 5u + 16u) {
+        printf("Failed to write chunked value: %zu\n", sink.size);
+        free(data);
+        free(sink.buffer);
+        return;
+    }
+
+    // Reading resumes once cursor covers the rest of the value
+    SmolTLV_Cursor cursor;
+    SmolTLV_ChunkReader reader;
+    SmolTLV_Cursor_init(&cursor, sink.buffer, 100);
+    SmolTLV_ChunkReader_init(&reader, &cursor);
+
+    const uint8_t *chunk;
+    size_t length, offset = 0, chunks = 0;
+    bool same = true;
+    SmolTLV_Status status = SmolTLV_ChunkReader_next(&reader, &chunk, &length);
+    if (status == SMOLTLV_STATUS_NEED_MORE_DATA && cursor.position == 0) {
+        cursor.size = sink.size;
+        while ((status = SmolTLV_ChunkReader_next(&reader, &chunk, &length)) == SMOLTLV_STATUS_OK) {
+            size_t expected = offset < large ? large - offset : large + 5u - offset;
+            const uint8_t *source = offset < large ? data + offset : data + offset - large;
+            if (length > expected || memcmp(chunk, source, length) != 0) {
+                same = false;
+            }
+            offset += length;
+            chunks++;
+        }
+    }
+    free(data);
+
+    if (status != SMOLTLV_STATUS_END || !same || offset != large + 5u ||
+        chunks != 4 || reader.type != SMOLTLV_TYPE_BYTES || cursor.position != sink.size) {
+        printf("Chunked value does not match: %d %zu %zu\n", status, offset, chunks);
+        free(sink.buffer);
+        return;
+    }
+
+    // Third chunk (after two headers and large bytes) of another type
+    sink.buffer[8u + large] = SMOLTLV_TYPE_STRING_CHUNK;
+    SmolTLV_Cursor_init(&cursor, sink.buffer, sink.size);
+    SmolTLV_ChunkReader_init(&reader, &cursor);
+    while ((status = SmolTLV_ChunkReader_next(&reader, &chunk, &length)) == SMOLTLV_STATUS_OK) {
+    }
+    free(sink.buffer);
+    if (status != SMOLTLV_STATUS_INVALID_FORMAT) {
+        printf("Chunked value of mixed types was accepted: %d\n", status);
+        return;
+    }
+
+    printf("Successfully streamed chunked value, chunks: %zu\n", chunks);
+}
+
+void test_chunked_nested() {
+    // {"a": chunked "x", "b": 1}, chunks are top-level only
+    static const uint8_t dict[] = {
+        0x07, 0x00, 0x00, 0x1f,
+        0x05, 0x00, 0x00, 0x01, 'a',
+        0x12, 0x00, 0x00, 0x01, 'x',
+        0x04, 0x00, 0x00, 0x00,
+        0x05, 0x00, 0x00, 0x01, 'b',
+        0x03, 0x00, 0x00, 0x08, 0, 0, 0, 0, 0, 0, 0, 1,
+    };
+    // [chunked "x"]
+    static const uint8_t list[] = {
+        0x06, 0x00, 0x00, 0x09,
+        0x13, 0x00, 0x00, 0x01, 'x',
+        0x05, 0x00, 0x00, 0x00,
+    };
+    SmolTLV_Item item = { dict }, value;
+    size_t count;
+    if (SmolTLV_Item_dict_get(item, "b", &value) || SmolTLV_Item_count(item, &count)) {
+        printf("Chunk inside dict was accepted\n");
+        return;
+    }
+    item.pointer = list;
+    if (SmolTLV_Item_list_at(item, 1, &value) || SmolTLV_Item_count(item, &count)) {
+        printf("Chunk inside list was accepted\n");
+        return;
+    }
+
+    SmolTLV_Encoder *encoder = SmolTLV_Encoder_create();
+    if (!encoder) {
+        printf("Failed to create encoder\n");
+        return;
+    }
+    SmolTLV_Status status = SmolTLV_Encoder_start_list(encoder);
+    if (status == SMOLTLV_STATUS_OK) {
+        status = SmolTLV_Encoder_write_primitive(encoder, SMOLTLV_TYPE_BYTES_CHUNK, 
+                                                 (const uint8_t *)"x", 1u);
+    }
+    SmolTLV_Encoder_destroy(encoder);
+    if (status != SMOLTLV_STATUS_INVALID_STATE) {
+        printf("Encoder wrote chunk inside list: %d\n", status);
+        return;
+    }
+
+    printf("Successfully rejected chunks inside containers\n");
+}
+
+static bool json_matches(const uint8_t *buffer, size_t size, const char *expected) {
+    char output[512];
+    ChunkSink sink = { (uint8_t *)output, 0, sizeof(output) - 1u, 0 };
+    SmolTLV_Status status = SmolTLV_json_write(buffer, size, chunk_sink_write, &sink);
+    output[sink.size] = '\0';
+    if (status != SMOLTLV_STATUS_OK || strcmp(output, expected) != 0) {
+        printf("JSON output does not match: %d %s", status, output);
+        return false;
+    }
+    return true;
+}
+
+void test_json() {
+    static const char json[] =
+        "{\"name\": \"caf\\u00e9 \\\"q\\\"\\n\\ud83d\\ude00\",\n"
+        " \"n\": [1, -2, 9223372036854775807, -9223372036854775808,\n"
+        "        18446744073709551616, 1.5, 2e0, true, false, null],\n"
+        " \"e\": {}, \"l\": [ ]}\n"
+        "42 \"tail\"";
+    static const char expected[] =
+        "{\"name\":\"caf\xc3\xa9 \\\"q\\\"\\n\xf0\x9f\x98\x80\","
+        "\"n\":[1,-2,9223372036854775807,-9223372036854775808,"
+        "1.8446744073709552e+19,1.5,2.0,true,false,null],"
+        "\"e\":{},\"l\":[]}\n42\n\"tail\"\n";
+
+    SmolTLV_Encoder *encoder = SmolTLV_Encoder_create();
+    size_t error_offset = 0;
+    SmolTLV_Status status = SmolTLV_json_encode(json, strlen(json), encoder, &error_offset);
+    const uint8_t *buffer;
+    size_t size;
+    if (status != SMOLTLV_STATUS_OK ||
+        SmolTLV_Encoder_finalize(encoder, &buffer, &size) != SMOLTLV_STATUS_OK) {
+        printf("Failed to transcode JSON: %d at %zu\n", status, error_offset);
+        SmolTLV_Encoder_destroy(encoder);
+        return;
+    }
+    SmolTLV_Encoder_destroy(encoder);
+    bool same = json_matches(buffer, size, expected);
+    free((void *)buffer);
+    if (!same) {
+        return;
+    }
+
+    // Types without JSON counterpart
+    static const char *const table[] = { "id" };
+    int64_t values[] = { 100, 101, 99 };
+    float ratio = 0.25f;
+    encoder = SmolTLV_Encoder_create();
+    SmolTLV_Encoder_write_string_table(encoder, table, 1);
+    SmolTLV_Encoder_start_dict(encoder);
+    SmolTLV_Encoder_write_key(encoder, "id");
+    SmolTLV_Encoder_write_delta_column(encoder, values, 3);
+    SmolTLV_Encoder_write_key(encoder, "raw");
+    SmolTLV_Encoder_write_primitive(encoder, SMOLTLV_TYPE_BYTES, (const uint8_t *)"abcd", 4);
+    SmolTLV_Encoder_write_key(encoder, "ratio");
+    SmolTLV_Encoder_write_float_array(encoder, &ratio, 1);
+    SmolTLV_Encoder_end(encoder);
+    SmolTLV_Encoder_start_batch(encoder);
+    SmolTLV_Encoder_start_list(encoder);
+    SmolTLV_Encoder_write_string_ref(encoder, 0);
+    SmolTLV_Encoder_write_string(encoder, "ok");
+    SmolTLV_Encoder_end(encoder);
+    SmolTLV_Encoder_write_delta_column(encoder, values, 2);
+    SmolTLV_Encoder_start_list(encoder);
+    SmolTLV_Encoder_write_bool(encoder, true);
+    SmolTLV_Encoder_write_null(encoder);
+    SmolTLV_Encoder_end(encoder);
+    SmolTLV_Encoder_end(encoder);
+    if (SmolTLV_Encoder_finalize(encoder, &buffer, &size) != SMOLTLV_STATUS_OK) {
+        printf("Failed to encode JSON test data\n");
+        SmolTLV_Encoder_destroy(encoder);
+        return;
+    }
+    SmolTLV_Encoder_destroy(encoder);
+    same = json_matches(buffer, size,
+                        "{\"id\":[100,101,99],\"raw\":\"YWJjZA==\",\"ratio\":0.25}\n"
+                        "[{\"id\":100,\"ok\":true},{\"id\":101,\"ok\":null}]\n");
+    free((void *)buffer);
+    if (!same) {
+        return;
+    }
+
+    // Invalid documents report offset of the offending byte
+    static const struct {
+        const char *json;
+        size_t offset;
+    } invalid[] = {
+        { "[1, 2, }", 7 },
+        { "{\"a\" 1}", 5 },
+        { "[01]", 2 },
+        { "1true", 1 },
+        { "\"\\ud800\"", 1 },
+        { "{\"a\": [1, 2}", 11 },
+        { "\"open", 5 },
+    };
+    for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+        encoder = SmolTLV_Encoder_create();
+        error_offset = 0;
+        status = SmolTLV_json_encode(invalid[i].json, strlen(invalid[i].json),
+                                     encoder, &error_offset);
+        SmolTLV_Encoder_destroy(encoder);
+        if (status != SMOLTLV_STATUS_INVALID_FORMAT || error_offset != invalid[i].offset) {
+            printf("Invalid JSON %s was not rejected: %d at %zu\n",
+                   invalid[i].json, status, error_offset);
+            return;
+        }
+    }
+
+    // Nesting beyond the limit is rejected rather than recursed into
+    char *deep = (char *)malloc(SMOLTLV_JSON_MAX_DEPTH + 1u);
+    memset(deep, '[', SMOLTLV_JSON_MAX_DEPTH + 1u);
+    encoder = SmolTLV_Encoder_create();
+    status = SmolTLV_json_encode(deep, SMOLTLV_JSON_MAX_DEPTH + 1u, encoder, NULL);
+    SmolTLV_Encoder_destroy(encoder);
+    free(deep);
+    if (status != SMOLTLV_STATUS_INVALID_FORMAT) {
+        printf("Too deep JSON was accepted: %d\n", status);
+        return;
+    }
+
+    printf("Successfully transcoded JSON\n");
+}
+
+void test_cbor() {
+    static const uint8_t cbor[] = {
+        // {"a": 1, "xyz": (_ h'0102', h'03'), 2: [-1, true]}
+        0xA3, 0x61, 'a', 0x01, 0x63, 'x', 'y', 'z',
+        0x5F, 0x42, 0x01, 0x02, 0x41, 0x03, 0xFF, 0x02, 0x82, 0x20, 0xF5,
+        // 1.0 as half float, int16 little-endian typed array [1, 2]
+        0xF9, 0x3C, 0x00,
+        0xD8, 77, 0x44, 0x01, 0x00, 0x02, 0x00,
+        // [_ 1, [_ ]], -2^63
+        0x9F, 0x01, 0x9F, 0xFF, 0xFF,
+        0x3B, 0x7F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    };
+    static const uint8_t expected[] = {
+        0xA3, 0x61, 'a', 0x01, 0x63, 'x', 'y', 'z',
+        0x43, 0x01, 0x02, 0x03, 0x02, 0x82, 0x20, 0xF5,
+        0xFA, 0x3F, 0x80, 0x00, 0x00,
+        0xD8, 73, 0x44, 0x00, 0x01, 0x00, 0x02,
+        0x82, 0x01, 0x80,
+        0x3B, 0x7F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    };
+
+    SmolTLV_Encoder *encoder = SmolTLV_Encoder_create();
+    SmolTLV_CborError error = { 0, NULL };
+    SmolTLV_Status status = SmolTLV_cbor_encode(cbor, sizeof(cbor), encoder, &error);
+    const uint8_t *buffer;
+    size_t size;
+    if (status != SMOLTLV_STATUS_OK ||
+        SmolTLV_Encoder_finalize(encoder, &buffer, &size) != SMOLTLV_STATUS_OK) {
+        printf("Failed to transcode CBOR: %d at %zu (%s)\n", status, error.offset, error.message);
+        SmolTLV_Encoder_destroy(encoder);
+        return;
+    }
+    SmolTLV_Encoder_destroy(encoder);
+
+    SmolTLV_Cursor cursor;
+    SmolTLV_Item item, value;
+    SmolTLV_Cursor_init(&cursor, buffer, size);
+    SmolTLV_Cursor_next(&cursor, &item);
+    if (!SmolTLV_Item_dict_get(item, "xyz", &value) ||
+        SmolTLV_Item_get_type(value) != SMOLTLV_TYPE_BYTES ||
+        SmolTLV_Item_get_length(value) != 3) {
+        printf("Indefinite length CBOR string was not joined\n");
+        free((void *)buffer);
+        return;
+    }
+
+    uint8_t output[64];
+    ChunkSink sink = { output, 0, sizeof(output), 0 };
+    status = SmolTLV_cbor_write(buffer, size, chunk_sink_write, &sink);
+    free((void *)buffer);
+    if (status != SMOLTLV_STATUS_OK || sink.size != sizeof(expected) ||
+        memcmp(output, expected, sizeof(expected)) != 0) {
+        printf("CBOR output does not match: %d %zu\n", status, sink.size);
+        return;
+    }
+
+    // Record batch rows become maps, interned key and DELTA column resolved
+    static const char *const table[] = { "id" };
+    static const uint8_t expected_batch[] = {
+        0x82,
+        0xA2, 0x62, 'i', 'd', 0x18, 100, 0x62, 'o', 'k', 0xF5,
+        0xA2, 0x62, 'i', 'd', 0x18, 101, 0x62, 'o', 'k', 0xF6,
+    };
+    int64_t values[] = { 100, 101 };
+    encoder = SmolTLV_Encoder_create();
+    SmolTLV_Encoder_write_string_table(encoder, table, 1);
+    SmolTLV_Encoder_start_batch(encoder);
+    SmolTLV_Encoder_start_list(encoder);
+    SmolTLV_Encoder_write_string_ref(encoder, 0);
+    SmolTLV_Encoder_write_string(encoder, "ok");
+    SmolTLV_Encoder_end(encoder);
+    SmolTLV_Encoder_write_delta_column(encoder, values, 2);
+    SmolTLV_Encoder_start_list(encoder);
+    SmolTLV_Encoder_write_bool(encoder, true);
+    SmolTLV_Encoder_write_null(encoder);
+    SmolTLV_Encoder_end(encoder);
+    SmolTLV_Encoder_end(encoder);
+    status = SmolTLV_Encoder_finalize(encoder, &buffer, &size);
+    SmolTLV_Encoder_destroy(encoder);
+    sink.size = 0;
+    if (status == SMOLTLV_STATUS_OK) {
+        status = SmolTLV_cbor_write(buffer, size, chunk_sink_write, &sink);
+        free((void *)buffer);
+    }
+    if (status != SMOLTLV_STATUS_OK || sink.size != sizeof(expected_batch) ||
+        memcmp(output, expected_batch, sizeof(expected_batch)) != 0) {
+        printf("CBOR record batch does not match: %d %zu\n", status, sink.size);
+        return;
+    }
+
+    // Unmappable and malformed items are located and explained
+    static const struct {
+        uint8_t cbor[10];
+        size_t size;
+        size_t offset;
+    } invalid[] = {
+        { { 0x81, 0xF7 }, 2, 1 },
+        { { 0x1B, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF }, 9, 0 },
+        { { 0x82, 0x01, 0xC1, 0x00 }, 4, 2 },
+        { { 0x82, 0x01 }, 2, 0 },
+        { { 0xBF, 0x61, 'a', 0xFF }, 4, 3 },
+        { { 0x5F, 0x61, 'a', 0xFF }, 4, 0 },
+    };
+    for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+        encoder = SmolTLV_Encoder_create();
+        error.message = NULL;
+        status = SmolTLV_cbor_encode(invalid[i].cbor, invalid[i].size, encoder, &error);
+        SmolTLV_Encoder_destroy(encoder);
+        if (status != SMOLTLV_STATUS_INVALID_FORMAT || error.offset != invalid[i].offset ||
+            !error.message) {
+            printf("Invalid CBOR %zu was not rejected: %d at %zu\n", i, status, error.offset);
+            return;
+        }
+    }
+
+    printf("Successfully transcoded CBOR\n");
+}
+
+typedef struct SharedReader_s {
+    SmolTLV_SharedDocument *document;
+    SmolTLV_Item dict;
+    SmolTLV_Item list;
+    size_t mismatches;
+} SharedReader;
+
+static void *shared_reader(void *arg) {
+    SharedReader *reader = (SharedReader *)arg;
+    SmolTLV_Item value;
+    char key[16];
+    int64_t number;
+
+    for (size_t round = 0; round < 20; round++) {
+        for (size_t i = 0; i < 200; i++) {
+            snprintf(key, sizeof(key), "key%zu", (i * 7u + round) % 200u);
+            if (!SmolTLV_SharedDocument_dict_get(reader->document, reader->dict, key, &value) ||
+                !SmolTLV_Item_as_int(value, &number) ||
+                number != (int64_t)((i * 7u + round) % 200u)) {
+                reader->mismatches++;
+            }
+            if (!SmolTLV_SharedDocument_list_at(reader->document, reader->list, i * 5u, &value) ||
+                !SmolTLV_Item_as_int(value, &number) || number != (int64_t)(i * 5u)) {
+                reader->mismatches++;
+            }
+        }
+        if (SmolTLV_SharedDocument_dict_get(reader->document, reader->dict, "missing", NULL) ||
+            SmolTLV_SharedDocument_list_at(reader->document, reader->list, 1000, NULL)) {
+            reader->mismatches++;
+        }
+    }
+    return NULL;
+}
+
+void test_shared() {
+    static const char *const table[] = { "key0", "key1", "key2" };
+    SmolTLV_Encoder *encoder = SmolTLV_Encoder_create();
+    char key[16];
+
+    // Root dict: "dict" (first keys interned), "list", "small"
+    SmolTLV_Encoder_write_string_table(encoder, table, 3);
+    SmolTLV_Encoder_start_dict(encoder);
+    SmolTLV_Encoder_write_key(encoder, "dict");
+    SmolTLV_Encoder_start_dict(encoder);
+    for (size_t i = 0; i < 200; i++) {
+        snprintf(key, sizeof(key), "key%zu", i);
+        SmolTLV_Encoder_write_key(encoder, key);
+        SmolTLV_Encoder_write_int(encoder, (int64_t)i);
+    }
+    SmolTLV_Encoder_end(encoder);
+    SmolTLV_Encoder_write_string(encoder, "list");
+    SmolTLV_Encoder_start_list(encoder);
+    for (size_t i = 0; i < 1000; i++) {
+        SmolTLV_Encoder_write_int(encoder, (int64_t)i);
+    }
+    SmolTLV_Encoder_end(encoder);
+    SmolTLV_Encoder_end(encoder);
+
+    const uint8_t *buffer;
+    size_t size;
+    if (SmolTLV_Encoder_finalize(encoder, &buffer, &size) != SMOLTLV_STATUS_OK) {
+        printf("Failed to encode shared document\n");
+        SmolTLV_Encoder_destroy(encoder);
+        return;
+    }
+    SmolTLV_Encoder_destroy(encoder);
+
+    SmolTLV_SharedDocument *document = SmolTLV_SharedDocument_create(buffer, size, NULL);
+    SharedReader readers[4];
+    pthread_t threads[4];
+    SmolTLV_Item root;
+    SmolTLV_SharedDocument_get_root(document, &root);
+    for (size_t i = 0; i < 4; i++) {
+        readers[i].document = document;
+        readers[i].mismatches = 0;
+        SmolTLV_SharedDocument_dict_get(document, root, "dict", &readers[i].dict);
+        SmolTLV_SharedDocument_dict_get(document, root, "list", &readers[i].list);
+    }
+    for (size_t i = 0; i < 4; i++) {
+        pthread_create(&threads[i], NULL, shared_reader, &readers[i]);
+    }
+    size_t mismatches = 0;
+    for (size_t i = 0; i < 4; i++) {
+        pthread_join(threads[i], NULL);
+        mismatches += readers[i].mismatches;
+    }
+
+    // Root has 2 entries, only scan marker is published for it
+    SmolTLV_SharedStats stats;
+    SmolTLV_SharedDocument_get_stats(document, &stats);
+    SmolTLV_SharedDocument_destroy(document);
+    if (mismatches != 0 || stats.indexes != 3 || stats.memory_used == 0) {
+        printf("Shared document lookups do not match: %zu %zu\n", mismatches, stats.indexes);
+        free((void *)buffer);
+        return;
+    }
+
+    // Over budget everything is scanned with the same results, a dict not
+    // fitting the budget leaves it for the smaller list
+    size_t memory_used = stats.memory_used;
+    static const size_t budgets[] = { 64, 5000 };
+    static const size_t over_budget[] = { 2, 1 };
+    for (size_t i = 0; i < 2; i++) {
+        SmolTLV_SharedConfig config = { budgets[i], 1, 16 };
+        document = SmolTLV_SharedDocument_create(buffer, size, &config);
+        readers[0].document = document;
+        readers[0].mismatches = 0;
+        shared_reader(&readers[0]);
+        SmolTLV_SharedDocument_get_stats(document, &stats);
+        SmolTLV_SharedDocument_destroy(document);
+        if (readers[0].mismatches != 0 || stats.indexes != 2 || stats.over_budget != over_budget[i] ||
+            (i == 1 && stats.memory_used < 1000 * sizeof(uint32_t))) {
+            printf("Shared document over budget does not match: %zu %zu\n",
+                   readers[0].mismatches, stats.over_budget);
+            free((void *)buffer);
+            return;
+        }
+    }
+    free((void *)buffer);
+
+    printf("Successfully shared document between threads, memory: %zu\n", memory_used);
+}
+
+
+void test_dom() {
+    static const char *const table[] = { "name", "tags" };
+    SmolTLV_Encoder *encoder = SmolTLV_Encoder_create();
+    char key[16];
+
+    // Root dict with interned keys, nested list of dicts, duplicate key
+    // and int key hiding entries after it
+    SmolTLV_Encoder_write_string_table(encoder, table, 2);
+    SmolTLV_Encoder_start_dict(encoder);
+    SmolTLV_Encoder_write_key(encoder, "name");
+    SmolTLV_Encoder_write_string_ref(encoder, 1);
+    SmolTLV_Encoder_write_key(encoder, "items");
+    SmolTLV_Encoder_start_list(encoder);
+    for (size_t i = 0; i < 100; i++) {
+        SmolTLV_Encoder_start_dict(encoder);
+        SmolTLV_Encoder_write_key(encoder, "id");
+        SmolTLV_Encoder_write_int(encoder, (int64_t)i);
+        SmolTLV_Encoder_end(encoder);
+    }
+    SmolTLV_Encoder_end(encoder);
+    SmolTLV_Encoder_write_key(encoder, "empty");
+    SmolTLV_Encoder_start_dict(encoder);
+    SmolTLV_Encoder_end(encoder);
+    for (size_t i = 0; i < 50; i++) {
+        snprintf(key, sizeof(key), "key%zu", i);
+        SmolTLV_Encoder_write_key(encoder, key);
+        SmolTLV_Encoder_write_int(encoder, (int64_t)i);
+    }
+    SmolTLV_Encoder_write_key(encoder, "key7");
+    SmolTLV_Encoder_write_int(encoder, -1);
+    SmolTLV_Encoder_write_int(encoder, 2);
+    SmolTLV_Encoder_write_null(encoder);
+    SmolTLV_Encoder_write_key(encoder, "hidden");
+    SmolTLV_Encoder_write_null(encoder);
+    SmolTLV_Encoder_end(encoder);
+
+    const uint8_t *buffer;
+    size_t size;
+    if (SmolTLV_Encoder_finalize(encoder, &buffer, &size) != SMOLTLV_STATUS_OK) {
+        printf("Failed to encode DOM document\n");
+        SmolTLV_Encoder_destroy(encoder);
+        return;
+    }
+    SmolTLV_Encoder_destroy(encoder);
+
+    SmolTLV_Dom *dom;
+    if (SmolTLV_Dom_create(buffer, size, &dom) != SMOLTLV_STATUS_OK) {
+        printf("Failed to create DOM\n");
+        free((void*)buffer);
+        return;
+    }
+
+    // Root with 56 entries, 100 items with id key and value
+    SmolTLV_DomNode node, value, items;
+    const char *string;
+    size_t length;
+    int64_t number;
+    if (SmolTLV_Dom_node_count(dom) != 1 + 2 * 56 + 100 + 2 * 100 ||
+        SmolTLV_Dom_get_type(dom, 0) != SMOLTLV_TYPE_DICT ||
+        SmolTLV_Dom_get_count(dom, 0) != 56) {
+        printf("Wrong DOM shape, nodes: %zu\n", SmolTLV_Dom_node_count(dom));
+        SmolTLV_Dom_destroy(dom);
+        free((void*)buffer);
+        return;
+    }
+
+    // Lookups agree with dict_get_interned
+    SmolTLV_StringTable strings;
+    SmolTLV_Item root = SmolTLV_Dom_get_item(dom, 0), table_item, expected;
+    SmolTLV_Cursor cursor;
+    SmolTLV_Cursor_init(&cursor, buffer, size);
+    SmolTLV_Cursor_next(&cursor, &table_item);
+    SmolTLV_StringTable_init(&strings, table_item);
+    for (size_t i = 0; i < 60; i++) {
+        snprintf(key, sizeof(key), "key%zu", i);
+        bool found = SmolTLV_Dom_dict_get(dom, 0, key, &node);
+        if (found != SmolTLV_Item_dict_get_interned(root, &strings, key, &expected) ||
+            (found && SmolTLV_Dom_get_item(dom, node).pointer != expected.pointer)) {
+            printf("DOM lookup of %s differs\n", key);
+            SmolTLV_Dom_destroy(dom);
+            free((void*)buffer);
+            return;
+        }
+    }
+    if (!SmolTLV_Dom_dict_get(dom, 0, "key7", &node) ||
+        !SmolTLV_Item_as_int(SmolTLV_Dom_get_item(dom, node), &number) || number != 7 ||
+        SmolTLV_Dom_dict_get(dom, 0, "hidden", NULL) ||
+        SmolTLV_Dom_dict_get(dom, 0, "tags", NULL) ||
+        !SmolTLV_Dom_dict_get(dom, 0, "empty", &node) ||
+        SmolTLV_Dom_get_count(dom, node) != 0 ||
+        SmolTLV_Dom_dict_get(dom, node, "id", NULL)) {
+        printf("Wrong DOM dict lookups\n");
+        SmolTLV_Dom_destroy(dom);
+        free((void*)buffer);
+        return;
+    }
+
+    // Interned key and STRING_REF value resolve to views into buffer
+    if (!SmolTLV_Dom_dict_get(dom, 0, "name", &value) ||
+        !SmolTLV_Dom_get_string(dom, value, &string, &length) ||
+        length != 4 || memcmp(string, "tags", 4) != 0 ||
+        (const uint8_t *)string < buffer || (const uint8_t *)string >= buffer + size ||
+        !SmolTLV_Dom_dict_entry(dom, 0, 0, &node, &value) ||
+        !SmolTLV_Dom_get_string(dom, node, &string, &length) ||
+        length != 4 || memcmp(string, "name", 4) != 0 ||
+        SmolTLV_Dom_dict_entry(dom, 0, 56, NULL, NULL)) {
+        printf("Wrong DOM strings\n");
+        SmolTLV_Dom_destroy(dom);
+        free((void*)buffer);
+        return;
+    }
+
+    // Children of list are consecutive
+    if (!SmolTLV_Dom_dict_get(dom, 0, "items", &items) ||
+        SmolTLV_Dom_get_count(dom, items) != 100 ||
+        SmolTLV_Dom_list_at(dom, items, 100, NULL) ||
+        SmolTLV_Dom_list_at(dom, 0, 0, NULL)) {
+        printf("Wrong DOM list\n");
+        SmolTLV_Dom_destroy(dom);
+        free((void*)buffer);
+        return;
+    }
+    for (size_t i = 0; i < 100; i++) {
+        SmolTLV_DomNode first;
+        SmolTLV_Dom_list_at(dom, items, 0, &first);
+        if (!SmolTLV_Dom_list_at(dom, items, i, &node) || node != first + i ||
+            !SmolTLV_Dom_dict_get(dom, node, "id", &value) ||
+            !SmolTLV_Item_as_int(SmolTLV_Dom_get_item(dom, value), &number) ||
+            number != (int64_t)i) {
+            printf("Wrong DOM list item %zu\n", i);
+            SmolTLV_Dom_destroy(dom);
+            free((void*)buffer);
+            return;
+        }
+    }
+    SmolTLV_Dom_destroy(dom);
+
+    // Leaf root, missing root, malformed documents
+    static const uint8_t leaf[] = { SMOLTLV_TYPE_NULL, 0, 0, 0 };
+    static const uint8_t odd_dict[] = { 
+        SMOLTLV_TYPE_DICT, 0, 0, 4, SMOLTLV_TYPE_NULL, 0, 0, 0 
+    };
+    static const uint8_t overlong[] = { 
+        SMOLTLV_TYPE_LIST, 0, 0, 8, SMOLTLV_TYPE_LIST, 0, 0, 4, 
+        SMOLTLV_TYPE_NULL, 0, 0, 4, 0, 0, 0, 0 
+    };
+    if (SmolTLV_Dom_create(leaf, sizeof(leaf), &dom) != SMOLTLV_STATUS_OK ||
+        SmolTLV_Dom_node_count(dom) != 1 ||
+        SmolTLV_Dom_get_count(dom, 0) != 0) {
+        printf("Failed to create DOM of leaf\n");
+        SmolTLV_Dom_destroy(dom);
+        free((void*)buffer);
+        return;
+    }
+    SmolTLV_Dom_destroy(dom);
+    size_t table_size = 4 + SmolTLV_Item_get_length(table_item);
+    if (SmolTLV_Dom_create(buffer, table_size, &dom) != SMOLTLV_STATUS_END ||
+        SmolTLV_Dom_create(odd_dict, sizeof(odd_dict), &dom) != SMOLTLV_STATUS_INVALID_FORMAT ||
+        SmolTLV_Dom_create(overlong, sizeof(overlong), &dom) != SMOLTLV_STATUS_INVALID_FORMAT ||
+        SmolTLV_Dom_create(buffer, size - 1, &dom) != SMOLTLV_STATUS_INVALID_FORMAT ||
+        dom != NULL) {
+        printf("Failed to reject malformed DOM documents\n");
+        free((void*)buffer);
+        return;
+    }
+
+    free((void*)buffer);
+    printf("Successfully materialized DOM\n");
+}
+
+typedef struct IngestCounter_s {
+    size_t items;
+    int64_t sum;
+    size_t bytes;
+    /** Callback fails after this many items, 0 for no limit */
+    size_t limit;
+    SmolTLV_Status end_status;
+    int ended;
+} IngestCounter;
+
+static SmolTLV_Status ingest_count_item(SmolTLV_Item item, void *context) {
+    IngestCounter *counter = (IngestCounter *)context;
+    int64_t value;
+    if (counter->limit && counter->items == counter->limit) {
+        return SMOLTLV_STATUS_INVALID_STATE;
+    }
+    counter->items++;
+    if (SmolTLV_Item_as_int(item, &value)) {
+        counter->sum += value;
+    } else {
+        counter->bytes += SmolTLV_Item_get_length(item);
+    }
+    return SMOLTLV_STATUS_OK;
+}
+
+static void ingest_count_end(SmolTLV_Status status, int error, void *context) {
+    IngestCounter *counter = (IngestCounter *)context;
+    (void)error;
+    counter->end_status = status;
+    counter->ended++;
+}
+
+typedef struct IngestWriter_s {
+    int fd;
+    const uint8_t *data;
+    size_t size;
+} IngestWriter;
+
+/** Writes data to pipe in small pieces splitting item headers */
+static void *ingest_writer(void *arg) {
+    IngestWriter *writer = (IngestWriter *)arg;
+    for (size_t offset = 0; offset < writer->size; ) {
+        size_t length = writer->size - offset < 7 ? writer->size - offset : 7;
+        ssize_t written = write(writer->fd, writer->data + offset, length);
+        if (written <= 0) {
+            break;
+        }
+        offset += (size_t)written;
+    }
+    close(writer->fd);
+    return NULL;
+}
+
+static int ingest_temp_file(const uint8_t *data, size_t size, FILE **out) {
+    FILE *file = tmpfile();
+    if (!file) {
+        return -1;
+    }
+    fwrite(data, 1, size, file);
+    fflush(file);
+    lseek(fileno(file), 0, SEEK_SET);
+    *out = file;
+    return fileno(file);
+}
+
+static bool test_ingest_backend(bool no_io_uring, const uint8_t *buffer, size_t size) {
+    SmolTLV_IngestConfig config = { 0 };
+    config.buffer_size = 4096;
+    config.fixed_buffers = 8;
+    config.no_io_uring = no_io_uring;
+
+    SmolTLV_Ingest *ingest;
+    if (SmolTLV_Ingest_create(&config, &ingest) != SMOLTLV_STATUS_OK) {
+        printf("Failed to create ingest\n");
+        return false;
+    }
+
+    // Whole stream from file and pipe, truncated file, failing callback
+    IngestCounter counters[4];
+    FILE *files[3] = { NULL, NULL, NULL };
+    int pipe_fds[2];
+    memset(counters, 0, sizeof(counters));
+    counters[3].limit = 3;
+    if (pipe(pipe_fds) != 0) {
+        printf("Failed to create pipe\n");
+        SmolTLV_Ingest_destroy(ingest);
+        return false;
+    }
+    int fds[4] = {
+        ingest_temp_file(buffer, size, &files[0]),
+        pipe_fds[0],
+        ingest_temp_file(buffer, 10 * 12 + 6, &files[1]),
+        ingest_temp_file(buffer, size, &files[2]),
+    };
+    for (size_t i = 0; i < 4; i++) {
+        SmolTLV_IngestSource source = { fds[i], ingest_count_item, ingest_count_end, &counters[i] };
+        SmolTLV_Ingest_add(ingest, &source);
+    }
+
+    IngestWriter writer = { pipe_fds[1], buffer, size };
+    pthread_t thread;
+    pthread_create(&thread, NULL, ingest_writer, &writer);
+    SmolTLV_Status status = SmolTLV_Ingest_run(ingest);
+    pthread_join(thread, NULL);
+
+    SmolTLV_IngestStats stats;
+    SmolTLV_Ingest_get_stats(ingest, &stats);
+    bool ok = status == SMOLTLV_STATUS_OK &&
+              stats.items == 2 * 2001 + 10 + 4;
+    for (size_t i = 0; i < 2; i++) {
+        ok = ok && counters[i].items == 2001 && counters[i].sum == 1999000 &&
+             counters[i].bytes == 100000 &&
+             counters[i].ended == 1 && counters[i].end_status == SMOLTLV_STATUS_OK;
+    }
+    ok = ok && counters[2].items == 10 && counters[2].ended == 1 &&
+         counters[2].end_status == SMOLTLV_STATUS_NEED_MORE_DATA &&
+         counters[3].items == 3 && counters[3].ended == 1 &&
+         counters[3].end_status == SMOLTLV_STATUS_INVALID_STATE;
+    if (!ok) {
+        printf("Wrong ingest results (io_uring: %d), items: %zu\n",
+               SmolTLV_Ingest_uses_io_uring(ingest), stats.items);
+    }
+
+    close(pipe_fds[0]);
+    for (size_t i = 0; i < 3; i++) {
+        fclose(files[i]);
+    }
+    SmolTLV_Ingest_destroy(ingest);
+    return ok;
+}
+
+void test_ingest() {
+    static uint8_t blob[100000];
+    SmolTLV_Encoder *encoder = SmolTLV_Encoder_create();
+
+    // 2000 INTs with BYTES item larger than ingest buffer in the middle
+    for (size_t i = 0; i < 2000; i++) {
+        SmolTLV_Encoder_write_int(encoder, (int64_t)i);
+        if (i == 1000) {
+            SmolTLV_Encoder_write_bytes(encoder, blob, sizeof(blob));
+        }
+    }
+
+    const uint8_t *buffer;
+    size_t size;
+    if (SmolTLV_Encoder_finalize(encoder, &buffer, &size) != SMOLTLV_STATUS_OK) {
+        printf("Failed to encode ingest stream\n");
+        SmolTLV_Encoder_destroy(encoder);
+        return;
+    }
+    SmolTLV_Encoder_destroy(encoder);
+
+    SmolTLV_Ingest *ingest;
+    SmolTLV_Ingest_create(NULL, &ingest);
+    bool io_uring = SmolTLV_Ingest_uses_io_uring(ingest);
+    SmolTLV_Ingest_destroy(ingest);
+
+    if (!test_ingest_backend(false, buffer, size) ||
+        !test_ingest_backend(true, buffer, size)) {
+        free((void*)buffer);
+        return;
+    }
+
+    free((void*)buffer);
+    printf("Successfully ingested files and pipes, io_uring: %s\n", io_uring ? "yes" : "no");
+}
+static bool test_archive_codec() {
+    static uint8_t data[100000];
+    static uint8_t compressed[100000 + 100000 / 255 + 16];
+    static uint8_t output[100000];
+    size_t sizes[] = { 0, 5, 13, sizeof(data) };
+    size_t compressed_size, size;
+
+    // Runs of a byte, repeated pattern with offset below 8, text-like tail
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = i < 30000 ? 'a' : i < 60000 ? (uint8_t)("abc"[i % 3]) : (uint8_t)(i / 7 % 26 + 'a');
+    }
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        if (SmolTLV_lz_compress(data, sizes[i], compressed, sizeof(compressed), &compressed_size) != SMOLTLV_STATUS_OK ||
+            SmolTLV_lz_decompress(compressed, compressed_size, output, sizeof(output), &size) != SMOLTLV_STATUS_OK ||
+            size != sizes[i] || memcmp(data, output, size) != 0) {
+            printf("Failed LZ round trip of %zu bytes\n", sizes[i]);
+            return false;
+        }
+    }
+    if (compressed_size > sizeof(data) / 50u) {
+        printf("Wrong LZ compressed size: %zu\n", compressed_size);
+        return false;
+    }
+
+    // Small capacity, truncated input, offset before start of output
+    static const uint8_t bad_offset[] = { 0x10, 'a', 0x05, 0x00 };
+    if (SmolTLV_lz_compress(data, sizeof(data), compressed, sizeof(data), &size) != SMOLTLV_STATUS_INVALID_ARGUMENT ||
+        SmolTLV_lz_decompress(compressed, compressed_size - 1u, output, sizeof(output), &size) != SMOLTLV_STATUS_INVALID_FORMAT ||
+        SmolTLV_lz_decompress(bad_offset, sizeof(bad_offset), output, sizeof(output), &size) != SMOLTLV_STATUS_INVALID_FORMAT ||
+        SmolTLV_lz_decompress(compressed, compressed_size, output, 1000, &size) != SMOLTLV_STATUS_INVALID_FORMAT) {
+        printf("Corrupted LZ input not rejected\n");
+        return false;
+    }
+    return true;
+}
+
+static SmolTLV_Status archive_sink_item(SmolTLV_Item item, void *context) {
+    return chunk_sink_write(item.pointer, 4u + SmolTLV_Item_get_length(item), context);
+}
+
+typedef struct ArchiveSource_s {
+    const uint8_t *data;
+    size_t size;
+    size_t position;
+    size_t reads;
+} ArchiveSource;
+
+/** Reads at most 3000 bytes at a time, like a socket would */
+static SmolTLV_Status archive_source_read(uint8_t *buffer, size_t capacity, 
+                                          size_t *out_length, void *context) {
+    ArchiveSource *source = (ArchiveSource *)context;
+    size_t length = source->size - source->position;
+    if (length > capacity) {
+        length = capacity;
+    }
+    if (length > 3000u) {
+        length = 3000u;
+    }
+    memcpy(buffer, source->data + source->position, length);
+    source->position += length;
+    source->reads++;
+    *out_length = length;
+    return SMOLTLV_STATUS_OK;
+}
+
+/** Streams archive through SmolTLV_ArchiveReader in pieces of given size 
+ * (0 pulls through read function), output has to match stream */
+static bool archive_stream_matches(const uint8_t *archive, size_t archive_size, 
+                                   size_t piece, const uint8_t *stream, size_t size) {
+    ChunkSink output = { (uint8_t *)malloc(size), 0, size, 0 };
+    SmolTLV_ArchiveReader *reader;
+    SmolTLV_Status status = SmolTLV_ArchiveReader_create(archive_sink_item, &output, &reader);
+    if (status == SMOLTLV_STATUS_OK && piece == 0) {
+        ArchiveSource source = { archive, archive_size, 0, 0 };
+        status = SmolTLV_ArchiveReader_read(reader, archive_source_read, &source);
+    } else if (status == SMOLTLV_STATUS_OK) {
+        for (size_t offset = 0; offset < archive_size && status == SMOLTLV_STATUS_OK; offset += piece) {
+            size_t length = archive_size - offset < piece ? archive_size - offset : piece;
+            status = SmolTLV_ArchiveReader_write(reader, archive + offset, length);
+        }
+        if (status == SMOLTLV_STATUS_OK) {
+            status = SmolTLV_ArchiveReader_finish(reader);
+        }
+    }
+    SmolTLV_ArchiveReader_destroy(reader);
+
+    bool ok = status == SMOLTLV_STATUS_OK && output.size == size &&
+              memcmp(output.buffer, stream, size) == 0;
+    free(output.buffer);
+    if (!ok) {
+        printf("Wrong streamed archive in pieces of %zu: %d\n", piece, status);
+    }
+    return ok;
+}
+
+void test_archive() {
+    static const char *const first_table[] = { "alpha", "beta" };
+    static const char *const second_table[] = { "gamma", "delta" };
+    static uint8_t blob[20000];
+    SmolTLV_Encoder *encoder = SmolTLV_Encoder_create();
+    uint32_t state = 2463534242u;
+
+    if (!test_archive_codec()) {
+        SmolTLV_Encoder_destroy(encoder);
+        return;
+    }
+
+    // 1000 dicts, string table replaced in the middle, random blob larger
+    // than a frame
+    for (size_t i = 0; i < sizeof(blob); i++) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        blob[i] = (uint8_t)state;
+    }
+    for (size_t i = 0; i < 1000; i++) {
+        if (i == 0) {
+            SmolTLV_Encoder_write_string_table(encoder, first_table, 2);
+        } else if (i == 500) {
+            SmolTLV_Encoder_write_string_table(encoder, second_table, 2);
+        } else if (i == 700) {
+            SmolTLV_Encoder_write_bytes(encoder, blob, sizeof(blob));
+        }
+        SmolTLV_Encoder_start_dict(encoder);
+        SmolTLV_Encoder_write_key(encoder, "id");
+        SmolTLV_Encoder_write_int(encoder, (int64_t)i);
+        SmolTLV_Encoder_write_key(encoder, "name");
+        SmolTLV_Encoder_write_string_ref(encoder, (uint32_t)(i % 2));
+        SmolTLV_Encoder_end(encoder);
+    }
+
+    const uint8_t *buffer;
+    size_t size;
+    if (SmolTLV_Encoder_finalize(encoder, &buffer, &size) != SMOLTLV_STATUS_OK) {
+        printf("Failed to encode archive stream\n");
+        SmolTLV_Encoder_destroy(encoder);
+        return;
+    }
+    SmolTLV_Encoder_destroy(encoder);
+
+    // Written in two parts, second one followed by partial item
+    ChunkSink sink = { (uint8_t *)malloc(2u * size), 0, 2u * size, 0 };
+    uint8_t *output = (uint8_t *)malloc(size + 1u);
+    uint8_t *frame = (uint8_t *)malloc(size);
+    SmolTLV_ArchiveWriter *writer;
+    SmolTLV_ArchiveWriter_create(4096, chunk_sink_write, &sink, &writer);
+    SmolTLV_Cursor cursor;
+    size_t skipped;
+    SmolTLV_Cursor_init(&cursor, buffer, size);
+    SmolTLV_Cursor_skip(&cursor, 500, &skipped);
+    size_t half = cursor.position;
+    bool ok = SmolTLV_ArchiveWriter_write(writer, buffer, half) == SMOLTLV_STATUS_OK &&
+              SmolTLV_ArchiveWriter_write(writer, buffer + half, size - half - 1u) == SMOLTLV_STATUS_NEED_MORE_DATA &&
+              SmolTLV_ArchiveWriter_write(writer, buffer + half, size - half) == SMOLTLV_STATUS_OK &&
+              SmolTLV_ArchiveWriter_finish(writer) == SMOLTLV_STATUS_OK;
+    SmolTLV_ArchiveWriter_destroy(writer);
+
+    SmolTLV_Archive *archive = NULL;
+    ok = ok && SmolTLV_Archive_open(sink.buffer, sink.size, &archive) == SMOLTLV_STATUS_OK &&
+         SmolTLV_Archive_item_count(archive) == 1003 &&
+         SmolTLV_Archive_stream_size(archive) == size &&
+         SmolTLV_Archive_frame_count(archive) > 4 &&
+         sink.size < size;
+    if (!ok) {
+        printf("Failed to write archive, %zu bytes\n", sink.size);
+    }
+
+    // Whole stream with one and more threads
+    for (unsigned threads = 1; ok && threads <= 4; threads += 3) {
+        memset(output, 0, size);
+        ok = SmolTLV_Archive_read_all(archive, output, size, threads) == SMOLTLV_STATUS_OK &&
+             memcmp(output, buffer, size) == 0;
+        if (!ok) {
+            printf("Wrong archive stream with %u threads\n", threads);
+        }
+    }
+
+    // Every item with its string table, blob frame stored uncompressed
+    SmolTLV_Item expected, item, table;
+    SmolTLV_Item expected_table = { NULL };
+    SmolTLV_Cursor_init(&cursor, buffer, size);
+    for (uint64_t i = 0; ok && SmolTLV_Cursor_next(&cursor, &expected) == SMOLTLV_STATUS_OK; i++) {
+        size_t length = 4u + SmolTLV_Item_get_length(expected);
+        ok = SmolTLV_Archive_read_item(archive, i, frame, size, &item, &table) == SMOLTLV_STATUS_OK &&
+             memcmp(item.pointer, expected.pointer, length) == 0 &&
+             (table.pointer == NULL) == (expected_table.pointer == NULL) &&
+             (!table.pointer || memcmp(table.pointer, expected_table.pointer,
+                                       4u + SmolTLV_Item_get_length(table)) == 0);
+        if (ok && SmolTLV_Item_get_type(expected) == SMOLTLV_TYPE_BYTES) {
+            size_t index;
+            SmolTLV_ArchiveFrame info;
+            ok = SmolTLV_Archive_find_item(archive, i, &index) &&
+                 SmolTLV_Archive_get_frame(archive, index, &info) &&
+                 info.stored_size == info.size && info.first_item == i;
+        }
+        if (SmolTLV_Item_get_type(expected) == SMOLTLV_TYPE_STRING_TABLE) {
+            expected_table = expected;
+        }
+        if (!ok) {
+            printf("Wrong archive item %llu\n", (unsigned long long)i);
+        }
+    }
+    ok = ok && SmolTLV_Archive_read_item(archive, 1003, frame, size, &item, &table) == SMOLTLV_STATUS_INVALID_ARGUMENT;
+    SmolTLV_Archive_destroy(archive);
+
+    // Sequential reader, byte at a time, in pieces and pulled
+    static const size_t pieces[] = { 1, 7, 5000, 0 };
+    for (size_t i = 0; ok && i < sizeof(pieces) / sizeof(pieces[0]); i++) {
+        ok = archive_stream_matches(sink.buffer, sink.size, pieces[i], buffer, size);
+    }
+    if (ok) {
+        SmolTLV_ArchiveReader *reader;
+        ChunkSink items = { output, 0, size, 0 };
+        SmolTLV_ArchiveReader_create(archive_sink_item, &items, &reader);
+        ok = SmolTLV_ArchiveReader_write(reader, sink.buffer, sink.size - 1u) == SMOLTLV_STATUS_OK &&
+             SmolTLV_ArchiveReader_finish(reader) == SMOLTLV_STATUS_NEED_MORE_DATA;
+        SmolTLV_ArchiveReader_destroy(reader);
+
+        // Index entry not matching frames
+        items.size = 0;
+        sink.buffer[sink.size - 30u] ^= 1u;
+        SmolTLV_ArchiveReader_create(archive_sink_item, &items, &reader);
+        ok = ok && SmolTLV_ArchiveReader_write(reader, sink.buffer, sink.size) == SMOLTLV_STATUS_INVALID_FORMAT &&
+             SmolTLV_ArchiveReader_finish(reader) == SMOLTLV_STATUS_INVALID_FORMAT;
+        SmolTLV_ArchiveReader_destroy(reader);
+        sink.buffer[sink.size - 30u] ^= 1u;
+        if (!ok) {
+            printf("Incomplete archive not rejected by sequential reader\n");
+        }
+    }
+
+    // Truncated archive, corrupted trailer, wrong decompressed size
+    if (ok) {
+        SmolTLV_ArchiveFrame info;
+        ok = SmolTLV_Archive_open(sink.buffer, sink.size - 1u, &archive) == SMOLTLV_STATUS_INVALID_FORMAT;
+        sink.buffer[sink.size - 10u] ^= 1u;
+        ok = ok && SmolTLV_Archive_open(sink.buffer, sink.size, &archive) == SMOLTLV_STATUS_INVALID_FORMAT;
+        sink.buffer[sink.size - 10u] ^= 1u;
+        sink.buffer[8 + 7] += 1u;
+        ok = ok && SmolTLV_Archive_open(sink.buffer, sink.size, &archive) == SMOLTLV_STATUS_OK &&
+             SmolTLV_Archive_get_frame(archive, 0, &info) && info.stored_size < info.size &&
+             SmolTLV_Archive_read_all(archive, output, size + 1u, 4) == SMOLTLV_STATUS_INVALID_FORMAT;
+        SmolTLV_Archive_destroy(archive);
+        if (!ok) {
+            printf("Corrupted archive not rejected\n");
+        }
+    }
+
+    if (ok) {
+        printf("Successfully read archive, %zu of %zu bytes\n", sink.size, size);
+    }
+    free(frame);
+    free(output);
+    free(sink.buffer);
+    free((void*)buffer);
+}
+
+/** Variant 0 is the base, others change it in one or a few places */
+static const uint8_t *diff_document(int variant, size_t *out_size) {
+    SmolTLV_Encoder *encoder = SmolTLV_Encoder_create();
+    const uint8_t *buffer = NULL;
+
+    if (variant == 9) {
+        SmolTLV_Encoder_write_int(encoder, 42);
+    } else {
+        SmolTLV_Encoder_start_dict(encoder);
+        if (variant != 10) {
+            SmolTLV_Encoder_write_key(encoder, variant == 7 ? "title" : "name");
+            SmolTLV_Encoder_write_string(encoder, "device");
+        }
+        if (variant == 3) {
+            SmolTLV_Encoder_write_key(encoder, "added");
+            SmolTLV_Encoder_write_bool(encoder, true);
+        }
+        SmolTLV_Encoder_write_key(encoder, "config");
+        SmolTLV_Encoder_start_dict(encoder);
+        SmolTLV_Encoder_write_key(encoder, "mode");
+        SmolTLV_Encoder_write_int(encoder, variant == 8 ? 2 : 1);
+        SmolTLV_Encoder_write_key(encoder, "values");
+        SmolTLV_Encoder_start_list(encoder);
+        for (int64_t i = 0; i < 100; i++) {
+            SmolTLV_Encoder_write_int(encoder, variant == 1 && i == 50 ? -1 : i);
+        }
+        SmolTLV_Encoder_end(encoder);
+        SmolTLV_Encoder_end(encoder);
+        if (variant != 4) {
+            SmolTLV_Encoder_write_key(encoder, "serial");
+            if (variant == 6) {
+                SmolTLV_Encoder_start_list(encoder);
+                SmolTLV_Encoder_end(encoder);
+            } else {
+                SmolTLV_Encoder_write_string(encoder, "A-1");
+            }
+        }
+        SmolTLV_Encoder_write_key(encoder, "log");
+        SmolTLV_Encoder_start_list(encoder);
+        for (int64_t i = 0; i < 1000; i++) {
+            if (variant == 5 && i >= 400 && i < 410) {
+                continue;
+            }
+            SmolTLV_Encoder_write_int(encoder, i);
+        }
+        if (variant == 2) {
+            SmolTLV_Encoder_write_string(encoder, "appended");
+            SmolTLV_Encoder_write_null(encoder);
+        }
+        SmolTLV_Encoder_end(encoder);
+        if (variant == 10) {
+            SmolTLV_Encoder_write_key(encoder, "name");
+            SmolTLV_Encoder_write_string(encoder, "device");
+        }
+        SmolTLV_Encoder_end(encoder);
+    }
+
+    if (SmolTLV_Encoder_finalize(encoder, &buffer, out_size) != SMOLTLV_STATUS_OK) {
+        buffer = NULL;
+    }
+    SmolTLV_Encoder_destroy(encoder);
+    return buffer;
+}
+
+/** Dict of count keys starting at first, value of key changed is negated */
+static const uint8_t *diff_large_dict(int64_t first, int64_t count, int64_t changed, size_t *out_size) {
+    SmolTLV_Encoder *encoder = SmolTLV_Encoder_create();
+    const uint8_t *buffer = NULL;
+    char key[16];
+    SmolTLV_Encoder_start_dict(encoder);
+    for (int64_t i = first; i < first + count; i++) {
+        snprintf(key, sizeof(key), "key%lld", (long long)i);
+        SmolTLV_Encoder_write_key(encoder, key);
+        SmolTLV_Encoder_write_int(encoder, i == changed ? -i : i);
+    }
+    SmolTLV_Encoder_end(encoder);
+    if (SmolTLV_Encoder_finalize(encoder, &buffer, out_size) != SMOLTLV_STATUS_OK) {
+        buffer = NULL;
+    }
+    SmolTLV_Encoder_destroy(encoder);
+    return buffer;
+}
+
+/** Diffs base against target and applies the patch, sets out_patch_size */
+static bool test_diff_target(SmolTLV_Item base, const uint8_t *target, size_t target_size, size_t *out_patch_size) {
+    size_t patch_size, size;
+    const uint8_t *patch = NULL;
+    uint8_t *output = (uint8_t *)malloc(target_size);
+    SmolTLV_Item target_item = { target };
+    SmolTLV_Encoder *encoder = SmolTLV_Encoder_create();
+    bool same = target_size == 4u + SmolTLV_Item_get_length(base) && memcmp(base.pointer, target, target_size) == 0;
+
+    bool ok = SmolTLV_diff(base, target_item, encoder) == SMOLTLV_STATUS_OK &&
+              SmolTLV_Encoder_finalize(encoder, &patch, &patch_size) == SMOLTLV_STATUS_OK;
+    SmolTLV_Encoder_destroy(encoder);
+    SmolTLV_Item patch_item = { patch };
+    ok = ok && SmolTLV_diff_target_size(patch_item, &size) == SMOLTLV_STATUS_OK &&
+         size == target_size &&
+         SmolTLV_diff_is_empty(patch_item) == same &&
+         SmolTLV_diff_apply(base, patch_item, output, target_size, &size) == SMOLTLV_STATUS_OK &&
+         size == target_size && memcmp(output, target, target_size) == 0;
+
+    *out_patch_size = patch_size;
+    free(output);
+    free((void*)patch);
+    return ok;
+}
+
+static bool test_diff_variant(SmolTLV_Item base, int variant, size_t *out_patch_size) {
+    size_t target_size;
+    const uint8_t *target = diff_document(variant, &target_size);
+    bool ok = test_diff_target(base, target, target_size, out_patch_size);
+    if (!ok) {
+        printf("Failed to diff and patch variant %d\n", variant);
+    }
+    free((void*)target);
+    return ok;
+}
+
+void test_diff() {
+    size_t base_size, size;
+    const uint8_t *buffer = diff_document(0, &base_size);
+    SmolTLV_Item base = { buffer };
+    if (!buffer) {
+        printf("Failed to encode diff document\n");
+        return;
+    }
+
+    // Unchanged, one nested value, appended, inserted and removed entries,
+    // removed list range, changed type, renamed key, root replaced, key
+    // moved to the end
+    size_t patch_sizes[11];
+    for (int variant = 0; variant < 11; variant++) {
+        if (!test_diff_variant(base, variant, &patch_sizes[variant])) {
+            free((void*)buffer);
+            return;
+        }
+    }
+    if (patch_sizes[1] > 128u || patch_sizes[5] > 128u) {
+        printf("Wrong patch sizes: %zu %zu\n", patch_sizes[1], patch_sizes[5]);
+        free((void*)buffer);
+        return;
+    }
+
+    // Dict entries are matched by key, removing the first entry, changing
+    // one and appending one does not touch the rest
+    size_t large_size, shifted_size, large_patch_size;
+    const uint8_t *large = diff_large_dict(0, 200, -1, &large_size);
+    const uint8_t *shifted = diff_large_dict(1, 200, 100, &shifted_size);
+    SmolTLV_Item large_item = { large };
+    bool ok = test_diff_target(large_item, shifted, shifted_size, &large_patch_size) &&
+              large_patch_size <= 256u;
+    free((void*)large);
+    free((void*)shifted);
+    if (!ok) {
+        printf("Failed to diff dict by key, %zu byte patch\n", large_patch_size);
+        free((void*)buffer);
+        return;
+    }
+
+    // Diverged base of the same size, wrong base, small capacity, set past
+    // the end of root, unknown operation
+    size_t diverged_size, patch_size;
+    const uint8_t *diverged = diff_document(8, &diverged_size);
+    const uint8_t *target = diff_document(1, &size);
+    const uint8_t *real_patch = NULL;
+    SmolTLV_Item diverged_item = { diverged };
+    SmolTLV_Item target_item = { target };
+    SmolTLV_Encoder *encoder = SmolTLV_Encoder_create();
+    uint8_t *output = (uint8_t *)malloc(base_size);
+    ok = diverged_size == base_size &&
+         SmolTLV_diff(base, target_item, encoder) == SMOLTLV_STATUS_OK &&
+         SmolTLV_Encoder_finalize(encoder, &real_patch, &patch_size) == SMOLTLV_STATUS_OK;
+    SmolTLV_Encoder_destroy(encoder);
+    SmolTLV_Item real_patch_item = { real_patch };
+    ok = ok && SmolTLV_diff_apply(diverged_item, real_patch_item, output, base_size, &size) == SMOLTLV_STATUS_INVALID_ARGUMENT;
+
+    static const uint8_t bad_ops[] = {
+        0x06, 0x00, 0x00, 0x54,
+        0x03, 0x00, 0x00, 0x08, 0, 0, 0, 0, 0, 0, 0, 0,
+        0x03, 0x00, 0x00, 0x08, 0, 0, 0, 0, 0, 0, 0, 0,
+        0x03, 0x00, 0x00, 0x08, 0, 0, 0, 0, 0, 0, 0, 0,
+        0x06, 0x00, 0x00, 0x2C,
+        0x06, 0x00, 0x00, 0x28,
+        0x03, 0x00, 0x00, 0x08, 0, 0, 0, 0, 0, 0, 0, 0,
+        0x06, 0x00, 0x00, 0x0C,
+        0x03, 0x00, 0x00, 0x08, 0, 0, 0, 0, 0, 0, 0x13, 0x88,
+        0x03, 0x00, 0x00, 0x08, 0, 0, 0, 0, 0, 0, 0, 1,
+    };
+    uint8_t patch[sizeof(bad_ops)];
+    SmolTLV_Item patch_item = { patch };
+    SmolTLV_Item other = { bad_ops };
+    memcpy(patch, bad_ops, sizeof(patch));
+    patch[15] = (uint8_t)base_size;
+    patch[14] = (uint8_t)(base_size >> 8);
+    patch[39] = patch[15];
+    patch[38] = patch[14];
+    // Base hash taken from a real patch
+    if (real_patch) {
+        memcpy(patch + 20, real_patch + 20, 8u);
+    }
+    ok = ok && SmolTLV_diff_apply(other, patch_item, output, base_size, &size) == SMOLTLV_STATUS_INVALID_ARGUMENT &&
+         SmolTLV_diff_apply(base, patch_item, output, base_size - 1u, &size) == SMOLTLV_STATUS_INVALID_ARGUMENT &&
+         SmolTLV_diff_apply(base, patch_item, output, base_size, &size) == SMOLTLV_STATUS_INVALID_FORMAT;
+    patch[59] = 7;
+    ok = ok && SmolTLV_diff_apply(base, patch_item, output, base_size, &size) == SMOLTLV_STATUS_INVALID_FORMAT;
+    free(output);
+    free((void*)real_patch);
+    free((void*)target);
+    free((void*)diverged);
+    free((void*)buffer);
+    if (!ok) {
+        printf("Invalid patch not rejected\n");
+        return;
+    }
+
+    printf("Successfully diffed and patched documents, %zu byte patch of %zu byte document\n",
+           patch_sizes[1], base_size);
+}
+
+void test_skip() {
+    SmolTLV_Encoder *encoder = SmolTLV_Encoder_create();
+
+    // Root list: 1000 INTs, mixed tail of string, null, nested list and dict
+    SmolTLV_Encoder_start_list(encoder);
+    for (size_t i = 0; i < 1000; i++) {
+        SmolTLV_Encoder_write_int(encoder, (int64_t)i);
+    }
+    SmolTLV_Encoder_write_string(encoder, "tail");
+    SmolTLV_Encoder_write_null(encoder);
+    SmolTLV_Encoder_start_list(encoder);
+    SmolTLV_Encoder_write_int(encoder, 1);
+    SmolTLV_Encoder_end(encoder);
+    SmolTLV_Encoder_start_dict(encoder);
+    SmolTLV_Encoder_write_key(encoder, "a");
+    SmolTLV_Encoder_write_int(encoder, 1);
+    SmolTLV_Encoder_write_key(encoder, "b");
+    SmolTLV_Encoder_write_bool(encoder, true);
+    SmolTLV_Encoder_end(encoder);
+    SmolTLV_Encoder_end(encoder);
+
+    const uint8_t *buffer;
+    size_t size;
+    if (SmolTLV_Encoder_finalize(encoder, &buffer, &size) != SMOLTLV_STATUS_OK) {
+        printf("Failed to encode skip document\n");
+        SmolTLV_Encoder_destroy(encoder);
+        return;
+    }
+    SmolTLV_Encoder_destroy(encoder);
+
+    SmolTLV_Cursor cursor;
+    SmolTLV_Item root, item;
+    size_t count = 0;
+    int64_t value = 0;
+    SmolTLV_Cursor_init(&cursor, buffer, size);
+    SmolTLV_Cursor_next(&cursor, &root);
+
+    if (!SmolTLV_Item_count(root, &count) || count != 1004) {
+        printf("Wrong list count %zu\n", count);
+        free((void*)buffer);
+        return;
+    }
+    SmolTLV_Item dict;
+    if (!SmolTLV_Item_list_at(root, 1003, &dict) ||
+        !SmolTLV_Item_count(dict, &count) || count != 4) {
+        printf("Wrong dict count %zu\n", count);
+        free((void*)buffer);
+        return;
+    }
+    if (!SmolTLV_Item_list_at(root, 0, &item) || SmolTLV_Item_count(item, &count)) {
+        printf("Counted items of non-container\n");
+        free((void*)buffer);
+        return;
+    }
+
+    // Skipping into INT run at every alignment
+    for (size_t n = 0; n < 1004; n += 37) {
+        SmolTLV_Cursor_for_item(&cursor, root);
+        size_t skipped = 0;
+        if (SmolTLV_Cursor_skip(&cursor, n, &skipped) != SMOLTLV_STATUS_OK ||
+            skipped != n ||
+            SmolTLV_Cursor_next(&cursor, &item) != SMOLTLV_STATUS_OK ||
+            (n < 1000 && (!SmolTLV_Item_as_int(item, &value) || value != (int64_t)n))) {
+            printf("Failed to skip %zu items\n", n);
+            free((void*)buffer);
+            return;
+        }
+    }
+
+    // Skipping past end stops at end and reports items skipped
+    SmolTLV_Cursor_for_item(&cursor, root);
+    size_t skipped = 0;
+    if (SmolTLV_Cursor_skip(&cursor, 998, NULL) != SMOLTLV_STATUS_OK ||
+        SmolTLV_Cursor_count(&cursor, &count) != SMOLTLV_STATUS_OK || count != 6 ||
+        SmolTLV_Cursor_skip(&cursor, 10, &skipped) != SMOLTLV_STATUS_END ||
+        skipped != 6 ||
+        SmolTLV_Cursor_next(&cursor, &item) != SMOLTLV_STATUS_END) {
+        printf("Failed to skip past end\n");
+        free((void*)buffer);
+        return;
+    }
+
+    // Malformed header in the middle of INT run (NULL with length 8)
+    uint8_t *broken = malloc(size);
+    memcpy(broken, buffer, size);
+    broken[4 + 500 * 12] = SMOLTLV_TYPE_NULL;
+    SmolTLV_Cursor_init(&cursor, broken, size);
+    SmolTLV_Cursor_next(&cursor, &root);
+    SmolTLV_Cursor_for_item(&cursor, root);
+    if (SmolTLV_Cursor_skip(&cursor, 1000, &skipped) != SMOLTLV_STATUS_INVALID_FORMAT ||
+        skipped != 500 ||
+        SmolTLV_Cursor_next(&cursor, &item) != SMOLTLV_STATUS_INVALID_FORMAT ||
+        SmolTLV_Item_count(root, NULL) ||
+        SmolTLV_Item_list_at(root, 600, NULL) ||
+        !SmolTLV_Item_list_at(root, 499, NULL)) {
+        printf("Failed to detect malformed item while skipping\n");
+        free(broken);
+        free((void*)buffer);
+        return;
+    }
+
+    // Truncated buffer
+    SmolTLV_Cursor_init(&cursor, buffer + 4, 100 * 12 + 6);
+    if (SmolTLV_Cursor_count(&cursor, &count) != SMOLTLV_STATUS_NEED_MORE_DATA ||
+        SmolTLV_Cursor_skip(&cursor, 200, &skipped) != SMOLTLV_STATUS_NEED_MORE_DATA ||
+        skipped != 100 || cursor.position != 100 * 12) {
+        printf("Failed to detect truncated buffer while skipping\n");
+        free(broken);
+        free((void*)buffer);
+        return;
+    }
+
+    free(broken);
+    free((void*)buffer);
+    printf("Successfully skipped and counted items\n");
+}
+
+static SmolTLV_Status encode_parallel_records(SmolTLV_Encoder *encoder,
+                                              size_t begin,
+                                              size_t end,
+                                              void *context) {
+    (void)context;
+    SmolTLV_Status status = SMOLTLV_STATUS_OK;
+    for (size_t i = begin; i < end && status == SMOLTLV_STATUS_OK; i++) {
+        SmolTLV_Encoder_start_dict(encoder);
+        SmolTLV_Encoder_write_string(encoder, "id");
+        SmolTLV_Encoder_write_int(encoder, (int64_t)i);
+        SmolTLV_Encoder_write_string(encoder, "even");
+        SmolTLV_Encoder_write_bool(encoder, (i & 1u) == 0u);
+        status = SmolTLV_Encoder_end(encoder);
+    }
+    return status;
+}
+
+static SmolTLV_Status encode_parallel_unbalanced(SmolTLV_Encoder *encoder,
+                                                 size_t begin,
+                                                 size_t end,
+                                                 void *context) {
+    (void)context;
+    (void)end;
+    // Slice not starting at zero leaves its dict open
+    return begin == 0 ? SMOLTLV_STATUS_OK : SmolTLV_Encoder_start_dict(encoder);
+}
+
+void test_parallel_list() {
+    SmolTLV_ParallelList list = { encode_parallel_records, NULL, 10001, 4 };
+    const uint8_t *expected, *buffer;
+    size_t expected_size, size;
+
+    SmolTLV_Encoder *encoder = SmolTLV_Encoder_create();
+    SmolTLV_Encoder_start_list(encoder);
+    encode_parallel_records(encoder, 0, list.count, NULL);
+    SmolTLV_Encoder_end(encoder);
+    SmolTLV_Encoder_finalize(encoder, &expected, &expected_size);
+    SmolTLV_Encoder_destroy(encoder);
+
+    encoder = SmolTLV_Encoder_create();
+    SmolTLV_Status status = SmolTLV_ParallelList_encode(&list, encoder);
+    if (status != SMOLTLV_STATUS_OK ||
+        SmolTLV_Encoder_finalize(encoder, &buffer, &size) != SMOLTLV_STATUS_OK) {
+        printf("Failed to encode list in parallel: %d\n", status);
+        SmolTLV_Encoder_destroy(encoder);
+        free((void*)expected);
+        return;
+    }
+    SmolTLV_Encoder_destroy(encoder);
+
+    bool same = size == expected_size && memcmp(buffer, expected, size) == 0;
+    free((void*)buffer);
+    if (!same) {
+        printf("Parallel list differs from serial encoding\n");
+        free((void*)expected);
+        return;
+    }
+
+    FILE *file = tmpfile();
+    uint8_t *written = (uint8_t *)malloc(expected_size + 1u);
+    size_t written_size = 0;
+    if (file && written && SmolTLV_ParallelList_write_fd(&list, fileno(file)) == SMOLTLV_STATUS_OK) {
+        rewind(file);
+        written_size = fread(written, 1, expected_size + 1u, file);
+    }
+    same = written_size == expected_size && memcmp(written, expected, expected_size) == 0;
+    if (file) {
+        fclose(file);
+    }
+    free(written);
+    free((void*)expected);
+    if (!same) {
+        printf("Parallel list written to file differs: %zu\n", written_size);
+        return;
+    }
+
+    SmolTLV_ParallelList unbalanced = { encode_parallel_unbalanced, NULL, 8, 2 };
+    encoder = SmolTLV_Encoder_create();
+    status = SmolTLV_ParallelList_encode(&unbalanced, encoder);
+    SmolTLV_Encoder_destroy(encoder);
+    if (status != SMOLTLV_STATUS_INVALID_STATE) {
+        printf("Parallel list with open container was accepted: %d\n", status);
+        return;
+    }
+
+    printf("Successfully encoded list in parallel, size: %zu\n", expected_size);
+}
+
+#ifdef SMOLTLV_STATS
+void test_stats() {
+    SmolTLV_DecoderStats decoder;
+    SmolTLV_Item dict_item = { test_dict }, item;
+    SmolTLV_Cursor cursor;
+
+    SmolTLV_DecoderStats_reset();
+    SmolTLV_Item_dict_get(dict_item, "name", &item);
+    SmolTLV_Item_dict_get(dict_item, "missing", &item);
+    SmolTLV_Cursor_init(&cursor, test_dict, 10);
+    SmolTLV_Cursor_next(&cursor, &item);
+    SmolTLV_DecoderStats_get(&decoder);
+
+    if (decoder.items_visited != 8 || decoder.need_more_data != 1 ||
+        decoder.lookups != 2 || decoder.lookup_scanned != 4 ||
+        decoder.lookup_scanned_max != 2) {
+        printf("Unexpected decoder stats: %llu %llu %llu %llu %llu\n",
+               (unsigned long long)decoder.items_visited,
+               (unsigned long long)decoder.need_more_data,
+               (unsigned long long)decoder.lookups,
+               (unsigned long long)decoder.lookup_scanned,
+               (unsigned long long)decoder.lookup_scanned_max);
+        return;
+    }
+
+    uint8_t blob[100] = { 0 };
+    SmolTLV_EncoderStats encoder_stats;
+    SmolTLV_Encoder *encoder = SmolTLV_Encoder_create();
+    SmolTLV_Encoder_start_list(encoder);
+    SmolTLV_Encoder_start_dict(encoder);
+    SmolTLV_Encoder_write_string(encoder, "k");
+    SmolTLV_Encoder_write_int(encoder, 1);
+    SmolTLV_Encoder_end(encoder);
+    SmolTLV_Encoder_write_bytes(encoder, blob, sizeof(blob));
+    SmolTLV_Encoder_get_stats(encoder, &encoder_stats);
+
+    // Buffer grows 4 -> 8 -> 16 -> 32 -> 256 with 4 + 8 + 13 + 25 bytes in use
+    if (encoder_stats.items_written != 5 || encoder_stats.reallocs != 4 ||
+        encoder_stats.realloc_bytes != 50 || encoder_stats.bytes_copied != 109 ||
+        encoder_stats.peak_depth != 2) {
+        printf("Unexpected encoder stats: %llu %llu %llu %llu %u\n",
+               (unsigned long long)encoder_stats.items_written,
+               (unsigned long long)encoder_stats.reallocs,
+               (unsigned long long)encoder_stats.realloc_bytes,
+               (unsigned long long)encoder_stats.bytes_copied,
+               encoder_stats.peak_depth);
+        SmolTLV_Encoder_destroy(encoder);
+        return;
+    }
+
+    SmolTLV_Encoder_reset_stats(encoder);
+    SmolTLV_Encoder_get_stats(encoder, &encoder_stats);
+    SmolTLV_Encoder_destroy(encoder);
+    if (encoder_stats.items_written != 0 || encoder_stats.peak_depth != 1) {
+        printf("Encoder stats were not reset\n");
+        return;
+    }
+
+    printf("Successfully counted decoder and encoder stats\n");
+}
+#endif
+
 int main() {
     test_decode_null();
     test_decode_bool();
@@ -410,9 +2780,31 @@ int main() {
     test_decode_negative_integer();
     test_decode_list();
     test_decode_dict();
+    test_decode_array();
 
     test_encode_null();
     test_encode_int();
     test_encode_dict();
+    test_encode_array();
+    test_string_table();
+    test_record_batch();
+    test_extract();
+    test_patch();
+    test_projection();
+    test_template();
+    test_parallel_list();
+    test_chunked();
+    test_chunked_nested();
+    test_json();
+    test_cbor();
+    test_shared();
+    test_skip();
+    test_dom();
+    test_ingest();
+    test_archive();
+    test_diff();
+#ifdef SMOLTLV_STATS
+    test_stats();
+#endif
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,212 @@
+#include <smoltlv.hpp>
+#include <smoltlv_schema.hpp>
+#include <cstdio>
+#include <cstdlib>
+
+static uint8_t test_dict[] = {
+    0x07, 0x00, 0x00, 0x38, // Type: DICT, Length: 56
+    // Key: "age"
+    0x05, 0x00, 0x00, 0x03, // STRING
+    'a', 'g', 'e',
+    // Value: 30
+    0x03, 0x00, 0x00, 0x08, // INT
+    0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x1E,
+    // Key: "name"
+    0x05, 0x00, 0x00, 0x04, // STRING
+    'n', 'a', 'm', 'e',
+    // Value: "Alice"
+    0x05, 0x00, 0x00, 0x05, // STRING
+    'A', 'l', 'i', 'c', 'e',
+    // Key: "list"
+    0x05, 0x00, 0x00, 0x04, // STRING
+    'l', 'i', 's', 't',
+    // Value: [true, null]
+    0x06, 0x00, 0x00, 0x08, // LIST
+    0x01, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00
+};
+
+void test_views() {
+    auto root = smoltlv::parse(test_dict, sizeof(test_dict));
+    if (!root) {
+        printf("Failed to parse dict\n");
+        return;
+    }
+
+    auto dict = root->as_dict();
+    if (!dict || dict->size() != 3) {
+        printf("Parsed item is not a dict of 3 entries\n");
+        return;
+    }
+
+    auto age = (*root)["age"];
+    if (!age || age->as_int() != 30) {
+        printf("'age' is not INT 30\n");
+        return;
+    }
+
+    auto name = dict->get("name");
+    if (!name || name->as_string() != std::string_view("Alice")) {
+        printf("'name' is not 'Alice'\n");
+        return;
+    }
+
+    if ((*root)["missing"] || root->at(0)) {
+        printf("Lookup of missing entry succeeded\n");
+        return;
+    }
+
+    size_t keys = 0;
+    for (const smoltlv::DictEntry &entry : *dict) {
+        if (entry.key.type() == SMOLTLV_TYPE_STRING) {
+            keys++;
+        }
+    }
+
+    auto list = (*root)["list"]->as_list();
+    size_t items = 0;
+    bool first_true = false;
+    for (smoltlv::Item item : *list) {
+        if (items == 0) {
+            first_true = item.as_bool() == true;
+        }
+        items++;
+    }
+
+    if (keys != 3 || items != 2 || !first_true || !list->at(1)->is_null()) {
+        printf("Iteration over dict and list does not match\n");
+        return;
+    }
+
+    // C and C++ lookups agree
+    SmolTLV_Item c_item;
+    if (!SmolTLV_Item_dict_get(*root, "name", &c_item) || smoltlv::Item(c_item) != *name) {
+        printf("C and C++ lookup differ\n");
+        return;
+    }
+
+    printf("Successfully accessed dict through C++ views\n");
+}
+
+void test_truncated() {
+    size_t count = 0;
+    for (smoltlv::Item item : smoltlv::ItemRange(test_dict + 4, 15)) {
+        (void)item;
+        count++;
+    }
+
+    if (count != 1) {
+        printf("Iteration over truncated buffer did not stop: %zu\n", count);
+        return;
+    }
+
+    printf("Successfully stopped at truncated item\n");
+}
+
+void test_nested_chunk() {
+    // [chunked "x", ""], chunk items end iteration inside containers only
+    static const uint8_t list[] = {
+        0x06, 0x00, 0x00, 0x09,
+        0x13, 0x00, 0x00, 0x01, 'x',
+        0x05, 0x00, 0x00, 0x00,
+    };
+    smoltlv::Item item(list);
+    size_t nested = item.as_list()->count();
+    size_t top_level = smoltlv::ItemRange(list + 4, 9).count();
+
+    if (nested != 0 || top_level != 2) {
+        printf("Chunk inside list was accepted: %zu %zu\n", nested, top_level);
+        return;
+    }
+
+    printf("Successfully stopped at chunk inside list\n");
+}
+
+struct TestLocation {
+    int32_t x;
+    int32_t y;
+};
+
+SMOLTLV_SCHEMA(TestLocation,
+    SMOLTLV_FIELD(TestLocation, x),
+    SMOLTLV_FIELD(TestLocation, y))
+
+struct TestSensor {
+    uint16_t id;
+    std::string name;
+    double value;
+    bool active;
+    std::vector<int16_t> samples;
+    std::optional<int64_t> parent;
+    TestLocation location;
+};
+
+SMOLTLV_SCHEMA(TestSensor,
+    SMOLTLV_FIELD(TestSensor, id),
+    SMOLTLV_FIELD(TestSensor, name),
+    SMOLTLV_FIELD(TestSensor, value),
+    SMOLTLV_FIELD(TestSensor, active),
+    SMOLTLV_FIELD(TestSensor, samples),
+    SMOLTLV_FIELD(TestSensor, parent),
+    SMOLTLV_FIELD_NAMED(TestSensor, location, "loc"))
+
+void test_schema() {
+    TestSensor sensor{ 7, "thermo", 21.5, true, { -1, 2, 300 }, std::nullopt, { 10, -20 } };
+    uint8_t buffer[256];
+
+    size_t size = smoltlv::schema::encode(sensor, buffer, sizeof(buffer));
+    if (size == 0 || size != smoltlv::schema::encoded_size(sensor)) {
+        printf("Failed to encode struct: %zu\n", size);
+        return;
+    }
+
+    SmolTLV_Item item = { buffer }, value;
+    int64_t x;
+    if (!SmolTLV_Item_dict_get(item, "loc", &value) ||
+        !SmolTLV_Item_dict_get(value, "x", &value) ||
+        !SmolTLV_Item_as_int(value, &x) || x != 10) {
+        printf("Encoded struct does not contain loc.x\n");
+        return;
+    }
+
+    TestSensor decoded{};
+    decoded.parent = 5;
+    if (!smoltlv::schema::decode(buffer, size, decoded)) {
+        printf("Failed to decode struct\n");
+        return;
+    }
+
+    if (decoded.id != 7 || decoded.name != "thermo" || decoded.value != 21.5 ||
+        !decoded.active || decoded.samples != sensor.samples || decoded.parent ||
+        decoded.location.x != 10 || decoded.location.y != -20) {
+        printf("Decoded struct does not match\n");
+        return;
+    }
+
+    if (smoltlv::schema::encode(sensor, buffer, size - 1) != 0) {
+        printf("Encoding into short buffer succeeded\n");
+        return;
+    }
+
+    // Out of range value for uint16_t member
+    static const uint8_t bad_id[] = {
+        0x07, 0x00, 0x00, 0x12,
+        0x05, 0x00, 0x00, 0x02, 'i', 'd',
+        0x03, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00
+    };
+    if (smoltlv::schema::decode(bad_id, sizeof(bad_id), decoded)) {
+        printf("Decoded out of range value\n");
+        return;
+    }
+
+    printf("Successfully encoded and decoded struct through schema\n");
+}
+
+int main() {
+    test_views();
+    test_truncated();
+    test_nested_chunk();
+    test_schema();
+    return 0;
+}
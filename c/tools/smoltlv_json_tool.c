@@ -0,0 +1,127 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil -*-
+ * 
+ * SmolTLV - Simple serialization format for JSON/CBOR-like data model 
+ * for embedded devices - JSON conversion tool.
+ * 
+ * Copyright (c) 2025 Aleš Hakl
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <smoltlv.h>
+#include <smoltlv_json.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char usage[] =
+    "usage: smoltlv-json [-d] [input [output]]\n"
+    "  Converts JSON to SmolTLV, with -d SmolTLV to JSON.\n"
+    "  Input and output default to stdin and stdout.\n";
+
+static uint8_t *read_all(FILE *file, size_t *out_size) {
+    size_t capacity = 65536u, size = 0;
+    uint8_t *data = (uint8_t *)malloc(capacity);
+    while (data) {
+        size += fread(data + size, 1, capacity - size, file);
+        if (size < capacity) {
+            break;
+        }
+        capacity *= 2u;
+        uint8_t *grown = (uint8_t *)realloc(data, capacity);
+        if (!grown) {
+            free(data);
+        }
+        data = grown;
+    }
+    if (data && ferror(file)) {
+        free(data);
+        data = NULL;
+    }
+    *out_size = size;
+    return data;
+}
+
+static SmolTLV_Status write_file(const uint8_t *data, size_t length, void *context) {
+    return fwrite(data, 1, length, (FILE *)context) == length
+        ? SMOLTLV_STATUS_OK
+        : SMOLTLV_STATUS_INVALID_STATE;
+}
+
+int main(int argc, char **argv) {
+    bool decode = false;
+    int arg = 1;
+    if (arg < argc && strcmp(argv[arg], "-d") == 0) {
+        decode = true;
+        arg++;
+    }
+    if (argc - arg > 2 || (arg < argc && argv[arg][0] == '-' && argv[arg][1] != '\0')) {
+        fputs(usage, stderr);
+        return 2;
+    }
+
+    FILE *input = stdin, *output = stdout;
+    if (arg < argc && strcmp(argv[arg], "-") != 0 && !(input = fopen(argv[arg], "rb"))) {
+        perror(argv[arg]);
+        return 1;
+    }
+    arg++;
+    if (arg < argc && strcmp(argv[arg], "-") != 0 && !(output = fopen(argv[arg], "wb"))) {
+        perror(argv[arg]);
+        return 1;
+    }
+
+    size_t size;
+    uint8_t *data = read_all(input, &size);
+    if (!data) {
+        fputs("smoltlv-json: cannot read input\n", stderr);
+        return 1;
+    }
+
+    SmolTLV_Status status;
+    size_t error_offset = 0;
+    if (decode) {
+        status = SmolTLV_json_write(data, size, write_file, output);
+    } else {
+        SmolTLV_Encoder *encoder = SmolTLV_Encoder_create_with_size(size + 64u);
+        const uint8_t *buffer;
+        size_t buffer_size;
+        status = encoder ? SmolTLV_json_encode((const char *)data, size, encoder, &error_offset)
+                         : SMOLTLV_STATUS_OUT_OF_MEMORY;
+        if (status == SMOLTLV_STATUS_OK) {
+            status = SmolTLV_Encoder_finalize(encoder, &buffer, &buffer_size);
+        }
+        if (status == SMOLTLV_STATUS_OK) {
+            status = write_file(buffer, buffer_size, output);
+            free((void *)buffer);
+        }
+        SmolTLV_Encoder_destroy(encoder);
+    }
+    free(data);
+
+    if (fflush(output) != 0) {
+        status = SMOLTLV_STATUS_INVALID_STATE;
+    }
+    if (status == SMOLTLV_STATUS_INVALID_FORMAT && !decode) {
+        fprintf(stderr, "smoltlv-json: invalid JSON at offset %zu\n", error_offset);
+    } else if (status != SMOLTLV_STATUS_OK) {
+        fprintf(stderr, "smoltlv-json: failed with status %d\n", (int)status);
+    }
+    return status == SMOLTLV_STATUS_OK ? 0 : 1;
+}
@@ -0,0 +1,70 @@
+# SmolTLV - Simple serialization format for JSON/CBOR-like data model for 
+# embedded devices
+#
+# Copyright (c) 2025 Aleš Hakl
+# SPDX-License-Identifier: MIT
+#
+
+# Compares the C accelerator with the pure-Python loads/dumps, prints one 
+# JSON object per benchmark.
+
+import json
+import time
+from array import array
+
+import smoltlv
+
+def make_documents():
+    records = [
+        {
+            "id": i,
+            "name": f"sensor-{i}",
+            "active": i % 3 == 0,
+            "tags": ["a", "b", None],
+            "reading": {"value": i * 7, "unit": "mV", "raw": b"\x00\x01\x02"},
+        }
+        for i in range(5000)
+    ]
+    samples = {"samples": array("i", range(100000)), "label": "trace"}
+    return {"records": records, "samples": samples}
+
+def measure(function, value, rounds):
+    best = None
+    for _ in range(rounds):
+        start = time.perf_counter()
+        function(value)
+        elapsed = time.perf_counter() - start
+        best = elapsed if best is None else min(best, elapsed)
+    return best
+
+def report(name, implementation, seconds, size):
+    print(json.dumps({
+        "bench": name,
+        "implementation": implementation,
+        "ms": round(seconds * 1e3, 3),
+        "mb_per_s": round(size / seconds / 1e6, 1),
+    }))
+
+def main(rounds=5):
+    implementations = [("python", smoltlv._loads_python, smoltlv._dumps_python)]
+    if smoltlv._native is not None:
+        implementations.append(("native", smoltlv.loads, smoltlv.dumps))
+    else:
+        print(json.dumps({"warning": "smoltlv._native is not built"}))
+
+    for name, value in make_documents().items():
+        encoded = smoltlv._dumps_python(value)
+        for implementation, loads, dumps in implementations:
+            report(f"{name}_dumps", implementation, measure(dumps, value, rounds), len(encoded))
+            report(f"{name}_loads", implementation, measure(loads, encoded, rounds), len(encoded))
+
+    # Time to first field with lazy views versus full decoding
+    encoded = smoltlv.dumps(make_documents())
+    first_field = lambda data: smoltlv.loads_lazy(data)["records"][0]["id"]
+    report("first_field", "lazy", measure(first_field, encoded, rounds), len(encoded))
+    for implementation, loads, _ in implementations:
+        first_field = lambda data: loads(data)["records"][0]["id"]
+        report("first_field", implementation, measure(first_field, encoded, rounds), len(encoded))
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,22 @@
+# SmolTLV - Simple serialization format for JSON/CBOR-like data model for 
+# embedded devices
+#
+# Copyright (c) 2025 Aleš Hakl
+# SPDX-License-Identifier: MIT
+#
+
+# The C accelerator is optional, when it fails to build the package falls 
+# back to the pure-Python implementation.
+
+from setuptools import Extension, setup
+
+setup(
+    ext_modules=[
+        Extension(
+            "smoltlv._native",
+            sources=["smoltlv/_native.c", "../c/smoltlv.c"],
+            include_dirs=["../c"],
+            optional=True,
+        ),
+    ],
+)
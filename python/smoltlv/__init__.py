@@ -6,6 +6,8 @@
 #
 
 import struct
+import sys
+from array import array
 from io import BytesIO
 
 class DecoderError(Exception):
@@ -19,7 +21,102 @@ SMOLTLV_TYPE_BYTES      = 0x04
 SMOLTLV_TYPE_STRING     = 0x05
 SMOLTLV_TYPE_LIST       = 0x06
 SMOLTLV_TYPE_DICT       = 0x07
-SMOLTLV_TYPE_MAX        = 0x08 
+
+# Extension: packed big-endian typed arrays
+SMOLTLV_TYPE_ARRAY_INT8    = 0x08
+SMOLTLV_TYPE_ARRAY_INT16   = 0x09
+SMOLTLV_TYPE_ARRAY_INT32   = 0x0A
+SMOLTLV_TYPE_ARRAY_INT64   = 0x0B
+SMOLTLV_TYPE_ARRAY_FLOAT32 = 0x0C
+SMOLTLV_TYPE_ARRAY_FLOAT64 = 0x0D
+
+# Extension: key interning
+SMOLTLV_TYPE_STRING_TABLE  = 0x0E
+SMOLTLV_TYPE_STRING_REF    = 0x0F
+
+# Extension: columnar record batches
+SMOLTLV_TYPE_RECORD_BATCH  = 0x10
+SMOLTLV_TYPE_DELTA         = 0x11
+
+# Extension: chunked values beyond SMOLTLV_MAX_LENGTH
+SMOLTLV_TYPE_BYTES_CHUNK   = 0x12
+SMOLTLV_TYPE_STRING_CHUNK  = 0x13
+
+SMOLTLV_TYPE_MAX        = 0x14
+
+SMOLTLV_MAX_LENGTH      = 0xFFFFFF
+
+# Chunk type -> type of terminating item
+_CHUNK_TYPES = {
+    SMOLTLV_TYPE_BYTES_CHUNK:  SMOLTLV_TYPE_BYTES,
+    SMOLTLV_TYPE_STRING_CHUNK: SMOLTLV_TYPE_STRING,
+}
+
+def _array_typecode(kinds, itemsize):
+    for typecode in kinds:
+        if array(typecode).itemsize == itemsize:
+            return typecode
+    return None
+
+# Typed array type ID -> array.array typecode with matching element size
+_ARRAY_TYPECODES = {
+    SMOLTLV_TYPE_ARRAY_INT8:    _array_typecode("bhilq", 1),
+    SMOLTLV_TYPE_ARRAY_INT16:   _array_typecode("bhilq", 2),
+    SMOLTLV_TYPE_ARRAY_INT32:   _array_typecode("bhilq", 4),
+    SMOLTLV_TYPE_ARRAY_INT64:   _array_typecode("bhilq", 8),
+    SMOLTLV_TYPE_ARRAY_FLOAT32: _array_typecode("fd", 4),
+    SMOLTLV_TYPE_ARRAY_FLOAT64: _array_typecode("fd", 8),
+}
+
+def _array_type_id(value):
+    if value.typecode in "bhilqfd":
+        is_float = value.typecode in "fd"
+        for type_id, typecode in _ARRAY_TYPECODES.items():
+            if typecode is not None \
+               and (typecode in "fd") == is_float \
+               and value.itemsize == array(typecode).itemsize:
+                return type_id
+    raise ValueError(f"Unsupported array typecode: {value.typecode}")
+
+def _wrap_int64(value):
+    return ((value + 2**63) % 2**64) - 2**63
+
+class RecordBatch:
+    """Records sharing the same keys, stored column by column"""
+    def __init__(self, keys, columns):
+        self.keys = list(keys)
+        self.columns = [list(column) for column in columns]
+        if len(self.keys) != len(self.columns):
+            raise ValueError("Number of keys and columns differs")
+        if len(set(len(column) for column in self.columns)) > 1:
+            raise ValueError("Columns have different lengths")
+
+    @classmethod
+    def from_rows(cls, rows):
+        rows = list(rows)
+        keys = list(rows[0].keys()) if rows else []
+        for row in rows:
+            if set(row.keys()) != set(keys):
+                raise ValueError("Rows have different keys")
+        return cls(keys, [[row[key] for row in rows] for key in keys])
+
+    def __len__(self):
+        return len(self.columns[0]) if self.columns else 0
+
+    def column(self, key):
+        return self.columns[self.keys.index(key)]
+
+    def rows(self):
+        for values in zip(*self.columns):
+            yield dict(zip(self.keys, values))
+
+    def __eq__(self, other):
+        return isinstance(other, RecordBatch) \
+            and self.keys == other.keys \
+            and self.columns == other.columns
+
+    def __repr__(self):
+        return f"RecordBatch({self.keys!r}, {self.columns!r})"
 
 class UnknownTLV:
     def __init__(self, type_id, data):
@@ -35,6 +132,16 @@ class Decoder:
         self.fp = fp
         self.position = 0
         self.allow_unknown_types = allow_unknown_types
+        self.string_table = None
+        self._depth = 0
+
+    def _decode_child(self):
+        """Decodes item inside a container, chunks are invalid there"""
+        self._depth += 1
+        try:
+            return self.decode()
+        finally:
+            self._depth -= 1
 
     def _read_bytes(self, n):
         data = self.fp.read(n)
@@ -56,8 +163,8 @@ class Decoder:
             items = {}
             end_position = self.position + length
             while self.position < end_position:
-                key = self.decode()
-                value = self.decode()
+                key = self._decode_child()
+                value = self._decode_child()
                 items[key] = value
             return items
         
@@ -65,9 +172,49 @@ class Decoder:
             items = []
             end_position = self.position + length
             while self.position < end_position:
-                items.append(self.decode())
+                items.append(self._decode_child())
             return items
 
+        if type_id == SMOLTLV_TYPE_RECORD_BATCH:
+            end_position = self.position + length
+            keys = self._decode_child()
+            if not isinstance(keys, list):
+                raise DecoderError("Invalid record batch schema")
+            columns = []
+            while self.position < end_position:
+                column = self._decode_child()
+                if not isinstance(column, (list, array)) \
+                   or (isinstance(column, array) and column.typecode in "fd"):
+                    raise DecoderError("Invalid record batch column")
+                columns.append(column)
+            try:
+                return RecordBatch(keys, columns)
+            except ValueError as e:
+                raise DecoderError(f"Invalid record batch: {e}")
+
+        if type_id == SMOLTLV_TYPE_DELTA:
+            deltas = self._decode_child()
+            if not isinstance(deltas, array) or deltas.typecode in "fd":
+                raise DecoderError("Invalid delta column")
+            values = []
+            value = 0
+            for delta in deltas:
+                value = _wrap_int64(value + delta)
+                values.append(value)
+            return values
+
+        if type_id == SMOLTLV_TYPE_STRING_TABLE:
+            # Table applies to the items following it
+            strings = []
+            end_position = self.position + length
+            while self.position < end_position:
+                string = self._decode_child()
+                if not isinstance(string, str):
+                    raise DecoderError("Invalid string table entry")
+                strings.append(string)
+            self.string_table = strings
+            return self.decode()
+
         data = self._read_bytes(length)
 
         if type_id == SMOLTLV_TYPE_NULL:  # Null
@@ -96,20 +243,158 @@ class Decoder:
         if type_id == SMOLTLV_TYPE_STRING:  # String
             return data.decode('utf-8')
 
+        if type_id in _CHUNK_TYPES:  # Chunked value, parts up to terminator
+            if self._depth:
+                raise DecoderError("Chunked value inside container")
+            value_type = _CHUNK_TYPES[type_id]
+            parts = [data]
+            while True:
+                part_type, length = self._read_header()
+                if part_type not in (type_id, value_type):
+                    raise DecoderError(f"Invalid chunk type: {part_type:02x}")
+                parts.append(self._read_bytes(length))
+                if part_type == value_type:
+                    break
+            data = b"".join(parts)
+            return data if value_type == SMOLTLV_TYPE_BYTES else data.decode('utf-8')
+
+        if type_id == SMOLTLV_TYPE_STRING_REF:  # String table reference
+            if length < 1 or length > 4:
+                raise DecoderError("Invalid length for string reference")
+            index = int.from_bytes(data, "big")
+            if self.string_table is None or index >= len(self.string_table):
+                raise DecoderError(f"Invalid string reference: {index}")
+            return self.string_table[index]
+
+        if type_id in _ARRAY_TYPECODES:  # Typed array
+            values = array(_ARRAY_TYPECODES[type_id])
+            if length % values.itemsize != 0:
+                raise DecoderError("Invalid length for typed array")
+            values.frombytes(data)
+            if sys.byteorder == "little":
+                values.byteswap()
+            return values
+
         if self.allow_unknown_types:
             return UnknownTLV(type_id, data)
         
         raise DecoderError(f"Unknown type ID: {type_id:02x}")
 
+_HEADER = struct.Struct('>I')
+_HEADER_INT = struct.Struct('>Iq')
+_PLACEHOLDER = bytes(4)
+
+def _header(type_id, length):
+    return (type_id << 24) | (length & 0xFFFFFF)
+
+def _delta_array(values):
+    """Delta-encodes int column into narrowest typed array"""
+    deltas = []
+    previous = 0
+    for value in values:
+        deltas.append(_wrap_int64(value - previous))
+        previous = value
+    bits = max((delta.bit_length() for delta in deltas), default=0)
+    for type_id in (SMOLTLV_TYPE_ARRAY_INT8, SMOLTLV_TYPE_ARRAY_INT16,
+                    SMOLTLV_TYPE_ARRAY_INT32, SMOLTLV_TYPE_ARRAY_INT64):
+        typecode = _ARRAY_TYPECODES[type_id]
+        if bits < array(typecode).itemsize * 8:
+            break
+    return array(typecode, deltas)
+
+def _is_int_column(column):
+    return all(type(item) is int for item in column)
+
 class Encoder:
-    def __init__(self, fp):
+    """Encodes into a single bytearray, container headers are written as 
+    placeholders and backpatched once their content is known. When fp is 
+    given, each top-level item is written to it as a whole."""
+    def __init__(self, fp=None):
         self.fp = fp
+        self.string_ids = {}
+        self._reset()
+
+    def _reset(self):
+        # Appending mode, position is the buffer length
+        self.buffer = bytearray()
+        self._write = self.buffer.extend
+        self._tell = self.buffer.__len__
+
+    def getvalue(self):
+        return bytes(self.buffer[:self._tell()])
+
+    def reserve(self, size):
+        """Preallocates size bytes (e.g. from encoded_size()), following 
+        writes fill the buffer in place"""
+        self.position = self._tell()
+        missing = self.position + size - len(self.buffer)
+        if missing > 0:
+            self.buffer.extend(bytes(missing))
+        self._write = self._write_in_place
+        self._tell = lambda: self.position
+
+    def _write_in_place(self, data):
+        end = self.position + len(data)
+        self.buffer[self.position:end] = data
+        self.position = end
 
     def _write_header(self, type_id, length):
-        header = (type_id << 24) | (length & 0xFFFFFF)
-        self.fp.write(struct.pack('>I', header))
+        self._write(_HEADER.pack(_header(type_id, length)))
+
+    def _start(self):
+        start = self._tell()
+        self._write(_PLACEHOLDER)
+        return start
+
+    def _end(self, type_id, start):
+        _HEADER.pack_into(self.buffer, start, 
+                          _header(type_id, self._tell() - start - 4))
+
+    def _flush(self):
+        if self.fp is not None:
+            self.fp.write(memoryview(self.buffer)[:self._tell()])
+            self._reset()
+
+    def write_string_table(self, strings):
+        """Writes string table, following dict keys present in it are encoded 
+        as references"""
+        start = self._start()
+        for string in strings:
+            self._encode(str(string))
+        self._end(SMOLTLV_TYPE_STRING_TABLE, start)
+        self._flush()
+        self.string_ids = {string: index for index, string in enumerate(strings)}
+
+    def _encode_key(self, key):
+        if isinstance(key, str) and key in self.string_ids:
+            index = self.string_ids[key]
+            data = index.to_bytes(max(1, (index.bit_length() + 7) // 8), "big")
+            self._write_header(SMOLTLV_TYPE_STRING_REF, len(data))
+            self._write(data)
+            return
+        self._encode(key)
 
     def encode(self, value):
+        self._encode(value)
+        self._flush()
+
+    def write_chunks(self, chunks, string=False):
+        """Writes chunked BYTES (or STRING) value from iterable of bytes-like 
+        (or str) parts, each part is written (and flushed to fp) as it arrives"""
+        chunk_type = SMOLTLV_TYPE_STRING_CHUNK if string else SMOLTLV_TYPE_BYTES_CHUNK
+        for chunk in chunks:
+            if isinstance(chunk, str):
+                chunk = chunk.encode("utf-8")
+            view = memoryview(chunk).cast("B")
+            for start in range(0, len(view), SMOLTLV_MAX_LENGTH):
+                part = view[start:start + SMOLTLV_MAX_LENGTH]
+                self._write_header(chunk_type, len(part))
+                self._write(part)
+            self._flush()
+        self._write_header(_CHUNK_TYPES[chunk_type], 0)
+        self._flush()
+
+    def _encode(self, value):
         if value is None:
             self._write_header(SMOLTLV_TYPE_NULL, 0)
             return
@@ -123,58 +408,407 @@ class Encoder:
             return
 
         if isinstance(value, int):
-            self._write_header(SMOLTLV_TYPE_INT, 8)
-            self.fp.write(struct.pack('>q', value))
+            self._write(_HEADER_INT.pack(_header(SMOLTLV_TYPE_INT, 8), value))
             return
 
         if isinstance(value, bytes):
             self._write_header(SMOLTLV_TYPE_BYTES, len(value))
-            self.fp.write(value)
+            self._write(value)
             return
 
         if isinstance(value, str):
             encoded_str = value.encode('utf-8')
             self._write_header(SMOLTLV_TYPE_STRING, len(encoded_str))
-            self.fp.write(encoded_str)
+            self._write(encoded_str)
+            return
+
+        if isinstance(value, array):
+            type_id = _array_type_id(value)
+            if sys.byteorder == "little":
+                value = array(value.typecode, value)
+                value.byteswap()
+            data = value.tobytes()
+            self._write_header(type_id, len(data))
+            self._write(data)
             return
 
         if isinstance(value, list):
-            buffer = BytesIO()
-            encoder = Encoder(buffer)
+            start = self._start()
             for item in value:
-                encoder.encode(item)
-            data = buffer.getvalue()
-            self._write_header(SMOLTLV_TYPE_LIST, len(data))
-            self.fp.write(data)
+                self._encode(item)
+            self._end(SMOLTLV_TYPE_LIST, start)
             return
 
         if isinstance(value, dict):
-            buffer = BytesIO()
-            encoder = Encoder(buffer)
+            start = self._start()
             for key, val in value.items():
-                encoder.encode(key)
-                encoder.encode(val)
-            data = buffer.getvalue()
-            self._write_header(SMOLTLV_TYPE_DICT, len(data))
-            self.fp.write(data)
+                self._encode_key(key)
+                self._encode(val)
+            self._end(SMOLTLV_TYPE_DICT, start)
+            return
+
+        if isinstance(value, RecordBatch):
+            start = self._start()
+            schema_start = self._start()
+            for key in value.keys:
+                self._encode_key(key)
+            self._end(SMOLTLV_TYPE_LIST, schema_start)
+            for column in value.columns:
+                if _is_int_column(column):
+                    delta_start = self._start()
+                    self._encode(_delta_array(column))
+                    self._end(SMOLTLV_TYPE_DELTA, delta_start)
+                else:
+                    self._encode(column)
+            self._end(SMOLTLV_TYPE_RECORD_BATCH, start)
             return
 
         if isinstance(value, UnknownTLV):
             self._write_header(value.type_id, len(value.data))
-            self.fp.write(value.data)
+            self._write(value.data)
             return
 
         raise ValueError(f"Unsupported type: {type(value)}")
+
+    def _key_size(self, key):
+        if isinstance(key, str) and key in self.string_ids:
+            return 4 + max(1, (self.string_ids[key].bit_length() + 7) // 8)
+        return self.encoded_size(key)
+
+    def encoded_size(self, value):
+        """Exact number of bytes encode(value) writes"""
+        if value is None or value is True or value is False:
+            return 4
+
+        if isinstance(value, int):
+            return 12
+
+        if isinstance(value, bytes):
+            return 4 + len(value)
+
+        if isinstance(value, str):
+            return 4 + len(value.encode('utf-8'))
+
+        if isinstance(value, array):
+            _array_type_id(value)
+            return 4 + len(value) * value.itemsize
+
+        # Plain loops keep recursion depth equal to nesting depth
+        if isinstance(value, list):
+            size = 4
+            for item in value:
+                size += self.encoded_size(item)
+            return size
+
+        if isinstance(value, dict):
+            size = 4
+            for key, val in value.items():
+                size += self._key_size(key) + self.encoded_size(val)
+            return size
+
+        if isinstance(value, RecordBatch):
+            size = 8 + sum(self._key_size(key) for key in value.keys)
+            for column in value.columns:
+                if _is_int_column(column):
+                    size += 4 + self.encoded_size(_delta_array(column))
+                else:
+                    size += self.encoded_size(column)
+            return size
+
+        if isinstance(value, UnknownTLV):
+            return 4 + len(value.data)
+
+        raise ValueError(f"Unsupported type: {type(value)}")
     
-def loads(data, allow_unknown_types=False):
+_INT = struct.Struct('>q')
+
+class _LazyContext:
+    """Buffer and decoding state shared by lazy views of one document. 
+    Container views are cached by offset, so repeated access to the same 
+    child reuses positions its view has already scanned."""
+    def __init__(self, data, allow_unknown_types):
+        view = memoryview(data)
+        self.view = view if view.format == "B" and view.ndim == 1 else view.cast("B")
+        self.allow_unknown_types = allow_unknown_types
+        self.string_table = None
+        self.views = {}
+
+    def header(self, offset, end, nested=False):
+        """Returns (type, start, end) of item at offset, chunks are invalid 
+        in nested (container) items"""
+        if end - offset < 4:
+            raise DecoderError("Unexpected end of data")
+        header = _HEADER.unpack_from(self.view, offset)[0]
+        if nested and header >> 24 in _CHUNK_TYPES:
+            raise DecoderError("Chunked value inside container")
+        length = header & 0xFFFFFF
+        start = offset + 4
+        if end - start < length:
+            raise DecoderError("Unexpected end of data")
+        return header >> 24, start, start + length
+
+    def decode(self, offset, end):
+        """Decodes item at offset, returns (value, end of item)"""
+        type_id, start, item_end = self.header(offset, end)
+
+        if type_id in _CHUNK_TYPES:
+            chunks = ChunkReader(self.view[offset:end])
+            data = b"".join(chunks)
+            item_end = offset + chunks.end
+            if _CHUNK_TYPES[type_id] == SMOLTLV_TYPE_STRING:
+                return str(data, "utf-8"), item_end
+            return data, item_end
+
+        if type_id == SMOLTLV_TYPE_STRING_TABLE:
+            # Table applies to the items following it
+            self.string_table = LazyList(self, start, item_end).to_python()
+            if not all(isinstance(string, str) for string in self.string_table):
+                raise DecoderError("Invalid string table entry")
+            return self.decode(item_end, end)
+
+        if type_id in (SMOLTLV_TYPE_LIST, SMOLTLV_TYPE_DICT):
+            view = self.views.get(offset)
+            if view is None:
+                view_type = LazyList if type_id == SMOLTLV_TYPE_LIST else LazyDict
+                view = self.views[offset] = view_type(self, start, item_end)
+            return view, item_end
+
+        if type_id == SMOLTLV_TYPE_BYTES:
+            return self.view[start:item_end], item_end
+
+        if type_id == SMOLTLV_TYPE_STRING:
+            return str(self.view[start:item_end], "utf-8"), item_end
+
+        if type_id == SMOLTLV_TYPE_STRING_REF and 1 <= item_end - start <= 4:
+            index = int.from_bytes(self.view[start:item_end], "big")
+            if self.string_table is None or index >= len(self.string_table):
+                raise DecoderError(f"Invalid string reference: {index}")
+            return self.string_table[index], item_end
+
+        if type_id == SMOLTLV_TYPE_INT and item_end - start == 8:
+            return _INT.unpack_from(self.view, start)[0], item_end
+
+        if type_id in (SMOLTLV_TYPE_NULL, SMOLTLV_TYPE_BOOL_TRUE, 
+                       SMOLTLV_TYPE_BOOL_FALSE) and item_end == start:
+            return (None, True, False)[type_id], item_end
+
+        # Everything else is decoded eagerly
+        decoder = Decoder(BytesIO(self.view[offset:item_end]), 
+                          allow_unknown_types=self.allow_unknown_types)
+        decoder.string_table = self.string_table
+        return decoder.decode(), item_end
+
+def _to_python(value):
+    if isinstance(value, (LazyDict, LazyList)):
+        return value.to_python()
+    if isinstance(value, memoryview):
+        return value.tobytes()
+    return value
+
+class LazyList:
+    """Read-only list view decoding elements on access, element positions 
+    found so far are cached"""
+    def __init__(self, context, start, end):
+        self._context = context
+        self._end = end
+        self._offsets = []
+        self._scan_position = start
+
+    def _scan_to(self, index):
+        """Finds element positions up to index (None scans all)"""
+        offsets = self._offsets
+        while (index is None or len(offsets) <= index) \
+              and self._scan_position < self._end:
+            offsets.append(self._scan_position)
+            _, _, self._scan_position = self._context.header(
+                self._scan_position, self._end, True)
+
+    def __len__(self):
+        self._scan_to(None)
+        return len(self._offsets)
+
+    def __getitem__(self, index):
+        if isinstance(index, slice):
+            return [self[i] for i in range(*index.indices(len(self)))]
+        if index < 0:
+            index += len(self)
+        self._scan_to(index)
+        if index < 0 or index >= len(self._offsets):
+            raise IndexError("list index out of range")
+        return self._context.decode(self._offsets[index], self._end)[0]
+
+    def __iter__(self):
+        index = 0
+        while True:
+            self._scan_to(index)
+            if index >= len(self._offsets):
+                return
+            yield self._context.decode(self._offsets[index], self._end)[0]
+            index += 1
+
+    def __eq__(self, other):
+        if not isinstance(other, (list, LazyList)):
+            return NotImplemented
+        return len(self) == len(other) \
+            and all(a == b for a, b in zip(self, other))
+
+    def to_python(self):
+        return [_to_python(value) for value in self]
+
+    def __repr__(self):
+        return f"LazyList({self.to_python()!r})"
+
+class LazyDict:
+    """Read-only dict view, entries are scanned only as far as needed to 
+    find a key, keys found so far are cached with their value positions. 
+    For duplicate keys the first entry is used."""
+    def __init__(self, context, start, end):
+        self._context = context
+        self._end = end
+        self._index = {}
+        self._scan_position = start
+
+    def _scan_entry(self):
+        self._context.header(self._scan_position, self._end, True)
+        key, value_offset = self._context.decode(self._scan_position, self._end)
+        if value_offset >= self._end:
+            raise DecoderError("Unexpected end of data")
+        _, _, self._scan_position = self._context.header(value_offset, self._end, True)
+        key = _to_python(key)
+        self._index.setdefault(key, value_offset)
+        return key
+
+    def _find(self, key):
+        offset = self._index.get(key)
+        while offset is None and self._scan_position < self._end:
+            if self._scan_entry() == key:
+                offset = self._index[key]
+        return offset
+
+    def __getitem__(self, key):
+        offset = self._find(key)
+        if offset is None:
+            raise KeyError(key)
+        return self._context.decode(offset, self._end)[0]
+
+    def get(self, key, default=None):
+        offset = self._find(key)
+        if offset is None:
+            return default
+        return self._context.decode(offset, self._end)[0]
+
+    def __contains__(self, key):
+        return self._find(key) is not None
+
+    def _scan_all(self):
+        while self._scan_position < self._end:
+            self._scan_entry()
+
+    def __len__(self):
+        self._scan_all()
+        return len(self._index)
+
+    def __iter__(self):
+        self._scan_all()
+        return iter(list(self._index))
+
+    def keys(self):
+        return list(self)
+
+    def items(self):
+        return [(key, self[key]) for key in self]
+
+    def values(self):
+        return [self[key] for key in self]
+
+    def __eq__(self, other):
+        if not isinstance(other, (dict, LazyDict)):
+            return NotImplemented
+        return len(self) == len(other) \
+            and all(key in other and self[key] == other[key] for key in self)
+
+    def to_python(self):
+        return {key: _to_python(value) for key, value in self.items()}
+
+    def __repr__(self):
+        return f"LazyDict({self.to_python()!r})"
+
+class ChunkReader:
+    """Iterates over parts of chunked (or plain) BYTES/STRING value at the 
+    start of data as zero-copy memoryviews, after iteration end is the 
+    offset following the value"""
+    def __init__(self, data):
+        view = memoryview(data)
+        self._view = view if view.format == "B" and view.ndim == 1 else view.cast("B")
+        self._value_type = None
+        self.end = 0
+        self._done = False
+
+    def __iter__(self):
+        return self
+
+    def __next__(self):
+        if self._done:
+            raise StopIteration
+        if len(self._view) - self.end < 4:
+            raise DecoderError("Unexpected end of data")
+        header = _HEADER.unpack_from(self._view, self.end)[0]
+        type_id, start = header >> 24, self.end + 4
+        item_end = start + (header & 0xFFFFFF)
+        if item_end > len(self._view):
+            raise DecoderError("Unexpected end of data")
+
+        value_type = _CHUNK_TYPES.get(type_id, type_id)
+        if value_type not in (SMOLTLV_TYPE_BYTES, SMOLTLV_TYPE_STRING) \
+           or self._value_type not in (None, value_type):
+            raise DecoderError(f"Invalid chunk type: {type_id:02x}")
+        self._value_type = value_type
+        self._done = type_id == value_type
+        self.end = item_end
+        return self._view[start:item_end]
+
+def loads_lazy(data, allow_unknown_types=False):
+    """Like loads, but LIST and DICT items are returned as LazyList and 
+    LazyDict over data (any buffer, e.g. mmap) and BYTES as memoryview 
+    slices of it. Data must not be modified while views are in use."""
+    context = _LazyContext(data, allow_unknown_types)
+    return context.decode(0, len(context.view))[0]
+
+def _loads_python(data, allow_unknown_types=False):
     decoder = Decoder(BytesIO(data), allow_unknown_types=allow_unknown_types)
     return decoder.decode()
 
-def dumps(value):
-    buffer = BytesIO()
-    encoder = Encoder(buffer)
+def _dumps_python(value, string_table=None, exact_size=False):
+    encoder = Encoder()
+    if string_table is not None:
+        encoder.write_string_table(string_table)
+    if exact_size:
+        encoder.reserve(encoder.encoded_size(value))
     encoder.encode(value)
-    return buffer.getvalue()
+    return encoder.getvalue()
+
+# Optional C accelerator (see setup.py), string tables and record batches 
+# are always encoded by the Python code
+try:
+    from smoltlv import _native
+    _native._init(DecoderError, UnknownTLV, RecordBatch, array,
+                  _ARRAY_TYPECODES, _array_type_id)
+except ImportError:
+    _native = None
+
+def loads(data, allow_unknown_types=False):
+    if _native is not None and (not data or data[0] not in _CHUNK_TYPES):
+        return _native.loads(data, allow_unknown_types)
+    return _loads_python(data, allow_unknown_types)
+
+def dumps(value, string_table=None, exact_size=False):
+    """With exact_size, output buffer is allocated once after a sizing pass 
+    over value"""
+    if _native is not None and string_table is None:
+        encoded = _native.dumps(value)
+        if encoded is not NotImplemented:
+            return encoded
+    return _dumps_python(value, string_table, exact_size)
 
 __all__ = [
     "Decoder",
@@ -183,4 +817,9 @@ __all__ = [
     "dumps",
     "DecoderError",
     "UnknownTLV",
+    "RecordBatch",
+    "LazyDict",
+    "LazyList",
+    "loads_lazy",
+    "ChunkReader",
 ]
\ No newline at end of file
@@ -0,0 +1,682 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil -*-
+ * 
+ * SmolTLV - Simple serialization format for JSON/CBOR-like data model 
+ * for embedded devices - Python accelerator module.
+ * 
+ * Copyright (c) 2025 Aleš Hakl
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Optional accelerator for smoltlv.loads / smoltlv.dumps built on the C
+ * implementation. Python classes and tables the results are built from
+ * are handed over by smoltlv/__init__.py through _init().
+ */
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <smoltlv.h>
+
+static PyObject *DecoderError = NULL;
+static PyObject *UnknownTLV = NULL;
+static PyObject *RecordBatch = NULL;
+static PyObject *ArrayType = NULL;
+static PyObject *ArrayTypecodes = NULL;
+static PyObject *ArrayTypeId = NULL;
+
+/* Returned by encode_value when value has to be encoded in Python */
+#define ENCODE_FALLBACK 1
+
+/*
+ * Decoding
+ */
+
+typedef struct DecodeState_s {
+    int allow_unknown_types;
+    PyObject *string_table;
+} DecodeState;
+
+static PyObject *decode_item(DecodeState *state, SmolTLV_Cursor *cursor);
+
+static int cursor_at_end(const SmolTLV_Cursor *cursor) {
+    return cursor->position >= cursor->size;
+}
+
+static PyObject *decode_list(DecodeState *state, SmolTLV_Item item) {
+    SmolTLV_Cursor cursor;
+    SmolTLV_Cursor_for_item(&cursor, item);
+
+    PyObject *list = PyList_New(0);
+    if (!list) {
+        return NULL;
+    }
+    while (!cursor_at_end(&cursor)) {
+        PyObject *value = decode_item(state, &cursor);
+        if (!value || PyList_Append(list, value) < 0) {
+            Py_XDECREF(value);
+            Py_DECREF(list);
+            return NULL;
+        }
+        Py_DECREF(value);
+    }
+    return list;
+}
+
+static PyObject *decode_dict(DecodeState *state, SmolTLV_Item item) {
+    SmolTLV_Cursor cursor;
+    SmolTLV_Cursor_for_item(&cursor, item);
+
+    PyObject *dict = PyDict_New();
+    if (!dict) {
+        return NULL;
+    }
+    while (!cursor_at_end(&cursor)) {
+        PyObject *key = decode_item(state, &cursor);
+        PyObject *value = key ? decode_item(state, &cursor) : NULL;
+        int failed = !value || PyDict_SetItem(dict, key, value) < 0;
+        Py_XDECREF(key);
+        Py_XDECREF(value);
+        if (failed) {
+            Py_DECREF(dict);
+            return NULL;
+        }
+    }
+    return dict;
+}
+
+static int is_int_array(PyObject *value) {
+    int is_array = PyObject_IsInstance(value, ArrayType);
+    if (is_array <= 0) {
+        return is_array;
+    }
+    PyObject *typecode = PyObject_GetAttrString(value, "typecode");
+    if (!typecode) {
+        return -1;
+    }
+    int is_float = PyUnicode_CompareWithASCIIString(typecode, "f") == 0
+        || PyUnicode_CompareWithASCIIString(typecode, "d") == 0;
+    Py_DECREF(typecode);
+    return !is_float;
+}
+
+static PyObject *decode_record_batch(DecodeState *state, SmolTLV_Item item) {
+    SmolTLV_Cursor cursor;
+    SmolTLV_Cursor_for_item(&cursor, item);
+
+    PyObject *keys = decode_item(state, &cursor);
+    if (!keys) {
+        return NULL;
+    }
+    if (!PyList_Check(keys)) {
+        Py_DECREF(keys);
+        PyErr_SetString(DecoderError, "Invalid record batch schema");
+        return NULL;
+    }
+
+    PyObject *columns = PyList_New(0);
+    if (!columns) {
+        Py_DECREF(keys);
+        return NULL;
+    }
+    while (!cursor_at_end(&cursor)) {
+        PyObject *column = decode_item(state, &cursor);
+        int valid = column ? (PyList_Check(column) ? 1 : is_int_array(column)) : -1;
+        if (valid == 0) {
+            PyErr_SetString(DecoderError, "Invalid record batch column");
+        }
+        if (valid <= 0 || PyList_Append(columns, column) < 0) {
+            Py_XDECREF(column);
+            Py_DECREF(columns);
+            Py_DECREF(keys);
+            return NULL;
+        }
+        Py_DECREF(column);
+    }
+
+    PyObject *batch = PyObject_CallFunctionObjArgs(RecordBatch, keys, columns, NULL);
+    Py_DECREF(columns);
+    Py_DECREF(keys);
+    if (!batch && PyErr_ExceptionMatches(PyExc_ValueError)) {
+        PyObject *type, *value, *traceback;
+        PyErr_Fetch(&type, &value, &traceback);
+        PyErr_NormalizeException(&type, &value, &traceback);
+        PyErr_Format(DecoderError, "Invalid record batch: %S", value);
+        Py_XDECREF(type);
+        Py_XDECREF(value);
+        Py_XDECREF(traceback);
+    }
+    return batch;
+}
+
+static PyObject *decode_delta(DecodeState *state, SmolTLV_Item item) {
+    SmolTLV_Cursor cursor;
+    SmolTLV_Cursor_for_item(&cursor, item);
+
+    PyObject *deltas = decode_item(state, &cursor);
+    if (!deltas) {
+        return NULL;
+    }
+    int valid = is_int_array(deltas);
+    if (valid <= 0) {
+        if (valid == 0) {
+            PyErr_SetString(DecoderError, "Invalid delta column");
+        }
+        Py_DECREF(deltas);
+        return NULL;
+    }
+
+    Py_buffer view;
+    if (PyObject_GetBuffer(deltas, &view, PyBUF_FORMAT) < 0) {
+        Py_DECREF(deltas);
+        return NULL;
+    }
+
+    Py_ssize_t itemsize = view.itemsize;
+    Py_ssize_t count = view.len / itemsize;
+    PyObject *values = PyList_New(count);
+    uint64_t value = 0;
+
+    for (Py_ssize_t i = 0; values && i < count; i++) {
+        const char *p = (const char *)view.buf + i * itemsize;
+        int64_t delta;
+        switch (itemsize) {
+        case 1: delta = *(const int8_t *)p; break;
+        case 2: { int16_t v; memcpy(&v, p, 2); delta = v; break; }
+        case 4: { int32_t v; memcpy(&v, p, 4); delta = v; break; }
+        default: { int64_t v; memcpy(&v, p, 8); delta = v; break; }
+        }
+        // Wraps around like int64 arithmetic
+        value += (uint64_t)delta;
+        PyObject *number = PyLong_FromLongLong((long long)(int64_t)value);
+        if (!number) {
+            Py_CLEAR(values);
+            break;
+        }
+        PyList_SET_ITEM(values, i, number);
+    }
+
+    PyBuffer_Release(&view);
+    Py_DECREF(deltas);
+    return values;
+}
+
+static PyObject *decode_string_table(DecodeState *state,
+                                     SmolTLV_Item item,
+                                     SmolTLV_Cursor *cursor) {
+    PyObject *strings = decode_list(state, item);
+    if (!strings) {
+        return NULL;
+    }
+    for (Py_ssize_t i = 0; i < PyList_GET_SIZE(strings); i++) {
+        if (!PyUnicode_Check(PyList_GET_ITEM(strings, i))) {
+            Py_DECREF(strings);
+            PyErr_SetString(DecoderError, "Invalid string table entry");
+            return NULL;
+        }
+    }
+    Py_XSETREF(state->string_table, strings);
+
+    // Table applies to the items following it
+    return decode_item(state, cursor);
+}
+
+/* Converts between host and big-endian element order (same both ways) */
+static void copy_elements_be(uint8_t *dst,
+                             const uint8_t *src,
+                             size_t length,
+                             size_t element_size) {
+#if PY_LITTLE_ENDIAN
+    switch (element_size) {
+    case 2:
+        for (size_t i = 0; i < length; i += 2u) {
+            uint16_t v;
+            memcpy(&v, src + i, 2u);
+            v = (uint16_t)((v >> 8) | (v << 8));
+            memcpy(dst + i, &v, 2u);
+        }
+        return;
+    case 4:
+        for (size_t i = 0; i < length; i += 4u) {
+            uint32_t v;
+            memcpy(&v, src + i, 4u);
+            v = ((v & 0xFF000000u) >> 24) | ((v & 0x00FF0000u) >> 8)
+              | ((v & 0x0000FF00u) << 8)  | ((v & 0x000000FFu) << 24);
+            memcpy(dst + i, &v, 4u);
+        }
+        return;
+    case 8:
+        for (size_t i = 0; i < length; i += 8u) {
+            uint64_t v;
+            memcpy(&v, src + i, 8u);
+            v = ((v & 0xFF00000000000000ull) >> 56) | ((v & 0x00FF000000000000ull) >> 40)
+              | ((v & 0x0000FF0000000000ull) >> 24) | ((v & 0x000000FF00000000ull) >> 8)
+              | ((v & 0x00000000FF000000ull) << 8)  | ((v & 0x0000000000FF0000ull) << 24)
+              | ((v & 0x000000000000FF00ull) << 40) | ((v & 0x00000000000000FFull) << 56);
+            memcpy(dst + i, &v, 8u);
+        }
+        return;
+    default:
+        break;
+    }
+#else
+    (void)element_size;
+#endif
+    memcpy(dst, src, length);
+}
+
+static PyObject *decode_array(SmolTLV_Item item) {
+    PyObject *type_id = PyLong_FromLong(SmolTLV_Item_get_type_raw(item));
+    PyObject *typecode = type_id ? PyDict_GetItemWithError(ArrayTypecodes, type_id) : NULL;
+    Py_XDECREF(type_id);
+    if (!typecode) {
+        return NULL;
+    }
+
+    size_t element_size = SmolTLV_Type_array_element_size(SmolTLV_Item_get_type(item));
+    size_t length = SmolTLV_Item_get_length(item);
+    const uint8_t *value = SmolTLV_Item_get_value(item);
+
+    PyObject *data = PyBytes_FromStringAndSize(NULL, (Py_ssize_t)length);
+    if (!data) {
+        return NULL;
+    }
+    copy_elements_be((uint8_t *)PyBytes_AS_STRING(data), value, length, element_size);
+
+    PyObject *array = PyObject_CallFunctionObjArgs(ArrayType, typecode, data, NULL);
+    Py_DECREF(data);
+    return array;
+}
+
+static PyObject *decode_primitive(DecodeState *state, SmolTLV_Item item) {
+    uint8_t type = SmolTLV_Item_get_type_raw(item);
+    const char *value = (const char *)SmolTLV_Item_get_value(item);
+    size_t length = SmolTLV_Item_get_length(item);
+
+    switch (type) {
+    case SMOLTLV_TYPE_NULL:
+        Py_RETURN_NONE;
+
+    case SMOLTLV_TYPE_BOOL_TRUE:
+        Py_RETURN_TRUE;
+
+    case SMOLTLV_TYPE_BOOL_FALSE:
+        Py_RETURN_FALSE;
+
+    case SMOLTLV_TYPE_INT: {
+        int64_t number;
+        SmolTLV_Item_as_int(item, &number);
+        return PyLong_FromLongLong((long long)number);
+    }
+
+    case SMOLTLV_TYPE_BYTES:
+        return PyBytes_FromStringAndSize(value, (Py_ssize_t)length);
+
+    case SMOLTLV_TYPE_STRING:
+        return PyUnicode_DecodeUTF8(value, (Py_ssize_t)length, NULL);
+
+    case SMOLTLV_TYPE_STRING_REF: {
+        uint32_t index;
+        SmolTLV_Item_as_string_ref(item, &index);
+        if (!state->string_table || 
+            (Py_ssize_t)index >= PyList_GET_SIZE(state->string_table)) {
+            PyErr_Format(DecoderError, "Invalid string reference: %u", index);
+            return NULL;
+        }
+        PyObject *string = PyList_GET_ITEM(state->string_table, index);
+        Py_INCREF(string);
+        return string;
+    }
+
+    default:
+        break;
+    }
+
+    if (SmolTLV_Item_is_array(item)) {
+        return decode_array(item);
+    }
+
+    if (state->allow_unknown_types) {
+        return PyObject_CallFunction(UnknownTLV, "iy#", (int)type,
+                                     value, (Py_ssize_t)length);
+    }
+
+    PyErr_Format(DecoderError, "Unknown type ID: %02x", (unsigned)type);
+    return NULL;
+}
+
+static PyObject *decode_item(DecodeState *state, SmolTLV_Cursor *cursor) {
+    SmolTLV_Item item;
+    SmolTLV_Status status = SmolTLV_Cursor_next(cursor, &item);
+    if (status == SMOLTLV_STATUS_END || status == SMOLTLV_STATUS_NEED_MORE_DATA) {
+        PyErr_SetString(DecoderError, "Unexpected end of data");
+        return NULL;
+    }
+    if (status != SMOLTLV_STATUS_OK) {
+        PyErr_SetString(DecoderError, "Invalid item");
+        return NULL;
+    }
+
+    if (Py_EnterRecursiveCall(" while decoding SmolTLV")) {
+        return NULL;
+    }
+
+    PyObject *result;
+    switch (SmolTLV_Item_get_type_raw(item)) {
+    case SMOLTLV_TYPE_LIST:
+        result = decode_list(state, item);
+        break;
+    case SMOLTLV_TYPE_DICT:
+        result = decode_dict(state, item);
+        break;
+    case SMOLTLV_TYPE_RECORD_BATCH:
+        result = decode_record_batch(state, item);
+        break;
+    case SMOLTLV_TYPE_DELTA:
+        result = decode_delta(state, item);
+        break;
+    case SMOLTLV_TYPE_STRING_TABLE:
+        result = decode_string_table(state, item, cursor);
+        break;
+    default:
+        result = decode_primitive(state, item);
+        break;
+    }
+
+    Py_LeaveRecursiveCall();
+    return result;
+}
+
+static PyObject *native_loads(PyObject *self, PyObject *args) {
+    Py_buffer data;
+    int allow_unknown_types = 0;
+    (void)self;
+
+    if (!DecoderError) {
+        PyErr_SetString(PyExc_RuntimeError, "smoltlv._native is not initialized");
+        return NULL;
+    }
+    if (!PyArg_ParseTuple(args, "y*|p", &data, &allow_unknown_types)) {
+        return NULL;
+    }
+
+    DecodeState state = { allow_unknown_types, NULL };
+    SmolTLV_Cursor cursor;
+    SmolTLV_Cursor_init(&cursor, (const uint8_t *)data.buf, (size_t)data.len);
+
+    PyObject *result = decode_item(&state, &cursor);
+    Py_XDECREF(state.string_table);
+    PyBuffer_Release(&data);
+    return result;
+}
+
+/*
+ * Encoding
+ */
+
+static int encode_value(SmolTLV_Encoder *encoder, PyObject *value);
+
+/* Encoder failures (e.g. lengths over 24 bits) are left to Python code */
+static int encode_status(SmolTLV_Status status) {
+    if (status == SMOLTLV_STATUS_OK) {
+        return 0;
+    }
+    if (status == SMOLTLV_STATUS_OUT_OF_MEMORY) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    return ENCODE_FALLBACK;
+}
+
+static int encode_buffer(SmolTLV_Encoder *encoder,
+                         SmolTLV_Type type,
+                         PyObject *value) {
+    Py_buffer view;
+    if (PyObject_GetBuffer(value, &view, PyBUF_SIMPLE) < 0) {
+        PyErr_Clear();
+        return ENCODE_FALLBACK;
+    }
+    int result = encode_status(SmolTLV_Encoder_write_primitive(
+        encoder, type, (const uint8_t *)view.buf, (size_t)view.len
+    ));
+    PyBuffer_Release(&view);
+    return result;
+}
+
+static int encode_array(SmolTLV_Encoder *encoder, PyObject *value) {
+    PyObject *type_id = PyObject_CallFunctionObjArgs(ArrayTypeId, value, NULL);
+    if (!type_id) {
+        return -1;
+    }
+    long type = PyLong_AsLong(type_id);
+    Py_DECREF(type_id);
+    if (type == -1 && PyErr_Occurred()) {
+        return -1;
+    }
+
+    Py_buffer view;
+    if (PyObject_GetBuffer(value, &view, PyBUF_SIMPLE) < 0) {
+        return -1;
+    }
+    uint8_t *data = (uint8_t *)PyMem_Malloc(view.len ? (size_t)view.len : 1u);
+    if (!data) {
+        PyBuffer_Release(&view);
+        PyErr_NoMemory();
+        return -1;
+    }
+    copy_elements_be(data, (const uint8_t *)view.buf, (size_t)view.len,
+                     SmolTLV_Type_array_element_size((SmolTLV_Type)type));
+    int result = encode_status(SmolTLV_Encoder_write_primitive(
+        encoder, (SmolTLV_Type)type, data, (size_t)view.len
+    ));
+    PyMem_Free(data);
+    PyBuffer_Release(&view);
+    return result;
+}
+
+static int encode_items(SmolTLV_Encoder *encoder, PyObject *value) {
+    int result = encode_status(SmolTLV_Encoder_start_list(encoder));
+    for (Py_ssize_t i = 0; result == 0 && i < PyList_GET_SIZE(value); i++) {
+        result = encode_value(encoder, PyList_GET_ITEM(value, i));
+    }
+    return result ? result : encode_status(SmolTLV_Encoder_end(encoder));
+}
+
+static int encode_entries(SmolTLV_Encoder *encoder, PyObject *value) {
+    PyObject *key, *item;
+    Py_ssize_t position = 0;
+
+    int result = encode_status(SmolTLV_Encoder_start_dict(encoder));
+    while (result == 0 && PyDict_Next(value, &position, &key, &item)) {
+        result = encode_value(encoder, key);
+        if (result == 0) {
+            result = encode_value(encoder, item);
+        }
+    }
+    return result ? result : encode_status(SmolTLV_Encoder_end(encoder));
+}
+
+static int encode_unknown(SmolTLV_Encoder *encoder, PyObject *value) {
+    PyObject *type_id = PyObject_GetAttrString(value, "type_id");
+    PyObject *data = type_id ? PyObject_GetAttrString(value, "data") : NULL;
+    int result = ENCODE_FALLBACK;
+
+    if (data && PyLong_Check(type_id)) {
+        long type = PyLong_AsLong(type_id);
+        if (type >= 0 && type <= 0xFF) {
+            result = encode_buffer(encoder, (SmolTLV_Type)type, data);
+        }
+    }
+
+    PyErr_Clear();
+    Py_XDECREF(type_id);
+    Py_XDECREF(data);
+    return result;
+}
+
+/* Same type dispatch order as Encoder._encode */
+static int encode_value(SmolTLV_Encoder *encoder, PyObject *value) {
+    if (value == Py_None) {
+        return encode_status(SmolTLV_Encoder_write_null(encoder));
+    }
+    if (value == Py_True || value == Py_False) {
+        return encode_status(SmolTLV_Encoder_write_bool(encoder, value == Py_True));
+    }
+
+    if (PyLong_Check(value)) {
+        int overflow;
+        long long number = PyLong_AsLongLongAndOverflow(value, &overflow);
+        if (overflow) {
+            return ENCODE_FALLBACK;
+        }
+        if (number == -1 && PyErr_Occurred()) {
+            return -1;
+        }
+        return encode_status(SmolTLV_Encoder_write_int(encoder, (int64_t)number));
+    }
+
+    if (PyBytes_Check(value)) {
+        return encode_status(SmolTLV_Encoder_write_primitive(
+            encoder, SMOLTLV_TYPE_BYTES,
+            (const uint8_t *)PyBytes_AS_STRING(value), (size_t)PyBytes_GET_SIZE(value)
+        ));
+    }
+
+    if (PyUnicode_Check(value)) {
+        Py_ssize_t length;
+        const char *str = PyUnicode_AsUTF8AndSize(value, &length);
+        if (!str) {
+            return -1;
+        }
+        return encode_status(SmolTLV_Encoder_write_primitive(
+            encoder, SMOLTLV_TYPE_STRING, (const uint8_t *)str, (size_t)length
+        ));
+    }
+
+    int is_array = PyObject_IsInstance(value, ArrayType);
+    if (is_array < 0) {
+        return -1;
+    }
+    if (is_array) {
+        return encode_array(encoder, value);
+    }
+
+    if (PyList_Check(value) || PyDict_Check(value)) {
+        if (Py_EnterRecursiveCall(" while encoding SmolTLV")) {
+            return -1;
+        }
+        int result = PyList_Check(value) ? encode_items(encoder, value)
+                                         : encode_entries(encoder, value);
+        Py_LeaveRecursiveCall();
+        return result;
+    }
+
+    int is_unknown = PyObject_IsInstance(value, UnknownTLV);
+    if (is_unknown < 0) {
+        return -1;
+    }
+    if (is_unknown) {
+        return encode_unknown(encoder, value);
+    }
+
+    // RecordBatch and unsupported types
+    return ENCODE_FALLBACK;
+}
+
+/* Returns NotImplemented when value has to be encoded in Python */
+static PyObject *native_dumps(PyObject *self, PyObject *value) {
+    (void)self;
+
+    if (!DecoderError) {
+        PyErr_SetString(PyExc_RuntimeError, "smoltlv._native is not initialized");
+        return NULL;
+    }
+
+    SmolTLV_Encoder *encoder = SmolTLV_Encoder_create_with_size(256u);
+    if (!encoder) {
+        return PyErr_NoMemory();
+    }
+
+    PyObject *result = NULL;
+    int status = encode_value(encoder, value);
+    if (status == 0) {
+        const uint8_t *buffer;
+        size_t size;
+        status = encode_status(SmolTLV_Encoder_finalize(encoder, &buffer, &size));
+        if (status == 0) {
+            result = PyBytes_FromStringAndSize((const char *)buffer, (Py_ssize_t)size);
+            free((void *)buffer);
+        }
+    }
+    if (status == ENCODE_FALLBACK) {
+        Py_INCREF(Py_NotImplemented);
+        result = Py_NotImplemented;
+    }
+
+    SmolTLV_Encoder_destroy(encoder);
+    return result;
+}
+
+static PyObject *native_init(PyObject *self, PyObject *args) {
+    (void)self;
+    PyObject *decoder_error, *unknown_tlv, *record_batch;
+    PyObject *array_type, *array_typecodes, *array_type_id;
+
+    if (!PyArg_ParseTuple(args, "OOOOO!O", &decoder_error, &unknown_tlv,
+                          &record_batch, &array_type, &PyDict_Type,
+                          &array_typecodes, &array_type_id)) {
+        return NULL;
+    }
+
+    Py_INCREF(decoder_error);
+    Py_XSETREF(DecoderError, decoder_error);
+    Py_INCREF(unknown_tlv);
+    Py_XSETREF(UnknownTLV, unknown_tlv);
+    Py_INCREF(record_batch);
+    Py_XSETREF(RecordBatch, record_batch);
+    Py_INCREF(array_type);
+    Py_XSETREF(ArrayType, array_type);
+    Py_INCREF(array_typecodes);
+    Py_XSETREF(ArrayTypecodes, array_typecodes);
+    Py_INCREF(array_type_id);
+    Py_XSETREF(ArrayTypeId, array_type_id);
+    Py_RETURN_NONE;
+}
+
+static PyMethodDef native_methods[] = {
+    { "_init", native_init, METH_VARARGS, NULL },
+    { "loads", native_loads, METH_VARARGS,
+      "loads(data, allow_unknown_types=False) -> decoded first item" },
+    { "dumps", native_dumps, METH_O,
+      "dumps(value) -> bytes, NotImplemented when unsupported natively" },
+    { NULL, NULL, 0, NULL },
+};
+
+static struct PyModuleDef native_module = {
+    PyModuleDef_HEAD_INIT,
+    "smoltlv._native",
+    "C accelerator for smoltlv",
+    -1,
+    native_methods,
+    NULL, NULL, NULL, NULL,
+};
+
+PyMODINIT_FUNC PyInit__native(void) {
+    return PyModule_Create(&native_module);
+}
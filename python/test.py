@@ -1,4 +1,9 @@
+import os
+import subprocess
+import sys
 import smoltlv
+from array import array
+from io import BytesIO
 
 def hexdump(data: bytes):
     def to_printable_ascii(byte):
@@ -15,10 +20,11 @@ def hexdump(data: bytes):
     return res
 
 
-def try_roundtrip(value, allow_unknown_types=False):
+def try_roundtrip(value, allow_unknown_types=False, string_table=None):
     print("Testing value:", repr(value))
 
-    encoded = smoltlv.dumps(value)
+    encoded = smoltlv.dumps(value, string_table=string_table)
+    assert smoltlv.dumps(value, string_table=string_table, exact_size=True) == encoded
 
     print("Encoded data:")
     print(hexdump(encoded))
@@ -26,6 +32,13 @@ def try_roundtrip(value, allow_unknown_types=False):
     decoded = smoltlv.loads(encoded, allow_unknown_types=allow_unknown_types)
     assert decoded == value, f"Roundtrip failed: {decoded} != {value}"
 
+    lazy = smoltlv.loads_lazy(encoded, allow_unknown_types=allow_unknown_types)
+    assert lazy == value and smoltlv._to_python(lazy) == decoded
+
+    # C accelerator and pure-Python code have to agree
+    assert smoltlv._dumps_python(value, string_table) == encoded
+    assert smoltlv._loads_python(encoded, allow_unknown_types) == decoded
+
 
 try_roundtrip(None)
 try_roundtrip(True)
@@ -52,4 +65,103 @@ try_roundtrip([
          "level2_key2": False
      }},
     smoltlv.UnknownTLV(0xEF, b"\x09\x0A\x0B")
-], allow_unknown_types=True)
\ No newline at end of file
+], allow_unknown_types=True)
+
+try_roundtrip(array("b", [1, -2, 127]))
+try_roundtrip(array("h", [1, -2, 0x1234]))
+try_roundtrip(array("i", [1, -2, 0x12345678]))
+try_roundtrip(array("q", [1, -2, 0x123456789ABCDEF]))
+try_roundtrip(array("f", [1.5, -0.25]))
+try_roundtrip({"samples": array("d", [1.5, -0.25, 1e300]), "empty": array("q")})
+assert smoltlv.dumps(array("h", [1, -2])) == b"\x09\x00\x00\x04\x00\x01\xff\xfe"
+
+try_roundtrip([{"name": "Alice", "age": 30}, {"name": "Bob", "age": 25, "city": "Brno"}],
+              string_table=["name", "age"])
+assert len(smoltlv.dumps({"name": "x"}, string_table=["name"])) \
+    == len(smoltlv.dumps({"name": "x"})) + 4 + 8 - 3
+
+try_roundtrip(smoltlv.RecordBatch.from_rows([
+    {"ts": 1700000000000 + i * 10, "temp": 215 - i, "status": "ok"} for i in range(100)
+]))
+try_roundtrip(smoltlv.RecordBatch(["a", "b"], [[2**63 - 1, -2**63], [None, "x"]]),
+              string_table=["a"])
+try_roundtrip(smoltlv.RecordBatch([], []))
+batch = smoltlv.loads(smoltlv.dumps(smoltlv.RecordBatch.from_rows([{"k": 1}, {"k": 3}])))
+assert list(batch.rows()) == [{"k": 1}, {"k": 3}]
+
+deep = [1]
+for _ in range(500):
+    deep = [deep, "x"]
+encoded = smoltlv.dumps(deep)
+assert len(encoded) == smoltlv.Encoder().encoded_size(deep) == 500 * 9 + 16
+assert smoltlv.loads(encoded) == deep
+
+stream = BytesIO()
+encoder = smoltlv.Encoder(stream)
+encoder.encode({"a": [1, 2]})
+encoder.encode("b")
+decoder = smoltlv.Decoder(BytesIO(stream.getvalue()))
+assert decoder.decode() == {"a": [1, 2]} and decoder.decode() == "b"
+
+for data in (b"\x03\x00\x00\x08\x00", b"\x06\x00\x00\x08\x00\x00\x00\x00", b"\x99\x00\x00\x00"):
+    for loads in (smoltlv.loads, smoltlv._loads_python):
+        try:
+            loads(data)
+            assert False, f"Decoded invalid data {data!r}"
+        except smoltlv.DecoderError:
+            pass
+
+# Lazy views decode only what is accessed and share the buffer
+data = bytearray(smoltlv.dumps({"blob": b"abc", "list": [1, "two", [3]], "tail": 5}))
+data[-12] = smoltlv.SMOLTLV_TYPE_NULL
+view = smoltlv.loads_lazy(data)
+blob = view["blob"]
+assert isinstance(blob, memoryview) and blob == b"abc"
+data[data.index(b"abc")] = ord("x")
+assert blob == b"xbc"
+assert view["list"][-1][0] == 3 and view["list"][1] == "two"
+assert "tail" in view and view.get("missing") is None
+assert view["list"] is view["list"] and view["list"][2] is view["list"][2]
+for decode in (smoltlv.loads, lambda data: view["tail"]):
+    try:
+        decode(bytes(data))
+        assert False, "Decoded invalid NULL"
+    except smoltlv.DecoderError:
+        pass
+
+# Chunked values are streamed part by part and read back without copying
+stream = BytesIO()
+encoder = smoltlv.Encoder(stream)
+encoder.write_chunks([b"abc", bytearray(b"de"), b""])
+encoder.write_chunks(["ž", "lu"], string=True)
+encoder.encode(7)
+data = stream.getvalue()
+assert data[:4] == b"\x12\x00\x00\x03" and data[13:17] == b"\x04\x00\x00\x00"
+reader = smoltlv.ChunkReader(data)
+assert [bytes(part) for part in reader] == [b"abc", b"de", b""] and reader.end == 17
+decoder = smoltlv.Decoder(BytesIO(data))
+assert decoder.decode() == b"abcde" and decoder.decode() == "žlu" and decoder.decode() == 7
+assert smoltlv.loads(data) == b"abcde" and smoltlv.loads_lazy(data[17:]) == "žlu"
+for data in (b"\x12\x00\x00\x01a", b"\x12\x00\x00\x01a\x05\x00\x00\x00"):
+    try:
+        smoltlv.loads(data)
+        assert False, f"Decoded invalid chunked value {data!r}"
+    except smoltlv.DecoderError:
+        pass
+
+# Chunked values are top-level only, C decoder rejects them in containers too
+nested_chunk = (b"\x06\x00\x00\x09\x13\x00\x00\x01x\x05\x00\x00\x00",
+                b"\x07\x00\x00\x0e\x05\x00\x00\x01a\x12\x00\x00\x01x\x04\x00\x00\x00")
+for data in nested_chunk:
+    for decode in (smoltlv.loads, lambda data: smoltlv.Decoder(BytesIO(data)).decode(),
+                   lambda data: smoltlv.loads_lazy(data).to_python()):
+        try:
+            decode(data)
+            assert False, f"Decoded chunk inside container {data!r}"
+        except smoltlv.DecoderError:
+            pass
+
+# Everything again without the C accelerator
+if smoltlv._native is not None:
+    subprocess.run([sys.executable, __file__], check=True, stdout=subprocess.DEVNULL,
+                   env=dict(os.environ, SMOLTLV_NO_NATIVE="1"))
@@ -134,6 +134,107 @@ SmolTLV does not define duplicate-key semantics. A profile *MUST* specify one of
 - first-wins,
 - collect-all.
 
+= Extension Types
+Extension types are optional. Decoders that do not implement an extension *MUST* treat its items as unknown types and skip them based on the length field.
+
+== Typed Arrays
+Typed arrays carry packed sequences of fixed-size numeric elements. The payload is a concatenation of elements, each encoded big-endian, with no per-element header:
+
+#table(
+  columns: (auto, auto, auto, 1fr),
+  inset: 6pt,
+  align: (left, left, left, left),
+  [*Type name*], [*Value*], [*Element size*], [*Element*],
+  [Int8 array], [`0x08`], [1], [Signed two's complement integer.],
+  [Int16 array], [`0x09`], [2], [Signed two's complement integer.],
+  [Int32 array], [`0x0A`], [4], [Signed two's complement integer.],
+  [Int64 array], [`0x0B`], [8], [Signed two's complement integer.],
+  [Float32 array], [`0x0C`], [4], [IEEE 754 binary32.],
+  [Float64 array], [`0x0D`], [8], [IEEE 754 binary64.],
+)
+
+Payload length *MUST* be a multiple of the element size; the element count is `Length / element size`. Decoders *MUST* reject typed arrays with a payload length that is not a multiple of the element size.
+
+For example, the Int16 array `[1, -2]`:
+```
+09 00 00 04  00 01  FF FE
+```
+
+== String Table
+The string table extension allows repeated strings (typically dictionary keys) to be stored once per document and referenced by index.
+
+#table(
+  columns: (auto, auto, 1fr),
+  inset: 6pt,
+  align: (left, left, left),
+  [*Type name*], [*Value*], [*Meaning*],
+  [String table], [`0x0E`], [Sequence of String items. Entries are numbered from 0 in order of appearance.],
+  [String reference], [`0x0F`], [Unsigned big-endian index into the string table. Payload length *MUST* be 1 to 4.],
+)
+
+A string table item appears in the top-level item sequence and applies to all items following it in the same sequence, until it is replaced by another string table item. A string table item is not a value by itself; decoders that materialize values *SHOULD* use the next item as the document value.
+
+A string reference is semantically equivalent to the String item it refers to. Encoders *SHOULD* use the shortest payload length able to represent the index. A reference to an index not present in the current table is a format error.
+
+For example, the document `{"k": 123}` with `"k"` interned:
+```
+0E 00 00 05
+   05 00 00 01  6B
+07 00 00 0D
+   0F 00 00 01  00
+   03 00 00 08  00 00 00 00  00 00 00 7B
+```
+
+== Record Batches
+Record batches store a sequence of dictionaries sharing the same set of keys column by column.
+
+#table(
+  columns: (auto, auto, 1fr),
+  inset: 6pt,
+  align: (left, left, left),
+  [*Type name*], [*Value*], [*Meaning*],
+  [Record batch], [`0x10`], [Schema followed by columns (container).],
+  [Delta], [`0x11`], [Integer typed array of successive differences (container).],
+)
+
+The record batch payload consists of:
+
+- a *schema*: List of keys (String or String reference items),
+- exactly one *column* item for each key, in the schema order.
+
+A column is one of:
+
+- a List with one item per row,
+- an integer typed array (`0x08..0x0B`) with one element per row,
+- a Delta item.
+
+The Delta payload *MUST* contain exactly one integer typed array item. Row values are its running sums: `value[0] = element[0]`, `value[i] = value[i-1] + element[i]`, computed in 64-bit two's complement arithmetic with wrap-around.
+
+All columns of a batch *MUST* have the same number of rows. Row `i` of the batch is equivalent to a Dict mapping each key of the schema to the row `i` value of its column, where typed array and Delta values are Int items.
+
+== Chunked Values
+Chunked values represent Bytes and String values longer than the maximum item length (`0xFFFFFF` bytes), or values produced incrementally.
+
+#table(
+  columns: (auto, auto, 1fr),
+  inset: 6pt,
+  align: (left, left, left),
+  [*Type name*], [*Value*], [*Meaning*],
+  [Bytes chunk], [`0x12`], [Non-final part of a Bytes value.],
+  [String chunk], [`0x13`], [Non-final part of a String value.],
+)
+
+A chunked value is a sequence of zero or more chunk items followed by a terminating Bytes (for Bytes chunks) or String (for String chunks) item holding the last part, which *MAY* be empty. The value is the concatenation of all payloads in order; a plain Bytes or String item is a chunked value with no chunk items. A chunk item followed by any other type is a format error. A String value *MAY* be split inside a UTF-8 sequence; only the concatenation has to be valid UTF-8.
+
+Since containers cannot exceed the maximum item length, chunked values *SHOULD* only appear in the top-level item sequence.
+
+For example, the Bytes value `"abcde"` sent in two parts:
+```
+12 00 00 03  61 62 63
+12 00 00 02  64 65
+04 00 00 00
+```
+
 = Canonical / Deterministic Encoding (Optional Profile)
 SmolTLV itself allows multiple equivalent encodings (e.g., dictionary order, integer minimality is required but key ordering is not).
 For deterministic encoding, a profile *MAY* require:
@@ -242,4 +343,21 @@ SMOLTLV_TYPE_LIST       = 0x06,
 SMOLTLV_TYPE_DICT       = 0x07,
 ```
 
-Values `0x08..0xFF` are reserved for future assignment or application-specific extensions.
\ No newline at end of file
+The following extension type assignments are defined by this specification:
+
+```
+SMOLTLV_TYPE_ARRAY_INT8    = 0x08,
+SMOLTLV_TYPE_ARRAY_INT16   = 0x09,
+SMOLTLV_TYPE_ARRAY_INT32   = 0x0A,
+SMOLTLV_TYPE_ARRAY_INT64   = 0x0B,
+SMOLTLV_TYPE_ARRAY_FLOAT32 = 0x0C,
+SMOLTLV_TYPE_ARRAY_FLOAT64 = 0x0D,
+SMOLTLV_TYPE_STRING_TABLE  = 0x0E,
+SMOLTLV_TYPE_STRING_REF    = 0x0F,
+SMOLTLV_TYPE_RECORD_BATCH  = 0x10,
+SMOLTLV_TYPE_DELTA         = 0x11,
+SMOLTLV_TYPE_BYTES_CHUNK   = 0x12,
+SMOLTLV_TYPE_STRING_CHUNK  = 0x13,
+```
+
+Values `0x14..0xFF` are reserved for future assignment or application-specific extensions.
\ No newline at end of file